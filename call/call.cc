@@ -1199,7 +1199,8 @@ FlexfecReceiveStream* Call::CreateFlexfecReceiveStream(
   // OnRtpPacket until the constructor is finished and the object is
   // in a valid state, since OnRtpPacket runs on the same thread.
   receive_stream = new FlexfecReceiveStreamImpl(
-      clock_, config, recovered_packet_receiver, call_stats_->AsRtcpRttStats());
+      clock_, config, recovered_packet_receiver, call_stats_->AsRtcpRttStats(),
+      trials_);
 
   // TODO(bugs.webrtc.org/11993): Set this up asynchronously on the network
   // thread.
@@ -75,6 +75,11 @@ struct CallConfig {
   // RtpTransportControllerSend to use for this call.
   RtpTransportControllerSendFactoryInterface*
       rtp_transport_controller_send_factory = nullptr;
+
+  // Pacer shared with the transports of other calls, e.g. those of an SFU. If
+  // not set, the transport of this call is paced on its own. Must outlive the
+  // call.
+  SharedPacer* shared_pacer = nullptr;
 };
 
 }  // namespace webrtc
@@ -13,15 +13,18 @@
 #include <stddef.h>
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/strings/match.h"
 #include "api/array_view.h"
 #include "api/call/transport.h"
 #include "api/rtp_parameters.h"
 #include "call/rtp_stream_receiver_controller_interface.h"
 #include "modules/rtp_rtcp/include/flexfec_receiver.h"
 #include "modules/rtp_rtcp/include/receive_statistics.h"
+#include "modules/rtp_rtcp/include/reed_solomon_fec_receiver.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/checks.h"
@@ -78,16 +81,20 @@ bool FlexfecReceiveStream::Config::IsCompleteAndEnabled() const {
 
 namespace {
 
+// Repair packets of the Reed-Solomon scheme are received in place of FlexFEC
+// packets; see MaybeCreateFecGenerator in rtp_video_sender.cc.
+bool UseReedSolomonFec(const WebRtcKeyValueConfig& field_trials) {
+  return absl::StartsWith(field_trials.Lookup("WebRTC-ReedSolomonFec"),
+                          "Enabled");
+}
+
 // TODO(brandtr): Update this function when we support multistream protection.
-std::unique_ptr<FlexfecReceiver> MaybeCreateFlexfecReceiver(
-    Clock* clock,
-    const FlexfecReceiveStream::Config& config,
-    RecoveredPacketReceiver* recovered_packet_receiver) {
+bool IsValidConfig(const FlexfecReceiveStream::Config& config) {
   if (config.payload_type < 0) {
     RTC_LOG(LS_WARNING)
         << "Invalid FlexFEC payload type given. "
            "This FlexfecReceiveStream will therefore be useless.";
-    return nullptr;
+    return false;
   }
   RTC_DCHECK_GE(config.payload_type, 0);
   RTC_DCHECK_LE(config.payload_type, 127);
@@ -95,13 +102,13 @@ std::unique_ptr<FlexfecReceiver> MaybeCreateFlexfecReceiver(
     RTC_LOG(LS_WARNING)
         << "Invalid FlexFEC SSRC given. "
            "This FlexfecReceiveStream will therefore be useless.";
-    return nullptr;
+    return false;
   }
   if (config.protected_media_ssrcs.empty()) {
     RTC_LOG(LS_WARNING)
         << "No protected media SSRC supplied. "
            "This FlexfecReceiveStream will therefore be useless.";
-    return nullptr;
+    return false;
   }
 
   if (config.protected_media_ssrcs.size() > 1) {
@@ -110,6 +117,17 @@ std::unique_ptr<FlexfecReceiver> MaybeCreateFlexfecReceiver(
            "media streams, but our implementation currently only "
            "supports protecting a single media stream. "
            "To avoid confusion, disabling FlexFEC completely.";
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<FlexfecReceiver> MaybeCreateFlexfecReceiver(
+    Clock* clock,
+    const FlexfecReceiveStream::Config& config,
+    RecoveredPacketReceiver* recovered_packet_receiver,
+    const WebRtcKeyValueConfig& field_trials) {
+  if (UseReedSolomonFec(field_trials) || !IsValidConfig(config)) {
     return nullptr;
   }
   RTC_DCHECK_EQ(1U, config.protected_media_ssrcs.size());
@@ -118,6 +136,20 @@ std::unique_ptr<FlexfecReceiver> MaybeCreateFlexfecReceiver(
       recovered_packet_receiver));
 }
 
+std::unique_ptr<ReedSolomonFecReceiver> MaybeCreateReedSolomonFecReceiver(
+    Clock* clock,
+    const FlexfecReceiveStream::Config& config,
+    RecoveredPacketReceiver* recovered_packet_receiver,
+    const WebRtcKeyValueConfig& field_trials) {
+  if (!UseReedSolomonFec(field_trials) || !IsValidConfig(config)) {
+    return nullptr;
+  }
+  RTC_DCHECK_EQ(1U, config.protected_media_ssrcs.size());
+  return std::make_unique<ReedSolomonFecReceiver>(
+      clock, config.rtp.remote_ssrc, config.protected_media_ssrcs[0],
+      recovered_packet_receiver);
+}
+
 std::unique_ptr<ModuleRtpRtcpImpl2> CreateRtpRtcpModule(
     Clock* clock,
     ReceiveStatistics* receive_statistics,
@@ -140,11 +172,18 @@ FlexfecReceiveStreamImpl::FlexfecReceiveStreamImpl(
     Clock* clock,
     const Config& config,
     RecoveredPacketReceiver* recovered_packet_receiver,
-    RtcpRttStats* rtt_stats)
+    RtcpRttStats* rtt_stats,
+    const WebRtcKeyValueConfig& field_trials)
     : config_(config),
       receiver_(MaybeCreateFlexfecReceiver(clock,
                                            config_,
-                                           recovered_packet_receiver)),
+                                           recovered_packet_receiver,
+                                           field_trials)),
+      reed_solomon_receiver_(
+          MaybeCreateReedSolomonFecReceiver(clock,
+                                            config_,
+                                            recovered_packet_receiver,
+                                            field_trials)),
       rtp_receive_statistics_(ReceiveStatistics::Create(clock)),
       rtp_rtcp_(CreateRtpRtcpModule(clock,
                                     rtp_receive_statistics_.get(),
@@ -167,7 +206,7 @@ void FlexfecReceiveStreamImpl::RegisterWithTransport(
   RTC_DCHECK_RUN_ON(&packet_sequence_checker_);
   RTC_DCHECK(!rtp_stream_receiver_);
 
-  if (!receiver_)
+  if (!receiver_ && !reed_solomon_receiver_)
     return;
 
   // TODO(nisse): OnRtpPacket in this class delegates all real work to
@@ -185,10 +224,13 @@ void FlexfecReceiveStreamImpl::UnregisterFromTransport() {
 
 void FlexfecReceiveStreamImpl::OnRtpPacket(const RtpPacketReceived& packet) {
   RTC_DCHECK_RUN_ON(&packet_sequence_checker_);
-  if (!receiver_)
+  if (receiver_) {
+    receiver_->OnRtpPacket(packet);
+  } else if (reed_solomon_receiver_) {
+    reed_solomon_receiver_->OnRtpPacket(packet);
+  } else {
     return;
-
-  receiver_->OnRtpPacket(packet);
+  }
 
   // Do not report media packets in the RTCP RRs generated by `rtp_rtcp_`.
   if (packet.Ssrc() == config_.rtp.remote_ssrc) {
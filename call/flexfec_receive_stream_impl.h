@@ -14,6 +14,7 @@
 #include <memory>
 #include <vector>
 
+#include "api/transport/webrtc_key_value_config.h"
 #include "call/flexfec_receive_stream.h"
 #include "call/rtp_packet_sink_interface.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl2.h"
@@ -25,6 +26,7 @@ namespace webrtc {
 class FlexfecReceiver;
 class ReceiveStatistics;
 class RecoveredPacketReceiver;
+class ReedSolomonFecReceiver;
 class RtcpRttStats;
 class RtpPacketReceived;
 class RtpRtcp;
@@ -36,7 +38,8 @@ class FlexfecReceiveStreamImpl : public FlexfecReceiveStream {
   FlexfecReceiveStreamImpl(Clock* clock,
                            const Config& config,
                            RecoveredPacketReceiver* recovered_packet_receiver,
-                           RtcpRttStats* rtt_stats);
+                           RtcpRttStats* rtt_stats,
+                           const WebRtcKeyValueConfig& field_trials);
   // Destruction happens on the worker thread. Prior to destruction the caller
   // must ensure that a registration with the transport has been cleared. See
   // `RegisterWithTransport` for details.
@@ -68,8 +71,9 @@ class FlexfecReceiveStreamImpl : public FlexfecReceiveStream {
   // Config. Mostly const, header extensions may change.
   Config config_ RTC_GUARDED_BY(packet_sequence_checker_);
 
-  // Erasure code interfacing.
+  // Erasure code interfacing. At most one of the receivers is set.
   const std::unique_ptr<FlexfecReceiver> receiver_;
+  const std::unique_ptr<ReedSolomonFecReceiver> reed_solomon_receiver_;
 
   // RTCP reporting.
   const std::unique_ptr<ReceiveStatistics> rtp_receive_statistics_;
@@ -11,6 +11,7 @@
 #include "call/flexfec_receive_stream.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -24,8 +25,12 @@
 #include "modules/rtp_rtcp/mocks/mock_recovered_packet_receiver.h"
 #include "modules/rtp_rtcp/mocks/mock_rtcp_rtt_stats.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "test/explicit_key_value_config.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/mock_transport.h"
@@ -88,7 +93,7 @@ class FlexfecReceiveStreamTest : public ::testing::Test {
       : config_(CreateDefaultConfig(&rtcp_send_transport_)) {
     receive_stream_ = std::make_unique<FlexfecReceiveStreamImpl>(
         Clock::GetRealTimeClock(), config_, &recovered_packet_receiver_,
-        &rtt_stats_);
+        &rtt_stats_, field_trials_);
     receive_stream_->RegisterWithTransport(&rtp_stream_receiver_controller_);
   }
 
@@ -96,6 +101,7 @@ class FlexfecReceiveStreamTest : public ::testing::Test {
     receive_stream_->UnregisterFromTransport();
   }
 
+  test::ExplicitKeyValueConfig field_trials_{""};
   MockTransport rtcp_send_transport_;
   FlexfecReceiveStream::Config config_;
   MockRecoveredPacketReceiver recovered_packet_receiver_;
@@ -144,7 +150,7 @@ TEST_F(FlexfecReceiveStreamTest, RecoversPacket) {
   ::testing::StrictMock<MockRecoveredPacketReceiver> recovered_packet_receiver;
   FlexfecReceiveStreamImpl receive_stream(Clock::GetRealTimeClock(), config_,
                                           &recovered_packet_receiver,
-                                          &rtt_stats_);
+                                          &rtt_stats_, field_trials_);
   receive_stream.RegisterWithTransport(&rtp_stream_receiver_controller_);
 
   EXPECT_CALL(recovered_packet_receiver,
@@ -156,4 +162,44 @@ TEST_F(FlexfecReceiveStreamTest, RecoversPacket) {
   receive_stream.UnregisterFromTransport();
 }
 
+// Create a Reed-Solomon repair packet that protects a single media packet, and
+// ensure that the callback is called when the field trial is enabled.
+// Correctness of recovery is checked in the ReedSolomonFecReceiver unit tests.
+TEST_F(FlexfecReceiveStreamTest, RecoversPacketWithReedSolomonFec) {
+  test::ExplicitKeyValueConfig field_trials("WebRTC-ReedSolomonFec/Enabled/");
+  RtpPacketToSend media_packet(nullptr);
+  media_packet.SetPayloadType(107);
+  media_packet.SetSequenceNumber(2);
+  media_packet.SetTimestamp(0xaabbccdd);
+  media_packet.SetSsrc(ByteReader<uint32_t>::ReadBigEndian(kMediaSsrc));
+  media_packet.AllocatePayload(4);
+  const std::vector<rtc::CopyOnWriteBuffer> media_packets = {
+      media_packet.Buffer()};
+  const std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+      ReedSolomonFec::Encode(media_packets, /*num_repair_packets=*/1);
+  ASSERT_EQ(1u, repair_payloads.size());
+
+  RtpPacketToSend repair_packet(nullptr);
+  repair_packet.SetPayloadType(kFlexfecPlType);
+  repair_packet.SetSequenceNumber(1);
+  repair_packet.SetTimestamp(0x00112233);
+  repair_packet.SetSsrc(ByteReader<uint32_t>::ReadBigEndian(kFlexfecSsrc));
+  memcpy(repair_packet.AllocatePayload(repair_payloads[0].size()),
+         repair_payloads[0].cdata(), repair_payloads[0].size());
+
+  ::testing::StrictMock<MockRecoveredPacketReceiver> recovered_packet_receiver;
+  FlexfecReceiveStreamImpl receive_stream(Clock::GetRealTimeClock(), config_,
+                                          &recovered_packet_receiver,
+                                          &rtt_stats_, field_trials);
+  receive_stream.RegisterWithTransport(&rtp_stream_receiver_controller_);
+
+  EXPECT_CALL(recovered_packet_receiver,
+              OnRecoveredPacket(_, media_packet.size()));
+
+  receive_stream.OnRtpPacket(ParsePacket(repair_packet));
+
+  // Tear-down
+  receive_stream.UnregisterFromTransport();
+}
+
 }  // namespace webrtc
@@ -10,6 +10,12 @@
 
 #include "call/rtp_demuxer.h"
 
+#include <string.h>
+
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "api/array_view.h"
 #include "call/rtp_packet_sink_interface.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
@@ -20,6 +26,16 @@
 namespace webrtc {
 namespace {
 
+// Returns the string carried by a string header extension, as parsed by
+// BaseRtpStringExtension, or an empty string if the extension is absent.
+absl::string_view StringExtensionValue(rtc::ArrayView<const uint8_t> data) {
+  if (data.empty()) {
+    return absl::string_view();
+  }
+  const char* cstr = reinterpret_cast<const char*>(data.data());
+  return absl::string_view(cstr, strnlen(cstr, data.size()));
+}
+
 template <typename Container, typename Value>
 size_t RemoveFromMultimapByValue(Container* multimap, const Value& value) {
   size_t count = 0;
@@ -141,6 +157,7 @@ bool RtpDemuxer::AddSink(const RtpDemuxerCriteria& criteria,
   }
 
   RefreshKnownMids();
+  resolved_sink_by_ssrc_.clear();
 
   RTC_LOG(LS_INFO) << "Added sink = " << sink << " for criteria "
                    << criteria.ToString();
@@ -236,6 +253,7 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
                        RemoveFromMapByValue(&sink_by_mid_and_rsid_, sink) +
                        RemoveFromMapByValue(&sink_by_rsid_, sink);
   RefreshKnownMids();
+  resolved_sink_by_ssrc_.clear();
   bool removed = num_removed > 0;
   if (removed) {
     RTC_LOG(LS_INFO) << "Removed sink = " << sink << " bindings";
@@ -244,7 +262,11 @@ bool RtpDemuxer::RemoveSink(const RtpPacketSinkInterface* sink) {
 }
 
 bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
-  RtpPacketSinkInterface* sink = ResolveSink(packet);
+  RtpPacketSinkInterface* sink = FindResolvedSink(packet);
+  if (sink == nullptr) {
+    sink = ResolveSink(packet);
+    CacheResolvedSink(packet.Ssrc(), sink);
+  }
   if (sink != nullptr) {
     sink->OnRtpPacket(packet);
     return true;
@@ -252,6 +274,60 @@ bool RtpDemuxer::OnRtpPacket(const RtpPacketReceived& packet) {
   return false;
 }
 
+RtpPacketSinkInterface* RtpDemuxer::FindResolvedSink(
+    const RtpPacketReceived& packet) const {
+  const auto it = resolved_sink_by_ssrc_.find(packet.Ssrc());
+  if (it == resolved_sink_by_ssrc_.end()) {
+    return nullptr;
+  }
+  const ResolvedSink& resolved = it->second;
+  // A packet without MID or RSID is demuxed by those learned for its SSRC, so
+  // only a different MID or RSID can route it elsewhere.
+  if (use_mid_) {
+    absl::string_view mid =
+        StringExtensionValue(packet.GetRawExtension<RtpMid>());
+    if (!mid.empty() && mid != resolved.mid) {
+      return nullptr;
+    }
+  }
+  absl::string_view rsid =
+      StringExtensionValue(packet.GetRawExtension<RepairedRtpStreamId>());
+  if (rsid.empty()) {
+    rsid = StringExtensionValue(packet.GetRawExtension<RtpStreamId>());
+  }
+  if (!rsid.empty() && rsid != resolved.rsid) {
+    return nullptr;
+  }
+  return resolved.sink;
+}
+
+void RtpDemuxer::CacheResolvedSink(uint32_t ssrc,
+                                   RtpPacketSinkInterface* sink) {
+  if (sink == nullptr) {
+    // The packet may have changed the MID or RSID learned for the SSRC.
+    resolved_sink_by_ssrc_.erase(ssrc);
+    return;
+  }
+  ResolvedSink resolved = {sink, "", ""};
+  const auto mid_it = mid_by_ssrc_.find(ssrc);
+  if (mid_it != mid_by_ssrc_.end()) {
+    resolved.mid = mid_it->second;
+  } else {
+    // Without a MID, a sink picked by payload type is only picked again for
+    // packets with another payload type if the SSRC has been bound to it.
+    const auto ssrc_it = sink_by_ssrc_.find(ssrc);
+    if (ssrc_it == sink_by_ssrc_.end() || ssrc_it->second != sink) {
+      resolved_sink_by_ssrc_.erase(ssrc);
+      return;
+    }
+  }
+  const auto rsid_it = rsid_by_ssrc_.find(ssrc);
+  if (rsid_it != rsid_by_ssrc_.end()) {
+    resolved.rsid = rsid_it->second;
+  }
+  resolved_sink_by_ssrc_[ssrc] = std::move(resolved);
+}
+
 RtpPacketSinkInterface* RtpDemuxer::ResolveSink(
     const RtpPacketReceived& packet) {
   // See the BUNDLE spec for high level reference to this algorithm:
@@ -404,6 +480,16 @@ RtpPacketSinkInterface* RtpDemuxer::ResolveSinkByPayloadType(
 
 void RtpDemuxer::AddSsrcSinkBinding(uint32_t ssrc,
                                     RtpPacketSinkInterface* sink) {
+  auto it = sink_by_ssrc_.find(ssrc);
+  if (it != sink_by_ssrc_.end()) {
+    if (it->second != sink) {
+      RTC_LOG(LS_INFO) << "Updated sink = " << sink
+                       << " binding with SSRC=" << ssrc;
+      it->second = sink;
+    }
+    return;
+  }
+
   if (sink_by_ssrc_.size() >= kMaxSsrcBindings) {
     RTC_LOG(LS_WARNING) << "New SSRC=" << ssrc
                         << " sink binding ignored; limit of" << kMaxSsrcBindings
@@ -411,17 +497,8 @@ void RtpDemuxer::AddSsrcSinkBinding(uint32_t ssrc,
     return;
   }
 
-  auto result = sink_by_ssrc_.emplace(ssrc, sink);
-  auto it = result.first;
-  bool inserted = result.second;
-  if (inserted) {
-    RTC_LOG(LS_INFO) << "Added sink = " << sink
-                     << " binding with SSRC=" << ssrc;
-  } else if (it->second != sink) {
-    RTC_LOG(LS_INFO) << "Updated sink = " << sink
-                     << " binding with SSRC=" << ssrc;
-    it->second = sink;
-  }
+  sink_by_ssrc_.emplace(ssrc, sink);
+  RTC_LOG(LS_INFO) << "Added sink = " << sink << " binding with SSRC=" << ssrc;
 }
 
 }  // namespace webrtc
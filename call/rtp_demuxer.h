@@ -13,6 +13,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -148,6 +149,18 @@ class RtpDemuxer {
   // If the packet should be dropped, this method returns null.
   RtpPacketSinkInterface* ResolveSink(const RtpPacketReceived& packet);
 
+  // Returns the sink that packets with the SSRC of `packet` were last routed
+  // to, if `packet` has the same MID and RSID as those packets, or none of
+  // them. Returns null otherwise, or if no sink has been resolved for the SSRC
+  // since sinks were last added or removed.
+  RtpPacketSinkInterface* FindResolvedSink(
+      const RtpPacketReceived& packet) const;
+
+  // Records that packets with `ssrc` are routed to `sink`. Forgets the sink
+  // resolved for `ssrc` instead if `sink` is null, or was picked by payload
+  // type without binding the SSRC to it.
+  void CacheResolvedSink(uint32_t ssrc, RtpPacketSinkInterface* sink);
+
   // Used by the ResolveSink algorithm.
   RtpPacketSinkInterface* ResolveSinkByMid(const std::string& mid,
                                            uint32_t ssrc);
@@ -189,6 +202,18 @@ class RtpDemuxer {
   flat_map<uint32_t, std::string> mid_by_ssrc_;
   flat_map<uint32_t, std::string> rsid_by_ssrc_;
 
+  // Sinks resolved for each SSRC, along with the MID and RSID learned for the
+  // SSRC when they were resolved, or empty strings if none were. Lets packets
+  // that repeat them, or don't carry them, skip the demuxing algorithm, which
+  // would route them to the same sink. Cleared when sinks are added or
+  // removed.
+  struct ResolvedSink {
+    RtpPacketSinkInterface* sink;
+    std::string mid;
+    std::string rsid;
+  };
+  std::unordered_map<uint32_t, ResolvedSink> resolved_sink_by_ssrc_;
+
   // Adds a binding from the SSRC to the given sink.
   void AddSsrcSinkBinding(uint32_t ssrc, RtpPacketSinkInterface* sink);
 
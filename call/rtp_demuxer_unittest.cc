@@ -1254,6 +1254,48 @@ TEST_F(RtpDemuxerTest, PacketWithMidAndUnknownRsidIsNotRoutedByPayloadType) {
   EXPECT_FALSE(demuxer_.OnRtpPacket(*packet));
 }
 
+TEST_F(RtpDemuxerTest, PacketsWithOnlySsrcFollowLatestMidOfSsrc) {
+  constexpr uint32_t ssrc = 10;
+  MockRtpPacketSink first_sink;
+  MockRtpPacketSink second_sink;
+  AddSinkOnlyMid("a", &first_sink);
+  AddSinkOnlyMid("b", &second_sink);
+
+  InSequence sequence;
+  auto packet_with_first_mid = CreatePacketWithSsrcMid(ssrc, "a");
+  EXPECT_CALL(first_sink, OnRtpPacket(SamePacketAs(*packet_with_first_mid)));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_with_first_mid));
+
+  auto packet_with_second_mid = CreatePacketWithSsrcMid(ssrc, "b");
+  EXPECT_CALL(second_sink,
+              OnRtpPacket(SamePacketAs(*packet_with_second_mid)));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_with_second_mid));
+
+  auto packet_without_mid = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(second_sink, OnRtpPacket(SamePacketAs(*packet_without_mid)));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_without_mid));
+}
+
+TEST_F(RtpDemuxerTest, PacketsWithOnlySsrcDroppedAfterMidWithoutSinkLearned) {
+  constexpr uint32_t ssrc = 10;
+  MockRtpPacketSink mid_sink;
+  MockRtpPacketSink mid_rsid_sink;
+  AddSinkOnlyMid("a", &mid_sink);
+  AddSinkBothMidRsid("b", "1", &mid_rsid_sink);
+
+  auto packet_with_mid_of_sink = CreatePacketWithSsrcMid(ssrc, "a");
+  EXPECT_CALL(mid_sink, OnRtpPacket(SamePacketAs(*packet_with_mid_of_sink)));
+  EXPECT_TRUE(demuxer_.OnRtpPacket(*packet_with_mid_of_sink));
+
+  // The MID is only bound to a sink together with an RSID.
+  auto packet_without_rsid = CreatePacketWithSsrcMid(ssrc, "b");
+  auto packet_without_mid = CreatePacketWithSsrc(ssrc);
+  EXPECT_CALL(mid_sink, OnRtpPacket(_)).Times(0);
+  EXPECT_CALL(mid_rsid_sink, OnRtpPacket(_)).Times(0);
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_without_rsid));
+  EXPECT_FALSE(demuxer_.OnRtpPacket(*packet_without_mid));
+}
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 
 TEST_F(RtpDemuxerDeathTest, CriteriaMustBeNonEmpty) {
@@ -22,6 +22,7 @@
 #include "rtc_base/task_queue.h"
 
 namespace webrtc {
+class SharedPacer;
 
 struct RtpTransportConfig {
   // Bitrate config used until valid bitrate estimates are calculated. Also
@@ -45,6 +46,10 @@ struct RtpTransportConfig {
   // Key-value mapping of internal configurations to apply,
   // e.g. field trials.
   const WebRtcKeyValueConfig* trials = nullptr;
+
+  // Pacer shared with other transports, e.g. those of an SFU. If not set, the
+  // transport is paced on its own.
+  SharedPacer* shared_pacer = nullptr;
 };
 }  // namespace webrtc
 
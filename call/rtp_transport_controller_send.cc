@@ -32,6 +32,9 @@ namespace webrtc {
 namespace {
 static const int64_t kRetransmitWindowSizeMs = 500;
 static const size_t kMaxOverheadBytes = 500;
+// Packet buffers kept for reuse by the video streams sending on the transport,
+// enough to absorb the bursts of a key frame.
+static const size_t kMaxFreePacketBuffers = 256;
 
 constexpr TimeDelta kPacerQueueUpdateInterval = TimeDelta::Millis(25);
 
@@ -92,14 +95,19 @@ RtpTransportControllerSend::RtpTransportControllerSend(
     const BitrateConstraints& bitrate_config,
     std::unique_ptr<ProcessThread> process_thread,
     TaskQueueFactory* task_queue_factory,
-    const WebRtcKeyValueConfig* trials)
+    const WebRtcKeyValueConfig* trials,
+    SharedPacer* shared_pacer)
     : clock_(clock),
       event_log_(event_log),
+      packet_buffer_pool_(
+          rtc::CopyOnWriteBufferPool::Create(IP_PACKET_SIZE,
+                                             kMaxFreePacketBuffers)),
       bitrate_configurator_(bitrate_config),
       pacer_started_(false),
       process_thread_(std::move(process_thread)),
       pacer_settings_(trials),
-      process_thread_pacer_(pacer_settings_.use_task_queue_pacer()
+      process_thread_pacer_(pacer_settings_.use_task_queue_pacer() ||
+                                    shared_pacer != nullptr
                                 ? nullptr
                                 : new PacedSender(clock,
                                                   &packet_router_,
@@ -107,7 +115,7 @@ RtpTransportControllerSend::RtpTransportControllerSend(
                                                   trials,
                                                   process_thread_.get())),
       task_queue_pacer_(
-          pacer_settings_.use_task_queue_pacer()
+          pacer_settings_.use_task_queue_pacer() && shared_pacer == nullptr
               ? new TaskQueuePacedSender(clock,
                                          &packet_router_,
                                          event_log,
@@ -116,6 +124,15 @@ RtpTransportControllerSend::RtpTransportControllerSend(
                                          pacer_settings_.holdback_window.Get(),
                                          pacer_settings_.holdback_packets.Get())
               : nullptr),
+      shared_pacer_sender_(
+          shared_pacer != nullptr
+              ? shared_pacer->CreatePacedSender(
+                    &packet_router_,
+                    event_log,
+                    trials,
+                    pacer_settings_.holdback_window.Get(),
+                    pacer_settings_.holdback_packets.Get())
+              : nullptr),
       observer_(nullptr),
       controller_factory_override_(controller_factory),
       controller_factory_fallback_(
@@ -203,6 +220,9 @@ void RtpTransportControllerSend::UpdateControlState() {
 }
 
 RtpPacketPacer* RtpTransportControllerSend::pacer() {
+  if (shared_pacer_sender_) {
+    return shared_pacer_sender_.get();
+  }
   if (pacer_settings_.use_task_queue_pacer()) {
     return task_queue_pacer_.get();
   }
@@ -210,6 +230,9 @@ RtpPacketPacer* RtpTransportControllerSend::pacer() {
 }
 
 const RtpPacketPacer* RtpTransportControllerSend::pacer() const {
+  if (shared_pacer_sender_) {
+    return shared_pacer_sender_.get();
+  }
   if (pacer_settings_.use_task_queue_pacer()) {
     return task_queue_pacer_.get();
   }
@@ -235,12 +258,20 @@ RtpTransportControllerSend::transport_feedback_observer() {
 }
 
 RtpPacketSender* RtpTransportControllerSend::packet_sender() {
+  if (shared_pacer_sender_) {
+    return shared_pacer_sender_.get();
+  }
   if (pacer_settings_.use_task_queue_pacer()) {
     return task_queue_pacer_.get();
   }
   return process_thread_pacer_.get();
 }
 
+rtc::scoped_refptr<rtc::CopyOnWriteBufferPool>
+RtpTransportControllerSend::packet_buffer_pool() {
+  return packet_buffer_pool_;
+}
+
 void RtpTransportControllerSend::SetAllocatedSendBitrateLimits(
     BitrateAllocationLimits limits) {
   RTC_DCHECK_RUN_ON(&task_queue_);
@@ -512,7 +543,9 @@ void RtpTransportControllerSend::IncludeOverheadInPacedSender() {
 void RtpTransportControllerSend::EnsureStarted() {
   if (!pacer_started_) {
     pacer_started_ = true;
-    if (pacer_settings_.use_task_queue_pacer()) {
+    if (shared_pacer_sender_) {
+      shared_pacer_sender_->EnsureStarted();
+    } else if (pacer_settings_.use_task_queue_pacer()) {
       task_queue_pacer_->EnsureStarted();
     } else {
       process_thread_->Start();
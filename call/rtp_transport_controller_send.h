@@ -30,6 +30,7 @@
 #include "modules/pacing/paced_sender.h"
 #include "modules/pacing/packet_router.h"
 #include "modules/pacing/rtp_packet_pacer.h"
+#include "modules/pacing/shared_pacer.h"
 #include "modules/pacing/task_queue_paced_sender.h"
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/constructor_magic.h"
@@ -60,7 +61,8 @@ class RtpTransportControllerSend final
       const BitrateConstraints& bitrate_config,
       std::unique_ptr<ProcessThread> process_thread,
       TaskQueueFactory* task_queue_factory,
-      const WebRtcKeyValueConfig* trials);
+      const WebRtcKeyValueConfig* trials,
+      SharedPacer* shared_pacer = nullptr);
   ~RtpTransportControllerSend() override;
 
   // TODO(tommi): Change to std::unique_ptr<>.
@@ -86,6 +88,7 @@ class RtpTransportControllerSend final
   NetworkStateEstimateObserver* network_state_estimate_observer() override;
   TransportFeedbackObserver* transport_feedback_observer() override;
   RtpPacketSender* packet_sender() override;
+  rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> packet_buffer_pool() override;
 
   void SetAllocatedSendBitrateLimits(BitrateAllocationLimits limits) override;
 
@@ -162,6 +165,7 @@ class RtpTransportControllerSend final
   RtcEventLog* const event_log_;
   SequenceChecker main_thread_;
   PacketRouter packet_router_;
+  const rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> packet_buffer_pool_;
   std::vector<std::unique_ptr<RtpVideoSenderInterface>> video_rtp_senders_
       RTC_GUARDED_BY(&main_thread_);
   RtpBitrateConfigurator bitrate_configurator_;
@@ -171,6 +175,9 @@ class RtpTransportControllerSend final
   const PacerSettings pacer_settings_;
   std::unique_ptr<PacedSender> process_thread_pacer_;
   std::unique_ptr<TaskQueuePacedSender> task_queue_pacer_;
+  // Used instead of the pacers above if the transport is paced by a
+  // SharedPacer.
+  std::unique_ptr<SharedPacedSender> shared_pacer_sender_;
 
   TargetTransferRateObserver* observer_ RTC_GUARDED_BY(task_queue_);
   TransportFeedbackDemuxer feedback_demuxer_;
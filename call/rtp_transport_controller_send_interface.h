@@ -32,6 +32,7 @@
 #include "modules/rtp_rtcp/include/rtp_packet_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
 
 namespace rtc {
 struct SentPacket;
@@ -114,6 +115,10 @@ class RtpTransportControllerSendInterface {
   virtual TransportFeedbackObserver* transport_feedback_observer() = 0;
 
   virtual RtpPacketSender* packet_sender() = 0;
+  // Pool of packet buffers shared by the RTP modules sending on this
+  // transport.
+  virtual rtc::scoped_refptr<rtc::CopyOnWriteBufferPool>
+  packet_buffer_pool() = 0;
 
   // SetAllocatedSendBitrateLimits sets bitrates limits imposed by send codec
   // settings.
@@ -22,6 +22,7 @@
 #include "api/video_codecs/video_codec.h"
 #include "call/rtp_transport_controller_send_interface.h"
 #include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/include/reed_solomon_fec_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl2.h"
 #include "modules/rtp_rtcp/source/rtp_sender.h"
@@ -167,6 +168,14 @@ std::unique_ptr<VideoFecGenerator> MaybeCreateFecGenerator(
     }
 
     RTC_DCHECK_EQ(1U, rtp.flexfec.protected_media_ssrcs.size());
+    // The Reed-Solomon scheme reuses the negotiated FlexFEC payload type and
+    // SSRC, so both ends need to have the field trial enabled.
+    if (absl::StartsWith(trials.Lookup("WebRTC-ReedSolomonFec"), "Enabled")) {
+      return std::make_unique<ReedSolomonFecSender>(
+          rtp.flexfec.payload_type, rtp.flexfec.ssrc,
+          rtp.flexfec.protected_media_ssrcs[0], rtp.mid, rtp.extensions,
+          RTPSender::FecExtensionSizes(), rtp_state, clock);
+    }
     return std::make_unique<FlexfecSender>(
         rtp.flexfec.payload_type, rtp.flexfec.ssrc,
         rtp.flexfec.protected_media_ssrcs[0], rtp.mid, rtp.extensions,
@@ -232,6 +241,7 @@ std::vector<RtpStreamSender> CreateRtpStreamSenders(
   configuration.extmap_allow_mixed = rtp_config.extmap_allow_mixed;
   configuration.rtcp_report_interval_ms = rtcp_report_interval_ms;
   configuration.field_trials = &trials;
+  configuration.packet_buffer_pool = transport->packet_buffer_pool();
 
   std::vector<RtpStreamSender> rtp_streams;
 
@@ -270,7 +280,7 @@ std::vector<RtpStreamSender> CreateRtpStreamSenders(
 
     const bool using_flexfec =
         fec_generator &&
-        fec_generator->GetFecType() == VideoFecGenerator::FecType::kFlexFec;
+        fec_generator->GetFecType() != VideoFecGenerator::FecType::kUlpFec;
     const bool should_disable_red_and_ulpfec =
         ShouldDisableRedAndUlpfec(using_flexfec, rtp_config, trials);
     if (!should_disable_red_and_ulpfec &&
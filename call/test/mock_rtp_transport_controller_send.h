@@ -60,6 +60,10 @@ class MockRtpTransportControllerSend
               (),
               (override));
   MOCK_METHOD(RtpPacketSender*, packet_sender, (), (override));
+  MOCK_METHOD(rtc::scoped_refptr<rtc::CopyOnWriteBufferPool>,
+              packet_buffer_pool,
+              (),
+              (override));
   MOCK_METHOD(void,
               SetAllocatedSendBitrateLimits,
               (BitrateAllocationLimits),
@@ -10,6 +10,8 @@
 
 #include "media/base/media_channel.h"
 
+#include <string.h>
+
 #include "media/base/rtp_utils.h"
 #include "rtc_base/task_utils/to_queued_task.h"
 
@@ -22,15 +24,26 @@ using webrtc::TaskQueueBase;
 using webrtc::ToQueuedTask;
 using webrtc::VideoTrackInterface;
 
+namespace {
+
+// Room SRTP needs to protect a packet in place: the SRTCP index and the
+// largest auth tag.
+constexpr size_t kMaxSrtpOverhead = 4 + 16;
+
+}  // namespace
+
 VideoOptions::VideoOptions()
     : content_hint(VideoTrackInterface::ContentHint::kNone) {}
 VideoOptions::~VideoOptions() = default;
 
-MediaChannel::MediaChannel(const MediaConfig& config,
-                           TaskQueueBase* network_thread)
+MediaChannel::MediaChannel(
+    const MediaConfig& config,
+    TaskQueueBase* network_thread,
+    rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> send_buffer_pool)
     : enable_dscp_(config.enable_dscp),
       network_safety_(PendingTaskSafetyFlag::CreateDetachedInactive()),
-      network_thread_(network_thread) {}
+      network_thread_(network_thread),
+      send_buffer_pool_(std::move(send_buffer_pool)) {}
 
 MediaChannel::MediaChannel(TaskQueueBase* network_thread)
     : enable_dscp_(false),
@@ -171,7 +184,7 @@ void MediaChannel::SendRtp(const uint8_t* data,
       [this, packet_id = options.packet_id,
        included_in_feedback = options.included_in_feedback,
        included_in_allocation = options.included_in_allocation,
-       packet = rtc::CopyOnWriteBuffer(data, len, kMaxRtpPacketLen)]() mutable {
+       packet = CopyToSendBuffer(data, len)]() mutable {
         rtc::PacketOptions rtc_options;
         rtc_options.packet_id = packet_id;
         if (DscpEnabled()) {
@@ -196,8 +209,7 @@ void MediaChannel::SendRtp(const uint8_t* data,
 }
 
 void MediaChannel::SendRtcp(const uint8_t* data, size_t len) {
-  auto send = [this, packet = rtc::CopyOnWriteBuffer(
-                         data, len, kMaxRtpPacketLen)]() mutable {
+  auto send = [this, packet = CopyToSendBuffer(data, len)]() mutable {
     rtc::PacketOptions rtc_options;
     if (DscpEnabled()) {
       rtc_options.dscp = PreferredDscp();
@@ -212,6 +224,17 @@ void MediaChannel::SendRtcp(const uint8_t* data, size_t len) {
   }
 }
 
+rtc::CopyOnWriteBuffer MediaChannel::CopyToSendBuffer(const uint8_t* data,
+                                                      size_t len) {
+  if (!send_buffer_pool_ ||
+      len + kMaxSrtpOverhead > send_buffer_pool_->buffer_size()) {
+    return rtc::CopyOnWriteBuffer(data, len, kMaxRtpPacketLen);
+  }
+  rtc::CopyOnWriteBuffer packet = send_buffer_pool_->Allocate(len);
+  memcpy(packet.MutableData(), data, len);
+  return packet;
+}
+
 MediaSenderInfo::MediaSenderInfo() = default;
 MediaSenderInfo::~MediaSenderInfo() = default;
 
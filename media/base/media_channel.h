@@ -46,6 +46,7 @@
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/buffer.h"
 #include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
 #include "rtc_base/dscp.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/network_route.h"
@@ -170,8 +171,12 @@ class MediaChannel {
     virtual ~NetworkInterface() {}
   };
 
+  // If `send_buffer_pool` is set, outgoing packets are copied into buffers
+  // taken from it, typically the pool of the transport they are sent on.
   MediaChannel(const MediaConfig& config,
-               webrtc::TaskQueueBase* network_thread);
+               webrtc::TaskQueueBase* network_thread,
+               rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> send_buffer_pool =
+                   nullptr);
   explicit MediaChannel(webrtc::TaskQueueBase* network_thread);
   virtual ~MediaChannel();
 
@@ -302,6 +307,10 @@ class MediaChannel {
                     bool rtcp,
                     const rtc::PacketOptions& options);
 
+  // Copies an outgoing packet into a buffer with room for SRTP to protect it
+  // in place, taken from `send_buffer_pool_` if possible.
+  rtc::CopyOnWriteBuffer CopyToSendBuffer(const uint8_t* data, size_t len);
+
   const bool enable_dscp_;
   const rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> network_safety_
       RTC_PT_GUARDED_BY(network_thread_);
@@ -311,6 +320,7 @@ class MediaChannel {
   rtc::DiffServCodePoint preferred_dscp_ RTC_GUARDED_BY(network_thread_) =
       rtc::DSCP_DEFAULT;
   bool extmap_allow_mixed_ = false;
+  const rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> send_buffer_pool_;
 };
 
 // The stats information is structured as follows:
@@ -782,9 +792,11 @@ class VoiceMediaChannel : public MediaChannel, public Delayable {
  public:
   explicit VoiceMediaChannel(webrtc::TaskQueueBase* network_thread)
       : MediaChannel(network_thread) {}
-  VoiceMediaChannel(const MediaConfig& config,
-                    webrtc::TaskQueueBase* network_thread)
-      : MediaChannel(config, network_thread) {}
+  VoiceMediaChannel(
+      const MediaConfig& config,
+      webrtc::TaskQueueBase* network_thread,
+      rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> send_buffer_pool = nullptr)
+      : MediaChannel(config, network_thread, std::move(send_buffer_pool)) {}
   ~VoiceMediaChannel() override {}
 
   cricket::MediaType media_type() const override;
@@ -854,9 +866,11 @@ class VideoMediaChannel : public MediaChannel, public Delayable {
  public:
   explicit VideoMediaChannel(webrtc::TaskQueueBase* network_thread)
       : MediaChannel(network_thread) {}
-  VideoMediaChannel(const MediaConfig& config,
-                    webrtc::TaskQueueBase* network_thread)
-      : MediaChannel(config, network_thread) {}
+  VideoMediaChannel(
+      const MediaConfig& config,
+      webrtc::TaskQueueBase* network_thread,
+      rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> send_buffer_pool = nullptr)
+      : MediaChannel(config, network_thread, std::move(send_buffer_pool)) {}
   ~VideoMediaChannel() override {}
 
   cricket::MediaType media_type() const override;
@@ -173,13 +173,15 @@ absl::string_view RtpPacketTypeToString(RtpPacketType packet_type) {
 }
 
 RtpPacketType InferRtpPacketType(rtc::ArrayView<const char> packet) {
+  // RTP and RTCP packets are told apart by payload type only, so at most one
+  // of the checks passes. Check for RTP first, as most packets are RTP.
+  if (webrtc::IsRtpPacket(rtc::reinterpret_array_view<const uint8_t>(packet))) {
+    return RtpPacketType::kRtp;
+  }
   if (webrtc::IsRtcpPacket(
           rtc::reinterpret_array_view<const uint8_t>(packet))) {
     return RtpPacketType::kRtcp;
   }
-  if (webrtc::IsRtpPacket(rtc::reinterpret_array_view<const uint8_t>(packet))) {
-    return RtpPacketType::kRtp;
-  }
   return RtpPacketType::kUnknown;
 }
 
@@ -223,6 +223,33 @@ class MockVideoSource : public rtc::VideoSourceInterface<webrtc::VideoFrame> {
               (override));
 };
 
+// Records the last RTCP packet sent, without keeping the packet alive, so that
+// its storage can go back to the pool it came from.
+class RtcpRecordingNetworkInterface
+    : public cricket::MediaChannel::NetworkInterface {
+ public:
+  bool SendPacket(rtc::CopyOnWriteBuffer* packet,
+                  const rtc::PacketOptions& options) override {
+    return true;
+  }
+  bool SendRtcp(rtc::CopyOnWriteBuffer* packet,
+                const rtc::PacketOptions& options) override {
+    capacity_ = packet->capacity();
+    contents_.assign(packet->cdata(), packet->cdata() + packet->size());
+    return true;
+  }
+  int SetOption(SocketType type, rtc::Socket::Option opt, int option) override {
+    return 0;
+  }
+
+  size_t capacity() const { return capacity_; }
+  const std::vector<uint8_t>& contents() const { return contents_; }
+
+ private:
+  size_t capacity_ = 0;
+  std::vector<uint8_t> contents_;
+};
+
 }  // namespace
 
 #define EXPECT_FRAME_WAIT(c, w, h, t)                        \
@@ -5333,6 +5360,37 @@ TEST_F(WebRtcVideoChannelTest, TestSetDscpOptions) {
   channel->SetInterface(nullptr);
 }
 
+// Outgoing packets are copied into storage taken from the buffer pool of the
+// send transport, with room for SRTP.
+TEST_F(WebRtcVideoChannelTest, SendsPacketsFromTransportBufferPool) {
+  rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> pool =
+      rtc::CopyOnWriteBufferPool::Create(kMaxRtpPacketLen,
+                                         /*max_free_buffers=*/4);
+  FakeCall fake_call;
+  ON_CALL(*fake_call.GetMockTransportControllerSend(), packet_buffer_pool())
+      .WillByDefault(Return(pool));
+  RtcpRecordingNetworkInterface network_interface;
+  const uint8_t kData[] = {0x80, 0xc8, 0x00, 0x01, 0x12, 0x34, 0x56, 0x78};
+
+  std::unique_ptr<cricket::WebRtcVideoChannel> channel(
+      static_cast<cricket::WebRtcVideoChannel*>(engine_.CreateMediaChannel(
+          &fake_call, MediaConfig(), VideoOptions(), webrtc::CryptoOptions(),
+          video_bitrate_allocator_factory_.get())));
+  channel->SetInterface(&network_interface);
+  EXPECT_TRUE(static_cast<webrtc::Transport*>(channel.get())
+                  ->SendRtcp(kData, sizeof(kData)));
+  EXPECT_THAT(network_interface.contents(), ElementsAreArray(kData));
+  EXPECT_EQ(network_interface.capacity(), kMaxRtpPacketLen);
+  EXPECT_TRUE(static_cast<webrtc::Transport*>(channel.get())
+                  ->SendRtcp(kData, sizeof(kData)));
+  channel->SetInterface(nullptr);
+
+  // The storage of the first packet went back to the pool once it was sent,
+  // and was reused for the second.
+  EXPECT_EQ(pool->GetStats().allocations, 1);
+  EXPECT_EQ(pool->GetStats().reuses, 1);
+}
+
 // This test verifies that the RTCP reduced size mode is properly applied to
 // send video streams.
 TEST_F(WebRtcVideoChannelTest, TestSetSendRtcpReducedSize) {
@@ -24,6 +24,7 @@
 #include "api/audio_codecs/audio_codec_pair_id.h"
 #include "api/call/audio_sink.h"
 #include "api/transport/webrtc_key_value_config.h"
+#include "call/rtp_transport_controller_send_interface.h"
 #include "media/base/audio_source.h"
 #include "media/base/media_constants.h"
 #include "media/base/stream_params.h"
@@ -1421,7 +1422,10 @@ WebRtcVoiceMediaChannel::WebRtcVoiceMediaChannel(
     const AudioOptions& options,
     const webrtc::CryptoOptions& crypto_options,
     webrtc::Call* call)
-    : VoiceMediaChannel(config, call->network_thread()),
+    : VoiceMediaChannel(
+          config,
+          call->network_thread(),
+          call->GetTransportControllerSend()->packet_buffer_pool()),
       worker_thread_(call->worker_thread()),
       engine_(engine),
       call_(call),
@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "modules/pacing/prioritized_packet_queue.h"
+#include "modules/pacing/round_robin_packet_queue.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+
+namespace webrtc {
+namespace {
+
+// Packets queued per stream when the benchmark starts.
+constexpr int kPacketsPerStream = 4;
+constexpr int kVideoPriority = 3;
+constexpr int kRetransmissionPriority = 2;
+
+std::unique_ptr<PacerPacketQueue> CreateQueue(bool prioritized,
+                                              Timestamp start_time) {
+  if (prioritized) {
+    return std::make_unique<PrioritizedPacketQueue>(start_time);
+  }
+  return std::make_unique<RoundRobinPacketQueue>(start_time, nullptr);
+}
+
+// Keeps `kPacketsPerStream` packets of each stream queued, and measures
+// popping a packet and pushing it back, as a pacer does in steady state.
+// Every tenth packet is pushed as a retransmission. Arguments are the number
+// of streams and whether the PrioritizedPacketQueue is used.
+void BM_PushPop(benchmark::State& state) {
+  const int num_streams = state.range(0);
+  Timestamp now = Timestamp::Millis(1000);
+  std::unique_ptr<PacerPacketQueue> queue =
+      CreateQueue(state.range(1) != 0, now);
+  uint64_t enqueue_order = 0;
+  for (int i = 0; i < kPacketsPerStream; ++i) {
+    for (int ssrc = 1; ssrc <= num_streams; ++ssrc) {
+      auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+      packet->set_packet_type(RtpPacketMediaType::kVideo);
+      packet->SetSsrc(ssrc);
+      packet->SetPayloadSize(1000 + ssrc % 200);
+      queue->Push(kVideoPriority, now, enqueue_order++, std::move(packet));
+    }
+  }
+
+  for (auto _ : state) {
+    now += TimeDelta::Micros(100);
+    queue->UpdateQueueTime(now);
+    std::unique_ptr<RtpPacketToSend> packet = queue->Pop();
+    const bool retransmission = enqueue_order % 10 == 0;
+    packet->set_packet_type(retransmission
+                                ? RtpPacketMediaType::kRetransmission
+                                : RtpPacketMediaType::kVideo);
+    queue->Push(retransmission ? kRetransmissionPriority : kVideoPriority, now,
+                enqueue_order++, std::move(packet));
+    benchmark::DoNotOptimize(queue->OldestEnqueueTime());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PushPop)
+    ->ArgsProduct({{10, 100, 1000}, {0, 1}})
+    ->ArgNames({"streams", "prioritized"});
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core):
+BM_PushPop/streams:10/prioritized:0        383 ns   items_per_second=2.66M/s
+BM_PushPop/streams:100/prioritized:0      1116 ns   items_per_second=907k/s
+BM_PushPop/streams:1000/prioritized:0    13419 ns   items_per_second=75.4k/s
+BM_PushPop/streams:10/prioritized:1        184 ns   items_per_second=5.50M/s
+BM_PushPop/streams:100/prioritized:1       273 ns   items_per_second=3.71M/s
+BM_PushPop/streams:1000/prioritized:1      374 ns   items_per_second=2.71M/s
+*/
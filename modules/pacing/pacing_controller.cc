@@ -18,6 +18,8 @@
 #include "absl/strings/match.h"
 #include "modules/pacing/bitrate_prober.h"
 #include "modules/pacing/interval_budget.h"
+#include "modules/pacing/prioritized_packet_queue.h"
+#include "modules/pacing/round_robin_packet_queue.h"
 #include "modules/utility/include/process_thread.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/experiments/field_trial_parser.h"
@@ -64,6 +66,15 @@ TimeDelta GetDynamicPaddingTarget(const WebRtcKeyValueConfig& field_trials) {
   return padding_target.Get();
 }
 
+std::unique_ptr<PacerPacketQueue> CreatePacketQueue(
+    Timestamp start_time,
+    const WebRtcKeyValueConfig& field_trials) {
+  if (IsEnabled(field_trials, "WebRTC-Pacer-PrioritizedPacketQueue")) {
+    return std::make_unique<PrioritizedPacketQueue>(start_time);
+  }
+  return std::make_unique<RoundRobinPacketQueue>(start_time, &field_trials);
+}
+
 int GetPriorityForType(RtpPacketMediaType type) {
   // Lower number takes priority over higher.
   switch (type) {
@@ -130,7 +141,7 @@ PacingController::PacingController(Clock* clock,
       pacing_bitrate_(DataRate::Zero()),
       last_process_time_(clock->CurrentTime()),
       last_send_time_(last_process_time_),
-      packet_queue_(last_process_time_, field_trials_),
+      packet_queue_(CreatePacketQueue(last_process_time_, *field_trials_)),
       packet_counter_(0),
       congestion_window_size_(DataSize::PlusInfinity()),
       outstanding_data_(DataSize::Zero()),
@@ -158,14 +169,14 @@ void PacingController::Pause() {
   if (!paused_)
     RTC_LOG(LS_INFO) << "PacedSender paused.";
   paused_ = true;
-  packet_queue_.SetPauseState(true, CurrentTime());
+  packet_queue_->SetPauseState(true, CurrentTime());
 }
 
 void PacingController::Resume() {
   if (paused_)
     RTC_LOG(LS_INFO) << "PacedSender resumed.";
   paused_ = false;
-  packet_queue_.SetPauseState(false, CurrentTime());
+  packet_queue_->SetPauseState(false, CurrentTime());
 }
 
 bool PacingController::IsPaused() const {
@@ -248,14 +259,14 @@ void PacingController::SetAccountForAudioPackets(bool account_for_audio) {
 
 void PacingController::SetIncludeOverhead() {
   include_overhead_ = true;
-  packet_queue_.SetIncludeOverhead();
+  packet_queue_->SetIncludeOverhead();
 }
 
 void PacingController::SetTransportOverhead(DataSize overhead_per_packet) {
   if (ignore_transport_overhead_)
     return;
   transport_overhead_per_packet_ = overhead_per_packet;
-  packet_queue_.SetTransportOverhead(overhead_per_packet);
+  packet_queue_->SetTransportOverhead(overhead_per_packet);
 }
 
 TimeDelta PacingController::ExpectedQueueTime() const {
@@ -266,11 +277,11 @@ TimeDelta PacingController::ExpectedQueueTime() const {
 }
 
 size_t PacingController::QueueSizePackets() const {
-  return packet_queue_.SizeInPackets();
+  return packet_queue_->SizeInPackets();
 }
 
 DataSize PacingController::QueueSizeData() const {
-  return packet_queue_.Size();
+  return packet_queue_->Size();
 }
 
 DataSize PacingController::CurrentBufferLevel() const {
@@ -282,7 +293,7 @@ absl::optional<Timestamp> PacingController::FirstSentPacketTime() const {
 }
 
 TimeDelta PacingController::OldestPacketWaitTime() const {
-  Timestamp oldest_packet = packet_queue_.OldestEnqueueTime();
+  Timestamp oldest_packet = packet_queue_->OldestEnqueueTime();
   if (oldest_packet.IsInfinite()) {
     return TimeDelta::Zero();
   }
@@ -297,7 +308,7 @@ void PacingController::EnqueuePacketInternal(
 
   Timestamp now = CurrentTime();
 
-  if (mode_ == ProcessMode::kDynamic && packet_queue_.Empty()) {
+  if (mode_ == ProcessMode::kDynamic && packet_queue_->Empty()) {
     // If queue is empty, we need to "fast-forward" the last process time,
     // so that we don't use passed time as budget for sending the first new
     // packet.
@@ -313,7 +324,7 @@ void PacingController::EnqueuePacketInternal(
     UpdateBudgetWithElapsedTime(elapsed_time);
     last_process_time_ = target_process_time;
   }
-  packet_queue_.Push(priority, now, packet_counter_++, std::move(packet));
+  packet_queue_->Push(priority, now, packet_counter_++, std::move(packet));
 }
 
 TimeDelta PacingController::UpdateTimeAndGetElapsed(Timestamp now) {
@@ -375,7 +386,7 @@ Timestamp PacingController::NextSendTime() const {
     // Not pacing audio, if leading packet is audio its target send
     // time is the time at which it was enqueued.
     absl::optional<Timestamp> audio_enqueue_time =
-        packet_queue_.LeadingAudioPacketEnqueueTime();
+        packet_queue_->LeadingAudioPacketEnqueueTime();
     if (audio_enqueue_time.has_value()) {
       return *audio_enqueue_time;
     }
@@ -387,7 +398,7 @@ Timestamp PacingController::NextSendTime() const {
   }
 
   // Check how long until we can send the next media packet.
-  if (media_rate_ > DataRate::Zero() && !packet_queue_.Empty()) {
+  if (media_rate_ > DataRate::Zero() && !packet_queue_->Empty()) {
     return std::min(last_send_time_ + kPausedProcessInterval,
                     last_process_time_ + media_debt_ / media_rate_);
   }
@@ -395,7 +406,7 @@ Timestamp PacingController::NextSendTime() const {
   // If we _don't_ have pending packets, check how long until we have
   // bandwidth for padding packets. Both media and padding debts must
   // have been drained to do this.
-  if (padding_rate_ > DataRate::Zero() && packet_queue_.Empty()) {
+  if (padding_rate_ > DataRate::Zero() && packet_queue_->Empty()) {
     TimeDelta drain_time =
         std::max(media_debt_ / media_rate_, padding_debt_ / padding_rate_);
     return std::min(last_send_time_ + kPausedProcessInterval,
@@ -471,16 +482,16 @@ void PacingController::ProcessPackets() {
 
   if (elapsed_time > TimeDelta::Zero()) {
     DataRate target_rate = pacing_bitrate_;
-    DataSize queue_size_data = packet_queue_.Size();
+    DataSize queue_size_data = packet_queue_->Size();
     if (queue_size_data > DataSize::Zero()) {
       // Assuming equal size packets and input/output rate, the average packet
       // has avg_time_left_ms left to get queue_size_bytes out of the queue, if
       // time constraint shall be met. Determine bitrate needed for that.
-      packet_queue_.UpdateQueueTime(now);
+      packet_queue_->UpdateQueueTime(now);
       if (drain_large_queues_) {
         TimeDelta avg_time_left =
             std::max(TimeDelta::Millis(1),
-                     queue_time_limit - packet_queue_.AverageQueueTime());
+                     queue_time_limit - packet_queue_->AverageQueueTime());
         DataRate min_rate_needed = queue_size_data / avg_time_left;
         if (min_rate_needed > target_rate) {
           target_rate = min_rate_needed;
@@ -626,7 +637,7 @@ void PacingController::ProcessPackets() {
 
 DataSize PacingController::PaddingToAdd(DataSize recommended_probe_size,
                                         DataSize data_sent) const {
-  if (!packet_queue_.Empty()) {
+  if (!packet_queue_->Empty()) {
     // Actual payload available, no need to add padding.
     return DataSize::Zero();
   }
@@ -662,7 +673,7 @@ std::unique_ptr<RtpPacketToSend> PacingController::GetPendingPacket(
     const PacedPacketInfo& pacing_info,
     Timestamp target_send_time,
     Timestamp now) {
-  if (packet_queue_.Empty()) {
+  if (packet_queue_->Empty()) {
     return nullptr;
   }
 
@@ -670,7 +681,8 @@ std::unique_ptr<RtpPacketToSend> PacingController::GetPendingPacket(
 
   // Unpaced audio packets and probes are exempted from send checks.
   bool unpaced_audio_packet =
-      !pace_audio_ && packet_queue_.LeadingAudioPacketEnqueueTime().has_value();
+      !pace_audio_ &&
+      packet_queue_->LeadingAudioPacketEnqueueTime().has_value();
   bool is_probe = pacing_info.probe_cluster_id != PacedPacketInfo::kNotAProbe;
   if (!unpaced_audio_packet && !is_probe) {
     if (Congested()) {
@@ -697,7 +709,7 @@ std::unique_ptr<RtpPacketToSend> PacingController::GetPendingPacket(
     }
   }
 
-  return packet_queue_.Pop();
+  return packet_queue_->Pop();
 }
 
 void PacingController::OnPacketSent(RtpPacketMediaType packet_type,
@@ -26,7 +26,7 @@
 #include "api/transport/webrtc_key_value_config.h"
 #include "modules/pacing/bitrate_prober.h"
 #include "modules/pacing/interval_budget.h"
-#include "modules/pacing/round_robin_packet_queue.h"
+#include "modules/pacing/pacer_packet_queue.h"
 #include "modules/pacing/rtp_packet_pacer.h"
 #include "modules/rtp_rtcp/include/rtp_packet_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
@@ -223,7 +223,9 @@ class PacingController {
   Timestamp last_send_time_;
   absl::optional<Timestamp> first_sent_packet_time_;
 
-  RoundRobinPacketQueue packet_queue_;
+  // A PrioritizedPacketQueue if the WebRTC-Pacer-PrioritizedPacketQueue field
+  // trial is enabled, a RoundRobinPacketQueue otherwise.
+  const std::unique_ptr<PacerPacketQueue> packet_queue_;
   uint64_t packet_counter_;
 
   DataSize congestion_window_size_;
@@ -14,6 +14,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -206,21 +207,32 @@ class PacingControllerProbing : public PacingController::PacketSender {
   PacedPacketInfo last_pacing_info_;
 };
 
+// Parameterized on the process mode and on whether the
+// WebRTC-Pacer-PrioritizedPacketQueue field trial is enabled.
 class PacingControllerTest
-    : public ::testing::TestWithParam<PacingController::ProcessMode> {
+    : public ::testing::TestWithParam<
+          std::tuple<PacingController::ProcessMode, bool>> {
  protected:
-  PacingControllerTest() : clock_(123456) {}
+  PacingControllerTest()
+      : field_trials_(std::get<1>(GetParam())
+                          ? "WebRTC-Pacer-PrioritizedPacketQueue/Enabled/"
+                          : ""),
+        clock_(123456) {}
+
+  PacingController::ProcessMode process_mode() const {
+    return std::get<0>(GetParam());
+  }
 
   void SetUp() override {
     srand(0);
     // Need to initialize PacingController after we initialize clock.
     pacer_ = std::make_unique<PacingController>(&clock_, &callback_, nullptr,
-                                                nullptr, GetParam());
+                                                nullptr, process_mode());
     Init();
   }
 
   bool PeriodicProcess() const {
-    return GetParam() == PacingController::ProcessMode::kPeriodic;
+    return process_mode() == PacingController::ProcessMode::kPeriodic;
   }
 
   void Init() {
@@ -318,6 +330,7 @@ class PacingControllerTest
     }
   }
 
+  ScopedFieldTrials field_trials_;
   SimulatedClock clock_;
   ::testing::NiceMock<MockPacingControllerCallback> callback_;
   std::unique_ptr<PacingController> pacer_;
@@ -867,7 +880,7 @@ TEST_P(PacingControllerTest, VerifyAverageBitrateVaryingMediaPayload) {
   const TimeDelta kAveragingWindowLength = TimeDelta::Seconds(10);
   PacingControllerPadding callback;
   pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   pacer_->SetProbingEnabled(false);
   pacer_->SetPacingRates(kTargetRate * kPaceMultiplier, kTargetRate);
 
@@ -1305,7 +1318,7 @@ TEST_P(PacingControllerTest, Pause) {
 TEST_P(PacingControllerTest, InactiveFromStart) {
   // Recreate the pacer without the inital time forwarding.
   pacer_ = std::make_unique<PacingController>(&clock_, &callback_, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   pacer_->SetProbingEnabled(false);
   pacer_->SetPacingRates(kTargetRate * kPaceMultiplier, kTargetRate);
 
@@ -1325,7 +1338,7 @@ TEST_P(PacingControllerTest, InactiveFromStart) {
   // Determine the margin need so we can advance to the last possible moment
   // that will not cause a process event.
   const TimeDelta time_margin =
-      (GetParam() == PacingController::ProcessMode::kDynamic
+      (process_mode() == PacingController::ProcessMode::kDynamic
            ? PacingController::kMinSleepTime
            : TimeDelta::Zero()) +
       TimeDelta::Micros(1);
@@ -1403,7 +1416,7 @@ TEST_P(PacingControllerTest, ProbingWithInsertedPackets) {
 
   PacingControllerProbing packet_sender;
   pacer_ = std::make_unique<PacingController>(&clock_, &packet_sender, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   pacer_->CreateProbeCluster(kFirstClusterRate,
                              /*cluster_id=*/0);
   pacer_->CreateProbeCluster(kSecondClusterRate,
@@ -1462,8 +1475,8 @@ TEST_P(PacingControllerTest, SkipsProbesWhenProcessIntervalTooLarge) {
                                "abort_delayed_probes:1,max_probe_delay:2ms/"
                              : "WebRTC-Bwe-ProbingBehavior/"
                                "abort_delayed_probes:0,max_probe_delay:2ms/");
-    pacer_ = std::make_unique<PacingController>(&clock_, &packet_sender,
-                                                nullptr, &trials, GetParam());
+    pacer_ = std::make_unique<PacingController>(
+        &clock_, &packet_sender, nullptr, &trials, process_mode());
     pacer_->SetPacingRates(
         DataRate::BitsPerSec(kInitialBitrateBps * kPaceMultiplier),
         DataRate::BitsPerSec(kInitialBitrateBps));
@@ -1570,7 +1583,7 @@ TEST_P(PacingControllerTest, ProbingWithPaddingSupport) {
 
   PacingControllerProbing packet_sender;
   pacer_ = std::make_unique<PacingController>(&clock_, &packet_sender, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   pacer_->CreateProbeCluster(kFirstClusterRate,
                              /*cluster_id=*/0);
   pacer_->SetPacingRates(
@@ -1636,7 +1649,7 @@ TEST_P(PacingControllerTest, ProbeClusterId) {
   MockPacketSender callback;
 
   pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   Init();
 
   uint32_t ssrc = 12346;
@@ -1693,7 +1706,7 @@ TEST_P(PacingControllerTest, ProbeClusterId) {
 TEST_P(PacingControllerTest, OwnedPacketPrioritizedOnType) {
   MockPacketSender callback;
   pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   Init();
 
   // Insert a packet of each type, from low to high priority. Since priority
@@ -1740,7 +1753,7 @@ TEST_P(PacingControllerTest, OwnedPacketPrioritizedOnType) {
 TEST_P(PacingControllerTest, SmallFirstProbePacket) {
   MockPacketSender callback;
   pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
-                                              nullptr, GetParam());
+                                              nullptr, process_mode());
   pacer_->CreateProbeCluster(kFirstClusterRate, /*cluster_id=*/0);
   pacer_->SetPacingRates(kTargetRate * kPaceMultiplier, DataRate::Zero());
 
@@ -1899,7 +1912,7 @@ TEST_P(PacingControllerTest,
     MockPacketSender callback;
     EXPECT_CALL(callback, SendPacket).Times(::testing::AnyNumber());
     pacer_ = std::make_unique<PacingController>(&clock_, &callback, nullptr,
-                                                nullptr, GetParam());
+                                                nullptr, process_mode());
     pacer_->SetAccountForAudioPackets(account_for_audio);
 
     // First, saturate the padding budget.
@@ -2170,8 +2183,10 @@ TEST_P(PacingControllerTest, GapInPacingDoesntAccumulateBudget) {
 INSTANTIATE_TEST_SUITE_P(
     WithAndWithoutIntervalBudget,
     PacingControllerTest,
-    ::testing::Values(PacingController::ProcessMode::kPeriodic,
-                      PacingController::ProcessMode::kDynamic));
+    ::testing::Combine(
+        ::testing::Values(PacingController::ProcessMode::kPeriodic,
+                          PacingController::ProcessMode::kDynamic),
+        ::testing::Bool()));
 
 }  // namespace test
 }  // namespace webrtc
@@ -0,0 +1,392 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/prioritized_packet_queue.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+constexpr DataSize kMaxLeadingSize = DataSize::Bytes(1400);
+}  // namespace
+
+PrioritizedPacketQueue::Stream::Stream(uint32_t ssrc) : ssrc(ssrc) {}
+
+PrioritizedPacketQueue::PrioritizedPacketQueue(Timestamp start_time)
+    : transport_overhead_per_packet_(DataSize::Zero()),
+      time_last_updated_(start_time),
+      paused_(false),
+      size_packets_(0),
+      size_(DataSize::Zero()),
+      max_size_(kMaxLeadingSize),
+      queue_time_sum_(TimeDelta::Zero()),
+      pause_time_sum_(TimeDelta::Zero()),
+      include_overhead_(false),
+      single_packet_(false),
+      free_nodes_(kNone),
+      oldest_node_(kNone),
+      newest_node_(kNone),
+      non_empty_priorities_(0),
+      schedule_order_(0) {}
+
+PrioritizedPacketQueue::~PrioritizedPacketQueue() = default;
+
+void PrioritizedPacketQueue::Push(int priority,
+                                  Timestamp enqueue_time,
+                                  uint64_t enqueue_order,
+                                  std::unique_ptr<RtpPacketToSend> packet) {
+  RTC_DCHECK(packet->packet_type().has_value());
+  RTC_DCHECK_GE(priority, 0);
+  RTC_DCHECK_LT(priority, kNumPriorityLevels);
+
+  auto stream_it = stream_indices_.find(packet->Ssrc());
+  if (stream_it == stream_indices_.end()) {
+    stream_it = stream_indices_
+                    .emplace(packet->Ssrc(), static_cast<int>(streams_.size()))
+                    .first;
+    streams_.emplace_back(packet->Ssrc());
+  }
+  const int stream_index = stream_it->second;
+
+  // In order to figure out how much time a packet has spent in the queue
+  // while not in a paused state, we subtract the total amount of time the
+  // queue has been paused so far, and when the packet is popped we subtract
+  // the total amount of time the queue has been paused at that moment.
+  UpdateQueueTime(enqueue_time);
+
+  single_packet_ = size_packets_ == 0;
+  const int index = AllocateNode();
+  Node& node = nodes_[index];
+  node.type = *packet->packet_type();
+  node.unpaused_enqueue_time = enqueue_time - pause_time_sum_;
+  // RoundRobinPacketQueue reports the enqueue time of a packet pushed to an
+  // empty queue with the pause time subtracted, also once more packets have
+  // been pushed.
+  node.enqueue_time =
+      single_packet_ ? node.unpaused_enqueue_time : enqueue_time;
+  node.packet = std::move(packet);
+  LinkByEnqueueTime(index);
+
+  size_packets_ += 1;
+  size_ += PacketSize(*node.packet);
+
+  // Packets are pushed in enqueue order, so each FIFO is in enqueue order.
+  Stream& stream = streams_[stream_index];
+  const int fifo_index =
+      2 * priority + (node.type == RtpPacketMediaType::kRetransmission ? 0 : 1);
+  Fifo& fifo = stream.fifos[fifo_index];
+  if (fifo.tail == kNone) {
+    fifo.head = index;
+    stream.non_empty_fifos |= 1u << fifo_index;
+  } else {
+    nodes_[fifo.tail].next = index;
+  }
+  fifo.tail = index;
+
+  if (stream.scheduled_priority == kNone) {
+    Schedule(stream_index, priority);
+  } else if (priority < stream.scheduled_priority) {
+    // Note that lower ordinal is higher priority.
+    Unschedule(stream_index);
+    Schedule(stream_index, priority);
+  }
+}
+
+std::unique_ptr<RtpPacketToSend> PrioritizedPacketQueue::Pop() {
+  const int stream_index = HighestPriorityStream();
+  RTC_CHECK_NE(stream_index, kNone);
+  Unschedule(stream_index);
+
+  Stream& stream = streams_[stream_index];
+  const int fifo_index = TopFifo(stream);
+  Fifo& fifo = stream.fifos[fifo_index];
+  const int index = fifo.head;
+  Node& node = nodes_[index];
+  fifo.head = node.next;
+  if (fifo.head == kNone) {
+    fifo.tail = kNone;
+    stream.non_empty_fifos &= ~(1u << fifo_index);
+  }
+
+  // `unpaused_enqueue_time` has the pause time up until the packet was
+  // pushed subtracted, so subtracting the pause time up until now leaves
+  // the time the packet spent in the queue while not paused.
+  queue_time_sum_ -=
+      time_last_updated_ - node.unpaused_enqueue_time - pause_time_sum_;
+  UnlinkByEnqueueTime(index);
+
+  // The stream that has sent the fewest bytes is served first, but a stream
+  // sending at a lower rate may not build up a budget of more than
+  // kMaxLeadingSize bytes.
+  const DataSize packet_size = PacketSize(*node.packet);
+  if (!single_packet_) {
+    stream.size =
+        std::max(stream.size + packet_size, max_size_ - kMaxLeadingSize);
+    max_size_ = std::max(max_size_, stream.size);
+  }
+  single_packet_ = false;
+
+  size_ -= packet_size;
+  size_packets_ -= 1;
+  RTC_DCHECK(size_packets_ > 0 || queue_time_sum_ == TimeDelta::Zero());
+
+  if (stream.non_empty_fifos != 0) {
+    Schedule(stream_index, TopFifo(stream) / 2);
+  }
+
+  std::unique_ptr<RtpPacketToSend> packet = std::move(node.packet);
+  FreeNode(index);
+  return packet;
+}
+
+bool PrioritizedPacketQueue::Empty() const {
+  return size_packets_ == 0;
+}
+
+size_t PrioritizedPacketQueue::SizeInPackets() const {
+  return size_packets_;
+}
+
+DataSize PrioritizedPacketQueue::Size() const {
+  return size_;
+}
+
+absl::optional<Timestamp>
+PrioritizedPacketQueue::LeadingAudioPacketEnqueueTime() const {
+  const int stream_index = HighestPriorityStream();
+  if (stream_index == kNone) {
+    return absl::nullopt;
+  }
+  const Node& node = nodes_[TopNode(streams_[stream_index])];
+  if (node.type != RtpPacketMediaType::kAudio) {
+    return absl::nullopt;
+  }
+  return node.unpaused_enqueue_time;
+}
+
+Timestamp PrioritizedPacketQueue::OldestEnqueueTime() const {
+  if (oldest_node_ == kNone) {
+    return Timestamp::MinusInfinity();
+  }
+  return nodes_[oldest_node_].enqueue_time;
+}
+
+TimeDelta PrioritizedPacketQueue::AverageQueueTime() const {
+  if (Empty())
+    return TimeDelta::Zero();
+  return queue_time_sum_ / size_packets_;
+}
+
+void PrioritizedPacketQueue::UpdateQueueTime(Timestamp now) {
+  RTC_CHECK_GE(now, time_last_updated_);
+  if (now == time_last_updated_)
+    return;
+
+  TimeDelta delta = now - time_last_updated_;
+  if (paused_) {
+    pause_time_sum_ += delta;
+  } else {
+    queue_time_sum_ += TimeDelta::Micros(delta.us() * size_packets_);
+  }
+  time_last_updated_ = now;
+}
+
+void PrioritizedPacketQueue::SetPauseState(bool paused, Timestamp now) {
+  if (paused_ == paused)
+    return;
+  UpdateQueueTime(now);
+  paused_ = paused;
+}
+
+void PrioritizedPacketQueue::SetIncludeOverhead() {
+  // RoundRobinPacketQueue moves a packet pushed to an empty queue into the
+  // streams here, after which its bytes are accounted to its stream.
+  single_packet_ = false;
+  include_overhead_ = true;
+  // We need to update the size to reflect overhead for existing packets.
+  for (int index = oldest_node_; index != kNone; index = nodes_[index].newer) {
+    size_ += DataSize::Bytes(nodes_[index].packet->headers_size()) +
+             transport_overhead_per_packet_;
+  }
+}
+
+void PrioritizedPacketQueue::SetTransportOverhead(
+    DataSize overhead_per_packet) {
+  // Like in SetIncludeOverhead().
+  single_packet_ = false;
+  if (include_overhead_) {
+    // We need to update the size to reflect overhead for existing packets.
+    const int64_t packets = static_cast<int64_t>(size_packets_);
+    size_ -= packets * transport_overhead_per_packet_;
+    size_ += packets * overhead_per_packet;
+  }
+  transport_overhead_per_packet_ = overhead_per_packet;
+}
+
+int PrioritizedPacketQueue::AllocateNode() {
+  if (free_nodes_ == kNone) {
+    nodes_.emplace_back();
+    return static_cast<int>(nodes_.size()) - 1;
+  }
+  const int index = free_nodes_;
+  free_nodes_ = nodes_[index].next;
+  nodes_[index].next = kNone;
+  return index;
+}
+
+void PrioritizedPacketQueue::FreeNode(int index) {
+  Node& node = nodes_[index];
+  node.packet = nullptr;
+  node.older = kNone;
+  node.newer = kNone;
+  node.next = free_nodes_;
+  free_nodes_ = index;
+}
+
+void PrioritizedPacketQueue::LinkByEnqueueTime(int index) {
+  Node& node = nodes_[index];
+  // Packets are pushed in order of enqueue time, so this is almost always
+  // the newest packet.
+  int older = newest_node_;
+  while (older != kNone && nodes_[older].enqueue_time > node.enqueue_time) {
+    older = nodes_[older].older;
+  }
+  const int newer = older == kNone ? oldest_node_ : nodes_[older].newer;
+  node.older = older;
+  node.newer = newer;
+  if (older == kNone) {
+    oldest_node_ = index;
+  } else {
+    nodes_[older].newer = index;
+  }
+  if (newer == kNone) {
+    newest_node_ = index;
+  } else {
+    nodes_[newer].older = index;
+  }
+}
+
+void PrioritizedPacketQueue::UnlinkByEnqueueTime(int index) {
+  const Node& node = nodes_[index];
+  if (node.older == kNone) {
+    oldest_node_ = node.newer;
+  } else {
+    nodes_[node.older].newer = node.newer;
+  }
+  if (node.newer == kNone) {
+    newest_node_ = node.older;
+  } else {
+    nodes_[node.newer].older = node.older;
+  }
+}
+
+int PrioritizedPacketQueue::TopFifo(const Stream& stream) const {
+  RTC_DCHECK_NE(stream.non_empty_fifos, 0);
+  return absl::countr_zero(stream.non_empty_fifos);
+}
+
+int PrioritizedPacketQueue::TopNode(const Stream& stream) const {
+  return stream.fifos[TopFifo(stream)].head;
+}
+
+void PrioritizedPacketQueue::Schedule(int stream_index, int priority) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_EQ(stream.scheduled_priority, kNone);
+  std::vector<int>& heap = scheduled_streams_[priority];
+  stream.scheduled_priority = priority;
+  stream.schedule_order = schedule_order_++;
+  stream.heap_index = heap.size();
+  heap.push_back(stream_index);
+  HeapSiftUp(heap, stream.heap_index);
+  non_empty_priorities_ |= 1u << priority;
+}
+
+void PrioritizedPacketQueue::Unschedule(int stream_index) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK_NE(stream.scheduled_priority, kNone);
+  std::vector<int>& heap = scheduled_streams_[stream.scheduled_priority];
+  const size_t heap_index = stream.heap_index;
+  RTC_DCHECK_EQ(heap[heap_index], stream_index);
+  HeapSwap(heap, heap_index, heap.size() - 1);
+  heap.pop_back();
+  if (heap_index < heap.size()) {
+    HeapSiftDown(heap, heap_index);
+    HeapSiftUp(heap, heap_index);
+  }
+  if (heap.empty()) {
+    non_empty_priorities_ &= ~(1u << stream.scheduled_priority);
+  }
+  stream.scheduled_priority = kNone;
+}
+
+bool PrioritizedPacketQueue::HeapLess(int stream_a, int stream_b) const {
+  const Stream& a = streams_[stream_a];
+  const Stream& b = streams_[stream_b];
+  if (a.size != b.size)
+    return a.size < b.size;
+  return a.schedule_order < b.schedule_order;
+}
+
+void PrioritizedPacketQueue::HeapSiftUp(std::vector<int>& heap, size_t index) {
+  while (index > 0) {
+    const size_t parent = (index - 1) / 2;
+    if (!HeapLess(heap[index], heap[parent]))
+      return;
+    HeapSwap(heap, index, parent);
+    index = parent;
+  }
+}
+
+void PrioritizedPacketQueue::HeapSiftDown(std::vector<int>& heap,
+                                          size_t index) {
+  while (true) {
+    size_t smallest = index;
+    for (size_t child = 2 * index + 1; child <= 2 * index + 2; ++child) {
+      if (child < heap.size() && HeapLess(heap[child], heap[smallest]))
+        smallest = child;
+    }
+    if (smallest == index)
+      return;
+    HeapSwap(heap, index, smallest);
+    index = smallest;
+  }
+}
+
+void PrioritizedPacketQueue::HeapSwap(std::vector<int>& heap,
+                                      size_t a,
+                                      size_t b) {
+  std::swap(heap[a], heap[b]);
+  streams_[heap[a]].heap_index = a;
+  streams_[heap[b]].heap_index = b;
+}
+
+int PrioritizedPacketQueue::HighestPriorityStream() const {
+  if (non_empty_priorities_ == 0) {
+    return kNone;
+  }
+  return scheduled_streams_[absl::countr_zero(non_empty_priorities_)].front();
+}
+
+DataSize PrioritizedPacketQueue::PacketSize(
+    const RtpPacketToSend& packet) const {
+  DataSize packet_size =
+      DataSize::Bytes(packet.payload_size() + packet.padding_size());
+  if (include_overhead_) {
+    packet_size +=
+        DataSize::Bytes(packet.headers_size()) + transport_overhead_per_packet_;
+  }
+  return packet_size;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,165 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_PACING_PRIORITIZED_PACKET_QUEUE_H_
+#define MODULES_PACING_PRIORITIZED_PACKET_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/pacing/pacer_packet_queue.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+
+namespace webrtc {
+
+// A PacerPacketQueue that pops packets in the same order as
+// RoundRobinPacketQueue, but without allocating or rebalancing trees on
+// every Push() and Pop(), for pacers with many streams.
+//
+// Packets are kept in a flat array of nodes, recycled through a free list,
+// and linked into a FIFO per stream, priority and retransmission flag, and
+// into a list ordered by enqueue time, whose head is the oldest packet.
+// Scheduled streams are kept in a bucket per priority, each a binary heap
+// ordered by the bytes the streams have sent.
+class PrioritizedPacketQueue : public PacerPacketQueue {
+ public:
+  // Priorities of pushed packets must be in [0, kNumPriorityLevels).
+  static constexpr int kNumPriorityLevels = 8;
+
+  explicit PrioritizedPacketQueue(Timestamp start_time);
+  ~PrioritizedPacketQueue() override;
+
+  PrioritizedPacketQueue(const PrioritizedPacketQueue&) = delete;
+  PrioritizedPacketQueue& operator=(const PrioritizedPacketQueue&) = delete;
+
+  void Push(int priority,
+            Timestamp enqueue_time,
+            uint64_t enqueue_order,
+            std::unique_ptr<RtpPacketToSend> packet) override;
+  std::unique_ptr<RtpPacketToSend> Pop() override;
+
+  bool Empty() const override;
+  size_t SizeInPackets() const override;
+  DataSize Size() const override;
+  absl::optional<Timestamp> LeadingAudioPacketEnqueueTime() const override;
+
+  Timestamp OldestEnqueueTime() const override;
+  TimeDelta AverageQueueTime() const override;
+  void UpdateQueueTime(Timestamp now) override;
+  void SetPauseState(bool paused, Timestamp now) override;
+  void SetIncludeOverhead() override;
+  void SetTransportOverhead(DataSize overhead_per_packet) override;
+
+ private:
+  static constexpr int kNone = -1;
+  // A FIFO for each priority, with retransmissions ahead of other packets
+  // of the same priority.
+  static constexpr int kNumFifos = 2 * kNumPriorityLevels;
+
+  struct Node {
+    std::unique_ptr<RtpPacketToSend> packet;
+    Timestamp enqueue_time = Timestamp::MinusInfinity();
+    // `enqueue_time` minus the time the queue had been paused when the
+    // packet was pushed.
+    Timestamp unpaused_enqueue_time = Timestamp::MinusInfinity();
+    RtpPacketMediaType type = RtpPacketMediaType::kAudio;
+    // Next packet in the FIFO of the stream, or in the free list.
+    int next = kNone;
+    // Neighbours in the list ordered by enqueue time.
+    int older = kNone;
+    int newer = kNone;
+  };
+
+  struct Fifo {
+    int head = kNone;
+    int tail = kNone;
+  };
+
+  struct Stream {
+    explicit Stream(uint32_t ssrc);
+
+    uint32_t ssrc;
+    DataSize size = DataSize::Zero();
+    std::array<Fifo, kNumFifos> fifos;
+    // Bit `i` is set if `fifos[i]` is not empty.
+    uint32_t non_empty_fifos = 0;
+    // The priority the stream is scheduled with, or kNone if it isn't.
+    int scheduled_priority = kNone;
+    // Position in the heap of `scheduled_priority`.
+    size_t heap_index = 0;
+    // Breaks ties between streams that have sent the same number of bytes,
+    // in the order they were scheduled.
+    uint64_t schedule_order = 0;
+  };
+
+  int AllocateNode();
+  void FreeNode(int index);
+  // Links `index` into the enqueue time list, after any packet with a later
+  // enqueue time.
+  void LinkByEnqueueTime(int index);
+  void UnlinkByEnqueueTime(int index);
+
+  int TopFifo(const Stream& stream) const;
+  int TopNode(const Stream& stream) const;
+
+  void Schedule(int stream_index, int priority);
+  void Unschedule(int stream_index);
+  bool HeapLess(int stream_a, int stream_b) const;
+  void HeapSiftUp(std::vector<int>& heap, size_t index);
+  void HeapSiftDown(std::vector<int>& heap, size_t index);
+  void HeapSwap(std::vector<int>& heap, size_t a, size_t b);
+  // Returns the stream to pop the next packet from, or kNone if empty.
+  int HighestPriorityStream() const;
+
+  DataSize PacketSize(const RtpPacketToSend& packet) const;
+
+  DataSize transport_overhead_per_packet_;
+  Timestamp time_last_updated_;
+  bool paused_;
+  size_t size_packets_;
+  DataSize size_;
+  DataSize max_size_;
+  TimeDelta queue_time_sum_;
+  TimeDelta pause_time_sum_;
+  bool include_overhead_;
+  // Set while the only packet in the queue was pushed to an empty queue, and
+  // the overhead hasn't changed since. Like RoundRobinPacketQueue, which
+  // keeps such a packet outside of the streams, its bytes aren't accounted
+  // to its stream when it's popped.
+  bool single_packet_;
+
+  std::vector<Node> nodes_;
+  int free_nodes_;
+  int oldest_node_;
+  int newest_node_;
+
+  std::vector<Stream> streams_;
+  std::unordered_map<uint32_t, int> stream_indices_;
+
+  // The scheduled streams of each priority, as binary heaps with the stream
+  // that has sent the fewest bytes on top.
+  std::array<std::vector<int>, kNumPriorityLevels> scheduled_streams_;
+  // Bit `i` is set if `scheduled_streams_[i]` is not empty.
+  uint32_t non_empty_priorities_;
+  uint64_t schedule_order_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_PACING_PRIORITIZED_PACKET_QUEUE_H_
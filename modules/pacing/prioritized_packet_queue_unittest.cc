@@ -0,0 +1,297 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/prioritized_packet_queue.h"
+
+#include <memory>
+#include <utility>
+
+#include "modules/pacing/round_robin_packet_queue.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kAudioPriority = 1;
+constexpr int kRetransmissionPriority = 2;
+constexpr int kVideoPriority = 3;
+constexpr int kPaddingPriority = 4;
+
+std::unique_ptr<RtpPacketToSend> BuildPacket(RtpPacketMediaType type,
+                                             uint32_t ssrc,
+                                             uint16_t sequence_number,
+                                             size_t size = 100) {
+  auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+  packet->set_packet_type(type);
+  packet->SetSsrc(ssrc);
+  packet->SetSequenceNumber(sequence_number);
+  packet->SetPayloadSize(size);
+  return packet;
+}
+
+int PriorityForType(RtpPacketMediaType type) {
+  switch (type) {
+    case RtpPacketMediaType::kAudio:
+      return kAudioPriority;
+    case RtpPacketMediaType::kRetransmission:
+      return kRetransmissionPriority;
+    case RtpPacketMediaType::kVideo:
+    case RtpPacketMediaType::kForwardErrorCorrection:
+      return kVideoPriority;
+    case RtpPacketMediaType::kPadding:
+      return kPaddingPriority;
+  }
+  return kPaddingPriority;
+}
+
+class PrioritizedPacketQueueTest : public ::testing::Test {
+ protected:
+  PrioritizedPacketQueueTest() : now_(Timestamp::Millis(1000)), queue_(now_) {}
+
+  void Push(RtpPacketMediaType type,
+            uint32_t ssrc,
+            uint16_t sequence_number,
+            size_t size = 100) {
+    queue_.Push(PriorityForType(type), now_, enqueue_order_++,
+                BuildPacket(type, ssrc, sequence_number, size));
+  }
+
+  uint16_t PopSequenceNumber() {
+    std::unique_ptr<RtpPacketToSend> packet = queue_.Pop();
+    EXPECT_TRUE(packet);
+    return packet ? packet->SequenceNumber() : 0;
+  }
+
+  Timestamp now_;
+  uint64_t enqueue_order_ = 0;
+  PrioritizedPacketQueue queue_;
+};
+
+TEST_F(PrioritizedPacketQueueTest, PopsPacketsInPriorityOrder) {
+  Push(RtpPacketMediaType::kPadding, 1, 1);
+  Push(RtpPacketMediaType::kVideo, 2, 2);
+  Push(RtpPacketMediaType::kRetransmission, 2, 3);
+  Push(RtpPacketMediaType::kAudio, 3, 4);
+
+  EXPECT_EQ(4u, queue_.SizeInPackets());
+  EXPECT_EQ(DataSize::Bytes(400), queue_.Size());
+  EXPECT_EQ(now_, queue_.LeadingAudioPacketEnqueueTime());
+  EXPECT_EQ(4, PopSequenceNumber());
+  EXPECT_FALSE(queue_.LeadingAudioPacketEnqueueTime().has_value());
+  EXPECT_EQ(3, PopSequenceNumber());
+  EXPECT_EQ(2, PopSequenceNumber());
+  EXPECT_EQ(1, PopSequenceNumber());
+  EXPECT_TRUE(queue_.Empty());
+  EXPECT_EQ(DataSize::Zero(), queue_.Size());
+}
+
+TEST_F(PrioritizedPacketQueueTest, PopsRetransmissionsFirstWithinPriority) {
+  queue_.Push(kVideoPriority, now_, enqueue_order_++,
+              BuildPacket(RtpPacketMediaType::kVideo, 1, 1));
+  queue_.Push(kVideoPriority, now_, enqueue_order_++,
+              BuildPacket(RtpPacketMediaType::kRetransmission, 1, 2));
+  queue_.Push(kVideoPriority, now_, enqueue_order_++,
+              BuildPacket(RtpPacketMediaType::kVideo, 1, 3));
+
+  EXPECT_EQ(2, PopSequenceNumber());
+  EXPECT_EQ(1, PopSequenceNumber());
+  EXPECT_EQ(3, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest, AlternatesBetweenStreamsOfSamePriority) {
+  for (uint16_t i = 0; i < 3; ++i) {
+    Push(RtpPacketMediaType::kVideo, 1, 10 + i);
+  }
+  for (uint16_t i = 0; i < 3; ++i) {
+    Push(RtpPacketMediaType::kVideo, 2, 20 + i);
+  }
+
+  EXPECT_EQ(10, PopSequenceNumber());
+  EXPECT_EQ(20, PopSequenceNumber());
+  EXPECT_EQ(11, PopSequenceNumber());
+  EXPECT_EQ(21, PopSequenceNumber());
+  EXPECT_EQ(12, PopSequenceNumber());
+  EXPECT_EQ(22, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest, ServesStreamThatHasSentFewestBytes) {
+  Push(RtpPacketMediaType::kVideo, 1, 10, /*size=*/1000);
+  Push(RtpPacketMediaType::kVideo, 1, 11, /*size=*/1000);
+  Push(RtpPacketMediaType::kVideo, 2, 20, /*size=*/300);
+  Push(RtpPacketMediaType::kVideo, 2, 21, /*size=*/300);
+  Push(RtpPacketMediaType::kVideo, 2, 22, /*size=*/300);
+  Push(RtpPacketMediaType::kVideo, 2, 23, /*size=*/300);
+
+  EXPECT_EQ(10, PopSequenceNumber());
+  EXPECT_EQ(20, PopSequenceNumber());
+  EXPECT_EQ(21, PopSequenceNumber());
+  EXPECT_EQ(22, PopSequenceNumber());
+  EXPECT_EQ(23, PopSequenceNumber());
+  EXPECT_EQ(11, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest,
+       DoesNotAccountPacketPushedToAndPoppedFromEmptyQueue) {
+  // Like in RoundRobinPacketQueue, stream 1 hasn't sent any bytes after this.
+  Push(RtpPacketMediaType::kVideo, 1, 10, /*size=*/1000);
+  EXPECT_EQ(10, PopSequenceNumber());
+
+  Push(RtpPacketMediaType::kVideo, 1, 11);
+  Push(RtpPacketMediaType::kVideo, 2, 20);
+  EXPECT_EQ(11, PopSequenceNumber());
+  EXPECT_EQ(20, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest,
+       AccountsPacketPushedToEmptyQueueOnceTransportOverheadIsSet) {
+  // Like in RoundRobinPacketQueue, setting the overhead moves the packet into
+  // its stream, so stream 1 has sent its bytes after this.
+  Push(RtpPacketMediaType::kVideo, 1, 10, /*size=*/1000);
+  queue_.SetTransportOverhead(DataSize::Bytes(28));
+  EXPECT_EQ(10, PopSequenceNumber());
+
+  Push(RtpPacketMediaType::kVideo, 1, 11);
+  Push(RtpPacketMediaType::kVideo, 2, 20);
+  EXPECT_EQ(20, PopSequenceNumber());
+  EXPECT_EQ(11, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest,
+       AccountsPacketPushedToEmptyQueueOnceOverheadIsIncluded) {
+  Push(RtpPacketMediaType::kVideo, 1, 10, /*size=*/1000);
+  queue_.SetIncludeOverhead();
+  EXPECT_EQ(10, PopSequenceNumber());
+
+  Push(RtpPacketMediaType::kVideo, 1, 11);
+  Push(RtpPacketMediaType::kVideo, 2, 20);
+  EXPECT_EQ(20, PopSequenceNumber());
+  EXPECT_EQ(11, PopSequenceNumber());
+}
+
+TEST_F(PrioritizedPacketQueueTest, TracksOldestEnqueueTime) {
+  EXPECT_EQ(Timestamp::MinusInfinity(), queue_.OldestEnqueueTime());
+  const Timestamp first_time = now_;
+  Push(RtpPacketMediaType::kVideo, 1, 1);
+  now_ += TimeDelta::Millis(10);
+  Push(RtpPacketMediaType::kAudio, 2, 2);
+  now_ += TimeDelta::Millis(10);
+  Push(RtpPacketMediaType::kVideo, 1, 3);
+
+  // The audio packet is popped first, while the oldest packet stays queued.
+  EXPECT_EQ(2, PopSequenceNumber());
+  EXPECT_EQ(first_time, queue_.OldestEnqueueTime());
+  EXPECT_EQ(1, PopSequenceNumber());
+  EXPECT_EQ(now_, queue_.OldestEnqueueTime());
+  EXPECT_EQ(3, PopSequenceNumber());
+  EXPECT_EQ(Timestamp::MinusInfinity(), queue_.OldestEnqueueTime());
+}
+
+TEST_F(PrioritizedPacketQueueTest, ExcludesPausedTimeFromQueueTime) {
+  Push(RtpPacketMediaType::kVideo, 1, 1);
+  Push(RtpPacketMediaType::kVideo, 1, 2);
+  now_ += TimeDelta::Millis(10);
+  queue_.SetPauseState(true, now_);
+  now_ += TimeDelta::Millis(100);
+  queue_.SetPauseState(false, now_);
+  now_ += TimeDelta::Millis(10);
+  queue_.UpdateQueueTime(now_);
+
+  EXPECT_EQ(TimeDelta::Millis(20), queue_.AverageQueueTime());
+  queue_.Pop();
+  EXPECT_EQ(TimeDelta::Millis(20), queue_.AverageQueueTime());
+  queue_.Pop();
+  EXPECT_EQ(TimeDelta::Zero(), queue_.AverageQueueTime());
+}
+
+TEST_F(PrioritizedPacketQueueTest, AccountsForOverhead) {
+  Push(RtpPacketMediaType::kVideo, 1, 1);
+  Push(RtpPacketMediaType::kVideo, 1, 2);
+  const DataSize headers_size = DataSize::Bytes(12);
+
+  queue_.SetTransportOverhead(DataSize::Bytes(28));
+  EXPECT_EQ(DataSize::Bytes(200), queue_.Size());
+  queue_.SetIncludeOverhead();
+  EXPECT_EQ(DataSize::Bytes(200) + 2 * (headers_size + DataSize::Bytes(28)),
+            queue_.Size());
+  queue_.SetTransportOverhead(DataSize::Bytes(48));
+  EXPECT_EQ(DataSize::Bytes(200) + 2 * (headers_size + DataSize::Bytes(48)),
+            queue_.Size());
+  queue_.Pop();
+  EXPECT_EQ(DataSize::Bytes(100) + headers_size + DataSize::Bytes(48),
+            queue_.Size());
+}
+
+// Pushes and pops random packets through both queue implementations, now
+// and then draining them, and checks that they pop packets in the same order
+// and report the same sizes and times.
+TEST(PrioritizedPacketQueueMatchesRoundRobinTest, RandomTraffic) {
+  constexpr RtpPacketMediaType kTypes[] = {
+      RtpPacketMediaType::kAudio, RtpPacketMediaType::kVideo,
+      RtpPacketMediaType::kRetransmission,
+      RtpPacketMediaType::kForwardErrorCorrection,
+      RtpPacketMediaType::kPadding};
+  Random random(12345);
+  Timestamp now = Timestamp::Millis(1000);
+  PrioritizedPacketQueue prioritized_queue(now);
+  RoundRobinPacketQueue round_robin_queue(now, nullptr);
+  uint64_t enqueue_order = 0;
+  uint16_t sequence_number = 0;
+
+  for (int i = 0; i < 20000; ++i) {
+    now += TimeDelta::Micros(random.Rand(0, 500));
+    // Drain the queue now and then, so that packets pushed to, and popped
+    // from, an otherwise empty queue are covered too.
+    if (!prioritized_queue.Empty() && random.Rand(0, 1) == 0) {
+      prioritized_queue.UpdateQueueTime(now);
+      round_robin_queue.UpdateQueueTime(now);
+      EXPECT_EQ(round_robin_queue.LeadingAudioPacketEnqueueTime(),
+                prioritized_queue.LeadingAudioPacketEnqueueTime());
+      std::unique_ptr<RtpPacketToSend> expected = round_robin_queue.Pop();
+      std::unique_ptr<RtpPacketToSend> actual = prioritized_queue.Pop();
+      ASSERT_EQ(expected->Ssrc(), actual->Ssrc());
+      ASSERT_EQ(expected->SequenceNumber(), actual->SequenceNumber());
+    } else {
+      RtpPacketMediaType type = kTypes[random.Rand(0, 4)];
+      uint32_t ssrc = random.Rand(1, 20);
+      size_t size = random.Rand(50, 1200);
+      prioritized_queue.Push(PriorityForType(type), now, enqueue_order,
+                             BuildPacket(type, ssrc, sequence_number, size));
+      round_robin_queue.Push(PriorityForType(type), now, enqueue_order,
+                             BuildPacket(type, ssrc, sequence_number, size));
+      ++enqueue_order;
+      ++sequence_number;
+    }
+    if (i > 0 && random.Rand(0, 100) == 0) {
+      bool paused = random.Rand(0, 1) == 0;
+      prioritized_queue.SetPauseState(paused, now);
+      round_robin_queue.SetPauseState(paused, now);
+    }
+    if (random.Rand(0, 1000) == 0) {
+      DataSize overhead = DataSize::Bytes(random.Rand(20, 60));
+      prioritized_queue.SetTransportOverhead(overhead);
+      round_robin_queue.SetTransportOverhead(overhead);
+    }
+    if (i == 10000) {
+      prioritized_queue.SetIncludeOverhead();
+      round_robin_queue.SetIncludeOverhead();
+    }
+    ASSERT_EQ(round_robin_queue.SizeInPackets(),
+              prioritized_queue.SizeInPackets());
+    EXPECT_EQ(round_robin_queue.Size(), prioritized_queue.Size());
+    EXPECT_EQ(round_robin_queue.OldestEnqueueTime(),
+              prioritized_queue.OldestEnqueueTime());
+    EXPECT_EQ(round_robin_queue.AverageQueueTime(),
+              prioritized_queue.AverageQueueTime());
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
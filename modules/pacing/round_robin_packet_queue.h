@@ -26,39 +26,36 @@
 #include "api/units/data_size.h"
 #include "api/units/time_delta.h"
 #include "api/units/timestamp.h"
+#include "modules/pacing/pacer_packet_queue.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
 
-class RoundRobinPacketQueue {
+class RoundRobinPacketQueue : public PacerPacketQueue {
  public:
   RoundRobinPacketQueue(Timestamp start_time,
                         const WebRtcKeyValueConfig* field_trials);
-  ~RoundRobinPacketQueue();
+  ~RoundRobinPacketQueue() override;
 
   void Push(int priority,
             Timestamp enqueue_time,
             uint64_t enqueue_order,
-            std::unique_ptr<RtpPacketToSend> packet);
-  std::unique_ptr<RtpPacketToSend> Pop();
-
-  bool Empty() const;
-  size_t SizeInPackets() const;
-  DataSize Size() const;
-  // If the next packet, that would be returned by Pop() if called
-  // now, is an audio packet this method returns the enqueue time
-  // of that packet. If queue is empty or top packet is not audio,
-  // returns nullopt.
-  absl::optional<Timestamp> LeadingAudioPacketEnqueueTime() const;
-
-  Timestamp OldestEnqueueTime() const;
-  TimeDelta AverageQueueTime() const;
-  void UpdateQueueTime(Timestamp now);
-  void SetPauseState(bool paused, Timestamp now);
-  void SetIncludeOverhead();
-  void SetTransportOverhead(DataSize overhead_per_packet);
+            std::unique_ptr<RtpPacketToSend> packet) override;
+  std::unique_ptr<RtpPacketToSend> Pop() override;
+
+  bool Empty() const override;
+  size_t SizeInPackets() const override;
+  DataSize Size() const override;
+  absl::optional<Timestamp> LeadingAudioPacketEnqueueTime() const override;
+
+  Timestamp OldestEnqueueTime() const override;
+  TimeDelta AverageQueueTime() const override;
+  void UpdateQueueTime(Timestamp now) override;
+  void SetPauseState(bool paused, Timestamp now) override;
+  void SetIncludeOverhead() override;
+  void SetTransportOverhead(DataSize overhead_per_packet) override;
 
  private:
   struct QueuedPacket {
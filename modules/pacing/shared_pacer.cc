@@ -0,0 +1,466 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/shared_pacer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/trace_event.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+// While packets are queued, update stats at least every
+// `kMaxTimeBetweenStatsUpdates`, and at most every
+// `kMinTimeBetweenStatsUpdates`.
+constexpr TimeDelta kMaxTimeBetweenStatsUpdates = TimeDelta::Millis(33);
+constexpr TimeDelta kMinTimeBetweenStatsUpdates = TimeDelta::Millis(1);
+}  // namespace
+
+SharedPacedSender::SharedPacedSender(
+    SharedPacer* shared_pacer,
+    PacingController::PacketSender* packet_sender,
+    RtcEventLog* event_log,
+    const WebRtcKeyValueConfig* field_trials,
+    TimeDelta max_hold_back_window,
+    int max_hold_back_window_in_packets)
+    : shared_pacer_(shared_pacer),
+      task_queue_(&shared_pacer->task_queue_),
+      max_hold_back_window_(max_hold_back_window),
+      max_hold_back_window_in_packets_(max_hold_back_window_in_packets),
+      pacing_controller_(shared_pacer->clock_,
+                         packet_sender,
+                         event_log,
+                         field_trials,
+                         PacingController::ProcessMode::kDynamic),
+      packet_size_(/*alpha=*/0.95),
+      last_stats_time_(Timestamp::MinusInfinity()) {
+  packet_size_.Apply(1, 0);
+}
+
+SharedPacedSender::~SharedPacedSender() {
+  if (task_queue_->IsCurrent()) {
+    shared_pacer_->RemoveSender(this);
+    return;
+  }
+  // Tasks posted by the sender run before this one, so none of them are
+  // left to run once it is done.
+  rtc::Event done;
+  task_queue_->PostTask([this, &done] {
+    shared_pacer_->RemoveSender(this);
+    done.Set();
+  });
+  done.Wait(rtc::Event::kForever);
+}
+
+void SharedPacedSender::EnsureStarted() {
+  task_queue_->PostTask([this] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    is_started_ = true;
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::EnqueuePackets(
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets) {
+  task_queue_->PostTask([this, packets = std::move(packets)]() mutable {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    for (auto& packet : packets) {
+      packet_size_.Apply(1, packet->size());
+      RTC_DCHECK_GE(packet->capture_time_ms(), 0);
+      pacing_controller_.EnqueuePacket(std::move(packet));
+    }
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::CreateProbeCluster(DataRate bitrate, int cluster_id) {
+  task_queue_->PostTask([this, bitrate, cluster_id] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.CreateProbeCluster(bitrate, cluster_id);
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::Pause() {
+  task_queue_->PostTask([this] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.Pause();
+  });
+}
+
+void SharedPacedSender::Resume() {
+  task_queue_->PostTask([this] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.Resume();
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::SetCongestionWindow(DataSize congestion_window_size) {
+  task_queue_->PostTask([this, congestion_window_size] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetCongestionWindow(congestion_window_size);
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::UpdateOutstandingData(DataSize outstanding_data) {
+  if (task_queue_->IsCurrent()) {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    // Fast path since this can be called once per sent packet while on the
+    // task queue.
+    pacing_controller_.UpdateOutstandingData(outstanding_data);
+    return;
+  }
+
+  task_queue_->PostTask([this, outstanding_data] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.UpdateOutstandingData(outstanding_data);
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::SetPacingRates(DataRate pacing_rate,
+                                       DataRate padding_rate) {
+  task_queue_->PostTask([this, pacing_rate, padding_rate] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetPacingRates(pacing_rate, padding_rate);
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+void SharedPacedSender::SetAccountForAudioPackets(bool account_for_audio) {
+  task_queue_->PostTask([this, account_for_audio] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetAccountForAudioPackets(account_for_audio);
+  });
+}
+
+void SharedPacedSender::SetIncludeOverhead() {
+  task_queue_->PostTask([this] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetIncludeOverhead();
+  });
+}
+
+void SharedPacedSender::SetTransportOverhead(DataSize overhead_per_packet) {
+  task_queue_->PostTask([this, overhead_per_packet] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetTransportOverhead(overhead_per_packet);
+  });
+}
+
+void SharedPacedSender::SetQueueTimeLimit(TimeDelta limit) {
+  task_queue_->PostTask([this, limit] {
+    RTC_DCHECK_RUN_ON(task_queue_);
+    pacing_controller_.SetQueueTimeLimit(limit);
+    MaybeProcessPackets(shared_pacer_->clock_->CurrentTime(),
+                        /*is_scheduled_call=*/false);
+  });
+}
+
+TimeDelta SharedPacedSender::OldestPacketWaitTime() const {
+  return GetStats().oldest_packet_wait_time;
+}
+
+DataSize SharedPacedSender::QueueSizeData() const {
+  return GetStats().queue_size;
+}
+
+absl::optional<Timestamp> SharedPacedSender::FirstSentPacketTime() const {
+  return GetStats().first_sent_packet_time;
+}
+
+TimeDelta SharedPacedSender::ExpectedQueueTime() const {
+  return GetStats().expected_queue_time;
+}
+
+void SharedPacedSender::MaybeProcessPackets(Timestamp now,
+                                            bool is_scheduled_call) {
+  RTC_DCHECK_RUN_ON(task_queue_);
+  if (!is_started_) {
+    return;
+  }
+
+  // Calls that aren't due to the timer, e.g. when packets are enqueued, only
+  // process packets if it is already time to send.
+  if (is_scheduled_call || now >= pacing_controller_.NextSendTime()) {
+    pacing_controller_.ProcessPackets();
+  }
+  MaybeUpdateStats(now);
+
+  shared_pacer_->Unschedule(this);
+  shared_pacer_->Schedule(this, NextWakeupTick(now));
+}
+
+int64_t SharedPacedSender::NextWakeupTick(Timestamp now) const {
+  Timestamp next_process_time = pacing_controller_.NextSendTime();
+  if (next_process_time.IsMinusInfinity()) {
+    return shared_pacer_->TickOf(now);
+  }
+  RTC_DCHECK(next_process_time.IsFinite());
+  if (pacing_controller_.IsProbing()) {
+    // Probes may be sent up to a millisecond early, so round down like
+    // TaskQueuePacedSender does.
+    return shared_pacer_->TickOf(next_process_time);
+  }
+
+  int64_t tick = shared_pacer_->TickAtOrAfter(next_process_time);
+  // As in TaskQueuePacedSender, hold back to batch sends, by at least a tick.
+  tick = std::max({tick, shared_pacer_->TickOf(now + HoldBackWindow()),
+                   shared_pacer_->TickOf(now) + 1});
+
+  const bool pacer_drained = pacing_controller_.QueueSizePackets() == 0 &&
+                             pacing_controller_.CurrentBufferLevel().IsZero();
+  if (!pacer_drained) {
+    // Keep the stats fresh, and drain remaining debt in an otherwise empty
+    // queue.
+    tick = std::min(tick, shared_pacer_->TickAtOrAfter(
+                              last_stats_time_ + kMaxTimeBetweenStatsUpdates));
+  }
+  return tick;
+}
+
+TimeDelta SharedPacedSender::HoldBackWindow() const {
+  TimeDelta hold_back_window = max_hold_back_window_;
+  DataRate pacing_rate = pacing_controller_.pacing_rate();
+  DataSize avg_packet_size = DataSize::Bytes(packet_size_.filtered());
+  if (max_hold_back_window_in_packets_ > 0 && !pacing_rate.IsZero() &&
+      !avg_packet_size.IsZero()) {
+    TimeDelta avg_packet_send_time = avg_packet_size / pacing_rate;
+    hold_back_window =
+        std::min(hold_back_window,
+                 avg_packet_send_time * max_hold_back_window_in_packets_);
+  }
+  return hold_back_window;
+}
+
+void SharedPacedSender::MaybeUpdateStats(Timestamp now) {
+  // Update right away when the queue has drained, since the sender may not
+  // be woken up again for a while.
+  if (now - last_stats_time_ < kMinTimeBetweenStatsUpdates &&
+      pacing_controller_.QueueSizePackets() > 0) {
+    return;
+  }
+
+  Stats new_stats;
+  new_stats.expected_queue_time = pacing_controller_.ExpectedQueueTime();
+  new_stats.first_sent_packet_time = pacing_controller_.FirstSentPacketTime();
+  new_stats.oldest_packet_wait_time = pacing_controller_.OldestPacketWaitTime();
+  new_stats.queue_size = pacing_controller_.QueueSizeData();
+  {
+    MutexLock lock(&stats_mutex_);
+    current_stats_ = new_stats;
+  }
+  last_stats_time_ = now;
+}
+
+SharedPacedSender::Stats SharedPacedSender::GetStats() const {
+  MutexLock lock(&stats_mutex_);
+  return current_stats_;
+}
+
+SharedPacer::SharedPacer(Clock* clock,
+                         TaskQueueFactory* task_queue_factory,
+                         TimeDelta tick)
+    : clock_(clock),
+      tick_(tick),
+      slots_{},
+      non_empty_slots_{},
+      processed_tick_(TickOf(clock->CurrentTime())),
+      task_queue_(task_queue_factory->CreateTaskQueue(
+          "SharedPacer",
+          TaskQueueFactory::Priority::NORMAL)) {
+  RTC_DCHECK_GE(tick_, TimeDelta::Millis(1));
+}
+
+SharedPacer::~SharedPacer() {
+  RTC_DCHECK_EQ(num_senders_.load(), 0) << "All senders must be deleted.";
+}
+
+std::unique_ptr<SharedPacedSender> SharedPacer::CreatePacedSender(
+    PacingController::PacketSender* packet_sender,
+    RtcEventLog* event_log,
+    const WebRtcKeyValueConfig* field_trials,
+    TimeDelta max_hold_back_window,
+    int max_hold_back_window_in_packets) {
+  ++num_senders_;
+  // Not using std::make_unique since the constructor is private.
+  return std::unique_ptr<SharedPacedSender>(new SharedPacedSender(
+      this, packet_sender, event_log, field_trials, max_hold_back_window,
+      max_hold_back_window_in_packets));
+}
+
+int64_t SharedPacer::wakeups() const {
+  MutexLock lock(&wakeups_mutex_);
+  return wakeups_;
+}
+
+int64_t SharedPacer::TickOf(Timestamp time) const {
+  return time.us() / tick_.us();
+}
+
+int64_t SharedPacer::TickAtOrAfter(Timestamp time) const {
+  return (time.us() + tick_.us() - 1) / tick_.us();
+}
+
+Timestamp SharedPacer::TimeOf(int64_t tick) const {
+  return Timestamp::Zero() + tick * tick_;
+}
+
+void SharedPacer::RemoveSender(SharedPacedSender* sender) {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  Unschedule(sender);
+  --num_senders_;
+}
+
+void SharedPacer::Schedule(SharedPacedSender* sender, int64_t tick) {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  RTC_DCHECK(!sender->wakeup_tick_);
+  tick = std::max(tick, processed_tick_ + 1);
+  const int slot = static_cast<int>(tick % kNumSlots);
+  // Senders are added first in their slot, so that a slot being processed
+  // can be walked from the first sender due while senders are rescheduled.
+  sender->wakeup_tick_ = tick;
+  sender->prev_ = nullptr;
+  sender->next_ = slots_[slot];
+  if (sender->next_) {
+    sender->next_->prev_ = sender;
+  }
+  slots_[slot] = sender;
+  non_empty_slots_[slot / 64] |= uint64_t{1} << (slot % 64);
+  MaybePostWakeup();
+}
+
+void SharedPacer::Unschedule(SharedPacedSender* sender) {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  if (!sender->wakeup_tick_) {
+    return;
+  }
+  const int slot = static_cast<int>(*sender->wakeup_tick_ % kNumSlots);
+  if (sender == next_sender_) {
+    next_sender_ = sender->next_;
+  }
+  if (sender->prev_) {
+    sender->prev_->next_ = sender->next_;
+  } else {
+    slots_[slot] = sender->next_;
+    if (!slots_[slot]) {
+      non_empty_slots_[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+    }
+  }
+  if (sender->next_) {
+    sender->next_->prev_ = sender->prev_;
+  }
+  sender->wakeup_tick_ = absl::nullopt;
+  sender->prev_ = nullptr;
+  sender->next_ = nullptr;
+}
+
+void SharedPacer::MaybePostWakeup() {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  if (processing_wakeup_) {
+    // Posted once all due senders have been processed.
+    return;
+  }
+  absl::optional<int64_t> tick = FirstScheduledTick();
+  if (!tick || (wakeup_tick_ && *wakeup_tick_ <= *tick)) {
+    return;
+  }
+  // A wakeup already posted for a later tick is ignored when it runs.
+  wakeup_tick_ = tick;
+  TimeDelta delay =
+      std::max(TimeDelta::Zero(), TimeOf(*tick) - clock_->CurrentTime());
+  // Round up, so that the timer fires no earlier than the tick.
+  task_queue_.PostDelayedTask(
+      [this, tick = *tick] {
+        RTC_DCHECK_RUN_ON(&task_queue_);
+        OnWakeup(tick);
+      },
+      (delay.us() + 999) / 1000);
+}
+
+void SharedPacer::OnWakeup(int64_t tick) {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  if (wakeup_tick_ != tick) {
+    return;
+  }
+  TRACE_EVENT0("webrtc", "SharedPacer::OnWakeup");
+  wakeup_tick_ = absl::nullopt;
+  {
+    MutexLock lock(&wakeups_mutex_);
+    ++wakeups_;
+  }
+
+  const Timestamp now = clock_->CurrentTime();
+  const int64_t current_tick = TickOf(now);
+  // Walk each slot at most once, even if the task queue was late by more
+  // than a lap.
+  const int64_t first_tick =
+      std::max(processed_tick_ + 1, current_tick - kNumSlots + 1);
+  // Senders processed now are rescheduled after `current_tick`.
+  processed_tick_ = std::max(processed_tick_, current_tick);
+  processing_wakeup_ = true;
+  for (int64_t t = first_tick; t <= current_tick; ++t) {
+    SharedPacedSender* sender = slots_[t % kNumSlots];
+    while (sender) {
+      // Processing a sender may delete other senders. Unschedule() keeps
+      // `next_sender_` valid, so it is read after processing.
+      next_sender_ = sender->next_;
+      // Senders due on a later lap stay in the slot.
+      if (*sender->wakeup_tick_ <= current_tick) {
+        Unschedule(sender);
+        sender->MaybeProcessPackets(now, /*is_scheduled_call=*/true);
+      }
+      sender = next_sender_;
+    }
+  }
+  next_sender_ = nullptr;
+  processing_wakeup_ = false;
+  MaybePostWakeup();
+}
+
+absl::optional<int64_t> SharedPacer::FirstScheduledTick() const {
+  // Find the first non-empty slot after `processed_tick_`, wrapping around.
+  // A sender in it may be due on a later lap, in which case the wakeup
+  // finds nothing to do and looks again.
+  const int start_slot = static_cast<int>((processed_tick_ + 1) % kNumSlots);
+  for (int i = 0; i <= kNumSlots / 64; ++i) {
+    const int word = (start_slot / 64 + i) % (kNumSlots / 64);
+    uint64_t bits = non_empty_slots_[word];
+    if (i == 0) {
+      // Skip slots before `start_slot` in its word.
+      bits &= ~uint64_t{0} << (start_slot % 64);
+    } else if (i == kNumSlots / 64) {
+      // Back to the word of `start_slot`, with the slots before it.
+      bits &= ~(~uint64_t{0} << (start_slot % 64));
+    }
+    if (bits != 0) {
+      const int slot = word * 64 + absl::countr_zero(bits);
+      const int distance = (slot - start_slot + kNumSlots) % kNumSlots;
+      return processed_tick_ + 1 + distance;
+    }
+  }
+  return absl::nullopt;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,208 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_PACING_SHARED_PACER_H_
+#define MODULES_PACING_SHARED_PACER_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/transport/webrtc_key_value_config.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/pacing/pacing_controller.h"
+#include "modules/pacing/rtp_packet_pacer.h"
+#include "modules/rtp_rtcp/include/rtp_packet_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/numerics/exp_filter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+class Clock;
+class RtcEventLog;
+class SharedPacer;
+
+// A pacer of one transport, paced by a SharedPacer. Behaves like a
+// TaskQueuePacedSender, except that it runs on the task queue of the
+// SharedPacer and is woken up by its timer.
+class SharedPacedSender : public RtpPacketPacer, public RtpPacketSender {
+ public:
+  // Removes the sender from the SharedPacer, waiting for it to stop using
+  // the sender if called off its task queue.
+  ~SharedPacedSender() override;
+
+  // Ensure that the sender is scheduled.
+  void EnsureStarted();
+
+  // Methods implementing RtpPacketSender.
+  void EnqueuePackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) override;
+
+  // Methods implementing RtpPacketPacer.
+  void CreateProbeCluster(DataRate bitrate, int cluster_id) override;
+  void Pause() override;
+  void Resume() override;
+  void SetCongestionWindow(DataSize congestion_window_size) override;
+  void UpdateOutstandingData(DataSize outstanding_data) override;
+  void SetPacingRates(DataRate pacing_rate, DataRate padding_rate) override;
+  void SetAccountForAudioPackets(bool account_for_audio) override;
+  void SetIncludeOverhead() override;
+  void SetTransportOverhead(DataSize overhead_per_packet) override;
+  TimeDelta OldestPacketWaitTime() const override;
+  DataSize QueueSizeData() const override;
+  absl::optional<Timestamp> FirstSentPacketTime() const override;
+  TimeDelta ExpectedQueueTime() const override;
+  void SetQueueTimeLimit(TimeDelta limit) override;
+
+ private:
+  friend class SharedPacer;
+
+  struct Stats {
+    TimeDelta oldest_packet_wait_time = TimeDelta::Zero();
+    DataSize queue_size = DataSize::Zero();
+    TimeDelta expected_queue_time = TimeDelta::Zero();
+    absl::optional<Timestamp> first_sent_packet_time;
+  };
+
+  SharedPacedSender(SharedPacer* shared_pacer,
+                    PacingController::PacketSender* packet_sender,
+                    RtcEventLog* event_log,
+                    const WebRtcKeyValueConfig* field_trials,
+                    TimeDelta max_hold_back_window,
+                    int max_hold_back_window_in_packets);
+
+  // Processes packets if it is time to, or if `is_scheduled_call`, and
+  // schedules the next wakeup.
+  void MaybeProcessPackets(Timestamp now, bool is_scheduled_call);
+  // Returns when the sender wants to be woken up next.
+  int64_t NextWakeupTick(Timestamp now) const RTC_RUN_ON(task_queue_);
+  TimeDelta HoldBackWindow() const RTC_RUN_ON(task_queue_);
+  void MaybeUpdateStats(Timestamp now) RTC_RUN_ON(task_queue_);
+  Stats GetStats() const;
+
+  SharedPacer* const shared_pacer_;
+  rtc::TaskQueue* const task_queue_;
+  const TimeDelta max_hold_back_window_;
+  const int max_hold_back_window_in_packets_;
+
+  PacingController pacing_controller_ RTC_GUARDED_BY(task_queue_);
+  bool is_started_ RTC_GUARDED_BY(task_queue_) = false;
+  // Filtered size of enqueued packets, in bytes.
+  rtc::ExpFilter packet_size_ RTC_GUARDED_BY(task_queue_);
+  Timestamp last_stats_time_ RTC_GUARDED_BY(task_queue_);
+
+  // Used by the SharedPacer on its task queue. The tick the sender is
+  // scheduled for, if it is, and its neighbours in the timer wheel slot of
+  // that tick.
+  absl::optional<int64_t> wakeup_tick_;
+  SharedPacedSender* prev_ = nullptr;
+  SharedPacedSender* next_ = nullptr;
+
+  mutable Mutex stats_mutex_;
+  Stats current_stats_ RTC_GUARDED_BY(stats_mutex_);
+};
+
+// Paces many transports, e.g. the subscribers of an SFU, from a single task
+// queue. Each transport has a SharedPacedSender with a PacingController of
+// its own, keeping its own budgets and probing, but rather than each posting
+// delayed tasks to a task queue of its own, senders are scheduled on a timer
+// wheel with one slot per `tick`, and the SharedPacer wakes up once per slot
+// that has a sender due, processing all of them.
+//
+// Like TaskQueuePacedSender, media is processed at the first tick at or after
+// its send time, but no earlier than the hold-back window after the sender was
+// last processed, and no earlier than the next tick. Probes, which may be sent
+// a millisecond early, are processed at the tick before.
+class SharedPacer {
+ public:
+  SharedPacer(Clock* clock,
+              TaskQueueFactory* task_queue_factory,
+              TimeDelta tick = PacingController::kMinSleepTime);
+  // All senders must have been deleted.
+  ~SharedPacer();
+
+  SharedPacer(const SharedPacer&) = delete;
+  SharedPacer& operator=(const SharedPacer&) = delete;
+
+  // Creates the pacer of a transport. The SharedPacer must outlive it. The
+  // hold-back window is limited like that of TaskQueuePacedSender.
+  std::unique_ptr<SharedPacedSender> CreatePacedSender(
+      PacingController::PacketSender* packet_sender,
+      RtcEventLog* event_log,
+      const WebRtcKeyValueConfig* field_trials,
+      TimeDelta max_hold_back_window = PacingController::kMinSleepTime,
+      int max_hold_back_window_in_packets = -1);
+
+  // The number of times the timer has fired, for testing.
+  int64_t wakeups() const;
+
+ private:
+  friend class SharedPacedSender;
+
+  // Enough slots to cover the longest time PacingController sleeps without
+  // sending. Senders due further ahead stay in their slot for another lap.
+  static constexpr int kNumSlots = 1024;
+
+  // Returns the tick `time` is in.
+  int64_t TickOf(Timestamp time) const;
+  // Returns the first tick starting at or after `time`.
+  int64_t TickAtOrAfter(Timestamp time) const;
+  Timestamp TimeOf(int64_t tick) const;
+
+  void RemoveSender(SharedPacedSender* sender);
+
+  // Schedules `sender` to be processed at `tick`, or at the first tick not
+  // yet processed, if later.
+  void Schedule(SharedPacedSender* sender, int64_t tick);
+  void Unschedule(SharedPacedSender* sender);
+  // Posts a delayed task to wake up for the first scheduled slot, unless one
+  // is already posted for that or an earlier tick.
+  void MaybePostWakeup();
+  void OnWakeup(int64_t tick);
+  absl::optional<int64_t> FirstScheduledTick() const RTC_RUN_ON(task_queue_);
+
+  Clock* const clock_;
+  const TimeDelta tick_;
+
+  std::array<SharedPacedSender*, kNumSlots> slots_ RTC_GUARDED_BY(task_queue_);
+  // Bit `i % 64` of `non_empty_slots_[i / 64]` is set if slot `i` has a
+  // sender.
+  std::array<uint64_t, kNumSlots / 64> non_empty_slots_
+      RTC_GUARDED_BY(task_queue_);
+  // Slots up to and including `processed_tick_` have been processed.
+  int64_t processed_tick_ RTC_GUARDED_BY(task_queue_);
+  // The tick a delayed wakeup task is posted for, if any.
+  absl::optional<int64_t> wakeup_tick_ RTC_GUARDED_BY(task_queue_);
+  bool processing_wakeup_ RTC_GUARDED_BY(task_queue_) = false;
+  // The sender OnWakeup() processes next in the slot it walks. Advanced by
+  // Unschedule() if a sender being processed removes it.
+  SharedPacedSender* next_sender_ RTC_GUARDED_BY(task_queue_) = nullptr;
+  // Senders created and not yet removed.
+  std::atomic<int> num_senders_{0};
+
+  mutable Mutex wakeups_mutex_;
+  int64_t wakeups_ RTC_GUARDED_BY(wakeups_mutex_) = 0;
+
+  rtc::TaskQueue task_queue_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_PACING_SHARED_PACER_H_
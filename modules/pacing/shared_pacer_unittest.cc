@@ -0,0 +1,356 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/shared_pacer.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "modules/pacing/task_queue_paced_sender.h"
+#include "rtc_base/arraysize.h"
+#include "test/gtest.h"
+#include "test/time_controller/simulated_time_controller.h"
+
+namespace webrtc {
+namespace {
+constexpr uint32_t kVideoSsrc = 234565;
+constexpr size_t kPacketSize = 1000;
+
+// Records the send time of each packet of a transport.
+class RecordingPacketSender : public PacingController::PacketSender {
+ public:
+  explicit RecordingPacketSender(Clock* clock) : clock_(clock) {}
+
+  void SendPacket(std::unique_ptr<RtpPacketToSend> packet,
+                  const PacedPacketInfo& cluster_info) override {
+    if (packet->packet_type() != RtpPacketMediaType::kPadding) {
+      media_send_times_.push_back(clock_->CurrentTime());
+    }
+    if (cluster_info.probe_cluster_id != PacedPacketInfo::kNotAProbe) {
+      ++probes_sent_;
+    }
+  }
+  std::vector<std::unique_ptr<RtpPacketToSend>> FetchFec() override {
+    return {};
+  }
+  std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
+      DataSize size) override {
+    return {};
+  }
+
+  const std::vector<Timestamp>& media_send_times() const {
+    return media_send_times_;
+  }
+  int probes_sent() const { return probes_sent_; }
+
+ private:
+  Clock* const clock_;
+  std::vector<Timestamp> media_send_times_;
+  int probes_sent_ = 0;
+};
+
+// Deletes the pacer of another transport when sending the first packet at or
+// after `delete_time`.
+class DeletingPacketSender : public RecordingPacketSender {
+ public:
+  DeletingPacketSender(Clock* clock,
+                       Timestamp delete_time,
+                       std::unique_ptr<SharedPacedSender>* pacer_to_delete)
+      : RecordingPacketSender(clock),
+        clock_(clock),
+        delete_time_(delete_time),
+        pacer_to_delete_(pacer_to_delete) {}
+
+  void SendPacket(std::unique_ptr<RtpPacketToSend> packet,
+                  const PacedPacketInfo& cluster_info) override {
+    RecordingPacketSender::SendPacket(std::move(packet), cluster_info);
+    if (clock_->CurrentTime() >= delete_time_) {
+      *pacer_to_delete_ = nullptr;
+    }
+  }
+
+ private:
+  Clock* const clock_;
+  const Timestamp delete_time_;
+  std::unique_ptr<SharedPacedSender>* const pacer_to_delete_;
+};
+
+std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePackets(
+    size_t num_packets) {
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+  for (size_t i = 0; i < num_packets; ++i) {
+    auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+    packet->set_packet_type(RtpPacketMediaType::kVideo);
+    packet->SetSsrc(kVideoSsrc);
+    packet->SetPayloadSize(kPacketSize);
+    packets.push_back(std::move(packet));
+  }
+  return packets;
+}
+
+DataRate RateForPacketsPerSecond(int packets_per_second) {
+  return DataRate::BitsPerSec(kPacketSize * 8 * packets_per_second);
+}
+
+TEST(SharedPacerTest, PacesPackets) {
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  SharedPacer shared_pacer(time_controller.GetClock(),
+                           time_controller.GetTaskQueueFactory());
+  RecordingPacketSender packet_sender(time_controller.GetClock());
+  std::unique_ptr<SharedPacedSender> pacer = shared_pacer.CreatePacedSender(
+      &packet_sender, /*event_log=*/nullptr, /*field_trials=*/nullptr);
+
+  // Insert a number of packets, covering one second.
+  static constexpr size_t kPacketsToSend = 42;
+  pacer->SetPacingRates(RateForPacketsPerSecond(kPacketsToSend),
+                        DataRate::Zero());
+  pacer->EnsureStarted();
+  pacer->EnqueuePackets(GeneratePackets(kPacketsToSend));
+  const Timestamp start_time = time_controller.GetClock()->CurrentTime();
+
+  // Packets should be sent over a period of close to 1s. Expect a little
+  // lower than this since initial probing is a bit quicker.
+  time_controller.AdvanceTime(TimeDelta::Seconds(1));
+  ASSERT_EQ(packet_sender.media_send_times().size(), kPacketsToSend);
+  EXPECT_NEAR(
+      (packet_sender.media_send_times().back() - start_time).ms<double>(),
+      1000.0, 50.0);
+  EXPECT_EQ(pacer->QueueSizeData(), DataSize::Zero());
+  EXPECT_TRUE(pacer->FirstSentPacketTime().has_value());
+}
+
+// Runs transports with different pacing rates on a SharedPacer, and each on
+// a TaskQueuePacedSender of its own, and checks that each transport sends its
+// packets at the same times either way.
+TEST(SharedPacerTest, KeepsPerTransportPacingRates) {
+  static constexpr int kPacketsPerSecond[] = {5, 50, 170, 400, 1000};
+  static constexpr int kNumTransports = arraysize(kPacketsPerSecond);
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+
+  std::vector<std::unique_ptr<RecordingPacketSender>> shared_senders;
+  std::vector<std::unique_ptr<RecordingPacketSender>> own_senders;
+  std::vector<std::unique_ptr<SharedPacedSender>> shared_pacers;
+  std::vector<std::unique_ptr<TaskQueuePacedSender>> own_pacers;
+  for (int i = 0; i < kNumTransports; ++i) {
+    shared_senders.push_back(std::make_unique<RecordingPacketSender>(clock));
+    own_senders.push_back(std::make_unique<RecordingPacketSender>(clock));
+    shared_pacers.push_back(shared_pacer.CreatePacedSender(
+        shared_senders[i].get(), /*event_log=*/nullptr,
+        /*field_trials=*/nullptr));
+    own_pacers.push_back(std::make_unique<TaskQueuePacedSender>(
+        clock, own_senders[i].get(), /*event_log=*/nullptr,
+        /*field_trials=*/nullptr, time_controller.GetTaskQueueFactory()));
+  }
+
+  for (int i = 0; i < kNumTransports; ++i) {
+    const DataRate rate = RateForPacketsPerSecond(kPacketsPerSecond[i]);
+    shared_pacers[i]->SetPacingRates(rate, DataRate::Zero());
+    own_pacers[i]->SetPacingRates(rate, DataRate::Zero());
+    shared_pacers[i]->EnsureStarted();
+    own_pacers[i]->EnsureStarted();
+  }
+  // Enqueue two seconds worth of packets, in bursts as an encoder would.
+  for (int burst = 0; burst < 10; ++burst) {
+    for (int i = 0; i < kNumTransports; ++i) {
+      const size_t num_packets = kPacketsPerSecond[i] / 5;
+      shared_pacers[i]->EnqueuePackets(GeneratePackets(num_packets));
+      own_pacers[i]->EnqueuePackets(GeneratePackets(num_packets));
+    }
+    time_controller.AdvanceTime(TimeDelta::Millis(200));
+  }
+  time_controller.AdvanceTime(TimeDelta::Millis(500));
+
+  for (int i = 0; i < kNumTransports; ++i) {
+    SCOPED_TRACE(kPacketsPerSecond[i]);
+    const std::vector<Timestamp>& shared_times =
+        shared_senders[i]->media_send_times();
+    const std::vector<Timestamp>& own_times =
+        own_senders[i]->media_send_times();
+    ASSERT_EQ(shared_times.size(), own_times.size());
+    EXPECT_EQ(shared_times.size(), size_t{2} * kPacketsPerSecond[i]);
+    for (size_t j = 0; j < shared_times.size(); ++j) {
+      // Both wake up on millisecond boundaries, but the SharedPacer may
+      // round a send time the other way.
+      EXPECT_NEAR(shared_times[j].ms<double>(), own_times[j].ms<double>(),
+                  1.0);
+    }
+    EXPECT_EQ(shared_senders[i]->probes_sent(), own_senders[i]->probes_sent());
+  }
+}
+
+TEST(SharedPacerTest, CoalescesWakeupsOfTransports) {
+  static constexpr int kNumTransports = 100;
+  static constexpr int kPacketsPerSecond = 200;
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+  std::vector<std::unique_ptr<RecordingPacketSender>> senders;
+  std::vector<std::unique_ptr<SharedPacedSender>> pacers;
+  for (int i = 0; i < kNumTransports; ++i) {
+    senders.push_back(std::make_unique<RecordingPacketSender>(clock));
+    pacers.push_back(shared_pacer.CreatePacedSender(
+        senders[i].get(), /*event_log=*/nullptr, /*field_trials=*/nullptr));
+    pacers[i]->SetPacingRates(RateForPacketsPerSecond(kPacketsPerSecond),
+                              DataRate::Zero());
+    pacers[i]->EnsureStarted();
+    pacers[i]->EnqueuePackets(GeneratePackets(kPacketsPerSecond));
+    // Let the transports start at different times within a millisecond.
+    time_controller.AdvanceTime(TimeDelta::Micros(7));
+  }
+  const int64_t wakeups_before = shared_pacer.wakeups();
+  time_controller.AdvanceTime(TimeDelta::Seconds(1));
+
+  size_t packets_sent = 0;
+  for (const auto& sender : senders) {
+    packets_sent += sender->media_send_times().size();
+  }
+  EXPECT_EQ(packets_sent, size_t{kNumTransports} * kPacketsPerSecond);
+  // The transports each want to wake up every 5 ms, i.e. 20000 times in
+  // total, but the shared pacer wakes up at most once per millisecond.
+  EXPECT_LE(shared_pacer.wakeups() - wakeups_before, 1000);
+}
+
+TEST(SharedPacerTest, SendsProbesOfEachTransport) {
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+  RecordingPacketSender probing_sender(clock);
+  RecordingPacketSender other_sender(clock);
+  std::unique_ptr<SharedPacedSender> probing_pacer =
+      shared_pacer.CreatePacedSender(&probing_sender, /*event_log=*/nullptr,
+                                     /*field_trials=*/nullptr);
+  std::unique_ptr<SharedPacedSender> other_pacer =
+      shared_pacer.CreatePacedSender(&other_sender, /*event_log=*/nullptr,
+                                     /*field_trials=*/nullptr);
+  for (SharedPacedSender* pacer : {probing_pacer.get(), other_pacer.get()}) {
+    pacer->SetPacingRates(RateForPacketsPerSecond(50), DataRate::Zero());
+    pacer->EnsureStarted();
+    pacer->EnqueuePackets(GeneratePackets(50));
+  }
+  // Get rid of the initial probes.
+  time_controller.AdvanceTime(TimeDelta::Seconds(1));
+  const int probing_probes_before = probing_sender.probes_sent();
+  const int other_probes_before = other_sender.probes_sent();
+
+  probing_pacer->CreateProbeCluster(RateForPacketsPerSecond(500),
+                                    /*cluster_id=*/17);
+  for (SharedPacedSender* pacer : {probing_pacer.get(), other_pacer.get()}) {
+    pacer->EnqueuePackets(GeneratePackets(50));
+  }
+  time_controller.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_GT(probing_sender.probes_sent(), probing_probes_before);
+  EXPECT_EQ(other_sender.probes_sent(), other_probes_before);
+}
+
+TEST(SharedPacerTest, StopsSendingWhenSenderIsDeleted) {
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+  RecordingPacketSender deleted_sender(clock);
+  RecordingPacketSender kept_sender(clock);
+  std::unique_ptr<SharedPacedSender> deleted_pacer =
+      shared_pacer.CreatePacedSender(&deleted_sender, /*event_log=*/nullptr,
+                                     /*field_trials=*/nullptr);
+  std::unique_ptr<SharedPacedSender> kept_pacer =
+      shared_pacer.CreatePacedSender(&kept_sender, /*event_log=*/nullptr,
+                                     /*field_trials=*/nullptr);
+  for (SharedPacedSender* pacer : {deleted_pacer.get(), kept_pacer.get()}) {
+    pacer->SetPacingRates(RateForPacketsPerSecond(10), DataRate::Zero());
+    pacer->EnsureStarted();
+    pacer->EnqueuePackets(GeneratePackets(10));
+  }
+  time_controller.AdvanceTime(TimeDelta::Millis(500));
+  const size_t sent_before_delete = deleted_sender.media_send_times().size();
+  EXPECT_LT(sent_before_delete, 10u);
+
+  deleted_pacer = nullptr;
+  time_controller.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_EQ(deleted_sender.media_send_times().size(), sent_before_delete);
+  EXPECT_EQ(kept_sender.media_send_times().size(), 10u);
+}
+
+// Two transports due at the same ticks, each deleting the pacer of the other
+// from its send callback, so that the one processed first deletes the other
+// while the SharedPacer walks their slot.
+TEST(SharedPacerTest, HandlesSenderDeletedByAnotherSender) {
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+  const Timestamp delete_time = clock->CurrentTime() + TimeDelta::Millis(500);
+  std::unique_ptr<SharedPacedSender> pacers[2];
+  DeletingPacketSender first_sender(clock, delete_time, &pacers[1]);
+  DeletingPacketSender second_sender(clock, delete_time, &pacers[0]);
+  pacers[0] = shared_pacer.CreatePacedSender(
+      &first_sender, /*event_log=*/nullptr, /*field_trials=*/nullptr);
+  pacers[1] = shared_pacer.CreatePacedSender(
+      &second_sender, /*event_log=*/nullptr, /*field_trials=*/nullptr);
+  for (const auto& pacer : pacers) {
+    pacer->SetPacingRates(RateForPacketsPerSecond(10), DataRate::Zero());
+    pacer->EnsureStarted();
+    pacer->EnqueuePackets(GeneratePackets(10));
+  }
+  time_controller.AdvanceTime(TimeDelta::Seconds(2));
+
+  // One pacer was deleted and the other one sent all its packets.
+  ASSERT_NE(pacers[0] == nullptr, pacers[1] == nullptr);
+  const RecordingPacketSender& kept_sender =
+      pacers[0] ? first_sender : second_sender;
+  EXPECT_EQ(kept_sender.media_send_times().size(), 10u);
+}
+
+// With a hold-back window, a transport sends its packets in bursts like on a
+// TaskQueuePacedSender with the same hold-back window.
+TEST(SharedPacerTest, HoldsBackLikeTaskQueuePacedSender) {
+  static constexpr TimeDelta kHoldBackWindow = TimeDelta::Millis(5);
+  static constexpr int kPacketsPerSecond = 1000;
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(1234));
+  Clock* clock = time_controller.GetClock();
+  SharedPacer shared_pacer(clock, time_controller.GetTaskQueueFactory());
+  RecordingPacketSender shared_sender(clock);
+  RecordingPacketSender own_sender(clock);
+  std::unique_ptr<SharedPacedSender> shared_pacer_sender =
+      shared_pacer.CreatePacedSender(&shared_sender, /*event_log=*/nullptr,
+                                     /*field_trials=*/nullptr, kHoldBackWindow);
+  TaskQueuePacedSender own_pacer(clock, &own_sender, /*event_log=*/nullptr,
+                                 /*field_trials=*/nullptr,
+                                 time_controller.GetTaskQueueFactory(),
+                                 kHoldBackWindow);
+  const DataRate rate = RateForPacketsPerSecond(kPacketsPerSecond);
+  shared_pacer_sender->SetPacingRates(rate, DataRate::Zero());
+  own_pacer.SetPacingRates(rate, DataRate::Zero());
+  shared_pacer_sender->EnsureStarted();
+  own_pacer.EnsureStarted();
+  shared_pacer_sender->EnqueuePackets(GeneratePackets(kPacketsPerSecond));
+  own_pacer.EnqueuePackets(GeneratePackets(kPacketsPerSecond));
+  time_controller.AdvanceTime(TimeDelta::Seconds(2));
+
+  const std::vector<Timestamp>& shared_times = shared_sender.media_send_times();
+  const std::vector<Timestamp>& own_times = own_sender.media_send_times();
+  ASSERT_EQ(shared_times.size(), own_times.size());
+  ASSERT_EQ(shared_times.size(), size_t{kPacketsPerSecond});
+  for (size_t i = 0; i < shared_times.size(); ++i) {
+    // TaskQueuePacedSender also sends when it updates its stats, which may
+    // break up a burst.
+    EXPECT_NEAR(shared_times[i].ms<double>(), own_times[i].ms<double>(),
+                kHoldBackWindow.ms<double>());
+  }
+  // Packets are sent in bursts, every hold-back window.
+  for (size_t i = 1; i < shared_times.size(); ++i) {
+    const TimeDelta gap = shared_times[i] - shared_times[i - 1];
+    EXPECT_TRUE(gap.IsZero() || gap >= kHoldBackWindow - TimeDelta::Millis(1))
+        << gap.ms();
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
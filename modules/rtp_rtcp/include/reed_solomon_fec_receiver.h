@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_RECEIVER_H_
+#define MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_RECEIVER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "api/sequence_checker.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/include/ulpfec_receiver.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/numerics/sequence_number_util.h"
+#include "rtc_base/system/no_unique_address.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+class Clock;
+
+// Receives the repair packets sent by ReedSolomonFecSender together with the
+// protected media packets, and returns recovered media packets through the
+// callback. Used like FlexfecReceiver.
+class ReedSolomonFecReceiver {
+ public:
+  ReedSolomonFecReceiver(Clock* clock,
+                         uint32_t ssrc,
+                         uint32_t protected_media_ssrc,
+                         RecoveredPacketReceiver* recovered_packet_receiver);
+  ~ReedSolomonFecReceiver();
+
+  // Inserts a received media or repair packet, and recovers the missing media
+  // packets of the block it belongs to if enough packets have been received.
+  void OnRtpPacket(const RtpPacketReceived& packet);
+
+  // Returns a counter describing the added and recovered packets.
+  FecPacketCounter GetPacketCounter() const;
+
+ private:
+  struct Block {
+    size_t num_media_packets = 0;
+    bool complete = false;
+    std::vector<rtc::CopyOnWriteBuffer> repair_payloads;
+  };
+
+  void OnRepairPacket(const RtpPacketReceived& packet);
+  void OnMediaPacket(const RtpPacketReceived& packet);
+  void MaybeRecover(int64_t base_seq_num, Block& block);
+  // Forgets packets and blocks far behind `newest_seq_num_`.
+  void DiscardOldPackets();
+
+  // Config.
+  const uint32_t ssrc_;
+  const uint32_t protected_media_ssrc_;
+  RecoveredPacketReceiver* const recovered_packet_receiver_;
+
+  // Received media packets, with mutable extensions zeroed, and blocks,
+  // indexed by unwrapped sequence number.
+  SeqNumUnwrapper<uint16_t> seq_num_unwrapper_
+      RTC_GUARDED_BY(sequence_checker_);
+  int64_t newest_seq_num_ RTC_GUARDED_BY(sequence_checker_);
+  std::map<int64_t, rtc::CopyOnWriteBuffer> media_packets_
+      RTC_GUARDED_BY(sequence_checker_);
+  std::map<int64_t, Block> blocks_ RTC_GUARDED_BY(sequence_checker_);
+
+  // Logging and stats.
+  Clock* const clock_;
+  int64_t last_recovered_packet_ms_ RTC_GUARDED_BY(sequence_checker_);
+  FecPacketCounter packet_counter_ RTC_GUARDED_BY(sequence_checker_);
+
+  RTC_NO_UNIQUE_ADDRESS SequenceChecker sequence_checker_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_RECEIVER_H_
@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_SENDER_H_
+#define MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_SENDER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/array_view.h"
+#include "api/rtp_parameters.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/rtp_header_extension_size.h"
+#include "modules/rtp_rtcp/source/video_fec_generator.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/race_checker.h"
+#include "rtc_base/random.h"
+#include "rtc_base/rate_statistics.h"
+#include "rtc_base/synchronization/mutex.h"
+
+namespace webrtc {
+
+class Clock;
+
+// Sends Reed-Solomon repair packets, see ReedSolomonFec, on a separate SSRC in
+// the same way as FlexfecSender. Blocks of up to
+// ReedSolomonFec::kMaxMediaPackets consecutive media packets are protected
+// with FecProtectionParams::fec_rate repair packets per 256 media packets; the
+// mask type is ignored since the code has no packet masks.
+//
+// Like FlexfecSender, this class requires external synchronization.
+class ReedSolomonFecSender : public VideoFecGenerator {
+ public:
+  ReedSolomonFecSender(int payload_type,
+                       uint32_t ssrc,
+                       uint32_t protected_media_ssrc,
+                       const std::string& mid,
+                       const std::vector<RtpExtension>& rtp_header_extensions,
+                       rtc::ArrayView<const RtpExtensionSize> extension_sizes,
+                       const RtpState* rtp_state,
+                       Clock* clock);
+  ~ReedSolomonFecSender() override;
+
+  FecType GetFecType() const override {
+    return VideoFecGenerator::FecType::kReedSolomon;
+  }
+  absl::optional<uint32_t> FecSsrc() override { return ssrc_; }
+  size_t MaxPacketOverhead() const override;
+  DataRate CurrentFecRate() const override;
+  void SetProtectionParameters(const FecProtectionParams& delta_params,
+                               const FecProtectionParams& key_params) override;
+  void AddPacketAndGenerateFec(const RtpPacketToSend& packet) override;
+  std::vector<std::unique_ptr<RtpPacketToSend>> GetFecPackets() override;
+  absl::optional<RtpState> GetRtpState() override;
+
+ private:
+  struct Params {
+    FecProtectionParams delta_params;
+    FecProtectionParams key_params;
+  };
+
+  const FecProtectionParams& CurrentParams() const;
+  // Encodes the repair packets of the buffered media packets.
+  void EncodeBlock();
+
+  // Utility.
+  Clock* const clock_;
+  Random random_;
+
+  // Config.
+  const int payload_type_;
+  const uint32_t timestamp_offset_;
+  const uint32_t ssrc_;
+  const uint32_t protected_media_ssrc_;
+  // MID value to send in the MID header extension.
+  const std::string mid_;
+  const RtpHeaderExtensionMap rtp_header_extension_map_;
+  const size_t header_extensions_size_;
+  // Sequence number of next packet to generate.
+  uint16_t seq_num_;
+
+  // Implementation.
+  rtc::RaceChecker race_checker_;
+  Params current_params_ RTC_GUARDED_BY(race_checker_);
+  std::vector<rtc::CopyOnWriteBuffer> media_packets_
+      RTC_GUARDED_BY(race_checker_);
+  int num_protected_frames_ RTC_GUARDED_BY(race_checker_) = 0;
+  bool media_contains_keyframe_ RTC_GUARDED_BY(race_checker_) = false;
+  std::vector<rtc::CopyOnWriteBuffer> repair_payloads_
+      RTC_GUARDED_BY(race_checker_);
+
+  mutable Mutex mutex_;
+  absl::optional<Params> pending_params_ RTC_GUARDED_BY(mutex_);
+  RateStatistics fec_bitrate_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_INCLUDE_REED_SOLOMON_FEC_SENDER_H_
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include <string.h>
+
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+
+#include "modules/rtp_rtcp/source/fec_xor_avx2.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+// XORs a 64 bit word at a time. Used for the bytes past the last full vector,
+// and on CPUs without vector instructions.
+void XorWords(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t s;
+    uint64_t d;
+    memcpy(&s, src + i, 8);
+    memcpy(&d, dst + i, 8);
+    d ^= s;
+    memcpy(dst + i, &d, 8);
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+#if defined(WEBRTC_HAS_NEON)
+void XorBytesNeon(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const uint8x16_t s0 = vld1q_u8(src + i);
+    const uint8x16_t s1 = vld1q_u8(src + i + 16);
+    const uint8x16_t d0 = vld1q_u8(dst + i);
+    const uint8x16_t d1 = vld1q_u8(dst + i + 16);
+    vst1q_u8(dst + i, veorq_u8(s0, d0));
+    vst1q_u8(dst + i + 16, veorq_u8(s1, d1));
+  }
+  XorWords(src + i, length - i, dst + i);
+}
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+void XorBytesSse2(const uint8_t* src, size_t length, uint8_t* dst) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m128i s0 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i s1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    const __m128i d0 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i d1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i + 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_xor_si128(s0, d0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16),
+                     _mm_xor_si128(s1, d1));
+  }
+  XorWords(src + i, length - i, dst + i);
+}
+
+using XorBytesFunction = void (*)(const uint8_t*, size_t, uint8_t*);
+
+XorBytesFunction SelectXorBytes() {
+  if (GetCPUInfo(kAVX2)) {
+    return &XorBytesAvx2;
+  }
+  if (GetCPUInfo(kSSE2)) {
+    return &XorBytesSse2;
+  }
+  return &XorWords;
+}
+#endif
+
+}  // namespace
+
+void XorBytes(const uint8_t* src, size_t length, uint8_t* dst) {
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(WEBRTC_HAS_NEON)
+  XorBytesNeon(src, length, dst);
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  static const XorBytesFunction xor_bytes = SelectXorBytes();
+  xor_bytes(src, length, dst);
+#else
+  XorWords(src, length, dst);
+#endif
+}
+
+}  // namespace webrtc
@@ -0,0 +1,25 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+#define MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace webrtc {
+
+// XORs `length` bytes at `src` into `dst`, using the widest vector
+// instructions supported by the CPU. The ranges must not overlap.
+void XorBytes(const uint8_t* src, size_t length, uint8_t* dst);
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(FecXorTest, XorsAllLengthsAndAlignments) {
+  Random random(4711);
+  constexpr size_t kMaxLength = 200;
+  constexpr size_t kMaxOffset = 33;
+  std::vector<uint8_t> src(kMaxLength + kMaxOffset);
+  std::vector<uint8_t> dst(kMaxLength + kMaxOffset);
+  for (size_t length = 0; length <= kMaxLength; ++length) {
+    for (size_t offset = 0; offset < kMaxOffset; offset += 3) {
+      for (uint8_t& byte : src) {
+        byte = random.Rand<uint8_t>();
+      }
+      for (uint8_t& byte : dst) {
+        byte = random.Rand<uint8_t>();
+      }
+      std::vector<uint8_t> expected = dst;
+      for (size_t i = 0; i < length; ++i) {
+        expected[i] ^= src[offset + i];
+      }
+      XorBytes(src.data() + offset, length, dst.data());
+      ASSERT_EQ(expected, dst) << "length " << length << " offset " << offset;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
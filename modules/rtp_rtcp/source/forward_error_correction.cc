@@ -19,6 +19,7 @@
 #include "modules/include/module_common_types_public.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/fec_xor.h"
 #include "modules/rtp_rtcp/source/flexfec_header_reader_writer.h"
 #include "modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "modules/rtp_rtcp/source/ulpfec_header_reader_writer.h"
@@ -204,66 +205,69 @@ void ForwardErrorCorrection::GenerateFecPayloads(
     const PacketList& media_packets,
     size_t num_fec_packets) {
   RTC_DCHECK(!media_packets.empty());
+  RTC_DCHECK_LE(num_fec_packets, kUlpfecMaxMediaPackets);
+  size_t fec_header_sizes[kUlpfecMaxMediaPackets];
   for (size_t i = 0; i < num_fec_packets; ++i) {
-    Packet* const fec_packet = &generated_fec_packets_[i];
-    size_t pkt_mask_idx = i * packet_mask_size_;
     const size_t min_packet_mask_size = fec_header_writer_->MinPacketMaskSize(
-        &packet_masks_[pkt_mask_idx], packet_mask_size_);
-    const size_t fec_header_size =
+        &packet_masks_[i * packet_mask_size_], packet_mask_size_);
+    fec_header_sizes[i] =
         fec_header_writer_->FecHeaderSize(min_packet_mask_size);
+  }
+
+  // Each media packet is XORed into all FEC packets protecting it before
+  // moving on to the next, so that it is only read from memory once.
+  size_t media_pkt_idx = 0;
+  uint16_t prev_seq_num =
+      ParseSequenceNumber(media_packets.front()->data.data());
+  for (const auto& media_packet : media_packets) {
+    const uint8_t* media_packet_data = media_packet->data.cdata();
+    const uint16_t seq_num = ParseSequenceNumber(media_packet_data);
+    media_pkt_idx += static_cast<uint16_t>(seq_num - prev_seq_num);
+    prev_seq_num = seq_num;
+    const size_t mask_byte = media_pkt_idx / 8;
+    const uint8_t mask_bit = 1 << (7 - media_pkt_idx % 8);
+    const size_t media_payload_length =
+        media_packet->data.size() - kRtpHeaderSize;
 
-    size_t media_pkt_idx = 0;
-    auto media_packets_it = media_packets.cbegin();
-    uint16_t prev_seq_num =
-        ParseSequenceNumber((*media_packets_it)->data.data());
-    while (media_packets_it != media_packets.end()) {
-      Packet* const media_packet = media_packets_it->get();
-      const uint8_t* media_packet_data = media_packet->data.cdata();
+    for (size_t i = 0; i < num_fec_packets; ++i) {
       // Should `media_packet` be protected by `fec_packet`?
-      if (packet_masks_[pkt_mask_idx] & (1 << (7 - media_pkt_idx))) {
-        size_t media_payload_length =
-            media_packet->data.size() - kRtpHeaderSize;
-
-        bool first_protected_packet = (fec_packet->data.size() == 0);
-        size_t fec_packet_length = fec_header_size + media_payload_length;
-        if (fec_packet_length > fec_packet->data.size()) {
-          // Recall that XORing with zero (which the FEC packets are prefilled
-          // with) is the identity operator, thus all prior XORs are
-          // still correct even though we expand the packet length here.
-          fec_packet->data.SetSize(fec_packet_length);
-        }
-        if (first_protected_packet) {
-          uint8_t* data = fec_packet->data.MutableData();
-          // Write P, X, CC, M, and PT recovery fields.
-          // Note that bits 0, 1, and 16 are overwritten in FinalizeFecHeaders.
-          memcpy(&data[0], &media_packet_data[0], 2);
-          // Write length recovery field. (This is a temporary location for
-          // ULPFEC.)
-          ByteWriter<uint16_t>::WriteBigEndian(&data[2], media_payload_length);
-          // Write timestamp recovery field.
-          memcpy(&data[4], &media_packet_data[4], 4);
-          // Write payload.
-          if (media_payload_length > 0) {
-            memcpy(&data[fec_header_size], &media_packet_data[kRtpHeaderSize],
-                   media_payload_length);
-          }
-        } else {
-          XorHeaders(*media_packet, fec_packet);
-          XorPayloads(*media_packet, media_payload_length, fec_header_size,
-                      fec_packet);
-        }
+      if (!(packet_masks_[i * packet_mask_size_ + mask_byte] & mask_bit)) {
+        continue;
       }
-      media_packets_it++;
-      if (media_packets_it != media_packets.end()) {
-        uint16_t seq_num =
-            ParseSequenceNumber((*media_packets_it)->data.data());
-        media_pkt_idx += static_cast<uint16_t>(seq_num - prev_seq_num);
-        prev_seq_num = seq_num;
+      Packet* const fec_packet = &generated_fec_packets_[i];
+      const size_t fec_header_size = fec_header_sizes[i];
+      bool first_protected_packet = (fec_packet->data.size() == 0);
+      size_t fec_packet_length = fec_header_size + media_payload_length;
+      if (fec_packet_length > fec_packet->data.size()) {
+        // Recall that XORing with zero (which the FEC packets are prefilled
+        // with) is the identity operator, thus all prior XORs are
+        // still correct even though we expand the packet length here.
+        fec_packet->data.SetSize(fec_packet_length);
+      }
+      if (first_protected_packet) {
+        uint8_t* data = fec_packet->data.MutableData();
+        // Write P, X, CC, M, and PT recovery fields.
+        // Note that bits 0, 1, and 16 are overwritten in FinalizeFecHeaders.
+        memcpy(&data[0], &media_packet_data[0], 2);
+        // Write length recovery field. (This is a temporary location for
+        // ULPFEC.)
+        ByteWriter<uint16_t>::WriteBigEndian(&data[2], media_payload_length);
+        // Write timestamp recovery field.
+        memcpy(&data[4], &media_packet_data[4], 4);
+        // Write payload.
+        if (media_payload_length > 0) {
+          memcpy(&data[fec_header_size], &media_packet_data[kRtpHeaderSize],
+                 media_payload_length);
+        }
+      } else {
+        XorHeaders(*media_packet, fec_packet);
+        XorPayloads(*media_packet, media_payload_length, fec_header_size,
+                    fec_packet);
       }
-      pkt_mask_idx += media_pkt_idx / 8;
-      media_pkt_idx %= 8;
     }
-    RTC_DCHECK_GT(fec_packet->data.size(), 0)
+  }
+  for (size_t i = 0; i < num_fec_packets; ++i) {
+    RTC_DCHECK_GT(generated_fec_packets_[i].data.size(), 0)
         << "Packet mask is wrong or poorly designed.";
   }
 }
@@ -634,11 +638,8 @@ void ForwardErrorCorrection::XorPayloads(const Packet& src,
   if (dst_offset + payload_length > dst->data.size()) {
     dst->data.SetSize(dst_offset + payload_length);
   }
-  uint8_t* dst_data = dst->data.MutableData();
-  const uint8_t* src_data = src.data.cdata();
-  for (size_t i = 0; i < payload_length; ++i) {
-    dst_data[dst_offset + i] ^= src_data[kRtpHeaderSize + i];
-  }
+  XorBytes(src.data.cdata() + kRtpHeaderSize, payload_length,
+           dst->data.MutableData() + dst_offset);
 }
 
 bool ForwardErrorCorrection::RecoverPacket(const ReceivedFecPacket& fec_packet,
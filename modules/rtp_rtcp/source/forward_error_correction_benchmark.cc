@@ -0,0 +1,176 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "modules/include/module_fec_types.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/fec_test_helper.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/random.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kMediaSsrc = 0x12345678;
+constexpr uint32_t kFlexfecSsrc = 0x87654321;
+constexpr uint16_t kFirstFecSeqNum = 30000;
+// Half as many FEC packets as media packets.
+constexpr uint8_t kProtectionFactor = 128;
+// One in `kLossInterval` media packets is lost.
+constexpr int kLossInterval = 16;
+
+std::unique_ptr<ForwardErrorCorrection> CreateFec(bool flexfec) {
+  return flexfec
+             ? ForwardErrorCorrection::CreateFlexfec(kFlexfecSsrc, kMediaSsrc)
+             : ForwardErrorCorrection::CreateUlpfec(kMediaSsrc);
+}
+
+// Returns the media packets of a frame, of 1000 to 1200 bytes.
+ForwardErrorCorrection::PacketList CreateMediaPackets(int num_media_packets) {
+  Random random(4711);
+  test::fec::MediaPacketGenerator generator(1000, 1200, kMediaSsrc, &random);
+  return generator.ConstructMediaPackets(num_media_packets);
+}
+
+// Protects the packets of a frame. The arguments are whether FlexFEC rather
+// than ULPFEC is used, and the number of media packets in the frame.
+void BM_EncodeFec(benchmark::State& state) {
+  const bool flexfec = state.range(0) != 0;
+  const int num_media_packets = state.range(1);
+  std::unique_ptr<ForwardErrorCorrection> fec = CreateFec(flexfec);
+  const ForwardErrorCorrection::PacketList media_packets =
+      CreateMediaPackets(num_media_packets);
+  std::list<ForwardErrorCorrection::Packet*> fec_packets;
+  for (auto _ : state) {
+    fec_packets.clear();
+    RTC_CHECK_EQ(fec->EncodeFec(media_packets, kProtectionFactor,
+                                /*num_important_packets=*/0,
+                                /*use_unequal_protection=*/false,
+                                kFecMaskRandom, &fec_packets),
+                 0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_media_packets);
+}
+
+// Recovers the media packets of a frame lost on the network, with the same
+// arguments as BM_EncodeFec.
+void BM_DecodeFec(benchmark::State& state) {
+  const bool flexfec = state.range(0) != 0;
+  const int num_media_packets = state.range(1);
+  std::unique_ptr<ForwardErrorCorrection> fec = CreateFec(flexfec);
+  const ForwardErrorCorrection::PacketList media_packets =
+      CreateMediaPackets(num_media_packets);
+  std::list<ForwardErrorCorrection::Packet*> fec_packets;
+  RTC_CHECK_EQ(fec->EncodeFec(media_packets, kProtectionFactor,
+                              /*num_important_packets=*/0,
+                              /*use_unequal_protection=*/false,
+                              kFecMaskRandom, &fec_packets),
+               0);
+
+  std::vector<std::unique_ptr<ForwardErrorCorrection::ReceivedPacket>>
+      received_packets;
+  std::vector<rtc::CopyOnWriteBuffer> received_data;
+  int media_index = 0;
+  for (const auto& media_packet : media_packets) {
+    if (media_index++ % kLossInterval == 0) {
+      continue;
+    }
+    auto received_packet =
+        std::make_unique<ForwardErrorCorrection::ReceivedPacket>();
+    received_packet->ssrc = kMediaSsrc;
+    received_packet->seq_num =
+        ByteReader<uint16_t>::ReadBigEndian(media_packet->data.data() + 2);
+    received_packet->is_fec = false;
+    received_packets.push_back(std::move(received_packet));
+    received_data.push_back(media_packet->data);
+  }
+  const size_t num_received_media_packets = received_packets.size();
+  uint16_t fec_seq_num = kFirstFecSeqNum;
+  for (const ForwardErrorCorrection::Packet* fec_packet : fec_packets) {
+    auto received_packet =
+        std::make_unique<ForwardErrorCorrection::ReceivedPacket>();
+    received_packet->ssrc = flexfec ? kFlexfecSsrc : kMediaSsrc;
+    received_packet->seq_num = fec_seq_num++;
+    received_packet->is_fec = true;
+    received_packets.push_back(std::move(received_packet));
+    received_data.push_back(fec_packet->data);
+  }
+
+  ForwardErrorCorrection::RecoveredPacketList recovered_packets;
+  int64_t recovered = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < received_packets.size(); ++i) {
+      // Decoding modifies the headers of received FEC packets in place.
+      received_packets[i]->pkt = new ForwardErrorCorrection::Packet();
+      received_packets[i]->pkt->data = received_data[i];
+      fec->DecodeFec(*received_packets[i], &recovered_packets);
+    }
+    recovered += recovered_packets.size() - num_received_media_packets;
+    fec->ResetState(&recovered_packets);
+  }
+  state.SetItemsProcessed(state.iterations() * num_media_packets);
+  state.counters["recovered_packets"] =
+      benchmark::Counter(recovered, benchmark::Counter::kAvgIterations);
+}
+
+void FecArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"flexfec", "media_packets"});
+  for (int flexfec : {0, 1}) {
+    for (int num_media_packets : {12, 24, 48}) {
+      benchmark->Args({flexfec, num_media_packets});
+    }
+  }
+}
+
+BENCHMARK(BM_EncodeFec)->Apply(FecArguments);
+BENCHMARK(BM_DecodeFec)->Apply(FecArguments);
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core, AVX2, median of 7), per frame of 1000 to 1200
+byte packets:
+Byte-wise XOR, FEC packets generated one at a time over all media packets:
+BM_EncodeFec/flexfec:0/media_packets:12    24.4 us
+BM_EncodeFec/flexfec:0/media_packets:24    20.8 us
+BM_EncodeFec/flexfec:0/media_packets:48    52.2 us
+BM_EncodeFec/flexfec:1/media_packets:12    22.6 us
+BM_EncodeFec/flexfec:1/media_packets:24    22.3 us
+BM_EncodeFec/flexfec:1/media_packets:48    51.6 us
+BM_DecodeFec/flexfec:0/media_packets:12    16.4 us
+BM_DecodeFec/flexfec:0/media_packets:24    28.7 us
+BM_DecodeFec/flexfec:0/media_packets:48    80.2 us
+BM_DecodeFec/flexfec:1/media_packets:12    15.9 us
+BM_DecodeFec/flexfec:1/media_packets:24    28.9 us
+BM_DecodeFec/flexfec:1/media_packets:48    62.9 us
+Vectorized XOR, media packets streamed once into the FEC packets protecting
+them:
+BM_EncodeFec/flexfec:0/media_packets:12     2.4 us
+BM_EncodeFec/flexfec:0/media_packets:24     3.8 us
+BM_EncodeFec/flexfec:0/media_packets:48     8.6 us
+BM_EncodeFec/flexfec:1/media_packets:12     2.7 us
+BM_EncodeFec/flexfec:1/media_packets:24     5.5 us
+BM_EncodeFec/flexfec:1/media_packets:48    11.0 us
+BM_DecodeFec/flexfec:0/media_packets:12     9.7 us
+BM_DecodeFec/flexfec:0/media_packets:24    23.7 us
+BM_DecodeFec/flexfec:0/media_packets:48    74.7 us
+BM_DecodeFec/flexfec:1/media_packets:12    10.0 us
+BM_DecodeFec/flexfec:1/media_packets:24    23.9 us
+BM_DecodeFec/flexfec:1/media_packets:48    70.1 us
+Decoding is dominated by packet list bookkeeping rather than XOR.
+*/
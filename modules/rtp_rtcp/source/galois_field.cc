@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/galois_field.h"
+
+#include "modules/rtp_rtcp/source/fec_xor.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+#include "modules/rtp_rtcp/source/galois_field_avx2.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+// Reducing polynomial, x^8 + x^4 + x^3 + x^2 + 1.
+constexpr int kPolynomial = 0x11d;
+
+struct GfTables {
+  // exp[i] = 2^i. Holds two periods, so that exp[log[a] + log[b]] needs no
+  // reduction modulo 255.
+  uint8_t exp[512];
+  // log[2^i] = i. log[0] is undefined.
+  uint8_t log[256];
+};
+
+constexpr GfTables CreateGfTables() {
+  GfTables tables = {};
+  int x = 1;
+  for (int i = 0; i < 255; ++i) {
+    tables.exp[i] = static_cast<uint8_t>(x);
+    tables.exp[i + 255] = static_cast<uint8_t>(x);
+    tables.log[x] = static_cast<uint8_t>(i);
+    x <<= 1;
+    if (x & 0x100) {
+      x ^= kPolynomial;
+    }
+  }
+  return tables;
+}
+
+constexpr GfTables kGfTables = CreateGfTables();
+
+// Products of `factor` with all values of the low and the high nibble of a
+// byte. Since multiplication distributes over XOR,
+// factor * b = low[b & 0x0f] ^ high[b >> 4].
+struct NibbleTables {
+  uint8_t low[16];
+  uint8_t high[16];
+};
+
+NibbleTables CreateNibbleTables(uint8_t factor) {
+  NibbleTables tables;
+  for (int i = 0; i < 16; ++i) {
+    tables.low[i] = GfMultiply(factor, i);
+    tables.high[i] = GfMultiply(factor, i << 4);
+  }
+  return tables;
+}
+
+void GfMultiplyAndAddGeneric(const uint8_t low[16],
+                             const uint8_t high[16],
+                             const uint8_t* src,
+                             size_t length,
+                             uint8_t* dst) {
+  for (size_t i = 0; i < length; ++i) {
+    dst[i] ^= low[src[i] & 0x0f] ^ high[src[i] >> 4];
+  }
+}
+
+#if defined(WEBRTC_HAS_NEON)
+void GfMultiplyAndAddNeon(const uint8_t low[16],
+                          const uint8_t high[16],
+                          const uint8_t* src,
+                          size_t length,
+                          uint8_t* dst) {
+  const uint8x8x2_t low_table = {{vld1_u8(low), vld1_u8(low + 8)}};
+  const uint8x8x2_t high_table = {{vld1_u8(high), vld1_u8(high + 8)}};
+  const uint8x16_t nibble_mask = vdupq_n_u8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const uint8x16_t s = vld1q_u8(src + i);
+    const uint8x16_t low_nibbles = vandq_u8(s, nibble_mask);
+    const uint8x16_t high_nibbles = vshrq_n_u8(s, 4);
+    const uint8x16_t low_product =
+        vcombine_u8(vtbl2_u8(low_table, vget_low_u8(low_nibbles)),
+                    vtbl2_u8(low_table, vget_high_u8(low_nibbles)));
+    const uint8x16_t high_product =
+        vcombine_u8(vtbl2_u8(high_table, vget_low_u8(high_nibbles)),
+                    vtbl2_u8(high_table, vget_high_u8(high_nibbles)));
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i),
+                               veorq_u8(low_product, high_product)));
+  }
+  GfMultiplyAndAddGeneric(low, high, src + i, length - i, dst + i);
+}
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+using GfMultiplyAndAddFunction = void (*)(const uint8_t*,
+                                          const uint8_t*,
+                                          const uint8_t*,
+                                          size_t,
+                                          uint8_t*);
+
+// SSE2 lacks byte shuffles, so x86 CPUs without AVX2 use the generic
+// version.
+GfMultiplyAndAddFunction SelectGfMultiplyAndAdd() {
+  if (GetCPUInfo(kAVX2)) {
+    return &GfMultiplyAndAddAvx2;
+  }
+  return &GfMultiplyAndAddGeneric;
+}
+#endif
+
+}  // namespace
+
+uint8_t GfMultiply(uint8_t a, uint8_t b) {
+  if (a == 0 || b == 0) {
+    return 0;
+  }
+  return kGfTables.exp[kGfTables.log[a] + kGfTables.log[b]];
+}
+
+uint8_t GfInverse(uint8_t a) {
+  RTC_DCHECK_NE(a, 0);
+  return kGfTables.exp[255 - kGfTables.log[a]];
+}
+
+void GfMultiplyAndAdd(uint8_t factor,
+                      const uint8_t* src,
+                      size_t length,
+                      uint8_t* dst) {
+  if (factor == 0) {
+    return;
+  }
+  if (factor == 1) {
+    XorBytes(src, length, dst);
+    return;
+  }
+  const NibbleTables tables = CreateNibbleTables(factor);
+#if defined(WEBRTC_HAS_NEON)
+  GfMultiplyAndAddNeon(tables.low, tables.high, src, length, dst);
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  static const GfMultiplyAndAddFunction multiply_and_add =
+      SelectGfMultiplyAndAdd();
+  multiply_and_add(tables.low, tables.high, src, length, dst);
+#else
+  GfMultiplyAndAddGeneric(tables.low, tables.high, src, length, dst);
+#endif
+}
+
+}  // namespace webrtc
@@ -0,0 +1,36 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_H_
+#define MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace webrtc {
+
+// Arithmetic in GF(2^8) with the reducing polynomial x^8 + x^4 + x^3 + x^2 + 1,
+// as used by Reed-Solomon erasure codes. Addition and subtraction are XOR.
+
+uint8_t GfMultiply(uint8_t a, uint8_t b);
+
+// Returns the multiplicative inverse of `a`, which must be non-zero.
+uint8_t GfInverse(uint8_t a);
+
+// Computes dst[i] ^= factor * src[i] for `length` bytes, using vector table
+// lookups where the CPU supports them. The ranges must not overlap.
+void GfMultiplyAndAdd(uint8_t factor,
+                      const uint8_t* src,
+                      size_t length,
+                      uint8_t* dst);
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_H_
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/galois_field_avx2.h"
+
+#include <immintrin.h>
+
+namespace webrtc {
+
+void GfMultiplyAndAddAvx2(const uint8_t low[16],
+                          const uint8_t high[16],
+                          const uint8_t* src,
+                          size_t length,
+                          uint8_t* dst) {
+  // Multiplication distributes over the XOR of the two nibbles, so each byte
+  // is multiplied with two 16 entry table lookups.
+  const __m256i low_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(low)));
+  const __m256i high_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(high)));
+  const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    const __m256i low_product =
+        _mm256_shuffle_epi8(low_table, _mm256_and_si256(s, nibble_mask));
+    const __m256i high_product = _mm256_shuffle_epi8(
+        high_table, _mm256_and_si256(_mm256_srli_epi64(s, 4), nibble_mask));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dst + i),
+        _mm256_xor_si256(d, _mm256_xor_si256(low_product, high_product)));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= low[src[i] & 0x0f] ^ high[src[i] >> 4];
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,30 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_AVX2_H_
+#define MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_AVX2_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace webrtc {
+
+// AVX2 version of GfMultiplyAndAdd(), only to be called if GetCPUInfo(kAVX2).
+// `low` and `high` hold the products of the factor with all values of the low
+// and the high nibble of a byte, respectively.
+void GfMultiplyAndAddAvx2(const uint8_t low[16],
+                          const uint8_t high[16],
+                          const uint8_t* src,
+                          size_t length,
+                          uint8_t* dst);
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_GALOIS_FIELD_AVX2_H_
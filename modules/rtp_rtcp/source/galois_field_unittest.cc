@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/galois_field.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// Carry-less multiplication reduced by x^8 + x^4 + x^3 + x^2 + 1.
+uint8_t ReferenceMultiply(uint8_t a, uint8_t b) {
+  int product = 0;
+  for (int i = 0; i < 8; ++i) {
+    if (b & (1 << i)) {
+      product ^= a << i;
+    }
+  }
+  for (int i = 14; i >= 8; --i) {
+    if (product & (1 << i)) {
+      product ^= 0x11d << (i - 8);
+    }
+  }
+  return static_cast<uint8_t>(product);
+}
+
+TEST(GaloisFieldTest, MultiplyMatchesPolynomialArithmetic) {
+  for (int a = 0; a < 256; ++a) {
+    for (int b = 0; b < 256; ++b) {
+      ASSERT_EQ(ReferenceMultiply(a, b), GfMultiply(a, b))
+          << "a " << a << " b " << b;
+    }
+  }
+}
+
+TEST(GaloisFieldTest, ProductWithInverseIsOne) {
+  for (int a = 1; a < 256; ++a) {
+    EXPECT_EQ(1, GfMultiply(a, GfInverse(a))) << "a " << a;
+  }
+}
+
+TEST(GaloisFieldTest, MultiplyAndAddAllLengthsAndAlignments) {
+  Random random(4711);
+  constexpr size_t kMaxLength = 100;
+  constexpr size_t kMaxOffset = 33;
+  std::vector<uint8_t> src(kMaxLength + kMaxOffset);
+  std::vector<uint8_t> dst(kMaxLength);
+  for (int factor : {0, 1, 2, 0x53, 0xff}) {
+    for (size_t length = 0; length <= kMaxLength; ++length) {
+      for (size_t offset = 0; offset < kMaxOffset; offset += 5) {
+        for (uint8_t& byte : src) {
+          byte = random.Rand<uint8_t>();
+        }
+        for (uint8_t& byte : dst) {
+          byte = random.Rand<uint8_t>();
+        }
+        std::vector<uint8_t> expected = dst;
+        for (size_t i = 0; i < length; ++i) {
+          expected[i] ^= ReferenceMultiply(factor, src[offset + i]);
+        }
+        GfMultiplyAndAdd(factor, src.data() + offset, length, dst.data());
+        ASSERT_EQ(expected, dst) << "factor " << factor << " length "
+                                 << length << " offset " << offset;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
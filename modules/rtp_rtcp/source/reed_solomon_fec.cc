@@ -0,0 +1,265 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/galois_field.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kRecoveryHeaderSize = ReedSolomonFec::kRecoveryHeaderSize;
+
+// Coefficient of media packet `media_index` in repair packet `repair_index`.
+// The Cauchy matrix 1 / (x_j - y_i), with x_j = j and y_i = 128 + i, has only
+// non-singular square submatrices, which makes the code maximum distance
+// separable.
+uint8_t Coefficient(size_t repair_index, size_t media_index) {
+  static_assert(ReedSolomonFec::kMaxRepairPackets <= 128 &&
+                    ReedSolomonFec::kMaxMediaPackets <= 128,
+                "Rows and columns of the Cauchy matrix must not overlap.");
+  return GfInverse(static_cast<uint8_t>(repair_index ^ (0x80 | media_index)));
+}
+
+size_t RecoveryDataSize(const rtc::CopyOnWriteBuffer& packet) {
+  return kRecoveryHeaderSize + packet.size() - kRtpHeaderSize;
+}
+
+// Adds `factor` times the recovery data of `packet` to `recovery_data`.
+void MultiplyAndAddPacket(uint8_t factor,
+                          const rtc::CopyOnWriteBuffer& packet,
+                          uint8_t* recovery_data) {
+  const uint8_t* data = packet.cdata();
+  uint8_t header[kRecoveryHeaderSize];
+  memcpy(&header[0], &data[0], 2);
+  ByteWriter<uint16_t>::WriteBigEndian(&header[2],
+                                       packet.size() - kRtpHeaderSize);
+  memcpy(&header[4], &data[4], 4);
+  GfMultiplyAndAdd(factor, header, kRecoveryHeaderSize, recovery_data);
+  GfMultiplyAndAdd(factor, data + kRtpHeaderSize,
+                   packet.size() - kRtpHeaderSize,
+                   recovery_data + kRecoveryHeaderSize);
+}
+
+// Inverts the n x n row-major `matrix` in place, by Gauss-Jordan elimination.
+bool InvertMatrix(size_t n, std::vector<uint8_t>* matrix) {
+  std::vector<uint8_t>& m = *matrix;
+  std::vector<uint8_t> inverse(n * n, 0);
+  for (size_t i = 0; i < n; ++i) {
+    inverse[i * n + i] = 1;
+  }
+  for (size_t col = 0; col < n; ++col) {
+    size_t pivot = col;
+    while (pivot < n && m[pivot * n + col] == 0) {
+      ++pivot;
+    }
+    if (pivot == n) {
+      return false;
+    }
+    if (pivot != col) {
+      std::swap_ranges(&m[pivot * n], &m[pivot * n] + n, &m[col * n]);
+      std::swap_ranges(&inverse[pivot * n], &inverse[pivot * n] + n,
+                       &inverse[col * n]);
+    }
+    const uint8_t scale = GfInverse(m[col * n + col]);
+    for (size_t i = 0; i < n; ++i) {
+      m[col * n + i] = GfMultiply(m[col * n + i], scale);
+      inverse[col * n + i] = GfMultiply(inverse[col * n + i], scale);
+    }
+    for (size_t row = 0; row < n; ++row) {
+      const uint8_t factor = m[row * n + col];
+      if (row == col || factor == 0) {
+        continue;
+      }
+      GfMultiplyAndAdd(factor, &m[col * n], n, &m[row * n]);
+      GfMultiplyAndAdd(factor, &inverse[col * n], n, &inverse[row * n]);
+    }
+  }
+  m = std::move(inverse);
+  return true;
+}
+
+}  // namespace
+
+std::vector<rtc::CopyOnWriteBuffer> ReedSolomonFec::Encode(
+    rtc::ArrayView<const rtc::CopyOnWriteBuffer> media_packets,
+    size_t num_repair_packets) {
+  RTC_DCHECK(!media_packets.empty());
+  RTC_DCHECK_LE(media_packets.size(), kMaxMediaPackets);
+  RTC_DCHECK_LE(num_repair_packets, kMaxRepairPackets);
+  size_t recovery_data_size = 0;
+  for (const rtc::CopyOnWriteBuffer& packet : media_packets) {
+    RTC_DCHECK_GE(packet.size(), kRtpHeaderSize);
+    recovery_data_size =
+        std::max(recovery_data_size, RecoveryDataSize(packet));
+  }
+
+  const uint8_t* first_packet = media_packets[0].cdata();
+  std::vector<rtc::CopyOnWriteBuffer> repair_payloads(num_repair_packets);
+  for (size_t j = 0; j < num_repair_packets; ++j) {
+    rtc::CopyOnWriteBuffer& payload = repair_payloads[j];
+    payload.SetSize(kHeaderSize + recovery_data_size);
+    uint8_t* data = payload.MutableData();
+    memset(data, 0, payload.size());
+    memcpy(&data[0], &first_packet[8], 4);
+    memcpy(&data[4], &first_packet[2], 2);
+    data[6] = static_cast<uint8_t>(media_packets.size());
+    data[7] = static_cast<uint8_t>(j);
+  }
+  // Each media packet is added to all repair packets before moving on to the
+  // next, so that it is only read from memory once.
+  for (size_t i = 0; i < media_packets.size(); ++i) {
+    for (size_t j = 0; j < num_repair_packets; ++j) {
+      MultiplyAndAddPacket(Coefficient(j, i), media_packets[i],
+                           repair_payloads[j].MutableData() + kHeaderSize);
+    }
+  }
+  return repair_payloads;
+}
+
+absl::optional<ReedSolomonFec::Header> ReedSolomonFec::ParseHeader(
+    rtc::ArrayView<const uint8_t> repair_payload) {
+  if (repair_payload.size() < kHeaderSize + kRecoveryHeaderSize) {
+    return absl::nullopt;
+  }
+  Header header;
+  header.protected_ssrc =
+      ByteReader<uint32_t>::ReadBigEndian(&repair_payload[0]);
+  header.base_seq_num = ByteReader<uint16_t>::ReadBigEndian(&repair_payload[4]);
+  header.num_media_packets = repair_payload[6];
+  header.repair_index = repair_payload[7];
+  if (header.num_media_packets == 0 ||
+      header.num_media_packets > kMaxMediaPackets ||
+      header.repair_index >= kMaxRepairPackets) {
+    return absl::nullopt;
+  }
+  return header;
+}
+
+bool ReedSolomonFec::Decode(
+    rtc::ArrayView<rtc::CopyOnWriteBuffer> media_packets,
+    rtc::ArrayView<const rtc::CopyOnWriteBuffer> repair_payloads) {
+  std::vector<size_t> missing;
+  for (size_t i = 0; i < media_packets.size(); ++i) {
+    if (media_packets[i].size() == 0) {
+      missing.push_back(i);
+    }
+  }
+  if (missing.empty()) {
+    return true;
+  }
+  if (repair_payloads.size() < missing.size()) {
+    return false;
+  }
+  const absl::optional<Header> header = ParseHeader(repair_payloads[0]);
+  if (!header || header->num_media_packets != media_packets.size()) {
+    return false;
+  }
+  const size_t recovery_data_size = repair_payloads[0].size() - kHeaderSize;
+
+  // Use the first `missing.size()` distinct repair packets.
+  const size_t n = missing.size();
+  std::vector<const rtc::CopyOnWriteBuffer*> repairs;
+  std::vector<uint8_t> repair_indices;
+  for (const rtc::CopyOnWriteBuffer& payload : repair_payloads) {
+    const absl::optional<Header> repair_header = ParseHeader(payload);
+    if (!repair_header ||
+        repair_header->protected_ssrc != header->protected_ssrc ||
+        repair_header->base_seq_num != header->base_seq_num ||
+        repair_header->num_media_packets != header->num_media_packets ||
+        payload.size() != kHeaderSize + recovery_data_size) {
+      return false;
+    }
+    if (std::find(repair_indices.begin(), repair_indices.end(),
+                  repair_header->repair_index) != repair_indices.end()) {
+      continue;
+    }
+    repairs.push_back(&payload);
+    repair_indices.push_back(repair_header->repair_index);
+    if (repairs.size() == n) {
+      break;
+    }
+  }
+  if (repairs.size() < n) {
+    return false;
+  }
+
+  // Subtract the received media packets from the repair packets, leaving
+  // combinations of the missing ones only.
+  std::vector<std::vector<uint8_t>> remainders(n);
+  for (size_t a = 0; a < n; ++a) {
+    remainders[a].assign(repairs[a]->cdata() + kHeaderSize,
+                         repairs[a]->cdata() + repairs[a]->size());
+  }
+  for (size_t i = 0; i < media_packets.size(); ++i) {
+    const rtc::CopyOnWriteBuffer& packet = media_packets[i];
+    if (packet.size() == 0) {
+      continue;
+    }
+    if (packet.size() < kRtpHeaderSize ||
+        RecoveryDataSize(packet) > recovery_data_size) {
+      return false;
+    }
+    for (size_t a = 0; a < n; ++a) {
+      MultiplyAndAddPacket(Coefficient(repair_indices[a], i), packet,
+                           remainders[a].data());
+    }
+  }
+
+  // Solve for the missing packets' recovery data.
+  std::vector<uint8_t> matrix(n * n);
+  for (size_t a = 0; a < n; ++a) {
+    for (size_t b = 0; b < n; ++b) {
+      matrix[a * n + b] = Coefficient(repair_indices[a], missing[b]);
+    }
+  }
+  if (!InvertMatrix(n, &matrix)) {
+    return false;
+  }
+  std::vector<rtc::CopyOnWriteBuffer> recovered(n);
+  std::vector<uint8_t> recovery_data(recovery_data_size);
+  for (size_t b = 0; b < n; ++b) {
+    std::fill(recovery_data.begin(), recovery_data.end(), 0);
+    for (size_t a = 0; a < n; ++a) {
+      GfMultiplyAndAdd(matrix[b * n + a], remainders[a].data(),
+                       recovery_data_size, recovery_data.data());
+    }
+    const size_t length =
+        ByteReader<uint16_t>::ReadBigEndian(&recovery_data[2]);
+    if (kRecoveryHeaderSize + length > recovery_data_size) {
+      return false;
+    }
+    rtc::CopyOnWriteBuffer& packet = recovered[b];
+    packet.SetSize(kRtpHeaderSize + length);
+    uint8_t* data = packet.MutableData();
+    // Set the version to 2.
+    data[0] = 0x80 | (recovery_data[0] & 0x3f);
+    data[1] = recovery_data[1];
+    ByteWriter<uint16_t>::WriteBigEndian(
+        &data[2], static_cast<uint16_t>(header->base_seq_num + missing[b]));
+    memcpy(&data[4], &recovery_data[4], 4);
+    ByteWriter<uint32_t>::WriteBigEndian(&data[8], header->protected_ssrc);
+    memcpy(&data[kRtpHeaderSize], &recovery_data[kRecoveryHeaderSize], length);
+  }
+  for (size_t b = 0; b < n; ++b) {
+    media_packets[missing[b]] = std::move(recovered[b]);
+  }
+  return true;
+}
+
+}  // namespace webrtc
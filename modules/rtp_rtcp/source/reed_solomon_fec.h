@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_REED_SOLOMON_FEC_H_
+#define MODULES_RTP_RTCP_SOURCE_REED_SOLOMON_FEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/array_view.h"
+#include "rtc_base/copy_on_write_buffer.h"
+
+namespace webrtc {
+
+// Systematic Reed-Solomon erasure code over GF(2^8), protecting a block of RTP
+// packets of one SSRC with consecutive sequence numbers. Each repair packet
+// carries a linear combination of the recovery data of the media packets: the
+// first two bytes of the RTP header, the length and the timestamp, followed by
+// everything after the fixed RTP header. The coefficients are taken from a
+// Cauchy matrix, so unlike the XOR parity codes of ForwardErrorCorrection, any
+// k of the k + m packets of a block recover all k media packets, regardless of
+// how the losses are distributed.
+//
+// Repair packet payload:
+//
+//    0                   1                   2                   3
+//    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                     Protected media SSRC                      |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |      Base sequence number     |  Media count  | Repair index  |
+//   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//   |                   Combined recovery data...                   |
+//
+// The payload format is not standardized, so both ends must agree to use it.
+class ReedSolomonFec {
+ public:
+  struct Header {
+    uint32_t protected_ssrc;
+    // Sequence number of the first media packet of the block.
+    uint16_t base_seq_num;
+    uint8_t num_media_packets;
+    // Row of the coding matrix used for this repair packet.
+    uint8_t repair_index;
+  };
+
+  static constexpr size_t kHeaderSize = 8;
+  // Size of the part of the recovery data taken from the fixed RTP header: the
+  // first two bytes, the length of the rest of the packet and the timestamp.
+  // A repair packet payload is `kHeaderSize + kRecoveryHeaderSize` bytes
+  // larger than the largest protected packet without its fixed RTP header.
+  static constexpr size_t kRecoveryHeaderSize = 8;
+  static constexpr size_t kMaxMediaPackets = 48;
+  static constexpr size_t kMaxRepairPackets = 48;
+
+  // Returns the payloads of `num_repair_packets` repair packets protecting
+  // `media_packets`, which must be complete RTP packets with consecutive
+  // sequence numbers.
+  static std::vector<rtc::CopyOnWriteBuffer> Encode(
+      rtc::ArrayView<const rtc::CopyOnWriteBuffer> media_packets,
+      size_t num_repair_packets);
+
+  // Returns the header of a repair packet payload, or nullopt if the payload
+  // is malformed.
+  static absl::optional<Header> ParseHeader(
+      rtc::ArrayView<const uint8_t> repair_payload);
+
+  // Recovers the missing packets of a block. `media_packets` holds the packets
+  // of the block in sequence number order, with empty buffers for those that
+  // are missing, and `repair_payloads` the received repair packet payloads of
+  // the block. Returns false, leaving `media_packets` unchanged, if fewer
+  // distinct repair packets than missing media packets were received or the
+  // input is inconsistent.
+  static bool Decode(rtc::ArrayView<rtc::CopyOnWriteBuffer> media_packets,
+                     rtc::ArrayView<const rtc::CopyOnWriteBuffer>
+                         repair_payloads);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_REED_SOLOMON_FEC_H_
@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/include/reed_solomon_fec_receiver.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+namespace {
+
+// Media packets and blocks further behind the newest sequence number than
+// this are forgotten. Allows for several maximum size blocks in flight.
+constexpr int64_t kMaxPacketAge = 4 * ReedSolomonFec::kMaxMediaPackets;
+
+// How often to log the recovered packets to the text log.
+constexpr int kPacketLogIntervalMs = 10000;
+
+}  // namespace
+
+ReedSolomonFecReceiver::ReedSolomonFecReceiver(
+    Clock* clock,
+    uint32_t ssrc,
+    uint32_t protected_media_ssrc,
+    RecoveredPacketReceiver* recovered_packet_receiver)
+    : ssrc_(ssrc),
+      protected_media_ssrc_(protected_media_ssrc),
+      recovered_packet_receiver_(recovered_packet_receiver),
+      newest_seq_num_(0),
+      clock_(clock),
+      last_recovered_packet_ms_(-1) {
+  // It's OK to create this object on a different thread/task queue than
+  // the one used during main operation.
+  sequence_checker_.Detach();
+}
+
+ReedSolomonFecReceiver::~ReedSolomonFecReceiver() = default;
+
+void ReedSolomonFecReceiver::OnRtpPacket(const RtpPacketReceived& packet) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  // Packets recovered here come back through the callback; see
+  // FlexfecReceiver::OnRtpPacket.
+  if (packet.recovered())
+    return;
+
+  if (packet.Ssrc() == ssrc_) {
+    OnRepairPacket(packet);
+  } else if (packet.Ssrc() == protected_media_ssrc_) {
+    OnMediaPacket(packet);
+  }
+}
+
+FecPacketCounter ReedSolomonFecReceiver::GetPacketCounter() const {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  return packet_counter_;
+}
+
+void ReedSolomonFecReceiver::OnRepairPacket(const RtpPacketReceived& packet) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  const absl::optional<ReedSolomonFec::Header> header =
+      ReedSolomonFec::ParseHeader(packet.payload());
+  if (!header || header->protected_ssrc != protected_media_ssrc_) {
+    RTC_LOG(LS_WARNING) << "Malformed Reed-Solomon repair packet, discarding.";
+    return;
+  }
+  ++packet_counter_.num_packets;
+  ++packet_counter_.num_fec_packets;
+
+  const int64_t base_seq_num = seq_num_unwrapper_.Unwrap(header->base_seq_num);
+  const int64_t last_seq_num = base_seq_num + header->num_media_packets - 1;
+  if (last_seq_num < newest_seq_num_ - kMaxPacketAge) {
+    return;
+  }
+  newest_seq_num_ = std::max(newest_seq_num_, last_seq_num);
+  Block& block = blocks_[base_seq_num];
+  if (block.num_media_packets == 0) {
+    block.num_media_packets = header->num_media_packets;
+  } else if (block.num_media_packets != header->num_media_packets) {
+    return;
+  }
+  if (!block.complete) {
+    block.repair_payloads.push_back(
+        packet.Buffer().Slice(packet.headers_size(), packet.payload_size()));
+    MaybeRecover(base_seq_num, block);
+  }
+  DiscardOldPackets();
+}
+
+void ReedSolomonFecReceiver::OnMediaPacket(const RtpPacketReceived& packet) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  ++packet_counter_.num_packets;
+
+  const int64_t seq_num = seq_num_unwrapper_.Unwrap(packet.SequenceNumber());
+  if (seq_num < newest_seq_num_ - kMaxPacketAge ||
+      media_packets_.find(seq_num) != media_packets_.end()) {
+    return;
+  }
+  newest_seq_num_ = std::max(newest_seq_num_, seq_num);
+  // The sender protects packets before mutable extensions are written.
+  RtpPacketReceived packet_copy(packet);
+  packet_copy.ZeroMutableExtensions();
+  media_packets_.emplace(seq_num, packet_copy.Buffer());
+
+  auto it = blocks_.upper_bound(seq_num);
+  if (it != blocks_.begin()) {
+    --it;
+    Block& block = it->second;
+    if (seq_num < it->first + static_cast<int64_t>(block.num_media_packets)) {
+      MaybeRecover(it->first, block);
+    }
+  }
+  DiscardOldPackets();
+}
+
+void ReedSolomonFecReceiver::MaybeRecover(int64_t base_seq_num, Block& block) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  if (block.complete) {
+    return;
+  }
+  std::vector<rtc::CopyOnWriteBuffer> packets(block.num_media_packets);
+  size_t num_missing = 0;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    auto it = media_packets_.find(base_seq_num + i);
+    if (it != media_packets_.end()) {
+      packets[i] = it->second;
+    } else {
+      ++num_missing;
+    }
+  }
+  if (num_missing > block.repair_payloads.size()) {
+    return;
+  }
+  const bool decoded = ReedSolomonFec::Decode(packets, block.repair_payloads);
+  block.complete = true;
+  block.repair_payloads.clear();
+  if (!decoded) {
+    RTC_LOG(LS_WARNING) << "Inconsistent Reed-Solomon repair packets.";
+    return;
+  }
+
+  std::vector<rtc::CopyOnWriteBuffer> recovered_packets;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (media_packets_.emplace(base_seq_num + i, packets[i]).second) {
+      recovered_packets.push_back(std::move(packets[i]));
+    }
+  }
+  // Return recovered packets through the callback last, since it may end up
+  // in this object again.
+  for (const rtc::CopyOnWriteBuffer& recovered_packet : recovered_packets) {
+    ++packet_counter_.num_recovered_packets;
+    recovered_packet_receiver_->OnRecoveredPacket(recovered_packet.cdata(),
+                                                  recovered_packet.size());
+    // Periodically log the recovered packets.
+    int64_t now_ms = clock_->TimeInMilliseconds();
+    if (now_ms - last_recovered_packet_ms_ > kPacketLogIntervalMs) {
+      RTC_LOG(LS_VERBOSE) << "Recovered media packet with SSRC: "
+                          << protected_media_ssrc_
+                          << " from Reed-Solomon FEC stream with SSRC: "
+                          << ssrc_ << ".";
+      last_recovered_packet_ms_ = now_ms;
+    }
+  }
+}
+
+void ReedSolomonFecReceiver::DiscardOldPackets() {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  const int64_t oldest_seq_num = newest_seq_num_ - kMaxPacketAge;
+  media_packets_.erase(media_packets_.begin(),
+                       media_packets_.lower_bound(oldest_seq_num));
+  blocks_.erase(blocks_.begin(), blocks_.lower_bound(oldest_seq_num));
+}
+
+}  // namespace webrtc
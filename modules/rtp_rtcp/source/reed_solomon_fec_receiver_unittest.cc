@@ -0,0 +1,183 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/include/reed_solomon_fec_receiver.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/rtp_parameters.h"
+#include "modules/rtp_rtcp/include/reed_solomon_fec_sender.h"
+#include "modules/rtp_rtcp/mocks/mock_recovered_packet_receiver.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::_;
+using ::testing::Args;
+using ::testing::ElementsAreArray;
+
+constexpr int kFecPayloadType = 123;
+constexpr uint32_t kMediaSsrc = 8353;
+constexpr uint32_t kFecSsrc = 42984;
+// 3 repair packets for 10 media packets.
+constexpr int kFecRate = 77;
+constexpr size_t kNumMediaPackets = 10;
+
+RtpPacketReceived ParsePacket(const rtc::CopyOnWriteBuffer& buffer) {
+  RtpPacketReceived packet;
+  EXPECT_TRUE(packet.Parse(buffer));
+  return packet;
+}
+
+class ReedSolomonFecReceiverTest : public ::testing::Test {
+ protected:
+  ReedSolomonFecReceiverTest()
+      : clock_(1),
+        sender_(kFecPayloadType,
+                kFecSsrc,
+                kMediaSsrc,
+                /*mid=*/"",
+                /*rtp_header_extensions=*/{},
+                /*extension_sizes=*/{},
+                /*rtp_state=*/nullptr,
+                &clock_),
+        receiver_(&clock_, kFecSsrc, kMediaSsrc, &recovered_packet_receiver_) {
+    FecProtectionParams params;
+    params.fec_rate = kFecRate;
+    params.max_fec_frames = 1;
+    sender_.SetProtectionParameters(params, params);
+  }
+
+  // Sends a frame of `kNumMediaPackets` packets of different sizes through
+  // `sender_`.
+  void SendFrame() {
+    for (size_t i = 0; i < kNumMediaPackets; ++i) {
+      RtpPacketToSend packet(nullptr);
+      packet.SetSsrc(kMediaSsrc);
+      packet.SetSequenceNumber(next_seq_num_++);
+      packet.SetTimestamp(90000);
+      packet.SetMarker(i == kNumMediaPackets - 1);
+      uint8_t* payload = packet.AllocatePayload(500 + 10 * i);
+      for (size_t j = 0; j < packet.payload_size(); ++j) {
+        payload[j] = static_cast<uint8_t>(i + j);
+      }
+      sender_.AddPacketAndGenerateFec(packet);
+      media_packets_.push_back(ParsePacket(packet.Buffer()));
+      for (const auto& fec_packet : sender_.GetFecPackets()) {
+        fec_packets_.push_back(ParsePacket(fec_packet->Buffer()));
+      }
+    }
+  }
+
+  void ExpectRecovered(const RtpPacketReceived& packet) {
+    EXPECT_CALL(recovered_packet_receiver_, OnRecoveredPacket(_, _))
+        .With(Args<0, 1>(ElementsAreArray(packet.data(), packet.size())));
+  }
+
+  SimulatedClock clock_;
+  ReedSolomonFecSender sender_;
+  ::testing::StrictMock<MockRecoveredPacketReceiver>
+      recovered_packet_receiver_;
+  ReedSolomonFecReceiver receiver_;
+  uint16_t next_seq_num_ = 65530;
+  std::vector<RtpPacketReceived> media_packets_;
+  std::vector<RtpPacketReceived> fec_packets_;
+};
+
+TEST_F(ReedSolomonFecReceiverTest, RecoversBurstLoss) {
+  SendFrame();
+  ASSERT_EQ(3u, fec_packets_.size());
+  for (size_t i = 0; i < kNumMediaPackets; ++i) {
+    // Lose three consecutive packets, across the sequence number wrap.
+    if (i < 5 || i > 7) {
+      receiver_.OnRtpPacket(media_packets_[i]);
+    }
+  }
+  receiver_.OnRtpPacket(fec_packets_[0]);
+  receiver_.OnRtpPacket(fec_packets_[1]);
+
+  ExpectRecovered(media_packets_[5]);
+  ExpectRecovered(media_packets_[6]);
+  ExpectRecovered(media_packets_[7]);
+  receiver_.OnRtpPacket(fec_packets_[2]);
+
+  const FecPacketCounter counter = receiver_.GetPacketCounter();
+  EXPECT_EQ(10u, counter.num_packets);
+  EXPECT_EQ(3u, counter.num_fec_packets);
+  EXPECT_EQ(3u, counter.num_recovered_packets);
+}
+
+TEST_F(ReedSolomonFecReceiverTest, RecoversWhenRepairPacketsArriveFirst) {
+  SendFrame();
+  receiver_.OnRtpPacket(fec_packets_[1]);
+  receiver_.OnRtpPacket(fec_packets_[2]);
+  // Packets 0, 1 and 9 are lost, and recovered once the last repair packet
+  // completes the set of ten packets needed for decoding.
+  for (size_t i = 2; i < 9; ++i) {
+    receiver_.OnRtpPacket(media_packets_[i]);
+  }
+  ExpectRecovered(media_packets_[0]);
+  ExpectRecovered(media_packets_[1]);
+  ExpectRecovered(media_packets_[9]);
+  receiver_.OnRtpPacket(fec_packets_[0]);
+
+  EXPECT_EQ(3u, receiver_.GetPacketCounter().num_recovered_packets);
+}
+
+TEST_F(ReedSolomonFecReceiverTest, DoesNotRecoverMoreLossesThanRepairPackets) {
+  SendFrame();
+  for (size_t i = 4; i < kNumMediaPackets; ++i) {
+    receiver_.OnRtpPacket(media_packets_[i]);
+  }
+  for (const RtpPacketReceived& fec_packet : fec_packets_) {
+    receiver_.OnRtpPacket(fec_packet);
+  }
+
+  EXPECT_EQ(0u, receiver_.GetPacketCounter().num_recovered_packets);
+}
+
+TEST_F(ReedSolomonFecReceiverTest, IgnoresRecoveredAndDuplicatePackets) {
+  SendFrame();
+  RtpPacketReceived recovered_packet = media_packets_[0];
+  recovered_packet.set_recovered(true);
+  receiver_.OnRtpPacket(recovered_packet);
+  for (size_t i = 1; i < kNumMediaPackets; ++i) {
+    receiver_.OnRtpPacket(media_packets_[i]);
+    receiver_.OnRtpPacket(media_packets_[i]);
+  }
+  ExpectRecovered(media_packets_[0]);
+  receiver_.OnRtpPacket(fec_packets_[0]);
+  receiver_.OnRtpPacket(fec_packets_[0]);
+  receiver_.OnRtpPacket(fec_packets_[1]);
+}
+
+TEST_F(ReedSolomonFecReceiverTest, RecoversPacketsOfConsecutiveFrames) {
+  SendFrame();
+  SendFrame();
+  ASSERT_EQ(6u, fec_packets_.size());
+  for (size_t i = 0; i < 2 * kNumMediaPackets; ++i) {
+    if (i % kNumMediaPackets != 3) {
+      receiver_.OnRtpPacket(media_packets_[i]);
+    }
+  }
+  ExpectRecovered(media_packets_[3]);
+  ExpectRecovered(media_packets_[kNumMediaPackets + 3]);
+  receiver_.OnRtpPacket(fec_packets_[0]);
+  receiver_.OnRtpPacket(fec_packets_[5]);
+}
+
+}  // namespace
+}  // namespace webrtc
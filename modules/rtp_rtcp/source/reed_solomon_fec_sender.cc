@@ -0,0 +1,235 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/include/reed_solomon_fec_sender.h"
+
+#include <string.h>
+
+#include <utility>
+
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+namespace {
+
+// Let first sequence number be in the first half of the interval.
+constexpr uint16_t kMaxInitRtpSeqNumber = 0x7fff;
+
+// Repair packets use the 90 kHz clock of the protected video stream.
+constexpr int kMsToRtpTimestamp = kVideoPayloadTypeFrequency / 1000;
+
+// As in UlpfecGenerator, a block is encoded before `max_fec_frames` frames
+// have been collected if the repair packet count, rounded to an integer,
+// exceeds the requested rate by less than this, in Q8.
+constexpr int kMaxExcessOverhead = 50;
+
+RtpHeaderExtensionMap RegisterSupportedExtensions(
+    const std::vector<RtpExtension>& rtp_header_extensions) {
+  RtpHeaderExtensionMap map;
+  for (const auto& extension : rtp_header_extensions) {
+    if (extension.uri == TransportSequenceNumber::Uri()) {
+      map.Register<TransportSequenceNumber>(extension.id);
+    } else if (extension.uri == AbsoluteSendTime::Uri()) {
+      map.Register<AbsoluteSendTime>(extension.id);
+    } else if (extension.uri == TransmissionOffset::Uri()) {
+      map.Register<TransmissionOffset>(extension.id);
+    } else if (extension.uri == RtpMid::Uri()) {
+      map.Register<RtpMid>(extension.id);
+    }
+  }
+  return map;
+}
+
+}  // namespace
+
+ReedSolomonFecSender::ReedSolomonFecSender(
+    int payload_type,
+    uint32_t ssrc,
+    uint32_t protected_media_ssrc,
+    const std::string& mid,
+    const std::vector<RtpExtension>& rtp_header_extensions,
+    rtc::ArrayView<const RtpExtensionSize> extension_sizes,
+    const RtpState* rtp_state,
+    Clock* clock)
+    : clock_(clock),
+      random_(clock_->TimeInMicroseconds()),
+      payload_type_(payload_type),
+      timestamp_offset_(rtp_state ? rtp_state->start_timestamp
+                                  : random_.Rand<uint32_t>()),
+      ssrc_(ssrc),
+      protected_media_ssrc_(protected_media_ssrc),
+      mid_(mid),
+      rtp_header_extension_map_(
+          RegisterSupportedExtensions(rtp_header_extensions)),
+      header_extensions_size_(
+          RtpHeaderExtensionSize(extension_sizes, rtp_header_extension_map_)),
+      seq_num_(rtp_state ? rtp_state->sequence_number
+                         : random_.Rand(1, kMaxInitRtpSeqNumber)),
+      fec_bitrate_(/*max_window_size_ms=*/1000, RateStatistics::kBpsScale) {
+  RTC_DCHECK_GE(payload_type, 0);
+  RTC_DCHECK_LE(payload_type, 127);
+}
+
+ReedSolomonFecSender::~ReedSolomonFecSender() = default;
+
+size_t ReedSolomonFecSender::MaxPacketOverhead() const {
+  return header_extensions_size_ + ReedSolomonFec::kHeaderSize +
+         ReedSolomonFec::kRecoveryHeaderSize;
+}
+
+DataRate ReedSolomonFecSender::CurrentFecRate() const {
+  MutexLock lock(&mutex_);
+  return DataRate::BitsPerSec(
+      fec_bitrate_.Rate(clock_->TimeInMilliseconds()).value_or(0));
+}
+
+void ReedSolomonFecSender::SetProtectionParameters(
+    const FecProtectionParams& delta_params,
+    const FecProtectionParams& key_params) {
+  RTC_DCHECK_GE(delta_params.fec_rate, 0);
+  RTC_DCHECK_LE(delta_params.fec_rate, 255);
+  RTC_DCHECK_GE(key_params.fec_rate, 0);
+  RTC_DCHECK_LE(key_params.fec_rate, 255);
+  // Applied from the next block on.
+  MutexLock lock(&mutex_);
+  pending_params_ = Params{delta_params, key_params};
+}
+
+void ReedSolomonFecSender::AddPacketAndGenerateFec(
+    const RtpPacketToSend& packet) {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  RTC_DCHECK_EQ(packet.Ssrc(), protected_media_ssrc_);
+  RTC_DCHECK(repair_payloads_.empty());
+
+  // Blocks cover consecutive sequence numbers only, so a gap, e.g. from
+  // padding sent on the media SSRC, ends the current block.
+  if (!media_packets_.empty() &&
+      packet.SequenceNumber() !=
+          static_cast<uint16_t>(ForwardErrorCorrection::ParseSequenceNumber(
+                                    media_packets_.back().cdata()) +
+                                1)) {
+    EncodeBlock();
+  }
+
+  if (media_packets_.empty()) {
+    MutexLock lock(&mutex_);
+    if (pending_params_) {
+      current_params_ = *pending_params_;
+      pending_params_.reset();
+    }
+  }
+  if (packet.is_key_frame()) {
+    media_contains_keyframe_ = true;
+  }
+  media_packets_.push_back(packet.Buffer());
+  if (packet.Marker()) {
+    ++num_protected_frames_;
+  }
+
+  const FecProtectionParams& params = CurrentParams();
+  const int num_media_packets = media_packets_.size();
+  const int num_repair_packets =
+      ForwardErrorCorrection::NumFecPackets(num_media_packets, params.fec_rate);
+  const int excess_overhead =
+      (num_repair_packets << 8) / num_media_packets - params.fec_rate;
+  if (media_packets_.size() == ReedSolomonFec::kMaxMediaPackets ||
+      (packet.Marker() && (num_protected_frames_ >= params.max_fec_frames ||
+                           excess_overhead < kMaxExcessOverhead))) {
+    EncodeBlock();
+  }
+}
+
+std::vector<std::unique_ptr<RtpPacketToSend>>
+ReedSolomonFecSender::GetFecPackets() {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets_to_send;
+  if (repair_payloads_.empty()) {
+    return fec_packets_to_send;
+  }
+  fec_packets_to_send.reserve(repair_payloads_.size());
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  size_t total_fec_data_bytes = 0;
+  for (const rtc::CopyOnWriteBuffer& repair_payload : repair_payloads_) {
+    auto fec_packet_to_send =
+        std::make_unique<RtpPacketToSend>(&rtp_header_extension_map_);
+    fec_packet_to_send->set_packet_type(
+        RtpPacketMediaType::kForwardErrorCorrection);
+    fec_packet_to_send->set_allow_retransmission(false);
+
+    // RTP header.
+    fec_packet_to_send->SetMarker(false);
+    fec_packet_to_send->SetPayloadType(payload_type_);
+    fec_packet_to_send->SetSequenceNumber(seq_num_++);
+    fec_packet_to_send->SetTimestamp(
+        timestamp_offset_ + static_cast<uint32_t>(kMsToRtpTimestamp * now_ms));
+    fec_packet_to_send->set_capture_time_ms(now_ms);
+    fec_packet_to_send->SetSsrc(ssrc_);
+    // Reserve extensions, if registered. These will be set by the RTPSender.
+    fec_packet_to_send->ReserveExtension<AbsoluteSendTime>();
+    fec_packet_to_send->ReserveExtension<TransmissionOffset>();
+    fec_packet_to_send->ReserveExtension<TransportSequenceNumber>();
+    if (!mid_.empty()) {
+      // This is a no-op if the MID header extension is not registered.
+      fec_packet_to_send->SetExtension<RtpMid>(mid_);
+    }
+
+    // RTP payload.
+    uint8_t* payload =
+        fec_packet_to_send->AllocatePayload(repair_payload.size());
+    memcpy(payload, repair_payload.cdata(), repair_payload.size());
+
+    total_fec_data_bytes += fec_packet_to_send->size();
+    fec_packets_to_send.push_back(std::move(fec_packet_to_send));
+  }
+  repair_payloads_.clear();
+
+  MutexLock lock(&mutex_);
+  fec_bitrate_.Update(total_fec_data_bytes, now_ms);
+  return fec_packets_to_send;
+}
+
+absl::optional<RtpState> ReedSolomonFecSender::GetRtpState() {
+  RtpState rtp_state;
+  rtp_state.sequence_number = seq_num_;
+  rtp_state.start_timestamp = timestamp_offset_;
+  return rtp_state;
+}
+
+const FecProtectionParams& ReedSolomonFecSender::CurrentParams() const {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  return media_contains_keyframe_ ? current_params_.key_params
+                                  : current_params_.delta_params;
+}
+
+void ReedSolomonFecSender::EncodeBlock() {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  RTC_DCHECK(!media_packets_.empty());
+  const int num_repair_packets = ForwardErrorCorrection::NumFecPackets(
+      media_packets_.size(), CurrentParams().fec_rate);
+  if (num_repair_packets > 0) {
+    std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+        ReedSolomonFec::Encode(media_packets_, num_repair_packets);
+    repair_payloads_.insert(repair_payloads_.end(),
+                            std::make_move_iterator(repair_payloads.begin()),
+                            std::make_move_iterator(repair_payloads.end()));
+  }
+  media_packets_.clear();
+  num_protected_frames_ = 0;
+  media_contains_keyframe_ = false;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/include/reed_solomon_fec_sender.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/rtp_parameters.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kFecPayloadType = 123;
+constexpr uint32_t kMediaSsrc = 1234;
+constexpr uint32_t kFecSsrc = 5678;
+const char kNoMid[] = "";
+const std::vector<RtpExtension> kNoRtpHeaderExtensions;
+const std::vector<RtpExtensionSize> kNoRtpHeaderExtensionSizes;
+constexpr size_t kPayloadLength = 100;
+
+RtpPacketToSend CreateMediaPacket(uint16_t seq_num, bool marker) {
+  RtpPacketToSend packet(nullptr);
+  packet.SetSsrc(kMediaSsrc);
+  packet.SetSequenceNumber(seq_num);
+  packet.SetTimestamp(3000);
+  packet.SetMarker(marker);
+  packet.SetPayloadSize(kPayloadLength);
+  return packet;
+}
+
+class ReedSolomonFecSenderTest : public ::testing::Test {
+ protected:
+  ReedSolomonFecSenderTest()
+      : clock_(1),
+        sender_(kFecPayloadType,
+                kFecSsrc,
+                kMediaSsrc,
+                kNoMid,
+                kNoRtpHeaderExtensions,
+                kNoRtpHeaderExtensionSizes,
+                /*rtp_state=*/nullptr,
+                &clock_) {}
+
+  void SetFecRate(int fec_rate, int max_fec_frames) {
+    FecProtectionParams params;
+    params.fec_rate = fec_rate;
+    params.max_fec_frames = max_fec_frames;
+    sender_.SetProtectionParameters(params, params);
+  }
+
+  SimulatedClock clock_;
+  ReedSolomonFecSender sender_;
+};
+
+TEST_F(ReedSolomonFecSenderTest, Ssrc) {
+  EXPECT_EQ(kFecSsrc, sender_.FecSsrc());
+  EXPECT_EQ(VideoFecGenerator::FecType::kReedSolomon, sender_.GetFecType());
+}
+
+TEST_F(ReedSolomonFecSenderTest, ProtectsFrameWithRepairPackets) {
+  // 3 repair packets for 10 media packets.
+  SetFecRate(77, 1);
+  for (uint16_t seq_num = 0; seq_num < 10; ++seq_num) {
+    EXPECT_TRUE(sender_.GetFecPackets().empty());
+    sender_.AddPacketAndGenerateFec(CreateMediaPacket(seq_num, seq_num == 9));
+  }
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets =
+      sender_.GetFecPackets();
+  ASSERT_EQ(3u, fec_packets.size());
+  for (size_t j = 0; j < fec_packets.size(); ++j) {
+    const RtpPacketToSend& fec_packet = *fec_packets[j];
+    EXPECT_EQ(kFecSsrc, fec_packet.Ssrc());
+    EXPECT_EQ(kFecPayloadType, fec_packet.PayloadType());
+    EXPECT_FALSE(fec_packet.Marker());
+    EXPECT_EQ(static_cast<uint16_t>(fec_packets[0]->SequenceNumber() + j),
+              fec_packet.SequenceNumber());
+    EXPECT_EQ(RtpPacketMediaType::kForwardErrorCorrection,
+              fec_packet.packet_type());
+    EXPECT_EQ(ReedSolomonFec::kHeaderSize +
+                  ReedSolomonFec::kRecoveryHeaderSize + kPayloadLength,
+              fec_packet.payload_size());
+    absl::optional<ReedSolomonFec::Header> header =
+        ReedSolomonFec::ParseHeader(fec_packet.payload());
+    ASSERT_TRUE(header);
+    EXPECT_EQ(kMediaSsrc, header->protected_ssrc);
+    EXPECT_EQ(0, header->base_seq_num);
+    EXPECT_EQ(10, header->num_media_packets);
+    EXPECT_EQ(j, header->repair_index);
+  }
+  EXPECT_TRUE(sender_.GetFecPackets().empty());
+}
+
+TEST_F(ReedSolomonFecSenderTest, NoRepairPacketsWithoutProtection) {
+  SetFecRate(0, 1);
+  for (uint16_t seq_num = 0; seq_num < 10; ++seq_num) {
+    sender_.AddPacketAndGenerateFec(CreateMediaPacket(seq_num, seq_num == 9));
+    EXPECT_TRUE(sender_.GetFecPackets().empty());
+  }
+}
+
+TEST_F(ReedSolomonFecSenderTest, ProtectsFramesTogetherUntilOverheadIsMet) {
+  // A single repair packet for four packets would be too much overhead, so
+  // the second frame is protected in the same block.
+  SetFecRate(10, 2);
+  for (uint16_t seq_num = 0; seq_num < 8; ++seq_num) {
+    sender_.AddPacketAndGenerateFec(
+        CreateMediaPacket(seq_num, seq_num == 3 || seq_num == 7));
+    if (seq_num < 7) {
+      EXPECT_TRUE(sender_.GetFecPackets().empty());
+    }
+  }
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets =
+      sender_.GetFecPackets();
+  ASSERT_EQ(1u, fec_packets.size());
+  EXPECT_EQ(8, ReedSolomonFec::ParseHeader(fec_packets[0]->payload())
+                   ->num_media_packets);
+}
+
+TEST_F(ReedSolomonFecSenderTest, EndsBlockOnSequenceNumberGap) {
+  SetFecRate(128, 1);
+  sender_.AddPacketAndGenerateFec(CreateMediaPacket(100, false));
+  sender_.AddPacketAndGenerateFec(CreateMediaPacket(101, false));
+  sender_.AddPacketAndGenerateFec(CreateMediaPacket(103, false));
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> fec_packets =
+      sender_.GetFecPackets();
+  ASSERT_EQ(1u, fec_packets.size());
+  absl::optional<ReedSolomonFec::Header> header =
+      ReedSolomonFec::ParseHeader(fec_packets[0]->payload());
+  EXPECT_EQ(100, header->base_seq_num);
+  EXPECT_EQ(2, header->num_media_packets);
+
+  sender_.AddPacketAndGenerateFec(CreateMediaPacket(104, true));
+  fec_packets = sender_.GetFecPackets();
+  ASSERT_EQ(1u, fec_packets.size());
+  header = ReedSolomonFec::ParseHeader(fec_packets[0]->payload());
+  EXPECT_EQ(103, header->base_seq_num);
+  EXPECT_EQ(2, header->num_media_packets);
+}
+
+TEST_F(ReedSolomonFecSenderTest, KeepsRtpStateAcrossInstances) {
+  SetFecRate(255, 1);
+  sender_.AddPacketAndGenerateFec(CreateMediaPacket(0, true));
+  const uint16_t seq_num = sender_.GetFecPackets()[0]->SequenceNumber();
+  const absl::optional<RtpState> rtp_state = sender_.GetRtpState();
+  ASSERT_TRUE(rtp_state);
+
+  ReedSolomonFecSender sender(kFecPayloadType, kFecSsrc, kMediaSsrc, kNoMid,
+                              kNoRtpHeaderExtensions,
+                              kNoRtpHeaderExtensionSizes, &*rtp_state, &clock_);
+  FecProtectionParams params;
+  params.fec_rate = 255;
+  sender.SetProtectionParameters(params, params);
+  sender.AddPacketAndGenerateFec(CreateMediaPacket(1, true));
+  EXPECT_EQ(static_cast<uint16_t>(seq_num + 1),
+            sender.GetFecPackets()[0]->SequenceNumber());
+}
+
+}  // namespace
+}  // namespace webrtc
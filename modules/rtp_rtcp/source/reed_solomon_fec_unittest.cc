@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/reed_solomon_fec.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "modules/rtp_rtcp/source/fec_test_helper.h"
+#include "modules/rtp_rtcp/source/forward_error_correction.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kMediaSsrc = 1234;
+
+std::vector<rtc::CopyOnWriteBuffer> CreateMediaPackets(size_t num_packets,
+                                                       Random* random) {
+  test::fec::MediaPacketGenerator generator(/*min_packet_size=*/12,
+                                            /*max_packet_size=*/1200,
+                                            kMediaSsrc, random);
+  std::vector<rtc::CopyOnWriteBuffer> media_packets;
+  for (const auto& packet : generator.ConstructMediaPackets(num_packets)) {
+    media_packets.push_back(packet->data);
+  }
+  return media_packets;
+}
+
+TEST(ReedSolomonFecTest, WritesHeader) {
+  Random random(4711);
+  const std::vector<rtc::CopyOnWriteBuffer> media_packets =
+      CreateMediaPackets(10, &random);
+  const std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+      ReedSolomonFec::Encode(media_packets, 3);
+  ASSERT_EQ(3u, repair_payloads.size());
+  for (int j = 0; j < 3; ++j) {
+    absl::optional<ReedSolomonFec::Header> header =
+        ReedSolomonFec::ParseHeader(repair_payloads[j]);
+    ASSERT_TRUE(header);
+    EXPECT_EQ(kMediaSsrc, header->protected_ssrc);
+    EXPECT_EQ(ForwardErrorCorrection::ParseSequenceNumber(
+                  media_packets[0].cdata()),
+              header->base_seq_num);
+    EXPECT_EQ(10, header->num_media_packets);
+    EXPECT_EQ(j, header->repair_index);
+  }
+}
+
+TEST(ReedSolomonFecTest, RejectsMalformedHeaders) {
+  uint8_t payload[ReedSolomonFec::kHeaderSize +
+                  ReedSolomonFec::kRecoveryHeaderSize] = {0};
+  payload[6] = 1;
+  EXPECT_TRUE(ReedSolomonFec::ParseHeader(payload));
+  EXPECT_FALSE(ReedSolomonFec::ParseHeader(
+      rtc::ArrayView<const uint8_t>(payload, sizeof(payload) - 1)));
+  payload[6] = 0;
+  EXPECT_FALSE(ReedSolomonFec::ParseHeader(payload));
+  payload[6] = ReedSolomonFec::kMaxMediaPackets + 1;
+  EXPECT_FALSE(ReedSolomonFec::ParseHeader(payload));
+  payload[6] = 1;
+  payload[7] = ReedSolomonFec::kMaxRepairPackets;
+  EXPECT_FALSE(ReedSolomonFec::ParseHeader(payload));
+}
+
+TEST(ReedSolomonFecTest, RecoversAnyLossesUpToNumberOfRepairPackets) {
+  Random random(4711);
+  constexpr size_t kNumMediaPackets = 12;
+  constexpr size_t kNumRepairPackets = 4;
+  for (int trial = 0; trial < 200; ++trial) {
+    const std::vector<rtc::CopyOnWriteBuffer> media_packets =
+        CreateMediaPackets(kNumMediaPackets, &random);
+    const std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+        ReedSolomonFec::Encode(media_packets, kNumRepairPackets);
+
+    // Lose `kNumRepairPackets` random packets of the block.
+    std::vector<size_t> order(kNumMediaPackets + kNumRepairPackets);
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    for (size_t i = 0; i < kNumRepairPackets; ++i) {
+      const uint32_t j = random.Rand(static_cast<uint32_t>(i),
+                                     static_cast<uint32_t>(order.size() - 1));
+      std::swap(order[i], order[j]);
+    }
+    std::vector<rtc::CopyOnWriteBuffer> received_media = media_packets;
+    std::vector<bool> repair_lost(kNumRepairPackets, false);
+    for (size_t i = 0; i < kNumRepairPackets; ++i) {
+      if (order[i] < kNumMediaPackets) {
+        received_media[order[i]] = rtc::CopyOnWriteBuffer();
+      } else {
+        repair_lost[order[i] - kNumMediaPackets] = true;
+      }
+    }
+    std::vector<rtc::CopyOnWriteBuffer> received_repair;
+    for (size_t j = 0; j < kNumRepairPackets; ++j) {
+      if (!repair_lost[j]) {
+        received_repair.push_back(repair_payloads[j]);
+      }
+    }
+
+    ASSERT_TRUE(ReedSolomonFec::Decode(received_media, received_repair));
+    EXPECT_EQ(media_packets, received_media);
+  }
+}
+
+TEST(ReedSolomonFecTest, RecoversLargestBlockFromRepairPacketsOnly) {
+  Random random(4711);
+  const std::vector<rtc::CopyOnWriteBuffer> media_packets =
+      CreateMediaPackets(ReedSolomonFec::kMaxMediaPackets, &random);
+  const std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+      ReedSolomonFec::Encode(media_packets, ReedSolomonFec::kMaxRepairPackets);
+  std::vector<rtc::CopyOnWriteBuffer> received_media(media_packets.size());
+
+  ASSERT_TRUE(ReedSolomonFec::Decode(received_media, repair_payloads));
+  EXPECT_EQ(media_packets, received_media);
+}
+
+TEST(ReedSolomonFecTest, FailsWithTooFewDistinctRepairPackets) {
+  Random random(4711);
+  const std::vector<rtc::CopyOnWriteBuffer> media_packets =
+      CreateMediaPackets(10, &random);
+  const std::vector<rtc::CopyOnWriteBuffer> repair_payloads =
+      ReedSolomonFec::Encode(media_packets, 2);
+  std::vector<rtc::CopyOnWriteBuffer> received_media = media_packets;
+  received_media[3] = rtc::CopyOnWriteBuffer();
+  received_media[4] = rtc::CopyOnWriteBuffer();
+
+  const std::vector<rtc::CopyOnWriteBuffer> one_repair = {repair_payloads[0]};
+  EXPECT_FALSE(ReedSolomonFec::Decode(received_media, one_repair));
+  const std::vector<rtc::CopyOnWriteBuffer> duplicate_repair = {
+      repair_payloads[1], repair_payloads[1]};
+  EXPECT_FALSE(ReedSolomonFec::Decode(received_media, duplicate_repair));
+  EXPECT_EQ(0u, received_media[3].size());
+  EXPECT_EQ(0u, received_media[4].size());
+}
+
+TEST(ReedSolomonFecTest, FailsWithRepairPacketsOfOtherBlock) {
+  Random random(4711);
+  const std::vector<rtc::CopyOnWriteBuffer> media_packets =
+      CreateMediaPackets(10, &random);
+  const std::vector<rtc::CopyOnWriteBuffer> other_media_packets =
+      CreateMediaPackets(10, &random);
+  std::vector<rtc::CopyOnWriteBuffer> repair_payloads = {
+      ReedSolomonFec::Encode(media_packets, 1)[0],
+      ReedSolomonFec::Encode(other_media_packets, 2)[1]};
+  std::vector<rtc::CopyOnWriteBuffer> received_media = media_packets;
+  received_media[0] = rtc::CopyOnWriteBuffer();
+  received_media[1] = rtc::CopyOnWriteBuffer();
+
+  EXPECT_FALSE(ReedSolomonFec::Decode(received_media, repair_payloads));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -69,6 +69,14 @@ RtpPacket::RtpPacket(const ExtensionManager* extensions, size_t capacity)
   Clear();
 }
 
+RtpPacket::RtpPacket(const ExtensionManager* extensions,
+                     rtc::CopyOnWriteBuffer buffer)
+    : extensions_(extensions ? *extensions : ExtensionManager()),
+      buffer_(std::move(buffer)) {
+  buffer_.SetSize(kFixedHeaderSize);
+  Clear();
+}
+
 RtpPacket::~RtpPacket() {}
 
 void RtpPacket::IdentifyExtensions(ExtensionManager extensions) {
@@ -120,6 +128,7 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   payload_offset_ = packet.payload_offset_;
   extensions_ = packet.extensions_;
   extension_entries_ = packet.extension_entries_;
+  extension_entry_index_ = packet.extension_entry_index_;
   extensions_size_ = packet.extensions_size_;
   buffer_ = packet.buffer_.Slice(0, packet.headers_size());
   // Reset payload and padding.
@@ -324,8 +333,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
   const uint16_t extension_info_offset = rtc::dchecked_cast<uint16_t>(
       extensions_offset + extensions_size_ + extension_header_size);
   const uint8_t extension_info_length = rtc::dchecked_cast<uint8_t>(length);
-  extension_entries_.emplace_back(id, extension_info_length,
-                                  extension_info_offset);
+  AddExtensionInfo(id, extension_info_length, extension_info_offset);
 
   extensions_size_ = new_extensions_size;
 
@@ -437,7 +445,7 @@ void RtpPacket::Clear() {
   payload_size_ = 0;
   padding_size_ = 0;
   extensions_size_ = 0;
-  extension_entries_.clear();
+  ClearExtensionInfo();
 
   memset(WriteAt(0), 0, kFixedHeaderSize);
   buffer_.SetSize(kFixedHeaderSize);
@@ -467,7 +475,7 @@ bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
   payload_offset_ = kFixedHeaderSize + number_of_crcs * 4;
 
   extensions_size_ = 0;
-  extension_entries_.clear();
+  ClearExtensionInfo();
   if (has_extension) {
     /* RTP header extension, RFC 3550.
      0                   1                   2                   3
@@ -564,6 +572,15 @@ bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
 }
 
 const RtpPacket::ExtensionInfo* RtpPacket::FindExtensionInfo(int id) const {
+  RTC_DCHECK_GE(id, 0);
+  RTC_DCHECK_LE(id, RtpExtension::kMaxId);
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    const uint8_t index = extension_entry_index_[id];
+    if (index == 0) {
+      return nullptr;
+    }
+    return &extension_entries_[index - 1];
+  }
   for (const ExtensionInfo& extension : extension_entries_) {
     if (extension.id == id) {
       return &extension;
@@ -573,15 +590,45 @@ const RtpPacket::ExtensionInfo* RtpPacket::FindExtensionInfo(int id) const {
 }
 
 RtpPacket::ExtensionInfo& RtpPacket::FindOrCreateExtensionInfo(int id) {
-  for (ExtensionInfo& extension : extension_entries_) {
-    if (extension.id == id) {
-      return extension;
+  RTC_DCHECK_GE(id, 0);
+  RTC_DCHECK_LE(id, RtpExtension::kMaxId);
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    const uint8_t index = extension_entry_index_[id];
+    if (index != 0) {
+      return extension_entries_[index - 1];
     }
+  } else {
+    for (ExtensionInfo& extension : extension_entries_) {
+      if (extension.id == id) {
+        return extension;
+      }
+    }
+  }
+  return AddExtensionInfo(id, /*length=*/0, /*offset=*/0);
+}
+
+RtpPacket::ExtensionInfo& RtpPacket::AddExtensionInfo(int id,
+                                                      uint8_t length,
+                                                      uint16_t offset) {
+  RTC_DCHECK(FindExtensionInfo(id) == nullptr);
+  extension_entries_.emplace_back(id, length, offset);
+  if (id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+    // There is at most one entry per id, so the index fits.
+    extension_entry_index_[id] =
+        rtc::dchecked_cast<uint8_t>(extension_entries_.size());
   }
-  extension_entries_.emplace_back(id);
   return extension_entries_.back();
 }
 
+void RtpPacket::ClearExtensionInfo() {
+  for (const ExtensionInfo& extension : extension_entries_) {
+    if (extension.id <= RtpExtension::kOneByteHeaderExtensionMaxId) {
+      extension_entry_index_[extension.id] = 0;
+    }
+  }
+  extension_entries_.clear();
+}
+
 rtc::ArrayView<const uint8_t> RtpPacket::FindExtension(
     ExtensionType type) const {
   uint8_t id = extensions_.GetId(type);
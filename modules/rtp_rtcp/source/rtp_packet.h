@@ -10,11 +10,13 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_H_
 
+#include <array>
 #include <string>
 #include <vector>
 
 #include "absl/types/optional.h"
 #include "api/array_view.h"
+#include "api/rtp_parameters.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
 #include "rtc_base/copy_on_write_buffer.h"
@@ -36,6 +38,10 @@ class RtpPacket {
   explicit RtpPacket(const ExtensionManager* extensions);
   RtpPacket(const RtpPacket&);
   RtpPacket(const ExtensionManager* extensions, size_t capacity);
+  // Writes the packet to `buffer`, e.g. storage taken from a
+  // rtc::CopyOnWriteBufferPool. The capacity of the packet is the capacity of
+  // `buffer`, and its content is overwritten.
+  RtpPacket(const ExtensionManager* extensions, rtc::CopyOnWriteBuffer buffer);
   ~RtpPacket();
 
   RtpPacket& operator=(const RtpPacket&) = default;
@@ -158,7 +164,6 @@ class RtpPacket {
 
  private:
   struct ExtensionInfo {
-    explicit ExtensionInfo(uint8_t id) : ExtensionInfo(id, 0, 0) {}
     ExtensionInfo(uint8_t id, uint8_t length, uint16_t offset)
         : id(id), length(length), offset(offset) {}
     uint8_t id;
@@ -178,6 +183,12 @@ class RtpPacket {
   // with the specified id if not found.
   ExtensionInfo& FindOrCreateExtensionInfo(int id);
 
+  // Adds an entry for an extension id not in the packet.
+  ExtensionInfo& AddExtensionInfo(int id, uint8_t length, uint16_t offset);
+
+  // Removes all extension entries.
+  void ClearExtensionInfo();
+
   // Allocates and returns place to store rtp header extension.
   // Returns empty arrayview on failure.
   rtc::ArrayView<uint8_t> AllocateRawExtension(int id, size_t length);
@@ -206,6 +217,12 @@ class RtpPacket {
 
   ExtensionManager extensions_;
   std::vector<ExtensionInfo> extension_entries_;
+  // For each id usable with one-byte headers, one more than the index of its
+  // entry in `extension_entries_`, or 0 if the packet doesn't have the
+  // extension. Entries of larger ids, which only two-byte headers can carry,
+  // are searched for. Kept small, since packets are copied often.
+  std::array<uint8_t, RtpExtension::kOneByteHeaderExtensionMaxId + 1>
+      extension_entry_index_ = {};
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
 };
@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copy_on_write_buffer.h"
+
+namespace webrtc {
+namespace {
+
+// Extensions looked up by the receiver, in the order they are added to a
+// packet.
+constexpr RTPExtensionType kExtensionTypes[] = {
+    kRtpExtensionTransportSequenceNumber,
+    kRtpExtensionAbsoluteSendTime,
+    kRtpExtensionTransmissionTimeOffset,
+    kRtpExtensionVideoRotation,
+    kRtpExtensionPlayoutDelay,
+    kRtpExtensionVideoContentType,
+    kRtpExtensionVideoFrameTrackingId,
+    kRtpExtensionAudioLevel,
+    kRtpExtensionMid,
+    kRtpExtensionRtpStreamId,
+};
+
+RtpHeaderExtensionMap CreateExtensionMap() {
+  RtpHeaderExtensionMap extensions;
+  int id = 1;
+  for (RTPExtensionType type : kExtensionTypes) {
+    extensions.RegisterByType(id++, type);
+  }
+  return extensions;
+}
+
+// Returns a video packet with the first `num_extensions` extensions of
+// `kExtensionTypes`.
+rtc::CopyOnWriteBuffer BuildPacket(const RtpHeaderExtensionMap& extensions,
+                                   int num_extensions) {
+  RtpPacketToSend packet(&extensions);
+  packet.SetPayloadType(96);
+  packet.SetSequenceNumber(4711);
+  packet.SetTimestamp(123456);
+  packet.SetSsrc(0x12345678);
+  for (int i = 0; i < num_extensions; ++i) {
+    switch (kExtensionTypes[i]) {
+      case kRtpExtensionTransportSequenceNumber:
+        packet.SetExtension<TransportSequenceNumber>(17);
+        break;
+      case kRtpExtensionAbsoluteSendTime:
+        packet.SetExtension<AbsoluteSendTime>(0x123456);
+        break;
+      case kRtpExtensionTransmissionTimeOffset:
+        packet.SetExtension<TransmissionOffset>(90);
+        break;
+      case kRtpExtensionVideoRotation:
+        packet.SetExtension<VideoOrientation>(kVideoRotation_90);
+        break;
+      case kRtpExtensionPlayoutDelay:
+        packet.SetExtension<PlayoutDelayLimits>(VideoPlayoutDelay(0, 100));
+        break;
+      case kRtpExtensionVideoContentType:
+        packet.SetExtension<VideoContentTypeExtension>(
+            VideoContentType::SCREENSHARE);
+        break;
+      case kRtpExtensionVideoFrameTrackingId:
+        packet.SetExtension<VideoFrameTrackingIdExtension>(42);
+        break;
+      case kRtpExtensionAudioLevel:
+        packet.SetExtension<AudioLevel>(/*voice_activity=*/false, 12);
+        break;
+      case kRtpExtensionMid:
+        packet.SetExtension<RtpMid>("video");
+        break;
+      case kRtpExtensionRtpStreamId:
+        packet.SetExtension<RtpStreamId>("hi");
+        break;
+      default:
+        break;
+    }
+  }
+  packet.SetPayloadSize(1000);
+  return packet.Buffer();
+}
+
+// Parses a received packet and looks up all extensions the receiver knows,
+// whether the packet has them or not. The argument is the number of
+// extensions in the packet.
+void BM_ParseAndFindExtensions(benchmark::State& state) {
+  const RtpHeaderExtensionMap extensions = CreateExtensionMap();
+  const rtc::CopyOnWriteBuffer buffer =
+      BuildPacket(extensions, state.range(0));
+  RtpPacketReceived packet(&extensions);
+  for (auto _ : state) {
+    bool parsed = packet.Parse(buffer);
+    benchmark::DoNotOptimize(parsed);
+    for (RTPExtensionType type : kExtensionTypes) {
+      benchmark::DoNotOptimize(packet.FindExtension(type));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ParseAndFindExtensions)->Arg(0)->Arg(4)->Arg(10)->ArgName(
+    "extensions");
+
+// A burst of packets as a relay receives it, from 16 streams with four
+// extensions each.
+constexpr size_t kBurstSize = 32;
+
+std::vector<rtc::CopyOnWriteBuffer> BuildBurst(
+    const RtpHeaderExtensionMap& extensions) {
+  std::vector<rtc::CopyOnWriteBuffer> burst;
+  for (size_t i = 0; i < kBurstSize; ++i) {
+    rtc::CopyOnWriteBuffer buffer = BuildPacket(extensions, 4);
+    // Vary the SSRC, which is at bytes 8-11, over 16 streams.
+    buffer.MutableData()[11] = static_cast<uint8_t>(i % 16);
+    burst.push_back(buffer);
+  }
+  return burst;
+}
+
+// Parses each packet of a burst in turn, as RtpTransport does.
+void BM_ParseBurst(benchmark::State& state) {
+  const RtpHeaderExtensionMap extensions = CreateExtensionMap();
+  const std::vector<rtc::CopyOnWriteBuffer> burst = BuildBurst(extensions);
+  std::vector<RtpPacketReceived> packets(kBurstSize,
+                                         RtpPacketReceived(&extensions));
+  for (auto _ : state) {
+    for (size_t i = 0; i < kBurstSize; ++i) {
+      bool parsed = packets[i].Parse(burst[i]);
+      benchmark::DoNotOptimize(parsed);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kBurstSize);
+}
+
+BENCHMARK(BM_ParseBurst);
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core, median of 5):
+Linear search of extension entries:
+BM_ParseAndFindExtensions/extensions:0        80.7 ns
+BM_ParseAndFindExtensions/extensions:4         169 ns
+BM_ParseAndFindExtensions/extensions:10        300 ns
+Id-indexed extension entries:
+BM_ParseAndFindExtensions/extensions:0        85.6 ns
+BM_ParseAndFindExtensions/extensions:4         159 ns
+BM_ParseAndFindExtensions/extensions:10        238 ns
+Bursts of 32 packets with 4 extensions from 16 streams:
+BM_ParseBurst                                 2760 ns
+*/
@@ -23,6 +23,11 @@
 
 namespace webrtc {
 
+namespace {
+// Number of slots the history starts out with, when a packet is first stored.
+constexpr size_t kMinNumSlots = 16;
+}  // namespace
+
 constexpr size_t RtpPacketHistory::kMaxCapacity;
 constexpr size_t RtpPacketHistory::kMaxPaddingHistory;
 constexpr int64_t RtpPacketHistory::kMinPacketDurationMs;
@@ -51,27 +56,8 @@ RtpPacketHistory::StoredPacket& RtpPacketHistory::StoredPacket::operator=(
     RtpPacketHistory::StoredPacket&&) = default;
 RtpPacketHistory::StoredPacket::~StoredPacket() = default;
 
-void RtpPacketHistory::StoredPacket::IncrementTimesRetransmitted(
-    PacketPrioritySet* priority_set) {
-  // Check if this StoredPacket is in the priority set. If so, we need to remove
-  // it before updating `times_retransmitted_` since that is used in sorting,
-  // and then add it back.
-  const bool in_priority_set = priority_set && priority_set->erase(this) > 0;
-  ++times_retransmitted_;
-  if (in_priority_set) {
-    auto it = priority_set->insert(this);
-    RTC_DCHECK(it.second)
-        << "ERROR: Priority set already contains matching packet! In set: "
-           "insert order = "
-        << (*it.first)->insert_order_
-        << ", times retransmitted = " << (*it.first)->times_retransmitted_
-        << ". Trying to add: insert order = " << insert_order_
-        << ", times retransmitted = " << times_retransmitted_;
-  }
-}
-
-bool RtpPacketHistory::MoreUseful::operator()(StoredPacket* lhs,
-                                              StoredPacket* rhs) const {
+bool RtpPacketHistory::MoreUseful::operator()(const StoredPacket* lhs,
+                                              const StoredPacket* rhs) const {
   // Prefer to send packets we haven't already sent as padding.
   if (lhs->times_retransmitted() != rhs->times_retransmitted()) {
     return lhs->times_retransmitted() < rhs->times_retransmitted();
@@ -86,7 +72,11 @@ RtpPacketHistory::RtpPacketHistory(Clock* clock, bool enable_padding_prio)
       number_to_store_(0),
       mode_(StorageMode::kDisabled),
       rtt_ms_(-1),
-      packets_inserted_(0) {}
+      first_sequence_number_(0),
+      num_packets_(0),
+      packets_inserted_(0) {
+  padding_priority_.reserve(kMaxPaddingHistory);
+}
 
 RtpPacketHistory::~RtpPacketHistory() {}
 
@@ -134,37 +124,40 @@ void RtpPacketHistory::PutRtpPacket(std::unique_ptr<RtpPacketToSend> packet,
   // Store packet.
   const uint16_t rtp_seq_no = packet->SequenceNumber();
   int packet_index = GetPacketIndex(rtp_seq_no);
-  if (packet_index >= 0 &&
-      static_cast<size_t>(packet_index) < packet_history_.size() &&
-      packet_history_[packet_index].packet_ != nullptr) {
+  if (packet_index >= 0 && static_cast<size_t>(packet_index) < num_packets_ &&
+      PacketAt(packet_index).packet_ != nullptr) {
     RTC_LOG(LS_WARNING) << "Duplicate packet inserted: " << rtp_seq_no;
     // Remove previous packet to avoid inconsistent state.
     RemovePacket(packet_index);
     packet_index = GetPacketIndex(rtp_seq_no);
   }
 
-  // Packet to be inserted ahead of first packet, expand front.
-  for (; packet_index < 0; ++packet_index) {
-    packet_history_.emplace_front(nullptr, absl::nullopt, 0);
+  if (num_packets_ == 0) {
+    first_sequence_number_ = rtp_seq_no;
   }
-  // Packet to be inserted behind last packet, expand back.
-  while (static_cast<int>(packet_history_.size()) <= packet_index) {
-    packet_history_.emplace_back(nullptr, absl::nullopt, 0);
+  if (packet_index < 0) {
+    // Packet to be inserted ahead of first packet, expand front.
+    const size_t num_new_packets = -packet_index;
+    EnsureCapacity(num_packets_ + num_new_packets);
+    first_sequence_number_ = rtp_seq_no;
+    num_packets_ += num_new_packets;
+    packet_index = 0;
+  } else if (static_cast<size_t>(packet_index) >= num_packets_) {
+    // Packet to be inserted behind last packet, expand back.
+    EnsureCapacity(packet_index + 1);
+    num_packets_ = packet_index + 1;
   }
 
-  RTC_DCHECK_GE(packet_index, 0);
-  RTC_DCHECK_LT(packet_index, packet_history_.size());
-  RTC_DCHECK(packet_history_[packet_index].packet_ == nullptr);
-
-  packet_history_[packet_index] =
+  StoredPacket& stored_packet = PacketAt(packet_index);
+  RTC_DCHECK(stored_packet.packet_ == nullptr);
+  stored_packet =
       StoredPacket(std::move(packet), send_time_ms, packets_inserted_++);
 
   if (enable_padding_prio_) {
     if (padding_priority_.size() >= kMaxPaddingHistory - 1) {
-      padding_priority_.erase(std::prev(padding_priority_.end()));
+      padding_priority_.pop_back();
     }
-    auto prio_it = padding_priority_.insert(&packet_history_[packet_index]);
-    RTC_DCHECK(prio_it.second) << "Failed to insert packet into prio set.";
+    AddToPaddingPriority(&stored_packet);
   }
 }
 
@@ -186,8 +179,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPacketAndSetSendTime(
   }
 
   if (packet->send_time_ms_) {
-    packet->IncrementTimesRetransmitted(
-        enable_padding_prio_ ? &padding_priority_ : nullptr);
+    IncrementTimesRetransmitted(packet);
   }
 
   // Update send-time and mark as no long in pacer queue.
@@ -257,8 +249,7 @@ void RtpPacketHistory::MarkPacketAsSent(uint16_t sequence_number) {
   // transmission count.
   packet->send_time_ms_ = clock_->TimeInMilliseconds();
   packet->pending_transmission_ = false;
-  packet->IncrementTimesRetransmitted(enable_padding_prio_ ? &padding_priority_
-                                                           : nullptr);
+  IncrementTimesRetransmitted(packet);
 }
 
 absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
@@ -269,11 +260,10 @@ absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
   }
 
   int packet_index = GetPacketIndex(sequence_number);
-  if (packet_index < 0 ||
-      static_cast<size_t>(packet_index) >= packet_history_.size()) {
+  if (packet_index < 0 || static_cast<size_t>(packet_index) >= num_packets_) {
     return absl::nullopt;
   }
-  const StoredPacket& packet = packet_history_[packet_index];
+  const StoredPacket& packet = PacketAt(packet_index);
   if (packet.packet_ == nullptr) {
     return absl::nullopt;
   }
@@ -318,14 +308,12 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
 
   StoredPacket* best_packet = nullptr;
   if (enable_padding_prio_ && !padding_priority_.empty()) {
-    auto best_packet_it = padding_priority_.begin();
-    best_packet = *best_packet_it;
-  } else if (!enable_padding_prio_ && !packet_history_.empty()) {
+    best_packet = padding_priority_.front();
+  } else if (!enable_padding_prio_) {
     // Prioritization not available, pick the last packet.
-    for (auto it = packet_history_.rbegin(); it != packet_history_.rend();
-         ++it) {
-      if (it->packet_ != nullptr) {
-        best_packet = &(*it);
+    for (int i = static_cast<int>(num_packets_) - 1; i >= 0; --i) {
+      if (PacketAt(i).packet_ != nullptr) {
+        best_packet = &PacketAt(i);
         break;
       }
     }
@@ -349,8 +337,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
   }
 
   best_packet->send_time_ms_ = clock_->TimeInMilliseconds();
-  best_packet->IncrementTimesRetransmitted(
-      enable_padding_prio_ ? &padding_priority_ : nullptr);
+  IncrementTimesRetransmitted(best_packet);
 
   return padding_packet;
 }
@@ -361,7 +348,8 @@ void RtpPacketHistory::CullAcknowledgedPackets(
   for (uint16_t sequence_number : sequence_numbers) {
     int packet_index = GetPacketIndex(sequence_number);
     if (packet_index < 0 ||
-        static_cast<size_t>(packet_index) >= packet_history_.size()) {
+        static_cast<size_t>(packet_index) >= num_packets_ ||
+        PacketAt(packet_index).packet_ == nullptr) {
       continue;
     }
     RemovePacket(packet_index);
@@ -390,21 +378,23 @@ void RtpPacketHistory::Clear() {
 
 void RtpPacketHistory::Reset() {
   packet_history_.clear();
+  packet_history_.shrink_to_fit();
+  num_packets_ = 0;
   padding_priority_.clear();
 }
 
 void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
   int64_t packet_duration_ms =
       std::max(kMinPacketDurationRtt * rtt_ms_, kMinPacketDurationMs);
-  while (!packet_history_.empty()) {
-    if (packet_history_.size() >= kMaxCapacity) {
+  while (num_packets_ > 0) {
+    if (num_packets_ >= kMaxCapacity) {
       // We have reached the absolute max capacity, remove one packet
       // unconditionally.
       RemovePacket(0);
       continue;
     }
 
-    const StoredPacket& stored_packet = packet_history_.front();
+    const StoredPacket& stored_packet = PacketAt(0);
     if (stored_packet.pending_transmission_) {
       // Don't remove packets in the pacer queue, pending tranmission.
       return;
@@ -415,7 +405,7 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
       return;
     }
 
-    if (packet_history_.size() >= number_to_store_ ||
+    if (num_packets_ >= number_to_store_ ||
         *stored_packet.send_time_ms_ +
                 (packet_duration_ms * kPacketCullingDelayFactor) <=
             now_ms) {
@@ -431,19 +421,20 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
 
 std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
     int packet_index) {
+  StoredPacket& stored_packet = PacketAt(packet_index);
   // Move the packet out from the StoredPacket container.
   std::unique_ptr<RtpPacketToSend> rtp_packet =
-      std::move(packet_history_[packet_index].packet_);
+      std::move(stored_packet.packet_);
 
   // Erase from padding priority set, if eligible.
   if (enable_padding_prio_) {
-    padding_priority_.erase(&packet_history_[packet_index]);
+    RemoveFromPaddingPriority(&stored_packet);
   }
 
   if (packet_index == 0) {
-    while (!packet_history_.empty() &&
-           packet_history_.front().packet_ == nullptr) {
-      packet_history_.pop_front();
+    while (num_packets_ > 0 && PacketAt(0).packet_ == nullptr) {
+      ++first_sequence_number_;
+      --num_packets_;
     }
   }
 
@@ -451,12 +442,12 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
 }
 
 int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
-  if (packet_history_.empty()) {
+  if (num_packets_ == 0) {
     return 0;
   }
 
-  RTC_DCHECK(packet_history_.front().packet_ != nullptr);
-  int first_seq = packet_history_.front().packet_->SequenceNumber();
+  RTC_DCHECK(PacketAt(0).packet_ != nullptr);
+  int first_seq = first_sequence_number_;
   if (first_seq == sequence_number) {
     return 0;
   }
@@ -477,14 +468,87 @@ int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
   return packet_index;
 }
 
+RtpPacketHistory::StoredPacket& RtpPacketHistory::PacketAt(int packet_index) {
+  RTC_DCHECK_GE(packet_index, 0);
+  RTC_DCHECK_LT(packet_index, num_packets_);
+  // The number of slots is a power of two no larger than the sequence number
+  // space, so the slot of a sequence number doesn't change when it wraps.
+  const uint16_t sequence_number = first_sequence_number_ + packet_index;
+  return packet_history_[sequence_number & (packet_history_.size() - 1)];
+}
+
+const RtpPacketHistory::StoredPacket& RtpPacketHistory::PacketAt(
+    int packet_index) const {
+  return const_cast<RtpPacketHistory*>(this)->PacketAt(packet_index);
+}
+
 RtpPacketHistory::StoredPacket* RtpPacketHistory::GetStoredPacket(
     uint16_t sequence_number) {
   int index = GetPacketIndex(sequence_number);
-  if (index < 0 || static_cast<size_t>(index) >= packet_history_.size() ||
-      packet_history_[index].packet_ == nullptr) {
+  if (index < 0 || static_cast<size_t>(index) >= num_packets_ ||
+      PacketAt(index).packet_ == nullptr) {
     return nullptr;
   }
-  return &packet_history_[index];
+  return &PacketAt(index);
+}
+
+void RtpPacketHistory::EnsureCapacity(size_t num_packets) {
+  if (num_packets <= packet_history_.size()) {
+    return;
+  }
+  size_t num_slots = std::max(kMinNumSlots, packet_history_.size());
+  while (num_slots < num_packets) {
+    num_slots *= 2;
+  }
+  RTC_DCHECK_LE(num_slots, std::numeric_limits<uint16_t>::max() + 1);
+  std::vector<StoredPacket> new_history;
+  new_history.reserve(num_slots);
+  for (size_t i = 0; i < num_slots; ++i) {
+    new_history.emplace_back(nullptr, absl::nullopt, 0);
+  }
+  const size_t mask = num_slots - 1;
+  // Point the padding priority set at the new slots, while the packets are
+  // still in the old ones to tell their sequence numbers.
+  for (StoredPacket*& stored_packet : padding_priority_) {
+    stored_packet =
+        &new_history[stored_packet->packet_->SequenceNumber() & mask];
+  }
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const uint16_t sequence_number = first_sequence_number_ + i;
+    new_history[sequence_number & mask] = std::move(PacketAt(i));
+  }
+  packet_history_.swap(new_history);
+}
+
+void RtpPacketHistory::IncrementTimesRetransmitted(StoredPacket* packet) {
+  // Check if the packet is in the priority set. If so, we need to remove it
+  // before updating its retransmission count since that is used in sorting,
+  // and then add it back.
+  const bool in_priority_set =
+      enable_padding_prio_ && RemoveFromPaddingPriority(packet);
+  packet->IncrementTimesRetransmitted();
+  if (in_priority_set) {
+    AddToPaddingPriority(packet);
+  }
+}
+
+void RtpPacketHistory::AddToPaddingPriority(StoredPacket* packet) {
+  auto it = std::upper_bound(padding_priority_.begin(),
+                             padding_priority_.end(), packet, MoreUseful());
+  RTC_DCHECK(it == padding_priority_.begin() || *std::prev(it) != packet)
+      << "Priority set already contains packet with insert order "
+      << packet->insert_order();
+  padding_priority_.insert(it, packet);
+}
+
+bool RtpPacketHistory::RemoveFromPaddingPriority(StoredPacket* packet) {
+  auto it = std::lower_bound(padding_priority_.begin(),
+                             padding_priority_.end(), packet, MoreUseful());
+  if (it == padding_priority_.end() || *it != packet) {
+    return false;
+  }
+  padding_priority_.erase(it);
+  return true;
 }
 
 RtpPacketHistory::PacketState RtpPacketHistory::StoredPacketToPacketState(
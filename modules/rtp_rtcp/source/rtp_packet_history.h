@@ -11,10 +11,7 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 
-#include <deque>
-#include <map>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "api/function_view.h"
@@ -140,10 +137,6 @@ class RtpPacketHistory {
   void Clear();
 
  private:
-  struct MoreUseful;
-  class StoredPacket;
-  using PacketPrioritySet = std::set<StoredPacket*, MoreUseful>;
-
   class StoredPacket {
    public:
     StoredPacket(std::unique_ptr<RtpPacketToSend> packet,
@@ -155,7 +148,7 @@ class RtpPacketHistory {
 
     uint64_t insert_order() const { return insert_order_; }
     size_t times_retransmitted() const { return times_retransmitted_; }
-    void IncrementTimesRetransmitted(PacketPrioritySet* priority_set);
+    void IncrementTimesRetransmitted() { ++times_retransmitted_; }
 
     // The time of last transmission, including retransmissions.
     absl::optional<int64_t> send_time_ms_;
@@ -175,7 +168,7 @@ class RtpPacketHistory {
     size_t times_retransmitted_;
   };
   struct MoreUseful {
-    bool operator()(StoredPacket* lhs, StoredPacket* rhs) const;
+    bool operator()(const StoredPacket* lhs, const StoredPacket* rhs) const;
   };
 
   // Helper method used by GetPacketAndSetSendTime() and GetPacketState() to
@@ -188,10 +181,29 @@ class RtpPacketHistory {
   // stored. Returns the RTP packet instance contained within the StoredPacket.
   std::unique_ptr<RtpPacketToSend> RemovePacket(int packet_index)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the index of `sequence_number` relative to the first packet in the
+  // history, which may be negative or beyond the last packet.
   int GetPacketIndex(uint16_t sequence_number) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the slot of the packet at `packet_index`, which must be within the
+  // history.
+  StoredPacket& PacketAt(int packet_index) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  const StoredPacket& PacketAt(int packet_index) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   StoredPacket* GetStoredPacket(uint16_t sequence_number)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Grows `packet_history_` to fit at least `num_packets` consecutive
+  // sequence numbers.
+  void EnsureCapacity(size_t num_packets) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Increments the retransmission count of `packet`, keeping
+  // `padding_priority_` sorted.
+  void IncrementTimesRetransmitted(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void AddToPaddingPriority(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns true if `packet` was in `padding_priority_`.
+  bool RemoveFromPaddingPriority(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   static PacketState StoredPacketToPacketState(
       const StoredPacket& stored_packet);
 
@@ -202,19 +214,22 @@ class RtpPacketHistory {
   StorageMode mode_ RTC_GUARDED_BY(lock_);
   int64_t rtt_ms_ RTC_GUARDED_BY(lock_);
 
-  // Queue of stored packets, ordered by sequence number, with older packets in
-  // the front and new packets being added to the back. Note that there may be
-  // wrap-arounds so the back may have a lower sequence number.
-  // Packets may also be removed out-of-order, in which case there will be
-  // instances of StoredPacket with `packet_` set to nullptr. The first and last
-  // entry in the queue will however always be populated.
-  std::deque<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  // Ring buffer of stored packets, with a power of two number of slots,
+  // indexed by sequence number. The `num_packets_` slots from the one of
+  // `first_sequence_number_` hold the history, with older packets first. Note
+  // that there may be wrap-arounds so the last packet may have a lower
+  // sequence number. Packets may also be removed out-of-order, in which case
+  // there will be instances of StoredPacket with `packet_` set to nullptr. The
+  // first and last packet in the history will however always be populated.
+  std::vector<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  uint16_t first_sequence_number_ RTC_GUARDED_BY(lock_);
+  size_t num_packets_ RTC_GUARDED_BY(lock_);
 
   // Total number of packets with inserted.
   uint64_t packets_inserted_ RTC_GUARDED_BY(lock_);
-  // Objects from `packet_history_` ordered by "most likely to be useful", used
-  // in GetPayloadPaddingPacket().
-  PacketPrioritySet padding_priority_ RTC_GUARDED_BY(lock_);
+  // Up to `kMaxPaddingHistory` - 1 objects from `packet_history_`, sorted by
+  // "most likely to be useful", used in GetPayloadPaddingPacket().
+  std::vector<StoredPacket*> padding_priority_ RTC_GUARDED_BY(lock_);
 };
 }  // namespace webrtc
 #endif  // MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "modules/rtp_rtcp/source/rtp_packet_history.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/random.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kNumPacketsToStore = 600;
+constexpr int64_t kRttMs = 100;
+constexpr int kPacketsPerMs = 2;
+constexpr size_t kPayloadSize = 1100;
+
+// Sends packets through the history as RTPSender and the pacer do, with 20%
+// of them lost. Lost packets are NACKed an RTT later, retransmitted, and
+// received packets are acknowledged by transport feedback. The packet pacer
+// asks for padding every millisecond. The argument is whether padding
+// prioritization is enabled.
+void BM_NackLoad(benchmark::State& state) {
+  SimulatedClock clock(123456);
+  RtpPacketHistory history(&clock, /*enable_padding_prio=*/state.range(0) != 0);
+  history.SetStorePacketsStatus(RtpPacketHistory::StorageMode::kStoreAndCull,
+                                kNumPacketsToStore);
+  history.SetRtt(kRttMs);
+  Random random(4711);
+  uint16_t sequence_number = 0;
+  // Sequence numbers of packets sent each millisecond of the last RTT, which
+  // are NACKed or acknowledged once the RTT has passed.
+  std::vector<std::vector<uint16_t>> lost(kRttMs);
+  std::vector<std::vector<uint16_t>> received(kRttMs);
+  int64_t retransmissions = 0;
+
+  for (auto _ : state) {
+    const size_t slot = clock.TimeInMilliseconds() % kRttMs;
+    for (uint16_t nacked : lost[slot]) {
+      std::unique_ptr<RtpPacketToSend> packet =
+          history.GetPacketAndMarkAsPending(nacked);
+      if (packet) {
+        history.MarkPacketAsSent(nacked);
+        ++retransmissions;
+      }
+    }
+    lost[slot].clear();
+    history.CullAcknowledgedPackets(received[slot]);
+    received[slot].clear();
+
+    for (int i = 0; i < kPacketsPerMs; ++i) {
+      auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+      packet->SetSequenceNumber(sequence_number);
+      packet->SetPayloadSize(kPayloadSize);
+      packet->set_allow_retransmission(true);
+      history.PutRtpPacket(std::move(packet), absl::nullopt);
+      benchmark::DoNotOptimize(
+          history.GetPacketAndSetSendTime(sequence_number));
+      if (random.Rand(0, 4) == 0) {
+        lost[slot].push_back(sequence_number);
+      } else {
+        received[slot].push_back(sequence_number);
+      }
+      ++sequence_number;
+    }
+    benchmark::DoNotOptimize(history.GetPayloadPaddingPacket());
+    clock.AdvanceTimeMilliseconds(1);
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerMs);
+  state.counters["retransmissions"] = benchmark::Counter(
+      retransmissions, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_NackLoad)->Arg(0)->Arg(1)->ArgName("padding_prio");
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core, median of 7), per millisecond of traffic:
+Deque and std::set based history:
+BM_NackLoad/padding_prio:0       1095 ns
+BM_NackLoad/padding_prio:1       1549 ns
+Ring buffer and sorted array based history:
+BM_NackLoad/padding_prio:0       1142 ns
+BM_NackLoad/padding_prio:1       1362 ns
+*/
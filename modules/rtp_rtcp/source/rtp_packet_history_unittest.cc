@@ -835,6 +835,49 @@ TEST_P(RtpPacketHistoryTest, UsesLastPacketAsPaddingWithPrioOff) {
   EXPECT_EQ(hist_.GetPayloadPaddingPacket(), nullptr);
 }
 
+TEST_P(RtpPacketHistoryTest, KeepsPacketsWhenGrowing) {
+  const size_t kNumPackets = 3000;
+  hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, kNumPackets);
+  // Insert every other packet first, in reverse order, and then the rest, to
+  // grow the history both at the front and at the back.
+  for (size_t i = 0; i < kNumPackets; i += 2) {
+    hist_.PutRtpPacket(CreateRtpPacket(To16u(kStartSeqNum - i)),
+                       fake_clock_.TimeInMilliseconds());
+  }
+  for (size_t i = 1; i < kNumPackets; i += 2) {
+    hist_.PutRtpPacket(CreateRtpPacket(To16u(kStartSeqNum - i)),
+                       fake_clock_.TimeInMilliseconds());
+  }
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    absl::optional<RtpPacketHistory::PacketState> packet_state =
+        hist_.GetPacketState(To16u(kStartSeqNum - i));
+    ASSERT_TRUE(packet_state);
+    EXPECT_EQ(packet_state->rtp_sequence_number, To16u(kStartSeqNum - i));
+  }
+  EXPECT_FALSE(hist_.GetPacketState(To16u(kStartSeqNum + 1)));
+  EXPECT_FALSE(hist_.GetPacketState(To16u(kStartSeqNum - kNumPackets)));
+
+  // With prioritization, the last inserted packet is the most useful one,
+  // otherwise the one with the highest sequence number.
+  EXPECT_EQ(hist_.GetPayloadPaddingPacket()->SequenceNumber(),
+            GetParam() ? To16u(kStartSeqNum - (kNumPackets - 1))
+                       : kStartSeqNum);
+}
+
+TEST_P(RtpPacketHistoryTest, RetransmissionSharesPayloadBuffer) {
+  hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, 10);
+  std::unique_ptr<RtpPacketToSend> packet = CreateRtpPacket(kStartSeqNum);
+  packet->SetPayloadSize(1000);
+  const uint8_t* data = packet->data();
+  hist_.PutRtpPacket(std::move(packet), fake_clock_.TimeInMilliseconds());
+
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  std::unique_ptr<RtpPacketToSend> retransmission =
+      hist_.GetPacketAndMarkAsPending(kStartSeqNum);
+  ASSERT_TRUE(retransmission);
+  EXPECT_EQ(retransmission->data(), data);
+}
+
 INSTANTIATE_TEST_SUITE_P(WithAndWithoutPaddingPrio,
                          RtpPacketHistoryTest,
                          ::testing::Bool());
@@ -40,6 +40,8 @@ class RtpPacketToSend : public RtpPacket {
 
   explicit RtpPacketToSend(const ExtensionManager* extensions);
   RtpPacketToSend(const ExtensionManager* extensions, size_t capacity);
+  RtpPacketToSend(const ExtensionManager* extensions,
+                  rtc::CopyOnWriteBuffer buffer);
   RtpPacketToSend(const RtpPacketToSend& packet);
   RtpPacketToSend(RtpPacketToSend&& packet);
 
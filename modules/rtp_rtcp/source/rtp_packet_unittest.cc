@@ -12,6 +12,7 @@
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/copy_on_write_buffer.h"
 #include "rtc_base/random.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -211,6 +212,19 @@ TEST(RtpPacketTest, CreateMinimum) {
   EXPECT_THAT(kMinimumPacket, ElementsAreArray(packet.data(), packet.size()));
 }
 
+TEST(RtpPacketTest, CreateInGivenBuffer) {
+  rtc::CopyOnWriteBuffer buffer(kPacketWithTO, sizeof(kPacketWithTO), 100);
+  const uint8_t* data = buffer.cdata();
+  RtpPacketToSend packet(nullptr, std::move(buffer));
+  packet.SetPayloadType(kPayloadType);
+  packet.SetSequenceNumber(kSeqNum);
+  packet.SetTimestamp(kTimestamp);
+  packet.SetSsrc(kSsrc);
+  EXPECT_THAT(kMinimumPacket, ElementsAreArray(packet.data(), packet.size()));
+  EXPECT_EQ(data, packet.data());
+  EXPECT_EQ(100u, packet.capacity());
+}
+
 TEST(RtpPacketTest, CreateWithExtension) {
   RtpPacketToSend::ExtensionManager extensions;
   extensions.Register<TransmissionOffset>(kTransmissionOffsetExtensionId);
@@ -693,6 +707,29 @@ TEST(RtpPacketTest, ParseSecondPacketWithFewerExtensions) {
   EXPECT_FALSE(packet.HasExtension<AudioLevel>());
 }
 
+TEST(RtpPacketTest, CopyKeepsExtensionsWhenOriginalIsParsedAgain) {
+  RtpPacketToSend::ExtensionManager extensions(/*extmap_allow_mixed=*/true);
+  extensions.Register<TransmissionOffset>(kTransmissionOffsetExtensionId);
+  extensions.Register<AudioLevel>(kAudioLevelExtensionId);
+  extensions.Register<PlayoutDelayLimits>(kTwoByteExtensionId);
+  RtpPacketReceived packet(&extensions);
+  ASSERT_TRUE(packet.Parse(kPacketWithTwoByteExtensionIdFirst,
+                           sizeof(kPacketWithTwoByteExtensionIdFirst)));
+  RtpPacketReceived copy = packet;
+
+  EXPECT_TRUE(packet.Parse(kPacketWithTO, sizeof(kPacketWithTO)));
+  EXPECT_TRUE(packet.HasExtension<TransmissionOffset>());
+  EXPECT_FALSE(packet.HasExtension<AudioLevel>());
+  EXPECT_FALSE(packet.HasExtension<PlayoutDelayLimits>());
+
+  EXPECT_EQ(copy.GetExtension<TransmissionOffset>(), kTimeOffset);
+  EXPECT_TRUE(copy.HasExtension<AudioLevel>());
+  VideoPlayoutDelay playout_delay;
+  ASSERT_TRUE(copy.GetExtension<PlayoutDelayLimits>(&playout_delay));
+  EXPECT_EQ(playout_delay.min_ms, 30);
+  EXPECT_EQ(playout_delay.max_ms, 340);
+}
+
 TEST(RtpPacketTest, ParseWith2ExtensionsInvalidPadding) {
   RtpPacketToSend::ExtensionManager extensions;
   extensions.Register<TransmissionOffset>(kTransmissionOffsetExtensionId);
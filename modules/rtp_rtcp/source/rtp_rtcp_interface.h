@@ -28,6 +28,7 @@
 #include "modules/rtp_rtcp/source/rtp_sequence_number_map.h"
 #include "modules/rtp_rtcp/source/video_fec_generator.h"
 #include "rtc_base/constructor_magic.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
 #include "system_wrappers/include/ntp_time.h"
 
 namespace webrtc {
@@ -91,6 +92,10 @@ class RtpRtcpInterface : public RtcpFeedbackSenderInterface {
     // Spread any bursts of packets into smaller bursts to minimize packet loss.
     RtpPacketSender* paced_sender = nullptr;
 
+    // If set, media and padding packets are built in storage taken from this
+    // pool, which may be shared by all RTP modules sending on a transport.
+    rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> packet_buffer_pool;
+
     // Generates FEC packets.
     // TODO(sprang): Wire up to RtpSenderEgress.
     VideoFecGenerator* fec_generator = nullptr;
@@ -175,6 +175,7 @@ RTPSender::RTPSender(const RtpRtcpInterface::Configuration& config,
       max_padding_size_factor_(GetMaxPaddingSizeFactor(config.field_trials)),
       packet_history_(packet_history),
       paced_sender_(packet_sender),
+      packet_buffer_pool_(config.packet_buffer_pool),
       sending_media_(true),                   // Default to sending media.
       max_packet_size_(IP_PACKET_SIZE - 28),  // Default is IP-v4/UDP.
       rtp_header_extension_map_(config.extmap_allow_mixed),
@@ -433,8 +434,8 @@ std::vector<std::unique_ptr<RtpPacketToSend>> RTPSender::GeneratePadding(
   }
 
   while (bytes_left > 0) {
-    auto padding_packet =
-        std::make_unique<RtpPacketToSend>(&rtp_header_extension_map_);
+    std::unique_ptr<RtpPacketToSend> padding_packet =
+        CreatePacket(IP_PACKET_SIZE);
     padding_packet->set_packet_type(RtpPacketMediaType::kPadding);
     padding_packet->SetMarker(false);
     if (rtx_ == kRtxOff) {
@@ -537,8 +538,8 @@ std::unique_ptr<RtpPacketToSend> RTPSender::AllocatePacket() const {
   // While sending slightly oversized packet increase chance of dropped packet,
   // it is better than crash on drop packet without trying to send it.
   static constexpr int kExtraCapacity = 16;
-  auto packet = std::make_unique<RtpPacketToSend>(
-      &rtp_header_extension_map_, max_packet_size_ + kExtraCapacity);
+  std::unique_ptr<RtpPacketToSend> packet =
+      CreatePacket(max_packet_size_ + kExtraCapacity);
   packet->SetSsrc(ssrc_);
   packet->SetCsrcs(csrcs_);
   // Reserve extensions, if registered, RtpSender set in SendToNetwork.
@@ -733,6 +734,16 @@ std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
   return rtx_packet;
 }
 
+std::unique_ptr<RtpPacketToSend> RTPSender::CreatePacket(
+    size_t capacity) const {
+  if (!packet_buffer_pool_) {
+    return std::make_unique<RtpPacketToSend>(&rtp_header_extension_map_,
+                                             capacity);
+  }
+  return std::make_unique<RtpPacketToSend>(
+      &rtp_header_extension_map_, packet_buffer_pool_->Allocate(capacity));
+}
+
 void RTPSender::SetRtpState(const RtpState& rtp_state) {
   MutexLock lock(&send_mutex_);
 
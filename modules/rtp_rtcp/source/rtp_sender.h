@@ -30,6 +30,7 @@
 #include "modules/rtp_rtcp/source/rtp_packet_history.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_interface.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
 #include "rtc_base/random.h"
 #include "rtc_base/rate_statistics.h"
 #include "rtc_base/synchronization/mutex.h"
@@ -173,6 +174,11 @@ class RTPSender {
 
   bool IsFecPacket(const RtpPacketToSend& packet) const;
 
+  // Returns an empty packet with room for at least `capacity` bytes, stored
+  // in `packet_buffer_pool_` if set.
+  std::unique_ptr<RtpPacketToSend> CreatePacket(size_t capacity) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(send_mutex_);
+
   void UpdateHeaderSizes() RTC_EXCLUSIVE_LOCKS_REQUIRED(send_mutex_);
 
   void UpdateLastPacketState(const RtpPacketToSend& packet)
@@ -192,6 +198,7 @@ class RTPSender {
 
   RtpPacketHistory* const packet_history_;
   RtpPacketSender* const paced_sender_;
+  const rtc::scoped_refptr<rtc::CopyOnWriteBufferPool> packet_buffer_pool_;
 
   std::unique_ptr<RtpPacketToSend> last_audio_packet;
   mutable Mutex send_mutex_;
@@ -32,6 +32,7 @@
 #include "modules/rtp_rtcp/source/rtp_sender_video.h"
 #include "modules/rtp_rtcp/source/video_fec_generator.h"
 #include "rtc_base/arraysize.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/rate_limiter.h"
 #include "rtc_base/strings/string_builder.h"
@@ -320,6 +321,25 @@ TEST_F(RtpSenderTest, AllocatePacketReserveExtensions) {
   EXPECT_FALSE(packet->HasExtension<VideoOrientation>());
 }
 
+TEST_F(RtpSenderTest, AllocatesPacketsInBufferPool) {
+  auto pool = rtc::CopyOnWriteBufferPool::Create(IP_PACKET_SIZE, 4);
+  RtpRtcpInterface::Configuration config = GetDefaultConfig();
+  config.packet_buffer_pool = pool;
+  CreateSender(config);
+
+  const uint8_t* data;
+  {
+    std::unique_ptr<RtpPacketToSend> packet = rtp_sender_->AllocatePacket();
+    data = packet->data();
+    EXPECT_EQ(IP_PACKET_SIZE, packet->capacity());
+  }
+  std::unique_ptr<RtpPacketToSend> packet = rtp_sender_->AllocatePacket();
+  EXPECT_EQ(data, packet->data());
+  EXPECT_EQ(rtp_sender_->SSRC(), packet->Ssrc());
+  EXPECT_EQ(1, pool->GetStats().allocations);
+  EXPECT_EQ(1, pool->GetStats().reuses);
+}
+
 TEST_F(RtpSenderTest, PaddingAlwaysAllowedOnAudio) {
   RtpRtcpInterface::Configuration config = GetDefaultConfig();
   config.audio = true;
@@ -0,0 +1,239 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * Compares the residual loss of FlexFEC and of the Reed-Solomon FEC scheme
+ * for a video stream sent over a simulated network with bursty loss, at the
+ * same overhead.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "api/test/simulated_network.h"
+#include "call/simulated_network.h"
+#include "modules/include/module_fec_types.h"
+#include "modules/rtp_rtcp/include/flexfec_receiver.h"
+#include "modules/rtp_rtcp/include/flexfec_sender.h"
+#include "modules/rtp_rtcp/include/reed_solomon_fec_receiver.h"
+#include "modules/rtp_rtcp/include/reed_solomon_fec_sender.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "modules/rtp_rtcp/source/video_fec_generator.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr int kFecPayloadType = 96;
+constexpr uint32_t kMediaSsrc = 1234;
+constexpr uint32_t kFecSsrc = 5678;
+constexpr int kNumFrames = 3000;
+constexpr int kPacketsPerFrame = 10;
+constexpr int kFrameIntervalMs = 33;
+constexpr size_t kPayloadSize = 1000;
+// 3 FEC packets for every 10 media packets.
+constexpr int kFecRate = 77;
+constexpr int kLossPercent = 5;
+
+class RecoveredPacketCounter : public RecoveredPacketReceiver {
+ public:
+  void OnRecoveredPacket(const uint8_t* packet, size_t length) override {
+    recovered_seq_nums_.insert(
+        ByteReader<uint16_t>::ReadBigEndian(packet + 2));
+  }
+
+  const std::set<uint16_t>& recovered_seq_nums() const {
+    return recovered_seq_nums_;
+  }
+
+ private:
+  std::set<uint16_t> recovered_seq_nums_;
+};
+
+struct LossStats {
+  int media_packets = 0;
+  int fec_packets = 0;
+  int lost_media_packets = 0;
+  int unrecovered_media_packets = 0;
+  // Frames that lost packets on the network, and frames still missing media
+  // packets after recovery.
+  int damaged_frames = 0;
+  int unrecovered_frames = 0;
+  // Frames still missing media packets even though no more packets were lost
+  // than FEC packets were sent for the frame.
+  int unrecovered_frames_within_fec_capacity = 0;
+};
+
+// Sends `kNumFrames` frames through `fec_generator` and a network with
+// `kLossPercent` loss in bursts of `avg_burst_loss_length` packets on
+// average, and feeds the received packets to `receive_packet`.
+template <typename ReceivePacket>
+LossStats SendOverBurstyNetwork(VideoFecGenerator* fec_generator,
+                                int avg_burst_loss_length,
+                                SimulatedClock* clock,
+                                const RecoveredPacketCounter& recovered,
+                                ReceivePacket receive_packet) {
+  BuiltInNetworkBehaviorConfig config;
+  config.loss_percent = kLossPercent;
+  config.avg_burst_loss_length = avg_burst_loss_length;
+  SimulatedNetwork network(config, /*random_seed=*/4711);
+
+  LossStats stats;
+  std::vector<RtpPacketReceived> packets_in_flight;
+  std::vector<std::vector<uint16_t>> lost_seq_nums_per_frame;
+  std::vector<bool> frame_within_fec_capacity;
+  uint16_t seq_num = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    packets_in_flight.clear();
+    int num_fec_packets = 0;
+    for (int i = 0; i < kPacketsPerFrame; ++i) {
+      RtpPacketToSend packet(nullptr);
+      packet.SetSsrc(kMediaSsrc);
+      packet.SetSequenceNumber(seq_num++);
+      packet.SetTimestamp(frame * 90 * kFrameIntervalMs);
+      packet.SetMarker(i == kPacketsPerFrame - 1);
+      packet.AllocatePayload(kPayloadSize)[0] = static_cast<uint8_t>(i);
+      fec_generator->AddPacketAndGenerateFec(packet);
+      packets_in_flight.emplace_back();
+      packets_in_flight.back().Parse(packet.Buffer());
+      for (const auto& fec_packet : fec_generator->GetFecPackets()) {
+        packets_in_flight.emplace_back();
+        packets_in_flight.back().Parse(fec_packet->Buffer());
+        ++num_fec_packets;
+      }
+    }
+    stats.media_packets += kPacketsPerFrame;
+    stats.fec_packets += num_fec_packets;
+
+    for (size_t i = 0; i < packets_in_flight.size(); ++i) {
+      network.EnqueuePacket(PacketInFlightInfo(
+          packets_in_flight[i].size(), clock->TimeInMicroseconds(), i));
+    }
+    clock->AdvanceTimeMilliseconds(kFrameIntervalMs);
+    int num_lost_packets = 0;
+    lost_seq_nums_per_frame.emplace_back();
+    for (const PacketDeliveryInfo& delivery :
+         network.DequeueDeliverablePackets(clock->TimeInMicroseconds())) {
+      const RtpPacketReceived& packet = packets_in_flight[delivery.packet_id];
+      if (delivery.receive_time_us != PacketDeliveryInfo::kNotReceived) {
+        receive_packet(packet);
+        continue;
+      }
+      ++num_lost_packets;
+      if (packet.Ssrc() == kMediaSsrc) {
+        lost_seq_nums_per_frame.back().push_back(packet.SequenceNumber());
+      }
+    }
+    frame_within_fec_capacity.push_back(num_lost_packets <= num_fec_packets);
+  }
+
+  for (size_t frame = 0; frame < lost_seq_nums_per_frame.size(); ++frame) {
+    const std::vector<uint16_t>& lost_seq_nums = lost_seq_nums_per_frame[frame];
+    int unrecovered = 0;
+    for (uint16_t lost_seq_num : lost_seq_nums) {
+      if (recovered.recovered_seq_nums().count(lost_seq_num) == 0) {
+        ++unrecovered;
+      }
+    }
+    stats.lost_media_packets += lost_seq_nums.size();
+    stats.unrecovered_media_packets += unrecovered;
+    if (!lost_seq_nums.empty()) {
+      ++stats.damaged_frames;
+    }
+    if (unrecovered > 0) {
+      ++stats.unrecovered_frames;
+      if (frame_within_fec_capacity[frame]) {
+        ++stats.unrecovered_frames_within_fec_capacity;
+      }
+    }
+  }
+  return stats;
+}
+
+LossStats SimulateFlexfec(int avg_burst_loss_length) {
+  SimulatedClock clock(1);
+  FlexfecSender sender(kFecPayloadType, kFecSsrc, kMediaSsrc, /*mid=*/"",
+                       /*rtp_header_extensions=*/{},
+                       /*extension_sizes=*/{}, /*rtp_state=*/nullptr, &clock);
+  FecProtectionParams params;
+  params.fec_rate = kFecRate;
+  params.max_fec_frames = 1;
+  params.fec_mask_type = kFecMaskBursty;
+  sender.SetProtectionParameters(params, params);
+  RecoveredPacketCounter recovered;
+  FlexfecReceiver receiver(&clock, kFecSsrc, kMediaSsrc, &recovered);
+  return SendOverBurstyNetwork(
+      &sender, avg_burst_loss_length, &clock, recovered,
+      [&](const RtpPacketReceived& packet) { receiver.OnRtpPacket(packet); });
+}
+
+LossStats SimulateReedSolomonFec(int avg_burst_loss_length) {
+  SimulatedClock clock(1);
+  ReedSolomonFecSender sender(
+      kFecPayloadType, kFecSsrc, kMediaSsrc, /*mid=*/"",
+      /*rtp_header_extensions=*/{},
+      /*extension_sizes=*/{}, /*rtp_state=*/nullptr, &clock);
+  FecProtectionParams params;
+  params.fec_rate = kFecRate;
+  params.max_fec_frames = 1;
+  sender.SetProtectionParameters(params, params);
+  RecoveredPacketCounter recovered;
+  ReedSolomonFecReceiver receiver(&clock, kFecSsrc, kMediaSsrc, &recovered);
+  return SendOverBurstyNetwork(
+      &sender, avg_burst_loss_length, &clock, recovered,
+      [&](const RtpPacketReceived& packet) { receiver.OnRtpPacket(packet); });
+}
+
+class FecBurstLossTest : public ::testing::TestWithParam<int> {};
+
+void PrintStats(const char* name,
+                int avg_burst_loss_length,
+                const LossStats& stats) {
+  printf(
+      "Burst length %d, %s: %d of %d media packets lost, %d unrecovered; "
+      "%d of %d frames damaged, %d unrecovered\n",
+      avg_burst_loss_length, name, stats.lost_media_packets,
+      stats.media_packets, stats.unrecovered_media_packets,
+      stats.damaged_frames, kNumFrames, stats.unrecovered_frames);
+}
+
+TEST_P(FecBurstLossTest, ReedSolomonFecRecoversMoreFramesThanFlexfec) {
+  const int avg_burst_loss_length = GetParam();
+  const LossStats flexfec = SimulateFlexfec(avg_burst_loss_length);
+  const LossStats reed_solomon = SimulateReedSolomonFec(avg_burst_loss_length);
+  PrintStats("FlexFEC", avg_burst_loss_length, flexfec);
+  PrintStats("Reed-Solomon", avg_burst_loss_length, reed_solomon);
+
+  // Same overhead and loss pattern.
+  EXPECT_EQ(flexfec.fec_packets, reed_solomon.fec_packets);
+  EXPECT_EQ(flexfec.lost_media_packets, reed_solomon.lost_media_packets);
+  EXPECT_GT(reed_solomon.damaged_frames, 0);
+  // Any frame that lost no more packets than it has repair packets for is
+  // recovered, which does not hold for the XOR based masks of FlexFEC.
+  EXPECT_EQ(0, reed_solomon.unrecovered_frames_within_fec_capacity);
+  EXPECT_LT(reed_solomon.unrecovered_frames, flexfec.unrecovered_frames);
+}
+
+INSTANTIATE_TEST_SUITE_P(BurstLengths,
+                         FecBurstLossTest,
+                         ::testing::Values(2, 3, 5));
+
+}  // namespace
+}  // namespace test
+}  // namespace webrtc
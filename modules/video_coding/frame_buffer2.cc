@@ -12,12 +12,13 @@
 
 #include <algorithm>
 #include <cstdlib>
-#include <iterator>
-#include <queue>
+#include <limits>
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
+#include "absl/numeric/bits.h"
 #include "api/video/encoded_image.h"
 #include "api/video/video_timing.h"
 #include "modules/video_coding/include/video_coding_defines.h"
@@ -38,6 +39,18 @@ namespace {
 // Max number of frames the buffer will hold.
 constexpr size_t kMaxFramesBuffered = 800;
 
+// Max number of frame ids from the oldest to the newest frame in the buffer.
+// Beyond half the interval of 2^16 the order of the frames is ambiguous.
+constexpr int64_t kMaxFrameIdSpan = 1 << 15;
+
+// Initial number of slots of the frame map, a multiple of 64.
+constexpr size_t kMinFrameMapSlots = 128;
+
+// Number of slots the frame map keeps when it shrinks, enough for
+// `kMaxFramesBuffered` consecutive frame ids so that regular streams don't
+// reallocate as the buffer fills and drains.
+constexpr size_t kMaxRetainedFrameMapSlots = 1024;
+
 // Default value for the maximum decode queue size that is used when the
 // low-latency renderer is used.
 constexpr size_t kZeroPlayoutDelayDefaultMaxDecodeQueueSize = 8;
@@ -50,6 +63,18 @@ constexpr int kMaxFramesHistory = 1 << 13;
 constexpr int kMaxAllowedFrameDelayMs = 5;
 
 constexpr int64_t kLogNonDecodedIntervalMs = 5000;
+
+bool IsSet(const std::vector<uint64_t>& bits, size_t index) {
+  return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+void SetBit(std::vector<uint64_t>& bits, size_t index) {
+  bits[index / 64] |= uint64_t{1} << (index % 64);
+}
+
+void ClearBit(std::vector<uint64_t>& bits, size_t index) {
+  bits[index / 64] &= ~(uint64_t{1} << (index % 64));
+}
 }  // namespace
 
 FrameBuffer::FrameBuffer(Clock* clock,
@@ -142,15 +167,11 @@ int64_t FrameBuffer::FindNextFrame(int64_t now_ms) {
 
   // `last_continuous_frame_` may be empty below, but nullopt is smaller
   // than everything else and loop will immediately terminate as expected.
-  for (auto frame_it = frames_.begin();
-       frame_it != frames_.end() && frame_it->first <= last_continuous_frame_;
-       ++frame_it) {
-    if (!frame_it->second.continuous ||
-        frame_it->second.num_missing_decodable > 0) {
-      continue;
-    }
-
-    EncodedFrame* frame = frame_it->second.frame.get();
+  for (absl::optional<int64_t> frame_id =
+           frames_.FindDecodable(std::numeric_limits<int64_t>::min());
+       frame_id && *frame_id <= last_continuous_frame_;
+       frame_id = frames_.FindDecodable(*frame_id + 1)) {
+    EncodedFrame* frame = frames_.Find(*frame_id)->frame.get();
 
     if (keyframe_required_ && !frame->is_keyframe())
       continue;
@@ -167,28 +188,32 @@ int64_t FrameBuffer::FindNextFrame(int64_t now_ms) {
     }
 
     // Gather all remaining frames for the same superframe.
-    std::vector<FrameMap::iterator> current_superframe;
-    current_superframe.push_back(frame_it);
-    bool last_layer_completed = frame_it->second.frame->is_last_spatial_layer;
-    FrameMap::iterator next_frame_it = frame_it;
+    std::vector<int64_t> current_superframe;
+    current_superframe.push_back(*frame_id);
+    bool last_layer_completed = frame->is_last_spatial_layer;
+    absl::optional<int64_t> next_frame_id = frame_id;
     while (!last_layer_completed) {
-      ++next_frame_it;
+      next_frame_id = frames_.NextId(*next_frame_id);
+      if (!next_frame_id) {
+        break;
+      }
 
-      if (next_frame_it == frames_.end() || !next_frame_it->second.frame) {
+      const FrameInfo& next_frame_info = *frames_.Find(*next_frame_id);
+      if (!next_frame_info.frame) {
         break;
       }
 
-      if (next_frame_it->second.frame->Timestamp() != frame->Timestamp() ||
-          !next_frame_it->second.continuous) {
+      if (next_frame_info.frame->Timestamp() != frame->Timestamp() ||
+          !next_frame_info.continuous) {
         break;
       }
 
-      if (next_frame_it->second.num_missing_decodable > 0) {
+      if (next_frame_info.num_missing_decodable > 0) {
         bool has_inter_layer_dependency = false;
         for (size_t i = 0; i < EncodedFrame::kMaxFrameReferences &&
-                           i < next_frame_it->second.frame->num_references;
+                           i < next_frame_info.frame->num_references;
              ++i) {
-          if (next_frame_it->second.frame->references[i] >= frame_it->first) {
+          if (next_frame_info.frame->references[i] >= *frame_id) {
             has_inter_layer_dependency = true;
             break;
           }
@@ -199,13 +224,13 @@ int64_t FrameBuffer::FindNextFrame(int64_t now_ms) {
         // is within the same temporal unit then the not yet decoded dependency
         // is just a lower spatial frame, which is ok.
         if (!has_inter_layer_dependency ||
-            next_frame_it->second.num_missing_decodable > 1) {
+            next_frame_info.num_missing_decodable > 1) {
           break;
         }
       }
 
-      current_superframe.push_back(next_frame_it);
-      last_layer_completed = next_frame_it->second.frame->is_last_spatial_layer;
+      current_superframe.push_back(*next_frame_id);
+      last_layer_completed = next_frame_info.frame->is_last_spatial_layer;
     }
     // Check if the current superframe is complete.
     // TODO(bugs.webrtc.org/10064): consider returning all available to
@@ -249,7 +274,7 @@ EncodedFrame* FrameBuffer::GetNextFrame() {
   RTC_DCHECK(!frames_to_decode_.empty());
   bool superframe_delayed_by_retransmission = false;
   size_t superframe_size = 0;
-  const EncodedFrame& first_frame = *frames_to_decode_[0]->second.frame;
+  const EncodedFrame& first_frame = *frames_.Find(frames_to_decode_[0])->frame;
   int64_t render_time_ms = first_frame.RenderTime();
   int64_t receive_time_ms = first_frame.ReceivedTime();
   // Gracefully handle bad RTP timestamps and render time issues.
@@ -259,9 +284,10 @@ EncodedFrame* FrameBuffer::GetNextFrame() {
     render_time_ms = timing_->RenderTimeMs(first_frame.Timestamp(), now_ms);
   }
 
-  for (FrameMap::iterator& frame_it : frames_to_decode_) {
-    RTC_DCHECK(frame_it != frames_.end());
-    EncodedFrame* frame = frame_it->second.frame.release();
+  for (int64_t frame_id : frames_to_decode_) {
+    FrameInfo* frame_info = frames_.Find(frame_id);
+    RTC_DCHECK(frame_info);
+    EncodedFrame* frame = frame_info->frame.release();
 
     frame->SetRenderTime(render_time_ms);
 
@@ -269,23 +295,15 @@ EncodedFrame* FrameBuffer::GetNextFrame() {
     receive_time_ms = std::max(receive_time_ms, frame->ReceivedTime());
     superframe_size += frame->size();
 
-    PropagateDecodability(frame_it->second);
-    decoded_frames_history_.InsertDecoded(frame_it->first, frame->Timestamp());
+    PropagateDecodability(*frame_info);
+    decoded_frames_history_.InsertDecoded(frame_id, frame->Timestamp());
 
     // Remove decoded frame and all undecoded frames before it.
-    if (stats_callback_) {
-      unsigned int dropped_frames =
-          std::count_if(frames_.begin(), frame_it,
-                        [](const std::pair<const int64_t, FrameInfo>& frame) {
-                          return frame.second.frame != nullptr;
-                        });
-      if (dropped_frames > 0) {
-        stats_callback_->OnDroppedFrames(dropped_frames);
-      }
+    unsigned int dropped_frames = frames_.EraseUpTo(frame_id);
+    if (stats_callback_ && dropped_frames > 0) {
+      stats_callback_->OnDroppedFrames(dropped_frames);
     }
 
-    frames_.erase(frames_.begin(), ++frame_it);
-
     frames_out.push_back(frame);
   }
 
@@ -383,8 +401,10 @@ void FrameBuffer::UpdateRtt(int64_t rtt_ms) {
 
 bool FrameBuffer::ValidReferences(const EncodedFrame& frame) const {
   for (size_t i = 0; i < frame.num_references; ++i) {
-    if (frame.references[i] >= frame.Id())
+    if (frame.references[i] >= frame.Id() ||
+        frame.Id() - frame.references[i] >= kMaxFrameIdSpan) {
       return false;
+    }
 
     for (size_t j = i + 1; j < frame.num_references; ++j) {
       if (frame.references[i] == frame.references[j])
@@ -454,23 +474,36 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
     }
   }
 
-  // Test if inserting this frame would cause the order of the frames to become
-  // ambiguous (covering more than half the interval of 2^16). This can happen
-  // when the frame id make large jumps mid stream.
-  if (!frames_.empty() && frame->Id() < frames_.begin()->first &&
-      frames_.rbegin()->first < frame->Id()) {
-    RTC_LOG(LS_WARNING) << "A jump in frame id was detected, clearing buffer.";
-    ClearFramesAndHistory();
-    last_continuous_frame_id = -1;
+  // Test if inserting this frame, and the frames it references that have not
+  // been decoded, would cause the order of the frames to become ambiguous
+  // (covering more than half the interval of 2^16). This can happen when the
+  // frame id make large jumps mid stream, or when frames are left undecoded
+  // for long, and is handled like a full buffer.
+  const int64_t frame_id = frame->Id();
+  int64_t first_frame_id = frame_id;
+  for (size_t i = 0; i < frame->num_references; ++i) {
+    if (!last_decoded_frame || frame->references[i] > *last_decoded_frame)
+      first_frame_id = std::min(first_frame_id, frame->references[i]);
+  }
+  if (!frames_.CanInsert(first_frame_id, frame_id)) {
+    if (frame->is_keyframe()) {
+      RTC_LOG(LS_WARNING) << "Inserting keyframe " << frame_id
+                          << " but a jump in frame id was detected, clearing"
+                             " buffer and inserting the frame.";
+      ClearFramesAndHistory();
+    } else {
+      RTC_LOG(LS_WARNING) << "Frame " << frame_id
+                          << " could not be inserted due to a jump in frame "
+                             "id, dropping frame.";
+      return last_continuous_frame_id;
+    }
   }
 
-  auto info = frames_.emplace(frame->Id(), FrameInfo()).first;
-
-  if (info->second.frame) {
+  if (frames_.FindOrInsert(frame_id).frame) {
     return last_continuous_frame_id;
   }
 
-  if (!UpdateFrameInfoWithIncomingFrame(*frame, info))
+  if (!UpdateFrameInfoWithIncomingFrame(*frame))
     return last_continuous_frame_id;
 
   if (!frame->delayed_by_retransmission())
@@ -483,11 +516,14 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
                                      frame->contentType());
   }
 
-  info->second.frame = std::move(frame);
+  // Adding the frames referenced by `frame` may have moved its FrameInfo.
+  FrameInfo& info = *frames_.Find(frame_id);
+  info.frame = std::move(frame);
 
-  if (info->second.num_missing_continuous == 0) {
-    info->second.continuous = true;
-    PropagateContinuity(info);
+  if (info.num_missing_continuous == 0) {
+    info.continuous = true;
+    UpdateDecodability(frame_id, info);
+    PropagateContinuity(frame_id);
     last_continuous_frame_id = *last_continuous_frame_;
 
     // Since we now have new continuous frames there might be a better frame
@@ -507,34 +543,36 @@ int64_t FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
   return last_continuous_frame_id;
 }
 
-void FrameBuffer::PropagateContinuity(FrameMap::iterator start) {
+void FrameBuffer::PropagateContinuity(int64_t start_id) {
   TRACE_EVENT0("webrtc", "FrameBuffer::PropagateContinuity");
-  RTC_DCHECK(start->second.continuous);
+  RTC_DCHECK(frames_.Find(start_id)->continuous);
 
-  std::queue<FrameMap::iterator> continuous_frames;
-  continuous_frames.push(start);
+  absl::InlinedVector<int64_t, 8> continuous_frames;
+  continuous_frames.push_back(start_id);
 
-  // A simple BFS to traverse continuous frames.
+  // A simple DFS to traverse continuous frames.
   while (!continuous_frames.empty()) {
-    auto frame = continuous_frames.front();
-    continuous_frames.pop();
+    const int64_t frame_id = continuous_frames.back();
+    continuous_frames.pop_back();
 
-    if (!last_continuous_frame_ || *last_continuous_frame_ < frame->first) {
-      last_continuous_frame_ = frame->first;
+    if (!last_continuous_frame_ || *last_continuous_frame_ < frame_id) {
+      last_continuous_frame_ = frame_id;
     }
 
     // Loop through all dependent frames, and if that frame no longer has
     // any unfulfilled dependencies then that frame is continuous as well.
-    for (size_t d = 0; d < frame->second.dependent_frames.size(); ++d) {
-      auto frame_ref = frames_.find(frame->second.dependent_frames[d]);
-      RTC_DCHECK(frame_ref != frames_.end());
+    const FrameInfo& info = *frames_.Find(frame_id);
+    for (int64_t dependent_id : info.dependent_frames) {
+      FrameInfo* dependent_info = frames_.Find(dependent_id);
+      RTC_DCHECK(dependent_info);
 
       // TODO(philipel): Look into why we've seen this happen.
-      if (frame_ref != frames_.end()) {
-        --frame_ref->second.num_missing_continuous;
-        if (frame_ref->second.num_missing_continuous == 0) {
-          frame_ref->second.continuous = true;
-          continuous_frames.push(frame_ref);
+      if (dependent_info) {
+        --dependent_info->num_missing_continuous;
+        if (dependent_info->num_missing_continuous == 0) {
+          dependent_info->continuous = true;
+          UpdateDecodability(dependent_id, *dependent_info);
+          continuous_frames.push_back(dependent_id);
         }
       }
     }
@@ -543,22 +581,27 @@ void FrameBuffer::PropagateContinuity(FrameMap::iterator start) {
 
 void FrameBuffer::PropagateDecodability(const FrameInfo& info) {
   TRACE_EVENT0("webrtc", "FrameBuffer::PropagateDecodability");
-  for (size_t d = 0; d < info.dependent_frames.size(); ++d) {
-    auto ref_info = frames_.find(info.dependent_frames[d]);
-    RTC_DCHECK(ref_info != frames_.end());
+  for (int64_t dependent_id : info.dependent_frames) {
+    FrameInfo* dependent_info = frames_.Find(dependent_id);
+    RTC_DCHECK(dependent_info);
     // TODO(philipel): Look into why we've seen this happen.
-    if (ref_info != frames_.end()) {
-      RTC_DCHECK_GT(ref_info->second.num_missing_decodable, 0U);
-      --ref_info->second.num_missing_decodable;
+    if (dependent_info) {
+      RTC_DCHECK_GT(dependent_info->num_missing_decodable, 0U);
+      --dependent_info->num_missing_decodable;
+      UpdateDecodability(dependent_id, *dependent_info);
     }
   }
 }
 
-bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
-                                                   FrameMap::iterator info) {
+void FrameBuffer::UpdateDecodability(int64_t id, const FrameInfo& info) {
+  if (info.continuous && info.num_missing_decodable == 0)
+    frames_.SetDecodable(id);
+}
+
+bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame) {
   TRACE_EVENT0("webrtc", "FrameBuffer::UpdateFrameInfoWithIncomingFrame");
   auto last_decoded_frame = decoded_frames_history_.GetLastDecodedFrameId();
-  RTC_DCHECK(!last_decoded_frame || *last_decoded_frame < info->first);
+  RTC_DCHECK(!last_decoded_frame || *last_decoded_frame < frame.Id());
 
   // In this function we determine how many missing dependencies this `frame`
   // has to become continuous/decodable. If a frame that this `frame` depend
@@ -572,7 +615,8 @@ bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
     int64_t frame_id;
     bool continuous;
   };
-  std::vector<Dependency> not_yet_fulfilled_dependencies;
+  absl::InlinedVector<Dependency, EncodedFrame::kMaxFrameReferences>
+      not_yet_fulfilled_dependencies;
 
   // Find all dependencies that have not yet been fulfilled.
   for (size_t i = 0; i < frame.num_references; ++i) {
@@ -592,24 +636,26 @@ bool FrameBuffer::UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
         return false;
       }
     } else {
-      auto ref_info = frames_.find(frame.references[i]);
-      bool ref_continuous =
-          ref_info != frames_.end() && ref_info->second.continuous;
+      const FrameInfo* ref_info = frames_.Find(frame.references[i]);
+      bool ref_continuous = ref_info && ref_info->continuous;
       not_yet_fulfilled_dependencies.push_back(
           {frame.references[i], ref_continuous});
     }
   }
 
-  info->second.num_missing_continuous = not_yet_fulfilled_dependencies.size();
-  info->second.num_missing_decodable = not_yet_fulfilled_dependencies.size();
-
+  size_t num_missing_continuous = not_yet_fulfilled_dependencies.size();
   for (const Dependency& dep : not_yet_fulfilled_dependencies) {
     if (dep.continuous)
-      --info->second.num_missing_continuous;
+      --num_missing_continuous;
 
-    frames_[dep.frame_id].dependent_frames.push_back(frame.Id());
+    frames_.FindOrInsert(dep.frame_id).dependent_frames.push_back(frame.Id());
   }
 
+  // Looked up after adding the referenced frames, which may move it.
+  FrameInfo& info = *frames_.Find(frame.Id());
+  info.num_missing_continuous = num_missing_continuous;
+  info.num_missing_decodable = not_yet_fulfilled_dependencies.size();
+
   return true;
 }
 
@@ -642,17 +688,10 @@ void FrameBuffer::UpdateTimingFrameInfo() {
 
 void FrameBuffer::ClearFramesAndHistory() {
   TRACE_EVENT0("webrtc", "FrameBuffer::ClearFramesAndHistory");
-  if (stats_callback_) {
-    unsigned int dropped_frames =
-        std::count_if(frames_.begin(), frames_.end(),
-                      [](const std::pair<const int64_t, FrameInfo>& frame) {
-                        return frame.second.frame != nullptr;
-                      });
-    if (dropped_frames > 0) {
-      stats_callback_->OnDroppedFrames(dropped_frames);
-    }
+  unsigned int dropped_frames = frames_.Clear();
+  if (stats_callback_ && dropped_frames > 0) {
+    stats_callback_->OnDroppedFrames(dropped_frames);
   }
-  frames_.clear();
   last_continuous_frame_.reset();
   frames_to_decode_.clear();
   decoded_frames_history_.Clear();
@@ -700,7 +739,180 @@ EncodedFrame* FrameBuffer::CombineAndDeleteFrames(
 
 FrameBuffer::FrameInfo::FrameInfo() = default;
 FrameBuffer::FrameInfo::FrameInfo(FrameInfo&&) = default;
+FrameBuffer::FrameInfo& FrameBuffer::FrameInfo::operator=(FrameInfo&&) =
+    default;
 FrameBuffer::FrameInfo::~FrameInfo() = default;
 
+FrameBuffer::FrameMap::FrameMap() = default;
+
+FrameBuffer::FrameMap::~FrameMap() = default;
+
+bool FrameBuffer::FrameMap::CanInsert(int64_t first_id,
+                                      int64_t last_id) const {
+  RTC_DCHECK_LE(first_id, last_id);
+  if (size_ > 0) {
+    first_id = std::min(first_id, oldest_id_);
+    last_id = std::max<int64_t>(last_id, oldest_id_ + span_ - 1);
+  }
+  return last_id - first_id < kMaxFrameIdSpan;
+}
+
+FrameBuffer::FrameInfo* FrameBuffer::FrameMap::Find(int64_t id) {
+  if (size_ == 0 || id < oldest_id_ ||
+      id - oldest_id_ >= static_cast<int64_t>(span_)) {
+    return nullptr;
+  }
+  const size_t index = Index(id);
+  return IsSet(occupied_, index) ? &slots_[index] : nullptr;
+}
+
+FrameBuffer::FrameInfo& FrameBuffer::FrameMap::FindOrInsert(int64_t id) {
+  if (FrameInfo* info = Find(id))
+    return *info;
+  RTC_DCHECK(CanInsert(id, id));
+  int64_t oldest_id = id;
+  int64_t newest_id = id;
+  if (size_ > 0) {
+    oldest_id = std::min(oldest_id, oldest_id_);
+    newest_id = std::max<int64_t>(newest_id, oldest_id_ + span_ - 1);
+  }
+  const size_t span = newest_id - oldest_id + 1;
+  if (span > slots_.size())
+    Grow(span);
+  oldest_id_ = oldest_id;
+  span_ = span;
+  const size_t index = Index(id);
+  SetBit(occupied_, index);
+  ++size_;
+  // Slots not holding a frame are left empty.
+  return slots_[index];
+}
+
+absl::optional<int64_t> FrameBuffer::FrameMap::NextId(int64_t id) const {
+  if (size_ == 0 || id - oldest_id_ + 1 >= static_cast<int64_t>(span_))
+    return absl::nullopt;
+  const size_t offset =
+      FindSet(occupied_, id < oldest_id_ ? 0 : id - oldest_id_ + 1);
+  if (offset == span_)
+    return absl::nullopt;
+  return oldest_id_ + offset;
+}
+
+void FrameBuffer::FrameMap::SetDecodable(int64_t id) {
+  RTC_DCHECK(Find(id));
+  SetBit(decodable_, Index(id));
+}
+
+absl::optional<int64_t> FrameBuffer::FrameMap::FindDecodable(
+    int64_t id) const {
+  if (size_ == 0 || (id > oldest_id_ &&
+                     id - oldest_id_ >= static_cast<int64_t>(span_))) {
+    return absl::nullopt;
+  }
+  const size_t offset =
+      FindSet(decodable_, id < oldest_id_ ? 0 : id - oldest_id_);
+  if (offset == span_)
+    return absl::nullopt;
+  return oldest_id_ + offset;
+}
+
+size_t FrameBuffer::FrameMap::EraseUpTo(int64_t id) {
+  if (size_ == 0 || id < oldest_id_)
+    return 0;
+  const size_t end =
+      std::min<int64_t>(id - oldest_id_ + 1, static_cast<int64_t>(span_));
+  size_t num_erased = 0;
+  size_t num_frames = 0;
+  size_t offset = FindSet(occupied_, 0);
+  while (offset < end) {
+    const size_t index = Index(oldest_id_ + offset);
+    if (slots_[index].frame)
+      ++num_frames;
+    slots_[index] = FrameInfo();
+    ClearBit(occupied_, index);
+    ClearBit(decodable_, index);
+    ++num_erased;
+    offset = FindSet(occupied_, offset + 1);
+  }
+  size_ -= num_erased;
+  if (size_ == 0) {
+    span_ = 0;
+  } else {
+    oldest_id_ += offset;
+    span_ -= offset;
+  }
+  MaybeShrink();
+  return num_frames;
+}
+
+size_t FrameBuffer::FrameMap::Clear() {
+  size_t num_frames = 0;
+  for (size_t offset = FindSet(occupied_, 0); offset < span_;
+       offset = FindSet(occupied_, offset + 1)) {
+    FrameInfo& info = slots_[Index(oldest_id_ + offset)];
+    if (info.frame)
+      ++num_frames;
+    info = FrameInfo();
+  }
+  std::fill(occupied_.begin(), occupied_.end(), 0);
+  std::fill(decodable_.begin(), decodable_.end(), 0);
+  span_ = 0;
+  size_ = 0;
+  MaybeShrink();
+  return num_frames;
+}
+
+size_t FrameBuffer::FrameMap::FindSet(const std::vector<uint64_t>& bits,
+                                      size_t offset) const {
+  while (offset < span_) {
+    const size_t index = Index(oldest_id_ + offset);
+    // The number of slots is a multiple of 64, so a word never wraps around.
+    const uint64_t word = bits[index / 64] >> (index % 64);
+    if (word != 0)
+      return std::min(offset + absl::countr_zero(word), span_);
+    offset += 64 - index % 64;
+  }
+  return span_;
+}
+
+void FrameBuffer::FrameMap::Grow(size_t min_size) {
+  size_t new_size = std::max(slots_.size(), kMinFrameMapSlots);
+  while (new_size < min_size)
+    new_size *= 2;
+  Resize(new_size);
+}
+
+void FrameBuffer::FrameMap::MaybeShrink() {
+  // A single frame id far from the others grows the map up to
+  // `kMaxFrameIdSpan` slots; give that memory back once the span is small
+  // again, leaving room for it to double before growing anew.
+  if (slots_.size() <= kMaxRetainedFrameMapSlots || span_ * 4 > slots_.size())
+    return;
+  size_t new_size = kMaxRetainedFrameMapSlots;
+  while (new_size < span_ * 2)
+    new_size *= 2;
+  Resize(new_size);
+}
+
+void FrameBuffer::FrameMap::Resize(size_t new_size) {
+  RTC_DCHECK_GE(new_size, span_);
+  RTC_DCHECK_EQ(new_size & (new_size - 1), 0);
+  std::vector<FrameInfo> slots(new_size);
+  std::vector<uint64_t> occupied(new_size / 64);
+  std::vector<uint64_t> decodable(new_size / 64);
+  for (size_t offset = FindSet(occupied_, 0); offset < span_;
+       offset = FindSet(occupied_, offset + 1)) {
+    const int64_t id = oldest_id_ + offset;
+    const size_t index = static_cast<size_t>(id) & (new_size - 1);
+    slots[index] = std::move(slots_[Index(id)]);
+    SetBit(occupied, index);
+    if (IsSet(decodable_, Index(id)))
+      SetBit(decodable, index);
+  }
+  slots_ = std::move(slots);
+  occupied_ = std::move(occupied);
+  decodable_ = std::move(decodable);
+}
+
 }  // namespace video_coding
 }  // namespace webrtc
@@ -12,12 +12,12 @@
 #define MODULES_VIDEO_CODING_FRAME_BUFFER2_H_
 
 #include <array>
-#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/types/optional.h"
 #include "api/sequence_checker.h"
 #include "api/video/encoded_frame.h"
 #include "modules/video_coding/include/video_coding_defines.h"
@@ -91,6 +91,7 @@ class FrameBuffer {
   struct FrameInfo {
     FrameInfo();
     FrameInfo(FrameInfo&&);
+    FrameInfo& operator=(FrameInfo&&);
     ~FrameInfo();
 
     // Which other frames that have direct unfulfilled dependencies
@@ -115,7 +116,62 @@ class FrameBuffer {
     std::unique_ptr<EncodedFrame> frame;
   };
 
-  using FrameMap = std::map<int64_t, FrameInfo>;
+  // The frames by id, in a circular array indexed by frame id, with a bit for
+  // each slot telling if it holds a frame and one telling if the frame is
+  // decodable, to skip over the others. Frame ids must span no more than
+  // `kMaxFrameIdSpan`.
+  class FrameMap {
+   public:
+    FrameMap();
+    ~FrameMap();
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+    // Returns true if the frame ids would span no more than `kMaxFrameIdSpan`
+    // with frames from `first_id` to `last_id` added.
+    bool CanInsert(int64_t first_id, int64_t last_id) const;
+    // Returns the frame with the given id, or nullptr if it is not in the map.
+    FrameInfo* Find(int64_t id);
+    // Returns the frame with the given id, adding an empty frame if it is not
+    // in the map. Pointers to the other frames may be invalidated.
+    FrameInfo& FindOrInsert(int64_t id);
+    // Returns the id of the first frame after `id`, if any.
+    absl::optional<int64_t> NextId(int64_t id) const;
+    // Marks the frame as decodable, until it is removed.
+    void SetDecodable(int64_t id);
+    // Returns the id of the first frame marked as decodable at or after `id`,
+    // if any.
+    absl::optional<int64_t> FindDecodable(int64_t id) const;
+    // Removes the frames up to and including `id`, and returns how many of
+    // them held an EncodedFrame.
+    size_t EraseUpTo(int64_t id);
+    // Removes all frames, and returns how many of them held an EncodedFrame.
+    size_t Clear();
+
+   private:
+    size_t Index(int64_t id) const {
+      return static_cast<size_t>(id) & (slots_.size() - 1);
+    }
+    // Returns the offset from the oldest frame of the first slot at or after
+    // `offset` whose bit is set in `bits`, or `span_` if there is none.
+    size_t FindSet(const std::vector<uint64_t>& bits, size_t offset) const;
+    // Resizes `slots_` to hold at least `min_size` frame ids.
+    void Grow(size_t min_size);
+    // Releases most of `slots_` if the frame ids span a small part of it.
+    void MaybeShrink();
+    // Moves the frames to `new_size` slots, a power of two of at least
+    // `span_`.
+    void Resize(size_t new_size);
+
+    std::vector<FrameInfo> slots_;
+    std::vector<uint64_t> occupied_;
+    std::vector<uint64_t> decodable_;
+    int64_t oldest_id_ = 0;
+    // Number of ids from the oldest to the newest frame, including those not
+    // in the map.
+    size_t span_ = 0;
+    size_t size_ = 0;
+  };
 
   // Check that the references of `frame` are valid.
   bool ValidReferences(const EncodedFrame& frame) const;
@@ -128,18 +184,22 @@ class FrameBuffer {
 
   // Update all directly dependent and indirectly dependent frames and mark
   // them as continuous if all their references has been fulfilled.
-  void PropagateContinuity(FrameMap::iterator start)
+  void PropagateContinuity(int64_t start_id)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Marks the frame as decoded and updates all directly dependent frames.
   void PropagateDecodability(const FrameInfo& info)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Marks the frame as decodable if it is continuous and all its references
+  // have been decoded.
+  void UpdateDecodability(int64_t id, const FrameInfo& info)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Update the corresponding FrameInfo of `frame` and all FrameInfos that
   // `frame` references.
   // Return false if `frame` will never be decodable, true otherwise.
-  bool UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame,
-                                        FrameMap::iterator info)
+  bool UpdateFrameInfoWithIncomingFrame(const EncodedFrame& frame)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   void UpdateJitterDelay() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -179,7 +239,7 @@ class FrameBuffer {
   VCMTiming* const timing_ RTC_GUARDED_BY(mutex_);
   VCMInterFrameDelay inter_frame_delay_ RTC_GUARDED_BY(mutex_);
   absl::optional<int64_t> last_continuous_frame_ RTC_GUARDED_BY(mutex_);
-  std::vector<FrameMap::iterator> frames_to_decode_ RTC_GUARDED_BY(mutex_);
+  std::vector<int64_t> frames_to_decode_ RTC_GUARDED_BY(mutex_);
   bool stopped_ RTC_GUARDED_BY(mutex_);
   VCMVideoProtection protection_mode_ RTC_GUARDED_BY(mutex_);
   VCMReceiveStatisticsCallback* const stats_callback_;
@@ -564,6 +564,87 @@ TEST_F(TestFrameBuffer2, InvalidReferences) {
   EXPECT_EQ(2, InsertFrame(2, 0, 3000, true, kFrameSize, 1));
 }
 
+TEST_F(TestFrameBuffer2, ReferencesTooFarBehindAreInvalid) {
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, true, kFrameSize));
+  ExtractFrame();
+  CheckFrame(0, 0, 0);
+
+  // Beyond 2^15 frame ids the order of the frames would be ambiguous.
+  EXPECT_EQ(0, InsertFrame(1 << 15, 0, 2000, true, kFrameSize, 0));
+  EXPECT_EQ((1 << 15) - 1,
+            InsertFrame((1 << 15) - 1, 0, 2000, true, kFrameSize, 0));
+}
+
+TEST_F(TestFrameBuffer2, DeltaFrameSpanningTooManyFrameIdsIsDropped) {
+  EXPECT_EQ(1, InsertFrame(1, 0, 1000, true, kFrameSize));
+
+  // The buffer would hold frames 2^15 or more ids apart, so the frame is
+  // dropped and the buffered frame is kept.
+  EXPECT_CALL(stats_callback_, OnDroppedFrames).Times(0);
+  EXPECT_EQ(1, InsertFrame(1 + (1 << 15), 0, 2000, true, kFrameSize,
+                           (1 << 15)));
+  EXPECT_EQ(1, buffer_->Size());
+  ExtractFrame();
+  CheckFrame(0, 1, 0);
+}
+
+TEST_F(TestFrameBuffer2, KeyframeSpanningTooManyFrameIdsClearsBuffer) {
+  EXPECT_EQ(1, InsertFrame(1, 0, 1000, true, kFrameSize));
+
+  EXPECT_CALL(stats_callback_, OnDroppedFrames(1));
+  EXPECT_EQ(1 + (1 << 15),
+            InsertFrame(1 + (1 << 15), 0, 2000, true, kFrameSize));
+  EXPECT_EQ(1, buffer_->Size());
+  ExtractFrame();
+  CheckFrame(0, 1 + (1 << 15), 0);
+}
+
+TEST_F(TestFrameBuffer2, MissingFramesNotCountedAsDroppedOnDecode) {
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, true, kFrameSize));
+  // Frame 2 references the missing frame 1, and is never decodable.
+  EXPECT_EQ(0, InsertFrame(2, 0, 2000, true, kFrameSize, 1));
+  EXPECT_EQ(3, InsertFrame(3, 0, 3000, true, kFrameSize));
+  ExtractFrame();
+
+  // Decoding frame 3 drops frame 2, but not the missing frame 1.
+  EXPECT_CALL(stats_callback_, OnDroppedFrames(1));
+  ExtractFrame();
+  CheckFrame(0, 0, 0);
+  CheckFrame(1, 3, 0);
+  EXPECT_EQ(0, buffer_->Size());
+}
+
+TEST_F(TestFrameBuffer2, MissingFramesNotCountedAsDroppedOnClear) {
+  InsertFrame(0, 0, 1000, true, kFrameSize);
+  InsertFrame(2, 0, 2000, true, kFrameSize, 1);
+  InsertFrame(4, 0, 3000, true, kFrameSize, 3);
+
+  EXPECT_CALL(stats_callback_, OnDroppedFrames(3));
+  buffer_->Clear();
+  EXPECT_EQ(0, buffer_->Size());
+}
+
+TEST_F(TestFrameBuffer2, KeepsDecodableFramesWhenResized) {
+  // Frame ids far apart grow the buffer's storage, which is shrunk again
+  // once the first frame is decoded. Both move the decodable frames.
+  EXPECT_EQ(0, InsertFrame(0, 0, 1000, true, kFrameSize));
+  EXPECT_EQ(200, InsertFrame(200, 0, 2000, true, kFrameSize));
+  EXPECT_EQ(30000, InsertFrame(30000, 0, 3000, true, kFrameSize));
+  EXPECT_EQ(30000, InsertFrame(30002, 0, 4000, true, kFrameSize, 30001));
+  ExtractFrame();
+  ExtractFrame();
+  EXPECT_EQ(30002, InsertFrame(30001, 0, 3500, true, kFrameSize, 30000));
+  ExtractFrame();
+  ExtractFrame();
+  ExtractFrame();
+
+  CheckFrame(0, 0, 0);
+  CheckFrame(1, 200, 0);
+  CheckFrame(2, 30000, 0);
+  CheckFrame(3, 30001, 0);
+  CheckFrame(4, 30002, 0);
+}
+
 TEST_F(TestFrameBuffer2, KeyframeRequired) {
   EXPECT_EQ(1, InsertFrame(1, 0, 1000, true, kFrameSize));
   EXPECT_EQ(2, InsertFrame(2, 0, 2000, true, kFrameSize, 1));
@@ -12,7 +12,9 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
 
+#include "absl/numeric/bits.h"
 #include "api/sequence_checker.h"
 #include "api/task_queue/task_queue_base.h"
 #include "api/units/timestamp.h"
@@ -32,6 +34,14 @@ const int kMaxNackRetries = 10;
 const int kMaxReorderedPackets = 128;
 const int kNumReorderingBuckets = 10;
 const int kDefaultSendNackDelayMs = 0;
+// Initial number of slots of the nack list. Doubled as needed to cover
+// `kMaxPacketAge` packets.
+const size_t kMinNackListSlots = 128;
+const size_t kSeqNumSetWords = (1 << 16) / 64;
+// Number of updates of NackPeriodicProcessor ahead that modules can be
+// scheduled for. Modules with no NACKs due sooner are processed after this
+// many updates, 1.28 s at the default update interval, and rescheduled.
+const int64_t kTimerWheelSlots = 64;
 
 int64_t GetSendNackDelay() {
   int64_t delay_ms = strtol(
@@ -48,14 +58,15 @@ int64_t GetSendNackDelay() {
 constexpr TimeDelta NackPeriodicProcessor::kUpdateInterval;
 
 NackPeriodicProcessor::NackPeriodicProcessor(TimeDelta update_interval)
-    : update_interval_(update_interval) {}
+    : update_interval_(update_interval), timer_wheel_(kTimerWheelSlots) {}
 
 NackPeriodicProcessor::~NackPeriodicProcessor() {}
 
 void NackPeriodicProcessor::RegisterNackModule(NackRequesterBase* module) {
   RTC_DCHECK_RUN_ON(&sequence_);
-  modules_.push_back(module);
-  if (modules_.size() != 1)
+  RTC_DCHECK(next_updates_.find(module) == next_updates_.end());
+  next_updates_.emplace(module, -1);
+  if (next_updates_.size() != 1)
     return;
   repeating_task_ = RepeatingTaskHandle::DelayedStart(
       TaskQueueBase::Current(), update_interval_, [this] {
@@ -67,17 +78,53 @@ void NackPeriodicProcessor::RegisterNackModule(NackRequesterBase* module) {
 
 void NackPeriodicProcessor::UnregisterNackModule(NackRequesterBase* module) {
   RTC_DCHECK_RUN_ON(&sequence_);
-  auto it = std::find(modules_.begin(), modules_.end(), module);
-  RTC_DCHECK(it != modules_.end());
-  modules_.erase(it);
-  if (modules_.empty())
+  // Entries of the module left in the timer wheel are skipped, as it is not
+  // found among the registered modules.
+  auto it = next_updates_.find(module);
+  RTC_DCHECK(it != next_updates_.end());
+  next_updates_.erase(it);
+  if (next_updates_.empty())
     repeating_task_.Stop();
 }
 
+void NackPeriodicProcessor::ScheduleNackModule(NackRequesterBase* module) {
+  RTC_DCHECK_RUN_ON(&sequence_);
+  Schedule(module, update_ + 1);
+}
+
 // RTC_RUN_ON(sequence_)
 void NackPeriodicProcessor::ProcessNackModules() {
-  for (NackRequesterBase* module : modules_)
-    module->ProcessNacks();
+  ++update_;
+  due_modules_.swap(timer_wheel_[update_ % kTimerWheelSlots]);
+  for (NackRequesterBase* module : due_modules_) {
+    auto it = next_updates_.find(module);
+    if (it == next_updates_.end() || it->second != update_)
+      continue;
+    it->second = -1;
+    const TimeDelta delay = module->ProcessNacks();
+    if (delay.IsPlusInfinity())
+      continue;
+    // Packets may be due when the delay has passed, at the earliest, so the
+    // module is processed at the last update before then. If none are due by
+    // then, the delay left is shorter than an update interval and the module
+    // is processed at the next update, as it would without the timer wheel.
+    const int64_t updates = std::min<int64_t>(
+        std::max<int64_t>(delay / update_interval_, 1), kTimerWheelSlots);
+    Schedule(module, update_ + updates);
+  }
+  due_modules_.clear();
+}
+
+// RTC_RUN_ON(sequence_)
+void NackPeriodicProcessor::Schedule(NackRequesterBase* module,
+                                     int64_t update) {
+  auto it = next_updates_.find(module);
+  if (it == next_updates_.end() ||
+      (it->second != -1 && it->second <= update)) {
+    return;
+  }
+  it->second = update;
+  timer_wheel_[update % kTimerWheelSlots].push_back(module);
 }
 
 ScopedNackPeriodicProcessorRegistration::
@@ -92,6 +139,10 @@ ScopedNackPeriodicProcessorRegistration::
   processor_->UnregisterNackModule(module_);
 }
 
+void ScopedNackPeriodicProcessorRegistration::ScheduleNackModule() {
+  processor_->ScheduleNackModule(module_);
+}
+
 NackRequester::NackInfo::NackInfo()
     : seq_num(0), send_at_seq_num(0), sent_at_time(-1), retries(0) {}
 
@@ -104,6 +155,260 @@ NackRequester::NackInfo::NackInfo(uint16_t seq_num,
       sent_at_time(-1),
       retries(0) {}
 
+NackRequester::NackList::NackList() = default;
+
+NackRequester::NackList::~NackList() = default;
+
+NackRequester::NackInfo* NackRequester::NackList::First() {
+  return size_ == 0 ? nullptr : &slots_[Index(oldest_seq_num_)];
+}
+
+NackRequester::NackInfo* NackRequester::NackList::FirstNotSent() {
+  size_t offset = 0;
+  if (size_ > 0 && AheadOf(not_sent_seq_num_, oldest_seq_num_))
+    offset = ForwardDiff(oldest_seq_num_, not_sent_seq_num_);
+  for (offset = FindOccupied(offset); offset < span_;
+       offset = FindOccupied(offset + 1)) {
+    NackInfo& nack_info = slots_[Index(oldest_seq_num_ + offset)];
+    if (nack_info.sent_at_time == -1) {
+      not_sent_seq_num_ = nack_info.seq_num;
+      return &nack_info;
+    }
+  }
+  not_sent_seq_num_ = oldest_seq_num_ + span_;
+  return nullptr;
+}
+
+NackRequester::NackInfo* NackRequester::NackList::Next(
+    const NackInfo& nack_info) {
+  const size_t offset =
+      FindOccupied(ForwardDiff(oldest_seq_num_, nack_info.seq_num) + 1);
+  return offset < span_ ? &slots_[Index(oldest_seq_num_ + offset)] : nullptr;
+}
+
+NackRequester::NackInfo* NackRequester::NackList::Find(uint16_t seq_num) {
+  if (size_ == 0 || ForwardDiff(oldest_seq_num_, seq_num) >= span_)
+    return nullptr;
+  const size_t index = Index(seq_num);
+  return IsOccupied(index) ? &slots_[index] : nullptr;
+}
+
+void NackRequester::NackList::Append(const NackInfo& nack_info) {
+  if (size_ == 0) {
+    oldest_seq_num_ = nack_info.seq_num;
+    not_sent_seq_num_ = nack_info.seq_num;
+    span_ = 0;
+  }
+  const size_t offset = ForwardDiff(oldest_seq_num_, nack_info.seq_num);
+  RTC_DCHECK_GE(offset, span_);
+  RTC_DCHECK_LT(offset, 1 << 15);
+  if (offset >= slots_.size())
+    Grow(offset + 1);
+  const size_t index = Index(nack_info.seq_num);
+  slots_[index] = nack_info;
+  SetOccupied(index, true);
+  span_ = offset + 1;
+  ++size_;
+}
+
+void NackRequester::NackList::Erase(uint16_t seq_num) {
+  if (!Find(seq_num))
+    return;
+  SetOccupied(Index(seq_num), false);
+  --size_;
+  if (seq_num == oldest_seq_num_)
+    AdvanceOldest(FindOccupied(1));
+}
+
+size_t NackRequester::NackList::EraseOlderThan(uint16_t seq_num) {
+  if (size_ == 0 || !AheadOf(seq_num, oldest_seq_num_))
+    return 0;
+  const size_t count = ForwardDiff(oldest_seq_num_, seq_num);
+  size_t erased = 0;
+  size_t offset = 0;
+  while (offset < count && offset < span_) {
+    SetOccupied(Index(oldest_seq_num_ + offset), false);
+    ++erased;
+    offset = FindOccupied(offset + 1);
+  }
+  size_ -= erased;
+  AdvanceOldest(offset);
+  return erased;
+}
+
+void NackRequester::NackList::Clear() {
+  std::fill(occupied_.begin(), occupied_.end(), 0);
+  span_ = 0;
+  size_ = 0;
+}
+
+bool NackRequester::NackList::IsOccupied(size_t index) const {
+  return (occupied_[index / 64] >> (index % 64)) & 1;
+}
+
+void NackRequester::NackList::SetOccupied(size_t index, bool occupied) {
+  const uint64_t bit = uint64_t{1} << (index % 64);
+  if (occupied) {
+    occupied_[index / 64] |= bit;
+  } else {
+    occupied_[index / 64] &= ~bit;
+  }
+}
+
+size_t NackRequester::NackList::FindOccupied(size_t offset) const {
+  while (offset < span_) {
+    const size_t index = Index(oldest_seq_num_ + offset);
+    // The number of slots is a multiple of 64, so a word never wraps around.
+    const uint64_t bits = occupied_[index / 64] >> (index % 64);
+    if (bits != 0)
+      return std::min(offset + absl::countr_zero(bits), span_);
+    offset += 64 - index % 64;
+  }
+  return span_;
+}
+
+void NackRequester::NackList::AdvanceOldest(size_t offset) {
+  if (size_ == 0) {
+    span_ = 0;
+    return;
+  }
+  oldest_seq_num_ += offset;
+  span_ -= offset;
+}
+
+void NackRequester::NackList::Grow(size_t min_size) {
+  size_t new_size = std::max(slots_.size(), kMinNackListSlots);
+  while (new_size < min_size)
+    new_size *= 2;
+  std::vector<NackInfo> slots(new_size);
+  std::vector<uint64_t> occupied(new_size / 64);
+  for (size_t offset = FindOccupied(0); offset < span_;
+       offset = FindOccupied(offset + 1)) {
+    const uint16_t seq_num = oldest_seq_num_ + offset;
+    const size_t index = seq_num & (new_size - 1);
+    slots[index] = slots_[Index(seq_num)];
+    occupied[index / 64] |= uint64_t{1} << (index % 64);
+  }
+  slots_ = std::move(slots);
+  occupied_ = std::move(occupied);
+}
+
+NackRequester::SeqNumSet::SeqNumSet() = default;
+
+NackRequester::SeqNumSet::~SeqNumSet() = default;
+
+bool NackRequester::SeqNumSet::Contains(uint16_t seq_num) const {
+  if (empty())
+    return false;
+  return (bits_[seq_num / 64] >> (seq_num % 64)) & 1;
+}
+
+uint16_t NackRequester::SeqNumSet::Oldest() const {
+  RTC_DCHECK_GT(size_, 0);
+  // The oldest sequence number is the one after the largest gap between
+  // sequence numbers in the set, going around the sequence number space.
+  size_t word = NextUsedWord(0);
+  uint64_t bits = bits_[word];
+  const uint16_t first = word * 64 + absl::countr_zero(bits);
+  bits &= bits - 1;
+  uint16_t oldest = first;
+  uint16_t previous = first;
+  uint16_t largest_gap = 0;
+  for (size_t i = 1; i < size_; ++i) {
+    if (bits == 0) {
+      word = NextUsedWord(word + 1);
+      bits = bits_[word];
+    }
+    const uint16_t seq_num = word * 64 + absl::countr_zero(bits);
+    bits &= bits - 1;
+    if (ForwardDiff(previous, seq_num) > largest_gap) {
+      largest_gap = ForwardDiff(previous, seq_num);
+      oldest = seq_num;
+    }
+    previous = seq_num;
+  }
+  if (ForwardDiff(previous, first) > largest_gap)
+    oldest = first;
+  return oldest;
+}
+
+void NackRequester::SeqNumSet::Insert(uint16_t seq_num) {
+  if (bits_.empty()) {
+    bits_.resize(kSeqNumSetWords);
+    used_words_.resize(kSeqNumSetWords / 64);
+  }
+  uint64_t& word = bits_[seq_num / 64];
+  const uint64_t bit = uint64_t{1} << (seq_num % 64);
+  if (word & bit)
+    return;
+  word |= bit;
+  used_words_[seq_num / 64 / 64] |= uint64_t{1} << (seq_num / 64 % 64);
+  ++size_;
+  if (lower_bound_ && AheadOf(*lower_bound_, seq_num))
+    lower_bound_.reset();
+}
+
+void NackRequester::SeqNumSet::Erase(uint16_t seq_num) {
+  if (empty())
+    return;
+  uint64_t& word = bits_[seq_num / 64];
+  const uint64_t bit = uint64_t{1} << (seq_num % 64);
+  if (!(word & bit))
+    return;
+  word &= ~bit;
+  if (word == 0)
+    used_words_[seq_num / 64 / 64] &= ~(uint64_t{1} << (seq_num / 64 % 64));
+  --size_;
+}
+
+void NackRequester::SeqNumSet::EraseOlderThan(uint16_t seq_num) {
+  if (lower_bound_ && AheadOrAt(seq_num, *lower_bound_)) {
+    EraseRange(*lower_bound_, ForwardDiff(*lower_bound_, seq_num));
+  } else {
+    // Exactly half the sequence number space apart, AheadOf() considers the
+    // larger sequence number to be ahead.
+    const size_t count = seq_num >= (1 << 15) ? (1 << 15) : (1 << 15) - 1;
+    EraseRange(seq_num - count, count);
+  }
+  lower_bound_ = seq_num;
+}
+
+void NackRequester::SeqNumSet::EraseRange(uint16_t first, size_t count) {
+  while (count > 0 && size_ > 0) {
+    const size_t word_index = first / 64;
+    size_t num_bits;
+    if (used_words_[word_index / 64] == 0) {
+      // Skip the rest of the 64 words without sequence numbers in the set.
+      num_bits = std::min<size_t>(64 * 64 - first % (64 * 64), count);
+    } else {
+      const size_t bit = first % 64;
+      num_bits = std::min<size_t>(64 - bit, count);
+      const uint64_t mask =
+          (num_bits == 64 ? ~uint64_t{0} : (uint64_t{1} << num_bits) - 1)
+          << bit;
+      uint64_t& word = bits_[word_index];
+      size_ -= absl::popcount(word & mask);
+      word &= ~mask;
+      if (word == 0)
+        used_words_[word_index / 64] &= ~(uint64_t{1} << (word_index % 64));
+    }
+    first += num_bits;
+    count -= num_bits;
+  }
+}
+
+size_t NackRequester::SeqNumSet::NextUsedWord(size_t word) const {
+  RTC_DCHECK_GT(size_, 0);
+  word %= kSeqNumSetWords;
+  size_t index = word / 64;
+  uint64_t used = used_words_[index] & (~uint64_t{0} << (word % 64));
+  while (used == 0) {
+    index = (index + 1) % used_words_.size();
+    used = used_words_[index];
+  }
+  return index * 64 + absl::countr_zero(used);
+}
+
 NackRequester::BackoffSettings::BackoffSettings(TimeDelta min_retry,
                                                 TimeDelta max_rtt,
                                                 double base)
@@ -162,14 +467,19 @@ NackRequester::~NackRequester() {
   RTC_DCHECK_RUN_ON(worker_thread_);
 }
 
-void NackRequester::ProcessNacks() {
+TimeDelta NackRequester::ProcessNacks() {
   RTC_DCHECK_RUN_ON(worker_thread_);
-  std::vector<uint16_t> nack_batch = GetNackBatch(kTimeOnly);
+  int64_t next_nack_time_ms = std::numeric_limits<int64_t>::max();
+  std::vector<uint16_t> nack_batch =
+      GetNackBatch(kTimeOnly, &next_nack_time_ms);
   if (!nack_batch.empty()) {
     // This batch of NACKs is triggered externally; there is no external
     // initiator who can batch them with other feedback messages.
     nack_sender_->SendNack(nack_batch, /*buffering_allowed=*/false);
   }
+  if (next_nack_time_ms == std::numeric_limits<int64_t>::max())
+    return TimeDelta::PlusInfinity();
+  return TimeDelta::Millis(next_nack_time_ms - clock_->TimeInMilliseconds());
 }
 
 int NackRequester::OnReceivedPacket(uint16_t seq_num, bool is_keyframe) {
@@ -190,7 +500,7 @@ int NackRequester::OnReceivedPacket(uint16_t seq_num,
   if (!initialized_) {
     newest_seq_num_ = seq_num;
     if (is_keyframe)
-      keyframe_list_.insert(seq_num);
+      keyframe_list_.Insert(seq_num);
     initialized_ = true;
     return 0;
   }
@@ -202,11 +512,11 @@ int NackRequester::OnReceivedPacket(uint16_t seq_num,
 
   if (AheadOf(newest_seq_num_, seq_num)) {
     // An out of order packet has been received.
-    auto nack_list_it = nack_list_.find(seq_num);
+    NackInfo* nack_info = nack_list_.Find(seq_num);
     int nacks_sent_for_packet = 0;
-    if (nack_list_it != nack_list_.end()) {
-      nacks_sent_for_packet = nack_list_it->second.retries;
-      nack_list_.erase(nack_list_it);
+    if (nack_info) {
+      nacks_sent_for_packet = nack_info->retries;
+      nack_list_.Erase(seq_num);
     }
     if (!is_retransmitted)
       UpdateReorderingStatistics(seq_num);
@@ -215,20 +525,16 @@ int NackRequester::OnReceivedPacket(uint16_t seq_num,
 
   // Keep track of new keyframes.
   if (is_keyframe)
-    keyframe_list_.insert(seq_num);
+    keyframe_list_.Insert(seq_num);
 
   // And remove old ones so we don't accumulate keyframes.
-  auto it = keyframe_list_.lower_bound(seq_num - kMaxPacketAge);
-  if (it != keyframe_list_.begin())
-    keyframe_list_.erase(keyframe_list_.begin(), it);
+  keyframe_list_.EraseOlderThan(seq_num - kMaxPacketAge);
 
   if (is_recovered) {
-    recovered_list_.insert(seq_num);
+    recovered_list_.Insert(seq_num);
 
     // Remove old ones so we don't accumulate recovered packets.
-    auto it = recovered_list_.lower_bound(seq_num - kMaxPacketAge);
-    if (it != recovered_list_.begin())
-      recovered_list_.erase(recovered_list_.begin(), it);
+    recovered_list_.EraseOlderThan(seq_num - kMaxPacketAge);
 
     // Do not send nack for packets recovered by FEC or RTX.
     return 0;
@@ -238,7 +544,8 @@ int NackRequester::OnReceivedPacket(uint16_t seq_num,
   newest_seq_num_ = seq_num;
 
   // Are there any nacks that are waiting for this seq_num.
-  std::vector<uint16_t> nack_batch = GetNackBatch(kSeqNumOnly);
+  std::vector<uint16_t> nack_batch =
+      GetNackBatch(kSeqNumOnly, /*next_nack_time_ms=*/nullptr);
   if (!nack_batch.empty()) {
     // This batch of NACKs is triggered externally; the initiator can
     // batch them with other feedback messages.
@@ -252,34 +559,33 @@ void NackRequester::ClearUpTo(uint16_t seq_num) {
   // Called via RtpVideoStreamReceiver2::FrameContinuous on the network thread.
   worker_thread_->PostTask(ToQueuedTask(task_safety_, [seq_num, this]() {
     RTC_DCHECK_RUN_ON(worker_thread_);
-    nack_list_.erase(nack_list_.begin(), nack_list_.lower_bound(seq_num));
-    keyframe_list_.erase(keyframe_list_.begin(),
-                         keyframe_list_.lower_bound(seq_num));
-    recovered_list_.erase(recovered_list_.begin(),
-                          recovered_list_.lower_bound(seq_num));
+    nack_list_.EraseOlderThan(seq_num);
+    keyframe_list_.EraseOlderThan(seq_num);
+    recovered_list_.EraseOlderThan(seq_num);
   }));
 }
 
 void NackRequester::UpdateRtt(int64_t rtt_ms) {
   RTC_DCHECK_RUN_ON(worker_thread_);
   rtt_ms_ = rtt_ms;
+  // Packets may be due sooner with a shorter round trip time.
+  if (nack_list_.size() > 0)
+    processor_registration_.ScheduleNackModule();
 }
 
 bool NackRequester::RemovePacketsUntilKeyFrame() {
   // Called on worker_thread_.
   while (!keyframe_list_.empty()) {
-    auto it = nack_list_.lower_bound(*keyframe_list_.begin());
+    const uint16_t keyframe_seq_num = keyframe_list_.Oldest();
 
-    if (it != nack_list_.begin()) {
-      // We have found a keyframe that actually is newer than at least one
-      // packet in the nack list.
-      nack_list_.erase(nack_list_.begin(), it);
+    // If we have found a keyframe that actually is newer than at least one
+    // packet in the nack list, the packets before it are removed.
+    if (nack_list_.EraseOlderThan(keyframe_seq_num) > 0)
       return true;
-    }
 
     // If this keyframe is so old it does not remove any packets from the list,
     // remove it from the list of keyframes and try the next keyframe.
-    keyframe_list_.erase(keyframe_list_.begin());
+    keyframe_list_.Erase(keyframe_seq_num);
   }
   return false;
 }
@@ -288,8 +594,7 @@ void NackRequester::AddPacketsToNack(uint16_t seq_num_start,
                                      uint16_t seq_num_end) {
   // Called on worker_thread_.
   // Remove old packets.
-  auto it = nack_list_.lower_bound(seq_num_end - kMaxPacketAge);
-  nack_list_.erase(nack_list_.begin(), it);
+  nack_list_.EraseOlderThan(seq_num_end - kMaxPacketAge);
 
   // If the nack list is too large, remove packets from the nack list until
   // the latest first packet of a keyframe. If the list is still too large,
@@ -301,7 +606,7 @@ void NackRequester::AddPacketsToNack(uint16_t seq_num_start,
     }
 
     if (nack_list_.size() + num_new_nacks > kMaxNackPackets) {
-      nack_list_.clear();
+      nack_list_.Clear();
       RTC_LOG(LS_WARNING) << "NACK list full, clearing NACK"
                              " list and requesting keyframe.";
       keyframe_request_sender_->RequestKeyFrame();
@@ -311,62 +616,81 @@ void NackRequester::AddPacketsToNack(uint16_t seq_num_start,
 
   for (uint16_t seq_num = seq_num_start; seq_num != seq_num_end; ++seq_num) {
     // Do not send nack for packets that are already recovered by FEC or RTX
-    if (recovered_list_.find(seq_num) != recovered_list_.end())
+    if (recovered_list_.Contains(seq_num))
       continue;
     NackInfo nack_info(seq_num, seq_num + WaitNumberOfPackets(0.5),
                        clock_->TimeInMilliseconds());
-    RTC_DCHECK(nack_list_.find(seq_num) == nack_list_.end());
-    nack_list_[seq_num] = nack_info;
+    RTC_DCHECK(!nack_list_.Find(seq_num));
+    nack_list_.Append(nack_info);
   }
+
+  // The new packets are due for a NACK by the next update at the latest.
+  if (num_new_nacks > 0)
+    processor_registration_.ScheduleNackModule();
 }
 
-std::vector<uint16_t> NackRequester::GetNackBatch(NackFilterOptions options) {
+std::vector<uint16_t> NackRequester::GetNackBatch(
+    NackFilterOptions options,
+    int64_t* next_nack_time_ms) {
   // Called on worker_thread_.
 
   bool consider_seq_num = options != kTimeOnly;
   bool consider_timestamp = options != kSeqNumOnly;
   Timestamp now = clock_->CurrentTime();
   std::vector<uint16_t> nack_batch;
-  auto it = nack_list_.begin();
-  while (it != nack_list_.end()) {
-    TimeDelta resend_delay = TimeDelta::Millis(rtt_ms_);
-    if (backoff_settings_) {
-      resend_delay =
-          std::max(resend_delay, backoff_settings_->min_retry_interval);
-      if (it->second.retries > 1) {
-        TimeDelta exponential_backoff =
-            std::min(TimeDelta::Millis(rtt_ms_), backoff_settings_->max_rtt) *
-            std::pow(backoff_settings_->base, it->second.retries - 1);
-        resend_delay = std::max(resend_delay, exponential_backoff);
-      }
-    }
+  // Packets are only nacked for their sequence number the first time.
+  NackInfo* next =
+      consider_timestamp ? nack_list_.First() : nack_list_.FirstNotSent();
+  while (next) {
+    NackInfo* nack_info = next;
+    next = nack_list_.Next(*nack_info);
+    TimeDelta resend_delay = ResendDelay(nack_info->retries);
 
     bool delay_timed_out =
-        now.ms() - it->second.created_at_time >= send_nack_delay_ms_;
+        now.ms() - nack_info->created_at_time >= send_nack_delay_ms_;
     bool nack_on_rtt_passed =
-        now.ms() - it->second.sent_at_time >= resend_delay.ms();
+        now.ms() - nack_info->sent_at_time >= resend_delay.ms();
     bool nack_on_seq_num_passed =
-        it->second.sent_at_time == -1 &&
-        AheadOrAt(newest_seq_num_, it->second.send_at_seq_num);
+        nack_info->sent_at_time == -1 &&
+        AheadOrAt(newest_seq_num_, nack_info->send_at_seq_num);
     if (delay_timed_out && ((consider_seq_num && nack_on_seq_num_passed) ||
                             (consider_timestamp && nack_on_rtt_passed))) {
-      nack_batch.emplace_back(it->second.seq_num);
-      ++it->second.retries;
-      it->second.sent_at_time = now.ms();
-      if (it->second.retries >= kMaxNackRetries) {
-        RTC_LOG(LS_WARNING) << "Sequence number " << it->second.seq_num
+      nack_batch.emplace_back(nack_info->seq_num);
+      ++nack_info->retries;
+      nack_info->sent_at_time = now.ms();
+      if (nack_info->retries >= kMaxNackRetries) {
+        RTC_LOG(LS_WARNING) << "Sequence number " << nack_info->seq_num
                             << " removed from NACK list due to max retries.";
-        it = nack_list_.erase(it);
-      } else {
-        ++it;
+        nack_list_.Erase(nack_info->seq_num);
+        continue;
       }
-      continue;
+      resend_delay = ResendDelay(nack_info->retries);
+    }
+    if (next_nack_time_ms) {
+      *next_nack_time_ms = std::min(
+          *next_nack_time_ms,
+          std::max(nack_info->created_at_time + send_nack_delay_ms_,
+                   nack_info->sent_at_time + resend_delay.ms()));
     }
-    ++it;
   }
   return nack_batch;
 }
 
+TimeDelta NackRequester::ResendDelay(int retries) const {
+  TimeDelta resend_delay = TimeDelta::Millis(rtt_ms_);
+  if (backoff_settings_) {
+    resend_delay =
+        std::max(resend_delay, backoff_settings_->min_retry_interval);
+    if (retries > 1) {
+      TimeDelta exponential_backoff =
+          std::min(TimeDelta::Millis(rtt_ms_), backoff_settings_->max_rtt) *
+          std::pow(backoff_settings_->base, retries - 1);
+      resend_delay = std::max(resend_delay, exponential_backoff);
+    }
+  }
+  return resend_delay;
+}
+
 void NackRequester::UpdateReorderingStatistics(uint16_t seq_num) {
   // Running on worker_thread_.
   RTC_DCHECK(AheadOf(newest_seq_num_, seq_num));
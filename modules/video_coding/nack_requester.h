@@ -13,14 +13,14 @@
 
 #include <stdint.h>
 
-#include <map>
-#include <set>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "api/sequence_checker.h"
 #include "api/units/time_delta.h"
 #include "modules/include/module_common_types.h"
 #include "modules/video_coding/histogram.h"
+#include "rtc_base/containers/flat_map.h"
 #include "rtc_base/numerics/sequence_number_util.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_utils/pending_task_safety_flag.h"
@@ -33,9 +33,15 @@ namespace webrtc {
 class NackRequesterBase {
  public:
   virtual ~NackRequesterBase() = default;
-  virtual void ProcessNacks() = 0;
+  // Sends the NACKs that are due. Returns the time until more NACKs may be
+  // due, or TimeDelta::PlusInfinity() if there are no packets to NACK.
+  virtual TimeDelta ProcessNacks() = 0;
 };
 
+// Processes the registered modules every `update_interval`, skipping those
+// that have no NACKs due. Modules are kept in a timer wheel with a slot for
+// each of the next updates, and only the modules in the slot of the current
+// update are visited.
 class NackPeriodicProcessor {
  public:
   static constexpr TimeDelta kUpdateInterval = TimeDelta::Millis(20);
@@ -43,13 +49,31 @@ class NackPeriodicProcessor {
   ~NackPeriodicProcessor();
   void RegisterNackModule(NackRequesterBase* module);
   void UnregisterNackModule(NackRequesterBase* module);
+  // Processes `module` at the next update, as it may have new NACKs due.
+  void ScheduleNackModule(NackRequesterBase* module);
 
  private:
   void ProcessNackModules() RTC_RUN_ON(sequence_);
+  // Processes `module` at the given update, unless it is already scheduled
+  // for an earlier one.
+  void Schedule(NackRequesterBase* module, int64_t update)
+      RTC_RUN_ON(sequence_);
 
   const TimeDelta update_interval_;
   RepeatingTaskHandle repeating_task_ RTC_GUARDED_BY(sequence_);
-  std::vector<NackRequesterBase*> modules_ RTC_GUARDED_BY(sequence_);
+  // Number of updates so far.
+  int64_t update_ RTC_GUARDED_BY(sequence_) = 0;
+  // The update at which each registered module is processed next, or -1 if
+  // it has no packets to NACK.
+  flat_map<NackRequesterBase*, int64_t> next_updates_
+      RTC_GUARDED_BY(sequence_);
+  // The modules to process at each of the next updates, in the slot indexed
+  // by the update modulo the number of slots. Modules that have been
+  // rescheduled or unregistered since they were added are skipped.
+  std::vector<std::vector<NackRequesterBase*>> timer_wheel_
+      RTC_GUARDED_BY(sequence_);
+  // The modules of the current update, swapped out of the timer wheel.
+  std::vector<NackRequesterBase*> due_modules_ RTC_GUARDED_BY(sequence_);
   RTC_NO_UNIQUE_ADDRESS SequenceChecker sequence_;
 };
 
@@ -59,6 +83,9 @@ class ScopedNackPeriodicProcessorRegistration {
                                           NackPeriodicProcessor* processor);
   ~ScopedNackPeriodicProcessorRegistration();
 
+  // Processes the module at the next update of the processor.
+  void ScheduleNackModule();
+
  private:
   NackRequesterBase* const module_;
   NackPeriodicProcessor* const processor_;
@@ -73,7 +100,7 @@ class NackRequester final : public NackRequesterBase {
                 KeyFrameRequestSender* keyframe_request_sender);
   ~NackRequester();
 
-  void ProcessNacks() override;
+  TimeDelta ProcessNacks() override;
 
   int OnReceivedPacket(uint16_t seq_num, bool is_keyframe);
   int OnReceivedPacket(uint16_t seq_num, bool is_keyframe, bool is_recovered);
@@ -102,6 +129,99 @@ class NackRequester final : public NackRequesterBase {
     int retries;
   };
 
+  // The packets in the nack list, in sequence number order. Packets are
+  // stored in a circular array indexed by sequence number, which grows to
+  // cover the span from the oldest to the newest packet in the list, with a
+  // bit for each slot telling whether it holds a packet. Packets are only ever
+  // added after the newest one, as they are found missing.
+  class NackList {
+   public:
+    NackList();
+    ~NackList();
+
+    size_t size() const { return size_; }
+    // Returns the oldest packet in the list, or nullptr if it is empty.
+    NackInfo* First();
+    // Returns the oldest packet that has not been nacked, or nullptr if there
+    // is none.
+    NackInfo* FirstNotSent();
+    // Returns the packet following `nack_info` in the list, or nullptr if
+    // `nack_info` is the newest one.
+    NackInfo* Next(const NackInfo& nack_info);
+    // Returns the packet with the given sequence number, or nullptr if it is
+    // not in the list.
+    NackInfo* Find(uint16_t seq_num);
+    // Adds a packet newer than all packets in the list.
+    void Append(const NackInfo& nack_info);
+    // Removes a packet. Pointers to the other packets remain valid.
+    void Erase(uint16_t seq_num);
+    // Removes the packets older than `seq_num`, and returns how many were
+    // removed.
+    size_t EraseOlderThan(uint16_t seq_num);
+    void Clear();
+
+   private:
+    size_t Index(uint16_t seq_num) const {
+      return seq_num & (slots_.size() - 1);
+    }
+    bool IsOccupied(size_t index) const;
+    void SetOccupied(size_t index, bool occupied);
+    // Returns the offset from the oldest packet of the first packet at or
+    // after `offset`, or `span_` if there is none.
+    size_t FindOccupied(size_t offset) const;
+    // Drops the first `offset` slots, which must not hold packets, from the
+    // start of the list.
+    void AdvanceOldest(size_t offset);
+    // Resizes `slots_` to hold at least `min_size` sequence numbers.
+    void Grow(size_t min_size);
+
+    std::vector<NackInfo> slots_;
+    std::vector<uint64_t> occupied_;
+    uint16_t oldest_seq_num_ = 0;
+    // Number of sequence numbers from the oldest to the newest packet in the
+    // list, including those not in the list.
+    size_t span_ = 0;
+    size_t size_ = 0;
+    // All packets older than this have been nacked.
+    uint16_t not_sent_seq_num_ = 0;
+  };
+
+  // A set of sequence numbers, with one bit for each of them and one bit for
+  // each 64 bit word that is not zero, to skip over empty ranges. The bits
+  // are allocated on the first insert, since a receiver without FEC or RTX
+  // never recovers a packet.
+  class SeqNumSet {
+   public:
+    SeqNumSet();
+    ~SeqNumSet();
+
+    bool empty() const { return size_ == 0; }
+    bool Contains(uint16_t seq_num) const;
+    // Returns the oldest sequence number in the set, which must not be empty.
+    uint16_t Oldest() const;
+    void Insert(uint16_t seq_num);
+    void Erase(uint16_t seq_num);
+    // Removes the sequence numbers older than `seq_num`, that is those in the
+    // half of the sequence number space behind it.
+    void EraseOlderThan(uint16_t seq_num);
+
+   private:
+    // Removes the `count` sequence numbers from `first` on.
+    void EraseRange(uint16_t first, size_t count);
+    // Returns the index of the first word at or after `word`, circularly,
+    // that is not zero. The set must not be empty.
+    size_t NextUsedWord(size_t word) const;
+
+    // Empty until the first insert.
+    std::vector<uint64_t> bits_;
+    std::vector<uint64_t> used_words_;
+    size_t size_ = 0;
+    // If set, no sequence number in the set is older than this, so that
+    // erasing older sequence numbers as it advances only has to look at the
+    // sequence numbers it advanced over.
+    absl::optional<uint16_t> lower_bound_;
+  };
+
   struct BackoffSettings {
     BackoffSettings(TimeDelta min_retry, TimeDelta max_rtt, double base);
     static absl::optional<BackoffSettings> ParseFromFieldTrials();
@@ -121,7 +241,15 @@ class NackRequester final : public NackRequesterBase {
   // if packets were removed.
   bool RemovePacketsUntilKeyFrame()
       RTC_EXCLUSIVE_LOCKS_REQUIRED(worker_thread_);
-  std::vector<uint16_t> GetNackBatch(NackFilterOptions options)
+  // Returns the packets to NACK. If `next_nack_time_ms` is not null, it is
+  // lowered to the earliest time at which one of the packets left in the nack
+  // list may be nacked because of the time passed.
+  std::vector<uint16_t> GetNackBatch(NackFilterOptions options,
+                                     int64_t* next_nack_time_ms)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(worker_thread_);
+  // Returns the time to wait before nacking a packet again that has been
+  // nacked `retries` times.
+  TimeDelta ResendDelay(int retries) const
       RTC_EXCLUSIVE_LOCKS_REQUIRED(worker_thread_);
 
   // Update the reordering distribution.
@@ -141,12 +269,9 @@ class NackRequester final : public NackRequesterBase {
   // TODO(philipel): Some of the variables below are consistently used on a
   // known thread (e.g. see `initialized_`). Those probably do not need
   // synchronized access.
-  std::map<uint16_t, NackInfo, DescendingSeqNumComp<uint16_t>> nack_list_
-      RTC_GUARDED_BY(worker_thread_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> keyframe_list_
-      RTC_GUARDED_BY(worker_thread_);
-  std::set<uint16_t, DescendingSeqNumComp<uint16_t>> recovered_list_
-      RTC_GUARDED_BY(worker_thread_);
+  NackList nack_list_ RTC_GUARDED_BY(worker_thread_);
+  SeqNumSet keyframe_list_ RTC_GUARDED_BY(worker_thread_);
+  SeqNumSet recovered_list_ RTC_GUARDED_BY(worker_thread_);
   video_coding::Histogram reordering_histogram_ RTC_GUARDED_BY(worker_thread_);
   bool initialized_ RTC_GUARDED_BY(worker_thread_);
   int64_t rtt_ms_ RTC_GUARDED_BY(worker_thread_);
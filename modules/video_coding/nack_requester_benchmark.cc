@@ -0,0 +1,269 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "benchmark/benchmark.h"
+#include "modules/include/module_common_types.h"
+#include "modules/video_coding/nack_requester.h"
+#include "rtc_base/random.h"
+#include "rtc_base/thread.h"
+#include "system_wrappers/include/clock.h"
+#include "test/time_controller/simulated_time_controller.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kFps = 30;
+// An 8 Mbps stream of 1200 byte packets, about 830 packets per second.
+constexpr int kPacketsPerSecond = 8'000'000 / 8 / 1200;
+constexpr int kPacketsPerFrame = kPacketsPerSecond / kFps;
+constexpr int kPacketsPerInterval =
+    kPacketsPerSecond * NackPeriodicProcessor::kUpdateInterval.ms() / 1000;
+// One key frame every two seconds.
+constexpr int kKeyFrameInterval = 2 * kFps * kPacketsPerFrame;
+// Frames are decoded, and their packets cleared from the NACK list, 200 ms
+// after they are received.
+constexpr int kJitterBufferPackets = kPacketsPerSecond / 5;
+constexpr int64_t kRttMs = 100;
+
+// Retransmits the NACKed packets one round trip later.
+class RetransmittingSender : public NackSender, public KeyFrameRequestSender {
+ public:
+  struct Retransmission {
+    int64_t arrival_time_ms;
+    uint16_t seq_num;
+  };
+
+  explicit RetransmittingSender(Clock* clock) : clock_(clock) {}
+
+  void SendNack(const std::vector<uint16_t>& sequence_numbers,
+                bool buffering_allowed) override {
+    for (uint16_t seq_num : sequence_numbers) {
+      retransmissions_.push_back(
+          {clock_->TimeInMilliseconds() + kRttMs, seq_num});
+    }
+    nacks_ += sequence_numbers.size();
+  }
+
+  void RequestKeyFrame() override { ++key_frame_requests_; }
+
+  std::deque<Retransmission>& retransmissions() { return retransmissions_; }
+  int64_t nacks() const { return nacks_; }
+  int64_t key_frame_requests() const { return key_frame_requests_; }
+
+ private:
+  Clock* const clock_;
+  std::deque<Retransmission> retransmissions_;
+  int64_t nacks_ = 0;
+  int64_t key_frame_requests_ = 0;
+};
+
+// Receives a lossy 8 Mbps stream for one NACK update interval per iteration:
+// the media packets of the interval and the retransmissions arriving in it,
+// of which the same share is lost, then the NACKs are processed. The argument
+// is the packet loss in percent.
+void BM_ReceivePacketsWithLoss(benchmark::State& state) {
+  const int loss_percent = state.range(0);
+  rtc::AutoThread main_thread;
+  SimulatedClock clock(123456);
+  Random random(4711);
+  RetransmittingSender sender(&clock);
+  // NACKs are processed below, in simulated time, rather than periodically.
+  NackPeriodicProcessor periodic_processor(TimeDelta::Seconds(1000));
+  NackRequester nack_requester(TaskQueueBase::Current(), &periodic_processor,
+                               &clock, &sender, &sender);
+  nack_requester.UpdateRtt(kRttMs);
+
+  uint16_t seq_num = 0;
+  int64_t received_packets = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kPacketsPerInterval; ++i) {
+      ++seq_num;
+      if (seq_num % kPacketsPerFrame == 0) {
+        nack_requester.ClearUpTo(seq_num - kJitterBufferPackets);
+        rtc::Thread::Current()->ProcessMessages(0);
+      }
+      if (random.Rand(1, 100) <= loss_percent)
+        continue;
+      const bool is_keyframe = seq_num % kKeyFrameInterval < kPacketsPerFrame;
+      nack_requester.OnReceivedPacket(seq_num, is_keyframe,
+                                      /*is_recovered=*/false);
+      ++received_packets;
+    }
+    clock.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+
+    std::deque<RetransmittingSender::Retransmission>& retransmissions =
+        sender.retransmissions();
+    while (!retransmissions.empty() &&
+           retransmissions.front().arrival_time_ms <=
+               clock.TimeInMilliseconds()) {
+      if (random.Rand(1, 100) > loss_percent) {
+        nack_requester.OnReceivedPacket(retransmissions.front().seq_num,
+                                        /*is_keyframe=*/false,
+                                        /*is_recovered=*/true);
+        ++received_packets;
+      }
+      retransmissions.pop_front();
+    }
+    nack_requester.ProcessNacks();
+  }
+  state.SetItemsProcessed(received_packets);
+  state.counters["nacks"] =
+      benchmark::Counter(sender.nacks(), benchmark::Counter::kAvgIterations);
+  state.counters["key_frame_requests"] = benchmark::Counter(
+      sender.key_frame_requests(), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ReceivePacketsWithLoss)
+    ->Arg(10)
+    ->Arg(20)
+    ->Arg(30)
+    ->ArgName("loss_percent");
+
+// Retransmits the NACKed packets of many streams one round trip later.
+class MultiStreamRetransmittingSender {
+ public:
+  struct Retransmission {
+    int64_t arrival_time_ms;
+    NackRequester* stream;
+    uint16_t seq_num;
+  };
+
+  class StreamSender : public NackSender, public KeyFrameRequestSender {
+   public:
+    StreamSender(MultiStreamRetransmittingSender* sender,
+                 NackRequester** stream)
+        : sender_(sender), stream_(stream) {}
+
+    void SendNack(const std::vector<uint16_t>& sequence_numbers,
+                  bool buffering_allowed) override {
+      for (uint16_t seq_num : sequence_numbers) {
+        sender_->retransmissions_.push_back(
+            {sender_->clock_->TimeInMilliseconds() + kRttMs, *stream_,
+             seq_num});
+      }
+      sender_->nacks_ += sequence_numbers.size();
+    }
+
+    void RequestKeyFrame() override {}
+
+   private:
+    MultiStreamRetransmittingSender* const sender_;
+    NackRequester** const stream_;
+  };
+
+  explicit MultiStreamRetransmittingSender(Clock* clock) : clock_(clock) {}
+
+  std::deque<Retransmission>& retransmissions() { return retransmissions_; }
+  int64_t nacks() const { return nacks_; }
+
+ private:
+  Clock* const clock_;
+  std::deque<Retransmission> retransmissions_;
+  int64_t nacks_ = 0;
+};
+
+// Runs one update of a NackPeriodicProcessor shared by many streams per
+// iteration. In each update one percent of the streams lose a packet, which
+// is retransmitted one round trip after it is nacked, so that a few percent
+// of the streams have packets to NACK at any time. The argument is the number
+// of streams.
+void BM_ProcessNacksOfManyStreams(benchmark::State& state) {
+  const int num_streams = state.range(0);
+  GlobalSimulatedTimeController time_controller(Timestamp::Millis(123456));
+  Clock* const clock = time_controller.GetClock();
+  Random random(4711);
+  MultiStreamRetransmittingSender sender(clock);
+  NackPeriodicProcessor periodic_processor;
+
+  std::vector<NackRequester*> stream_ptrs(num_streams);
+  std::vector<std::unique_ptr<MultiStreamRetransmittingSender::StreamSender>>
+      stream_senders;
+  std::vector<std::unique_ptr<NackRequester>> streams;
+  std::vector<uint16_t> seq_nums(num_streams);
+  for (int i = 0; i < num_streams; ++i) {
+    stream_senders.push_back(
+        std::make_unique<MultiStreamRetransmittingSender::StreamSender>(
+            &sender, &stream_ptrs[i]));
+    streams.push_back(std::make_unique<NackRequester>(
+        TaskQueueBase::Current(), &periodic_processor, clock,
+        stream_senders.back().get(), stream_senders.back().get()));
+    stream_ptrs[i] = streams.back().get();
+    streams.back()->UpdateRtt(kRttMs);
+    streams.back()->OnReceivedPacket(seq_nums[i], /*is_keyframe=*/true,
+                                     /*is_recovered=*/false);
+  }
+
+  for (auto _ : state) {
+    for (int i = 0; i < (num_streams + 99) / 100; ++i) {
+      const int stream = random.Rand(0, num_streams - 1);
+      // The packet before this one is lost.
+      seq_nums[stream] += 2;
+      streams[stream]->OnReceivedPacket(seq_nums[stream],
+                                        /*is_keyframe=*/false,
+                                        /*is_recovered=*/false);
+    }
+
+    std::deque<MultiStreamRetransmittingSender::Retransmission>&
+        retransmissions = sender.retransmissions();
+    while (!retransmissions.empty() &&
+           retransmissions.front().arrival_time_ms <=
+               clock->TimeInMilliseconds()) {
+      retransmissions.front().stream->OnReceivedPacket(
+          retransmissions.front().seq_num, /*is_keyframe=*/false,
+          /*is_recovered=*/true);
+      retransmissions.pop_front();
+    }
+    time_controller.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  }
+  state.SetItemsProcessed(state.iterations() * num_streams);
+  state.counters["nacks"] =
+      benchmark::Counter(sender.nacks(), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ProcessNacksOfManyStreams)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->ArgName("streams");
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core, median of 7), per 20 ms of 8 Mbps stream:
+std::map nack list, std::set key frame and recovered packet lists, every
+packet in the nack list visited for each packet received:
+BM_ReceivePacketsWithLoss/loss_percent:10    3.9 us    4.1M packets/s
+BM_ReceivePacketsWithLoss/loss_percent:20    5.8 us    2.7M packets/s
+BM_ReceivePacketsWithLoss/loss_percent:30    7.6 us    2.1M packets/s
+Nack list in a circular array indexed by sequence number, key frame and
+recovered packet lists in bitsets, only the packets not yet nacked visited
+for each packet received:
+BM_ReceivePacketsWithLoss/loss_percent:10    2.7 us    6.0M packets/s
+BM_ReceivePacketsWithLoss/loss_percent:20    3.1 us    5.2M packets/s
+BM_ReceivePacketsWithLoss/loss_percent:30    3.3 us    4.9M packets/s
+Per update of the NACK periodic processor, every stream processed at each
+update:
+BM_ProcessNacksOfManyStreams/streams:1000      16.1 us
+BM_ProcessNacksOfManyStreams/streams:10000    375 us
+Streams in a timer wheel, processed only at the updates when NACKs may be
+due, 0.9% of the streams at 10000 streams:
+BM_ProcessNacksOfManyStreams/streams:1000      11.5 us
+BM_ProcessNacksOfManyStreams/streams:10000    193 us
+Most of the time left is spent receiving the lost packets and
+retransmissions.
+*/
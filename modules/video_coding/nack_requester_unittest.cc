@@ -19,6 +19,7 @@
 #include "test/field_trial.h"
 #include "test/gtest.h"
 #include "test/run_loop.h"
+#include "test/time_controller/simulated_time_controller.h"
 
 namespace webrtc {
 // TODO(bugs.webrtc.org/11594): Use the use the GlobalSimulatedTimeController
@@ -317,6 +318,38 @@ TEST_P(TestNackRequester, ClearUpToWrap) {
   EXPECT_EQ(0, sent_nacks_[0]);
 }
 
+TEST_P(TestNackRequester, ResendNacksAfterLargeGapAcrossWrap) {
+  NackRequester& nack_module = CreateNackModule(TimeDelta::Millis(1));
+  nack_module.OnReceivedPacket(0xff00, false, false);
+  nack_module.OnReceivedPacket(0xff10, false, false);
+  nack_module.OnReceivedPacket(0x100, false, false);
+  EXPECT_EQ(510u, sent_nacks_.size());
+  for (uint16_t seq_num = 0x7f; seq_num != 0xff7f; --seq_num)
+    nack_module.OnReceivedPacket(seq_num, false, false);
+
+  sent_nacks_.clear();
+  clock_->AdvanceTimeMilliseconds(100);
+  WaitForSendNack();
+  ASSERT_EQ(254u, sent_nacks_.size());
+  EXPECT_EQ(0xff01, sent_nacks_[0]);
+  EXPECT_EQ(0xff11, sent_nacks_[15]);
+  EXPECT_EQ(0xff7f, sent_nacks_[125]);
+  EXPECT_EQ(0x80, sent_nacks_[126]);
+  EXPECT_EQ(0xff, sent_nacks_[253]);
+}
+
+TEST_P(TestNackRequester, HandleFecRecoveredPacketsAcrossWrap) {
+  NackRequester& nack_module = CreateNackModule();
+  nack_module.OnReceivedPacket(0xfffd, false, false);
+  nack_module.OnReceivedPacket(0xffff, false, true);
+  nack_module.OnReceivedPacket(0, false, true);
+  EXPECT_EQ(0u, sent_nacks_.size());
+  nack_module.OnReceivedPacket(2, false, false);
+  ASSERT_EQ(2u, sent_nacks_.size());
+  EXPECT_EQ(0xfffe, sent_nacks_[0]);
+  EXPECT_EQ(1, sent_nacks_[1]);
+}
+
 TEST_P(TestNackRequester, PacketNackCount) {
   NackRequester& nack_module = CreateNackModule(TimeDelta::Millis(1));
   EXPECT_EQ(0, nack_module.OnReceivedPacket(0, false, false));
@@ -417,4 +450,88 @@ TEST_F(TestNackRequesterWithFieldTrial, SendNackWithDelay) {
   nack_module_.OnReceivedPacket(109, false, false);
   EXPECT_EQ(104u, sent_nacks_.size());
 }
+
+class FakeNackModule : public NackRequesterBase {
+ public:
+  TimeDelta ProcessNacks() override {
+    ++num_processed_;
+    return next_nack_delay_;
+  }
+
+  TimeDelta next_nack_delay_ = TimeDelta::PlusInfinity();
+  int num_processed_ = 0;
+};
+
+class TestNackPeriodicProcessor : public ::testing::Test {
+ protected:
+  TestNackPeriodicProcessor()
+      : time_controller_(Timestamp::Millis(1000)),
+        registration_(&module_, &nack_periodic_processor_) {}
+
+  GlobalSimulatedTimeController time_controller_;
+  NackPeriodicProcessor nack_periodic_processor_;
+  FakeNackModule module_;
+  ScopedNackPeriodicProcessorRegistration registration_;
+};
+
+TEST_F(TestNackPeriodicProcessor, ProcessesModuleOnlyWhenScheduled) {
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_EQ(0, module_.num_processed_);
+
+  registration_.ScheduleNackModule();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(1, module_.num_processed_);
+
+  // Nothing left to NACK.
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_EQ(1, module_.num_processed_);
+}
+
+TEST_F(TestNackPeriodicProcessor, ProcessesModuleAtLastUpdateBeforeDue) {
+  module_.next_nack_delay_ = TimeDelta::Millis(70);
+  registration_.ScheduleNackModule();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(1, module_.num_processed_);
+
+  // Due in 70 ms, so processed after three updates, 60 ms.
+  module_.next_nack_delay_ = TimeDelta::Millis(10);
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval * 2);
+  EXPECT_EQ(1, module_.num_processed_);
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(2, module_.num_processed_);
+
+  // Due before the next update, so processed at every update.
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(3, module_.num_processed_);
+  module_.next_nack_delay_ = TimeDelta::PlusInfinity();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(4, module_.num_processed_);
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_EQ(4, module_.num_processed_);
+}
+
+TEST_F(TestNackPeriodicProcessor, SchedulingMovesModuleToNextUpdate) {
+  module_.next_nack_delay_ = TimeDelta::Seconds(1);
+  registration_.ScheduleNackModule();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(1, module_.num_processed_);
+
+  registration_.ScheduleNackModule();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(2, module_.num_processed_);
+  // Processed once when due, not again when it was first scheduled for.
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_EQ(3, module_.num_processed_);
+}
+
+TEST_F(TestNackPeriodicProcessor, ProcessesModuleDueLaterThanTimerWheelSpan) {
+  module_.next_nack_delay_ = TimeDelta::Seconds(10);
+  registration_.ScheduleNackModule();
+  time_controller_.AdvanceTime(NackPeriodicProcessor::kUpdateInterval);
+  EXPECT_EQ(1, module_.num_processed_);
+
+  // Processed every 64 updates, 1.28 s, as far ahead as it can be scheduled.
+  time_controller_.AdvanceTime(TimeDelta::Seconds(10));
+  EXPECT_EQ(8, module_.num_processed_);
+}
 }  // namespace webrtc
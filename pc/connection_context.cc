@@ -98,7 +98,8 @@ ConnectionContext::ConnectionContext(
                                  network_thread())),
       trials_(dependencies->trials
                   ? std::move(dependencies->trials)
-                  : std::make_unique<FieldTrialBasedConfig>()) {
+                  : std::make_unique<FieldTrialBasedConfig>()),
+      task_queue_factory_(dependencies->task_queue_factory.get()) {
   signaling_thread_->AllowInvokesToThread(worker_thread_);
   signaling_thread_->AllowInvokesToThread(network_thread_);
   worker_thread_->AllowInvokesToThread(network_thread_);
@@ -20,6 +20,7 @@
 #include "api/ref_counted_base.h"
 #include "api/scoped_refptr.h"
 #include "api/sequence_checker.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "api/transport/sctp_transport_factory_interface.h"
 #include "api/transport/webrtc_key_value_config.h"
 #include "media/base/media_engine.h"
@@ -76,6 +77,10 @@ class ConnectionContext final
 
   const WebRtcKeyValueConfig& trials() const { return *trials_.get(); }
 
+  // Owned by the PeerConnectionFactory, which must outlive the
+  // PeerConnections using it, as their Calls do. May be null.
+  TaskQueueFactory* task_queue_factory() const { return task_queue_factory_; }
+
   // Accessors only used from the PeerConnectionFactory class
   rtc::BasicNetworkManager* default_network_manager() {
     RTC_DCHECK_RUN_ON(signaling_thread_);
@@ -124,6 +129,7 @@ class ConnectionContext final
   std::unique_ptr<SctpTransportFactoryInterface> const sctp_factory_;
   // Accessed both on signaling thread and worker thread.
   std::unique_ptr<WebRtcKeyValueConfig> const trials_;
+  TaskQueueFactory* const task_queue_factory_;
 };
 
 }  // namespace webrtc
@@ -487,9 +487,18 @@ JsepTransportController::CreateSdesTransport(
   if (config_.enable_external_auth) {
     srtp_transport->EnableExternalAuth();
   }
+  MaybeEnableParallelUnprotect(srtp_transport.get());
   return srtp_transport;
 }
 
+void JsepTransportController::MaybeEnableParallelUnprotect(
+    SrtpTransport* srtp_transport) {
+  if (config_.srtp_unprotect_workers > 0 && config_.task_queue_factory) {
+    srtp_transport->EnableParallelUnprotect(config_.task_queue_factory,
+                                            config_.srtp_unprotect_workers);
+  }
+}
+
 std::unique_ptr<webrtc::DtlsSrtpTransport>
 JsepTransportController::CreateDtlsSrtpTransport(
     const std::string& transport_name,
@@ -501,6 +510,7 @@ JsepTransportController::CreateDtlsSrtpTransport(
   if (config_.enable_external_auth) {
     dtls_srtp_transport->EnableExternalAuth();
   }
+  MaybeEnableParallelUnprotect(dtls_srtp_transport.get());
 
   dtls_srtp_transport->SetDtlsTransports(rtp_dtls_transport,
                                          rtcp_dtls_transport);
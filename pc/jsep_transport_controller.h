@@ -32,6 +32,7 @@
 #include "api/rtc_event_log/rtc_event_log.h"
 #include "api/scoped_refptr.h"
 #include "api/sequence_checker.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "api/transport/data_channel_transport_interface.h"
 #include "api/transport/sctp_transport_factory_interface.h"
 #include "media/sctp/sctp_transport_internal.h"
@@ -120,6 +121,11 @@ class JsepTransportController : public sigslot::has_slots<> {
         PeerConnectionInterface::kRtcpMuxPolicyRequire;
     bool disable_encryption = false;
     bool enable_external_auth = false;
+    // If positive, received SRTP packets are unprotected on this many task
+    // queues created by `task_queue_factory`, see
+    // SrtpTransport::EnableParallelUnprotect().
+    int srtp_unprotect_workers = 0;
+    TaskQueueFactory* task_queue_factory = nullptr;
     // Used to inject the ICE/DTLS transports created externally.
     webrtc::IceTransportFactory* ice_transport_factory = nullptr;
     cricket::DtlsTransportFactory* dtls_transport_factory = nullptr;
@@ -400,6 +406,9 @@ class JsepTransportController : public sigslot::has_slots<> {
       const std::string& transport_name,
       cricket::DtlsTransportInternal* rtp_dtls_transport,
       cricket::DtlsTransportInternal* rtcp_dtls_transport);
+  // Makes `srtp_transport` unprotect on several task queues if the config
+  // asks for it.
+  void MaybeEnableParallelUnprotect(SrtpTransport* srtp_transport);
   std::unique_ptr<webrtc::DtlsSrtpTransport> CreateDtlsSrtpTransport(
       const std::string& transport_name,
       cricket::DtlsTransportInternal* rtp_dtls_transport,
@@ -48,6 +48,7 @@
 #include "pc/sctp_transport.h"
 #include "pc/simulcast_description.h"
 #include "pc/webrtc_session_description_factory.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/location.h"
@@ -681,6 +682,13 @@ void PeerConnection::InitializeTransportController_n(
   config.enable_external_auth = true;
 #endif
   config.active_reset_srtp_params = configuration.active_reset_srtp_params;
+  // Unprotects received SRTP packets on the given number of task queues, e.g.
+  // "WebRTC-SrtpParallelUnprotect/workers:4/".
+  FieldTrialParameter<int> srtp_unprotect_workers("workers", 0);
+  ParseFieldTrial({&srtp_unprotect_workers},
+                  context_->trials().Lookup("WebRTC-SrtpParallelUnprotect"));
+  config.srtp_unprotect_workers = srtp_unprotect_workers;
+  config.task_queue_factory = context_->task_queue_factory();
 
   // DTLS has to be enabled to use SCTP.
   if (dtls_enabled_) {
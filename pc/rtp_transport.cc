@@ -11,6 +11,8 @@
 #include "pc/rtp_transport.h"
 
 #include <errno.h>
+#include <string.h>
+
 #include <string>
 #include <utility>
 
@@ -25,6 +27,19 @@
 #include "rtc_base/trace_event.h"
 
 namespace webrtc {
+namespace {
+
+// Enough to cover the packets in flight between the network thread and the
+// decoders of a few streams.
+constexpr size_t kMaxFreeReceiveBuffers = 128;
+
+}  // namespace
+
+RtpTransport::RtpTransport(bool rtcp_mux_enabled)
+    : rtcp_mux_enabled_(rtcp_mux_enabled),
+      receive_buffer_pool_(
+          rtc::CopyOnWriteBufferPool::Create(cricket::kMaxRtpPacketLen,
+                                             kMaxFreeReceiveBuffers)) {}
 
 void RtpTransport::SetRtcpMuxEnabled(bool enable) {
   rtcp_mux_enabled_ = enable;
@@ -229,7 +244,7 @@ void RtpTransport::OnSentPacket(rtc::PacketTransportInternal* packet_transport,
 
 void RtpTransport::OnRtpPacketReceived(rtc::CopyOnWriteBuffer packet,
                                        int64_t packet_time_us) {
-  DemuxPacket(packet, packet_time_us);
+  DemuxPacket(std::move(packet), packet_time_us);
 }
 
 void RtpTransport::OnRtcpPacketReceived(rtc::CopyOnWriteBuffer packet,
@@ -261,7 +276,8 @@ void RtpTransport::OnReadPacket(rtc::PacketTransportInternal* transport,
     return;
   }
 
-  rtc::CopyOnWriteBuffer packet(data, len);
+  rtc::CopyOnWriteBuffer packet = receive_buffer_pool_->Allocate(len);
+  memcpy(packet.MutableData(), data, len);
   if (packet_type == cricket::RtpPacketType::kRtcp) {
     OnRtcpPacketReceived(std::move(packet), packet_time_us);
   } else {
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/rtp_parameters.h"
+#include "benchmark/benchmark.h"
+#include "call/rtp_demuxer.h"
+#include "call/rtp_packet_sink_interface.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "p2p/base/fake_packet_transport.h"
+#include "pc/rtp_transport.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumSsrcs = 16;
+constexpr size_t kPayloadSize = 1100;
+// One in `kRtcpInterval` packets received is RTCP.
+constexpr int kRtcpInterval = 50;
+
+class CountingSink : public RtpPacketSinkInterface,
+                     public sigslot::has_slots<> {
+ public:
+  void OnRtpPacket(const RtpPacketReceived& packet) override { ++packets_; }
+  void OnRtcpPacket(rtc::CopyOnWriteBuffer* packet, int64_t packet_time_us) {
+    ++packets_;
+  }
+
+  int64_t packets() const { return packets_; }
+
+ private:
+  int64_t packets_ = 0;
+};
+
+std::vector<RtpExtension> ExtensionsToRegister() {
+  return {RtpExtension(RtpExtension::kTransportSequenceNumberUri, 1),
+          RtpExtension(RtpExtension::kAbsSendTimeUri, 2),
+          RtpExtension(RtpExtension::kVideoRotationUri, 3),
+          RtpExtension(RtpExtension::kMidUri, 4)};
+}
+
+// Returns video packets with the registered extensions, round robin over
+// `kNumSsrcs` streams, with an RTCP receiver report every
+// `kRtcpInterval` packets.
+std::vector<rtc::CopyOnWriteBuffer> BuildPackets() {
+  const RtpHeaderExtensionMap extensions(ExtensionsToRegister());
+  std::vector<rtc::CopyOnWriteBuffer> packets;
+  for (int i = 0; i < kNumSsrcs * kRtcpInterval; ++i) {
+    if (i % kRtcpInterval == kRtcpInterval - 1) {
+      // Empty receiver report.
+      const uint8_t kRtcpReport[] = {0x80, 201, 0x00, 0x01,
+                                     0x00, 0x00, 0x00, 0x01};
+      packets.emplace_back(kRtcpReport);
+      continue;
+    }
+    RtpPacketToSend packet(&extensions);
+    packet.SetPayloadType(96);
+    packet.SetSequenceNumber(i);
+    packet.SetTimestamp(i * 3000);
+    packet.SetSsrc(1 + i % kNumSsrcs);
+    packet.SetExtension<TransportSequenceNumber>(i);
+    packet.SetExtension<AbsoluteSendTime>(i);
+    packet.SetExtension<VideoOrientation>(kVideoRotation_0);
+    packet.SetExtension<RtpMid>("video");
+    packet.SetPayloadSize(kPayloadSize);
+    packets.push_back(packet.Buffer());
+  }
+  return packets;
+}
+
+// Receives packets on an RtpTransport with RTCP muxing, as an SFU does for
+// each of its clients. Every packet is classified, copied, and RTP packets are
+// parsed and demuxed to a sink by SSRC.
+void BM_ReceivePackets(benchmark::State& state) {
+  const std::vector<rtc::CopyOnWriteBuffer> packets = BuildPackets();
+  rtc::FakePacketTransport packet_transport("fake");
+  RtpTransport transport(/*rtcp_mux_enabled=*/true);
+  transport.SetRtpPacketTransport(&packet_transport);
+  transport.UpdateRtpHeaderExtensionMap(ExtensionsToRegister());
+  CountingSink sink;
+  RtpDemuxerCriteria criteria;
+  criteria.mid = "video";
+  for (int i = 0; i < kNumSsrcs; ++i) {
+    criteria.ssrcs.insert(1 + i);
+  }
+  transport.RegisterRtpDemuxerSink(criteria, &sink);
+  transport.SignalRtcpPacketReceived.connect(&sink,
+                                             &CountingSink::OnRtcpPacket);
+
+  for (auto _ : state) {
+    for (const rtc::CopyOnWriteBuffer& packet : packets) {
+      packet_transport.SignalReadPacket(&packet_transport,
+                                        packet.data<char>(), packet.size(),
+                                        /*packet_time_us=*/-1, /*flags=*/0);
+    }
+  }
+  RTC_CHECK_EQ(sink.packets(),
+               static_cast<int64_t>(state.iterations() * packets.size()));
+  state.SetItemsProcessed(sink.packets());
+  transport.UnregisterRtpDemuxerSink(&sink);
+  transport.SetRtpPacketTransport(nullptr);
+}
+
+BENCHMARK(BM_ReceivePackets);
+
+}  // namespace
+}  // namespace webrtc
+
+/* Results (Linux, single core, median of 7), per 800 packets:
+Classifying as RTCP first, copying the buffer into DemuxPacket:
+BM_ReceivePackets    610 us    1.31M packets/s
+Classifying as RTP first, moving the buffer into DemuxPacket:
+BM_ReceivePackets    554 us    1.44M packets/s
+*/
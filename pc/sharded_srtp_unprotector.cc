@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/sharded_srtp_unprotector.h"
+
+#include <utility>
+
+#include "modules/rtp_rtcp/source/rtp_util.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+
+namespace webrtc {
+
+struct ShardedSrtpUnprotector::Shard {
+  Mutex mutex;
+  // Posted tasks not yet run. A task to run them is posted to `task_queue`
+  // when the first one is added.
+  std::vector<std::unique_ptr<QueuedTask>> pending_tasks RTC_GUARDED_BY(mutex);
+  // Created and used on `task_queue`. Destroyed with the shard, on the
+  // origin, after `task_queue`, which is declared after it, has been deleted
+  // and has stopped running tasks.
+  std::unique_ptr<cricket::SrtpSession> session;
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> task_queue;
+};
+
+ShardedSrtpUnprotector::ShardedSrtpUnprotector(
+    TaskQueueFactory* task_queue_factory,
+    int num_shards,
+    DeliverPacketCallback deliver_packet,
+    UnprotectFailureCallback unprotect_failure)
+    : origin_(TaskQueueBase::Current()),
+      deliver_packet_(std::move(deliver_packet)),
+      unprotect_failure_(std::move(unprotect_failure)) {
+  RTC_DCHECK(origin_);
+  RTC_DCHECK_GT(num_shards, 0);
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<Shard>();
+    shard->task_queue = task_queue_factory->CreateTaskQueue(
+        "SrtpUnprotect", TaskQueueFactory::Priority::NORMAL);
+    shards_.push_back(std::move(shard));
+  }
+}
+
+ShardedSrtpUnprotector::~ShardedSrtpUnprotector() {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  // Running tasks use the members below, so the shards must stop first.
+  shards_.clear();
+}
+
+void ShardedSrtpUnprotector::SetRecv(int cs,
+                                     const uint8_t* key,
+                                     int len,
+                                     const std::vector<int>& extension_ids) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    PostToShard(
+        shard.get(),
+        ToQueuedTask([shard = shard.get(), cs,
+                      key = rtc::ZeroOnFreeBuffer<uint8_t>(key, len),
+                      extension_ids] {
+          bool ret;
+          if (!shard->session) {
+            shard->session = std::make_unique<cricket::SrtpSession>();
+            ret = shard->session->SetRecv(cs, key.data(), key.size(),
+                                          extension_ids);
+          } else {
+            ret = shard->session->UpdateRecv(cs, key.data(), key.size(),
+                                             extension_ids);
+          }
+          if (!ret) {
+            RTC_LOG(LS_ERROR) << "Failed to set the SRTP params of a shard.";
+            shard->session = nullptr;
+          }
+        }));
+  }
+}
+
+void ShardedSrtpUnprotector::Reset() {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    PostToShard(shard.get(), ToQueuedTask([shard = shard.get()] {
+                  shard->session = nullptr;
+                }));
+  }
+}
+
+void ShardedSrtpUnprotector::UnprotectRtp(rtc::CopyOnWriteBuffer packet,
+                                          int64_t packet_time_us) {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  Shard* shard = shards_[ParseRtpSsrc(packet) % shards_.size()].get();
+  PostToShard(shard,
+              CreateUnprotectTask(shard, std::move(packet), packet_time_us));
+}
+
+std::unique_ptr<QueuedTask> ShardedSrtpUnprotector::CreateUnprotectTask(
+    Shard* shard,
+    rtc::CopyOnWriteBuffer packet,
+    int64_t packet_time_us) {
+  return ToQueuedTask(
+      [this, shard, packet = std::move(packet), packet_time_us]() mutable {
+        if (!shard->session) {
+          return;
+        }
+        char* data = packet.MutableData<char>();
+        int len = rtc::checked_cast<int>(packet.size());
+        const bool unprotected = shard->session->UnprotectRtp(data, len, &len);
+        if (unprotected) {
+          packet.SetSize(len);
+        }
+        AddProcessedPacket({std::move(packet), packet_time_us, unprotected});
+      });
+}
+
+// static
+void ShardedSrtpUnprotector::PostToShard(
+    Shard* shard,
+    std::vector<std::unique_ptr<QueuedTask>> tasks) {
+  bool post_task;
+  {
+    MutexLock lock(&shard->mutex);
+    post_task = shard->pending_tasks.empty();
+    if (post_task) {
+      shard->pending_tasks = std::move(tasks);
+    } else {
+      for (std::unique_ptr<QueuedTask>& task : tasks) {
+        shard->pending_tasks.push_back(std::move(task));
+      }
+    }
+  }
+  if (post_task) {
+    shard->task_queue->PostTask(
+        ToQueuedTask([shard] { RunPendingTasks(shard); }));
+  }
+}
+
+// static
+void ShardedSrtpUnprotector::PostToShard(Shard* shard,
+                                         std::unique_ptr<QueuedTask> task) {
+  std::vector<std::unique_ptr<QueuedTask>> tasks;
+  tasks.push_back(std::move(task));
+  PostToShard(shard, std::move(tasks));
+}
+
+// static
+void ShardedSrtpUnprotector::RunPendingTasks(Shard* shard) {
+  std::vector<std::unique_ptr<QueuedTask>> tasks;
+  {
+    MutexLock lock(&shard->mutex);
+    tasks.swap(shard->pending_tasks);
+  }
+  for (std::unique_ptr<QueuedTask>& task : tasks) {
+    if (!task->Run()) {
+      task.release();
+    }
+  }
+}
+
+void ShardedSrtpUnprotector::AddProcessedPacket(ProcessedPacket packet) {
+  bool post_task;
+  {
+    MutexLock lock(&processed_mutex_);
+    post_task = processed_packets_.empty();
+    processed_packets_.push_back(std::move(packet));
+  }
+  if (post_task) {
+    origin_->PostTask(
+        ToQueuedTask(safety_.flag(), [this] { DeliverProcessedPackets(); }));
+  }
+}
+
+void ShardedSrtpUnprotector::DeliverProcessedPackets() {
+  RTC_DCHECK_RUN_ON(&sequence_checker_);
+  std::vector<ProcessedPacket> packets;
+  {
+    MutexLock lock(&processed_mutex_);
+    packets.swap(processed_packets_);
+  }
+  for (ProcessedPacket& packet : packets) {
+    if (packet.unprotected) {
+      deliver_packet_(std::move(packet.packet), packet.packet_time_us);
+    } else {
+      unprotect_failure_(packet.packet);
+    }
+  }
+}
+
+}  // namespace webrtc
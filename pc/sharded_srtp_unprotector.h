@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef PC_SHARDED_SRTP_UNPROTECTOR_H_
+#define PC_SHARDED_SRTP_UNPROTECTOR_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "api/sequence_checker.h"
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/no_unique_address.h"
+#include "rtc_base/task_utils/pending_task_safety_flag.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Unprotects received SRTP packets on a set of task queues instead of on the
+// network thread, for transports receiving more packets than one core can
+// decrypt. Packets are sharded by SSRC, and each shard has an SrtpSession of
+// its own, so the streams of an SSRC, and their replay windows, are only
+// ever touched by one task queue. Unprotected packets, and the packets that
+// failed to be unprotected, are handed back on the task queue the
+// unprotector was created on, in the order they were received for each
+// SSRC. Packets of different SSRCs may be reordered.
+//
+// Work is handed to a shard, and unprotected packets back, in batches of
+// whatever is pending, so that a busy transport doesn't cost a task per
+// packet and hop.
+class ShardedSrtpUnprotector {
+ public:
+  using DeliverPacketCallback =
+      std::function<void(rtc::CopyOnWriteBuffer packet,
+                         int64_t packet_time_us)>;
+  using UnprotectFailureCallback =
+      std::function<void(const rtc::CopyOnWriteBuffer& packet)>;
+
+  // Creates `num_shards` task queues with `task_queue_factory`, which must
+  // outlive the unprotector. `deliver_packet` is called with each
+  // unprotected packet, and `unprotect_failure` with each packet that the
+  // session of its shard failed to unprotect.
+  ShardedSrtpUnprotector(TaskQueueFactory* task_queue_factory,
+                         int num_shards,
+                         DeliverPacketCallback deliver_packet,
+                         UnprotectFailureCallback unprotect_failure);
+  ~ShardedSrtpUnprotector();
+
+  ShardedSrtpUnprotector(const ShardedSrtpUnprotector&) = delete;
+  ShardedSrtpUnprotector& operator=(const ShardedSrtpUnprotector&) = delete;
+
+  // Sets the receive key of the sessions of all shards, or updates it if it
+  // has been set. The parameters must already have been accepted by an
+  // SrtpSession, since failures on the shards aren't reported.
+  void SetRecv(int cs,
+               const uint8_t* key,
+               int len,
+               const std::vector<int>& extension_ids);
+  // Drops the sessions of all shards. Packets are dropped until SetRecv()
+  // is called again.
+  void Reset();
+
+  // Unprotects the RTP `packet` on the shard of its SSRC, and delivers it if
+  // it could be unprotected.
+  void UnprotectRtp(rtc::CopyOnWriteBuffer packet, int64_t packet_time_us);
+
+ private:
+  struct Shard;
+  struct ProcessedPacket {
+    rtc::CopyOnWriteBuffer packet;
+    int64_t packet_time_us;
+    bool unprotected;
+  };
+
+  std::unique_ptr<QueuedTask> CreateUnprotectTask(
+      Shard* shard,
+      rtc::CopyOnWriteBuffer packet,
+      int64_t packet_time_us);
+  // Runs `tasks` on `shard` after the tasks already posted to it.
+  static void PostToShard(Shard* shard,
+                          std::vector<std::unique_ptr<QueuedTask>> tasks);
+  static void PostToShard(Shard* shard, std::unique_ptr<QueuedTask> task);
+  static void RunPendingTasks(Shard* shard);
+
+  // Called on the shards, queues `packet` to be handed back to the origin.
+  void AddProcessedPacket(ProcessedPacket packet);
+  void DeliverProcessedPackets();
+
+  RTC_NO_UNIQUE_ADDRESS SequenceChecker sequence_checker_;
+  TaskQueueBase* const origin_;
+  const DeliverPacketCallback deliver_packet_;
+  const UnprotectFailureCallback unprotect_failure_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  Mutex processed_mutex_;
+  std::vector<ProcessedPacket> processed_packets_
+      RTC_GUARDED_BY(processed_mutex_);
+  ScopedTaskSafety safety_;
+};
+
+}  // namespace webrtc
+
+#endif  // PC_SHARDED_SRTP_UNPROTECTOR_H_
@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "pc/sharded_srtp_unprotector.h"
+#include "pc/srtp_session.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kNumSsrcs = 16;
+constexpr int kPacketsPerSsrc = 64;
+constexpr size_t kRtpHeaderSize = 12;
+constexpr size_t kPayloadSize = 1200;
+constexpr size_t kAuthTagSize = 10;
+constexpr int kCipherSuite = rtc::kSrtpAes128CmSha1_80;
+constexpr uint8_t kKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ1234";
+constexpr int kKeyLen = 30;
+
+// Protects the next `kPacketsPerSsrc` packets of each of `kNumSsrcs`
+// streams, interleaved like packets of a simulcast publisher.
+class PacketSource {
+ public:
+  PacketSource() {
+    RTC_CHECK(sender_.SetSend(kCipherSuite, kKey, kKeyLen, {}));
+  }
+
+  std::vector<rtc::CopyOnWriteBuffer> NextPackets() {
+    std::vector<rtc::CopyOnWriteBuffer> packets;
+    for (int i = 0; i < kPacketsPerSsrc; ++i) {
+      for (uint32_t ssrc = 1; ssrc <= kNumSsrcs; ++ssrc) {
+        rtc::CopyOnWriteBuffer packet(
+            kRtpHeaderSize + kPayloadSize,
+            kRtpHeaderSize + kPayloadSize + kAuthTagSize);
+        uint8_t* data = packet.MutableData();
+        data[0] = 0x80;
+        data[1] = 96;
+        rtc::SetBE16(data + 2, sequence_number_);
+        rtc::SetBE32(data + 4, 0);
+        rtc::SetBE32(data + 8, ssrc);
+        int len = static_cast<int>(packet.size());
+        RTC_CHECK(sender_.ProtectRtp(data, len,
+                                     static_cast<int>(packet.capacity()),
+                                     &len));
+        packet.SetSize(len);
+        packets.push_back(std::move(packet));
+      }
+      ++sequence_number_;
+    }
+    return packets;
+  }
+
+ private:
+  cricket::SrtpSession sender_;
+  uint16_t sequence_number_ = 0;
+};
+
+// Unprotects the packets of a transport on the network thread.
+void BM_UnprotectOnNetworkThread(benchmark::State& state) {
+  PacketSource source;
+  cricket::SrtpSession receiver;
+  RTC_CHECK(receiver.SetRecv(kCipherSuite, kKey, kKeyLen, {}));
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<rtc::CopyOnWriteBuffer> packets = source.NextPackets();
+    state.ResumeTiming();
+    for (rtc::CopyOnWriteBuffer& packet : packets) {
+      int len = static_cast<int>(packet.size());
+      RTC_CHECK(receiver.UnprotectRtp(packet.MutableData(), len, &len));
+      packet.SetSize(len);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumSsrcs * kPacketsPerSsrc);
+}
+
+// Unprotects the packets of a transport with a ShardedSrtpUnprotector, and
+// waits for them to be handed back to the network thread. The argument is
+// the number of shards.
+void BM_UnprotectSharded(benchmark::State& state) {
+  rtc::Thread* network_thread =
+      rtc::ThreadManager::Instance()->WrapCurrentThread();
+  std::unique_ptr<TaskQueueFactory> task_queue_factory =
+      CreateDefaultTaskQueueFactory();
+  PacketSource source;
+  size_t delivered = 0;
+  // Stops processing messages once all packets have been delivered.
+  auto unprotector = std::make_unique<ShardedSrtpUnprotector>(
+      task_queue_factory.get(), state.range(0),
+      [&delivered, network_thread](rtc::CopyOnWriteBuffer packet,
+                                   int64_t packet_time_us) {
+        if (++delivered == kNumSsrcs * kPacketsPerSsrc)
+          network_thread->Quit();
+      },
+      [](const rtc::CopyOnWriteBuffer& packet) { RTC_CHECK_NOTREACHED(); });
+  unprotector->SetRecv(kCipherSuite, kKey, kKeyLen, {});
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<rtc::CopyOnWriteBuffer> packets = source.NextPackets();
+    delivered = 0;
+    network_thread->Restart();
+    state.ResumeTiming();
+    for (rtc::CopyOnWriteBuffer& packet : packets) {
+      unprotector->UnprotectRtp(std::move(packet), /*packet_time_us=*/0);
+    }
+    network_thread->ProcessMessages(rtc::ThreadManager::kForever);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumSsrcs * kPacketsPerSsrc);
+  unprotector = nullptr;
+  rtc::ThreadManager::Instance()->UnwrapCurrentThread();
+}
+
+BENCHMARK(BM_UnprotectOnNetworkThread)->UseRealTime();
+BENCHMARK(BM_UnprotectSharded)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->ArgName("shards")
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "pc/sharded_srtp_unprotector.h"
+
+#include <string.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "media/base/fake_rtp.h"
+#include "pc/srtp_session.h"
+#include "pc/test/srtp_test_util.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::rtc::kSrtpAes128CmSha1_80;
+using ::rtc::kTestKey1;
+using ::rtc::kTestKeyLen;
+
+constexpr int kNumShards = 4;
+constexpr uint32_t kNumSsrcs = 16;
+constexpr uint16_t kPacketsPerSsrc = 200;
+constexpr int kTimeoutMs = 10000;
+
+class ShardedSrtpUnprotectorTest : public ::testing::Test {
+ protected:
+  ShardedSrtpUnprotectorTest()
+      : task_queue_factory_(CreateDefaultTaskQueueFactory()),
+        unprotector_(task_queue_factory_.get(),
+                     kNumShards,
+                     [this](rtc::CopyOnWriteBuffer packet,
+                            int64_t packet_time_us) {
+                       received_.push_back(std::move(packet));
+                     },
+                     [this](const rtc::CopyOnWriteBuffer& packet) {
+                       failed_.push_back(packet);
+                     }) {
+    EXPECT_TRUE(sender_.SetSend(kSrtpAes128CmSha1_80, kTestKey1, kTestKeyLen,
+                                {}));
+  }
+
+  rtc::CopyOnWriteBuffer MakeProtectedPacket(uint32_t ssrc,
+                                             uint16_t sequence_number) {
+    rtc::CopyOnWriteBuffer packet(kPcmuFrame, sizeof(kPcmuFrame),
+                                  sizeof(kPcmuFrame) + 10);
+    rtc::SetBE16(packet.MutableData() + 2, sequence_number);
+    rtc::SetBE32(packet.MutableData() + 8, ssrc);
+    int len = static_cast<int>(packet.size());
+    EXPECT_TRUE(sender_.ProtectRtp(packet.MutableData(), len,
+                                   static_cast<int>(packet.capacity()), &len));
+    packet.SetSize(len);
+    return packet;
+  }
+
+  rtc::AutoThread main_thread_;
+  std::unique_ptr<TaskQueueFactory> task_queue_factory_;
+  cricket::SrtpSession sender_;
+  ShardedSrtpUnprotector unprotector_;
+  std::vector<rtc::CopyOnWriteBuffer> received_;
+  std::vector<rtc::CopyOnWriteBuffer> failed_;
+};
+
+TEST_F(ShardedSrtpUnprotectorTest, DeliversPacketsOfEachSsrcInOrder) {
+  unprotector_.SetRecv(kSrtpAes128CmSha1_80, kTestKey1, kTestKeyLen, {});
+  for (uint16_t sequence_number = 0; sequence_number < kPacketsPerSsrc;
+       ++sequence_number) {
+    for (uint32_t ssrc = 1; ssrc <= kNumSsrcs; ++ssrc) {
+      rtc::CopyOnWriteBuffer packet =
+          MakeProtectedPacket(ssrc, sequence_number);
+      if (sequence_number % 10 == 0) {
+        // Replayed packets fail to be unprotected by the session of the
+        // shard.
+        unprotector_.UnprotectRtp(packet, /*packet_time_us=*/0);
+      }
+      unprotector_.UnprotectRtp(std::move(packet), /*packet_time_us=*/0);
+    }
+  }
+
+  ASSERT_EQ_WAIT(kNumSsrcs * kPacketsPerSsrc, received_.size(), kTimeoutMs);
+  // Nothing else is delivered.
+  rtc::Thread::Current()->ProcessMessages(100);
+  EXPECT_EQ(kNumSsrcs * kPacketsPerSsrc, received_.size());
+  EXPECT_EQ(kNumSsrcs * kPacketsPerSsrc / 10, failed_.size());
+
+  std::map<uint32_t, uint16_t> next_sequence_numbers;
+  for (const rtc::CopyOnWriteBuffer& packet : received_) {
+    ASSERT_EQ(sizeof(kPcmuFrame), packet.size());
+    uint32_t ssrc = rtc::GetBE32(packet.data() + 8);
+    EXPECT_EQ(next_sequence_numbers[ssrc]++, rtc::GetBE16(packet.data() + 2));
+    EXPECT_EQ(0, memcmp(packet.data() + 12, kPcmuFrame + 12,
+                        sizeof(kPcmuFrame) - 12));
+  }
+  EXPECT_EQ(kNumSsrcs, next_sequence_numbers.size());
+}
+
+TEST_F(ShardedSrtpUnprotectorTest, ReportsPacketsThatFailToUnprotect) {
+  unprotector_.SetRecv(kSrtpAes128CmSha1_80, kTestKey1, kTestKeyLen, {});
+  rtc::CopyOnWriteBuffer packet = MakeProtectedPacket(1, 2);
+  unprotector_.UnprotectRtp(MakeProtectedPacket(1, 1), /*packet_time_us=*/0);
+  unprotector_.UnprotectRtp(packet, /*packet_time_us=*/0);
+  // Replayed.
+  unprotector_.UnprotectRtp(packet, /*packet_time_us=*/0);
+  unprotector_.UnprotectRtp(MakeProtectedPacket(1, 3), /*packet_time_us=*/0);
+
+  ASSERT_EQ_WAIT(3u, received_.size(), kTimeoutMs);
+  ASSERT_EQ(1u, failed_.size());
+  EXPECT_EQ(packet.size(), failed_[0].size());
+  EXPECT_EQ(2, rtc::GetBE16(failed_[0].data() + 2));
+  EXPECT_EQ(1u, rtc::GetBE32(failed_[0].data() + 8));
+}
+
+TEST_F(ShardedSrtpUnprotectorTest, DropsPacketsAfterReset) {
+  unprotector_.SetRecv(kSrtpAes128CmSha1_80, kTestKey1, kTestKeyLen, {});
+  unprotector_.UnprotectRtp(MakeProtectedPacket(1, 1), /*packet_time_us=*/0);
+  unprotector_.Reset();
+  unprotector_.UnprotectRtp(MakeProtectedPacket(1, 2), /*packet_time_us=*/0);
+  unprotector_.SetRecv(kSrtpAes128CmSha1_80, kTestKey1, kTestKeyLen, {});
+  unprotector_.UnprotectRtp(MakeProtectedPacket(1, 3), /*packet_time_us=*/0);
+
+  ASSERT_EQ_WAIT(2u, received_.size(), kTimeoutMs);
+  rtc::Thread::Current()->ProcessMessages(100);
+  ASSERT_EQ(2u, received_.size());
+  EXPECT_EQ(1, rtc::GetBE16(received_[0].data() + 2));
+  EXPECT_EQ(3, rtc::GetBE16(received_[1].data() + 2));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -206,26 +206,36 @@ void SrtpTransport::OnRtpPacketReceived(rtc::CopyOnWriteBuffer packet,
         << "Inactive SRTP transport received an RTP packet. Drop it.";
     return;
   }
+  if (parallel_unprotector_) {
+    parallel_unprotector_->UnprotectRtp(std::move(packet), packet_time_us);
+    return;
+  }
   char* data = packet.MutableData<char>();
   int len = rtc::checked_cast<int>(packet.size());
   if (!UnprotectRtp(data, len, &len)) {
-    // Limit the error logging to avoid excessive logs when there are lots of
-    // bad packets.
-    const int kFailureLogThrottleCount = 100;
-    if (decryption_failure_count_ % kFailureLogThrottleCount == 0) {
-      RTC_LOG(LS_ERROR) << "Failed to unprotect RTP packet: size=" << len
-                        << ", seqnum=" << ParseRtpSequenceNumber(packet)
-                        << ", SSRC=" << ParseRtpSsrc(packet)
-                        << ", previous failure count: "
-                        << decryption_failure_count_;
-    }
-    ++decryption_failure_count_;
+    OnUnprotectRtpFailure(packet);
     return;
   }
   packet.SetSize(len);
   DemuxPacket(std::move(packet), packet_time_us);
 }
 
+void SrtpTransport::OnUnprotectRtpFailure(
+    const rtc::CopyOnWriteBuffer& packet) {
+  // Limit the error logging to avoid excessive logs when there are lots of
+  // bad packets.
+  const int kFailureLogThrottleCount = 100;
+  if (decryption_failure_count_ % kFailureLogThrottleCount == 0) {
+    RTC_LOG(LS_ERROR) << "Failed to unprotect RTP packet: size="
+                      << packet.size()
+                      << ", seqnum=" << ParseRtpSequenceNumber(packet)
+                      << ", SSRC=" << ParseRtpSsrc(packet)
+                      << ", previous failure count: "
+                      << decryption_failure_count_;
+  }
+  ++decryption_failure_count_;
+}
+
 void SrtpTransport::OnRtcpPacketReceived(rtc::CopyOnWriteBuffer packet,
                                          int64_t packet_time_us) {
   TRACE_EVENT0("webrtc", "SrtpTransport::OnRtcpPacketReceived");
@@ -302,6 +312,11 @@ bool SrtpTransport::SetRtpParams(int send_cs,
     return false;
   }
 
+  if (parallel_unprotector_) {
+    parallel_unprotector_->SetRecv(recv_cs, recv_key, recv_key_len,
+                                   recv_extension_ids);
+  }
+
   RTC_LOG(LS_INFO) << "SRTP " << (new_sessions ? "activated" : "updated")
                    << " with negotiated parameters: send cipher_suite "
                    << send_cs << " recv cipher_suite " << recv_cs;
@@ -356,10 +371,27 @@ void SrtpTransport::ResetParams() {
   recv_session_ = nullptr;
   send_rtcp_session_ = nullptr;
   recv_rtcp_session_ = nullptr;
+  if (parallel_unprotector_) {
+    parallel_unprotector_->Reset();
+  }
   MaybeUpdateWritableState();
   RTC_LOG(LS_INFO) << "The params in SRTP transport are reset.";
 }
 
+void SrtpTransport::EnableParallelUnprotect(
+    TaskQueueFactory* task_queue_factory,
+    int num_workers) {
+  RTC_DCHECK(!send_session_);
+  parallel_unprotector_ = std::make_unique<ShardedSrtpUnprotector>(
+      task_queue_factory, num_workers,
+      [this](rtc::CopyOnWriteBuffer packet, int64_t packet_time_us) {
+        DemuxPacket(std::move(packet), packet_time_us);
+      },
+      [this](const rtc::CopyOnWriteBuffer& packet) {
+        OnUnprotectRtpFailure(packet);
+      });
+}
+
 void SrtpTransport::CreateSrtpSessions() {
   send_session_.reset(new cricket::SrtpSession());
   recv_session_.reset(new cricket::SrtpSession());
@@ -21,8 +21,10 @@
 #include "absl/types/optional.h"
 #include "api/crypto_params.h"
 #include "api/rtc_error.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "p2p/base/packet_transport_internal.h"
 #include "pc/rtp_transport.h"
+#include "pc/sharded_srtp_unprotector.h"
 #include "pc/srtp_session.h"
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/buffer.h"
@@ -84,6 +86,14 @@ class SrtpTransport : public RtpTransport {
 
   void ResetParams();
 
+  // Makes received RTP packets be unprotected on `num_workers` task queues
+  // created by `task_queue_factory`, sharded by SSRC, before they are demuxed
+  // on the network thread, see ShardedSrtpUnprotector. For transports that
+  // receive more than one core can decrypt. Must be called before the RTP
+  // params are set. `task_queue_factory` must outlive the transport.
+  void EnableParallelUnprotect(TaskQueueFactory* task_queue_factory,
+                               int num_workers);
+
   // If external auth is enabled, SRTP will write a dummy auth tag that then
   // later must get replaced before the packet is sent out. Only supported for
   // non-GCM cipher suites and can be checked through "IsExternalAuthActive"
@@ -121,6 +131,8 @@ class SrtpTransport : public RtpTransport {
                            int64_t packet_time_us) override;
   void OnRtcpPacketReceived(rtc::CopyOnWriteBuffer packet,
                             int64_t packet_time_us) override;
+  // Logs and counts an RTP packet that failed to be unprotected.
+  void OnUnprotectRtpFailure(const rtc::CopyOnWriteBuffer& packet);
   void OnNetworkRouteChanged(
       absl::optional<rtc::NetworkRoute> network_route) override;
 
@@ -152,6 +164,8 @@ class SrtpTransport : public RtpTransport {
   std::unique_ptr<cricket::SrtpSession> recv_session_;
   std::unique_ptr<cricket::SrtpSession> send_rtcp_session_;
   std::unique_ptr<cricket::SrtpSession> recv_rtcp_session_;
+  // Unprotects RTP packets instead of `recv_session_` when enabled.
+  std::unique_ptr<ShardedSrtpUnprotector> parallel_unprotector_;
 
   absl::optional<cricket::CryptoParams> send_params_;
   absl::optional<cricket::CryptoParams> recv_params_;
@@ -28,6 +28,16 @@ AsyncPacketSocket::AsyncPacketSocket() = default;
 
 AsyncPacketSocket::~AsyncPacketSocket() = default;
 
+int AsyncPacketSocket::SendToBatch(ArrayView<const PacketToSend> packets) {
+  for (size_t i = 0; i < packets.size(); ++i) {
+    const PacketToSend& packet = packets[i];
+    int sent = SendTo(packet.data, packet.size, packet.address, packet.options);
+    if (sent < 0)
+      return i == 0 ? sent : static_cast<int>(i);
+  }
+  return static_cast<int>(packets.size());
+}
+
 void CopySocketInformationToPacketInfo(size_t packet_size_bytes,
                                        const AsyncPacketSocket& socket_from,
                                        bool is_connectionless,
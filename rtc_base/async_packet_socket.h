@@ -13,6 +13,7 @@
 
 #include <vector>
 
+#include "api/array_view.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/dscp.h"
 #include "rtc_base/network/sent_packet.h"
@@ -83,6 +84,20 @@ class RTC_EXPORT AsyncPacketSocket : public sigslot::has_slots<> {
                      const SocketAddress& addr,
                      const PacketOptions& options) = 0;
 
+  // A packet passed to SendToBatch().
+  struct PacketToSend {
+    const void* data = nullptr;
+    size_t size = 0;
+    SocketAddress address;
+    PacketOptions options;
+  };
+  // Sends `packets` in order, using fewer system calls than one SendTo() per
+  // packet where the socket supports it. Returns the number of packets sent,
+  // or a negative value if the first packet could not be sent. A partial count
+  // means the socket blocked or failed; the remaining packets were not sent.
+  // The default implementation calls SendTo() for each packet.
+  virtual int SendToBatch(ArrayView<const PacketToSend> packets);
+
   // Close the socket.
   virtual int Close() = 0;
 
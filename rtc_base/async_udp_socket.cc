@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <string>
 
 #include "rtc_base/checks.h"
@@ -52,6 +53,8 @@ AsyncUDPSocket::AsyncUDPSocket(Socket* socket) : socket_(socket) {
 }
 
 AsyncUDPSocket::~AsyncUDPSocket() {
+  if (destroyed_)
+    *destroyed_ = true;
   delete[] buf_;
 }
 
@@ -86,6 +89,26 @@ int AsyncUDPSocket::SendTo(const void* pv,
   return ret;
 }
 
+int AsyncUDPSocket::SendToBatch(ArrayView<const PacketToSend> packets) {
+  send_batch_.resize(packets.size());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    send_batch_[i].data = packets[i].data;
+    send_batch_[i].size = packets[i].size;
+    send_batch_[i].destination = packets[i].address;
+  }
+  int64_t send_time_ms = rtc::TimeMillis();
+  int ret = socket_->SendToBatch(send_batch_.data(), send_batch_.size());
+  for (int i = 0; i < ret; ++i) {
+    const PacketToSend& packet = packets[i];
+    rtc::SentPacket sent_packet(packet.options.packet_id, send_time_ms,
+                                packet.options.info_signaled_after_sent);
+    CopySocketInformationToPacketInfo(packet.size, *this, true,
+                                      &sent_packet.info);
+    SignalSentPacket(this, sent_packet);
+  }
+  return ret;
+}
+
 int AsyncUDPSocket::Close() {
   return socket_->Close();
 }
@@ -110,9 +133,67 @@ void AsyncUDPSocket::SetError(int error) {
   return socket_->SetError(error);
 }
 
+void AsyncUDPSocket::SetReceiveBatchSize(size_t max_batch_size) {
+  RTC_DCHECK_GE(max_batch_size, 1);
+  batch_slots_.clear();
+  batch_buffer_.reset();
+  if (max_batch_size <= 1)
+    return;
+
+  batch_buffer_.reset(new char[(max_batch_size - 1) * kReceiveBatchSlotSize]);
+  batch_slots_.resize(max_batch_size);
+  batch_slots_[0].data = buf_;
+  batch_slots_[0].capacity = size_;
+  for (size_t i = 1; i < max_batch_size; ++i) {
+    batch_slots_[i].data = &batch_buffer_[(i - 1) * kReceiveBatchSlotSize];
+    batch_slots_[i].capacity = kReceiveBatchSlotSize;
+  }
+}
+
+void AsyncUDPSocket::ReadBatch() {
+  int count = socket_->RecvFromBatch(batch_slots_.data(), batch_slots_.size());
+  if (count < 0) {
+    SocketAddress local_addr = socket_->GetLocalAddress();
+    RTC_LOG(LS_INFO) << "AsyncUDPSocket[" << local_addr.ToSensitiveString()
+                     << "] batched receive failed with error "
+                     << socket_->GetError();
+    return;
+  }
+  if (count == 0)
+    return;
+
+  ++receive_batch_stats_.batches;
+  receive_batch_stats_.max_batch_size =
+      std::max(receive_batch_stats_.max_batch_size, static_cast<size_t>(count));
+
+  bool destroyed = false;
+  destroyed_ = &destroyed;
+  for (int i = 0; i < count; ++i) {
+    const Socket::ReceivedDatagram& datagram = batch_slots_[i];
+    if (datagram.truncated) {
+      ++receive_batch_stats_.truncated_packets;
+      RTC_LOG(LS_WARNING) << "Dropping truncated datagram from "
+                          << datagram.source.ToSensitiveString();
+      continue;
+    }
+    ++receive_batch_stats_.packets;
+    SignalReadPacket(this, datagram.data, datagram.size, datagram.source,
+                     (datagram.timestamp > -1 ? datagram.timestamp
+                                              : TimeMicros()));
+    if (destroyed)
+      return;
+  }
+  destroyed_ = nullptr;
+}
+
 void AsyncUDPSocket::OnReadEvent(Socket* socket) {
   RTC_DCHECK(socket_.get() == socket);
 
+  if (!batch_slots_.empty()) {
+    ReadBatch();
+    return;
+  }
+
   SocketAddress remote_addr;
   int64_t timestamp;
   int len = socket_->RecvFrom(buf_, size_, &remote_addr, &timestamp);
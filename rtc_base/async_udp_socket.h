@@ -12,8 +12,10 @@
 #define RTC_BASE_ASYNC_UDP_SOCKET_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "rtc_base/async_packet_socket.h"
 #include "rtc_base/socket.h"
@@ -47,6 +49,7 @@ class AsyncUDPSocket : public AsyncPacketSocket {
              size_t cb,
              const SocketAddress& addr,
              const rtc::PacketOptions& options) override;
+  int SendToBatch(ArrayView<const PacketToSend> packets) override;
   int Close() override;
 
   State GetState() const override;
@@ -55,15 +58,52 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   int GetError() const override;
   void SetError(int error) override;
 
+  // Counters describing batched receives, see SetReceiveBatchSize().
+  struct ReceiveBatchStats {
+    // Number of read events that delivered at least one datagram.
+    int64_t batches = 0;
+    // Number of datagrams delivered through SignalReadPacket.
+    int64_t packets = 0;
+    // Number of datagrams dropped because they did not fit a batch slot.
+    int64_t truncated_packets = 0;
+    // Largest number of datagrams read in a single batch.
+    size_t max_batch_size = 0;
+  };
+
+  // Allows up to `max_batch_size` datagrams to be read per read event, when
+  // the underlying socket supports it. The datagrams are signaled back to back
+  // through SignalReadPacket. The first datagram of a batch may be as large as
+  // a single-datagram read, the remaining ones must fit in
+  // `kReceiveBatchSlotSize` bytes and are dropped otherwise. A value of 1,
+  // the default, reads one datagram per read event.
+  void SetReceiveBatchSize(size_t max_batch_size);
+  const ReceiveBatchStats& receive_batch_stats() const {
+    return receive_batch_stats_;
+  }
+
+  static constexpr size_t kReceiveBatchSlotSize = 2048;
+
  private:
   // Called when the underlying socket is ready to be read from.
   void OnReadEvent(Socket* socket);
   // Called when the underlying socket is ready to send.
   void OnWriteEvent(Socket* socket);
 
+  // Reads and signals up to `batch_slots_.size()` datagrams.
+  void ReadBatch();
+
   std::unique_ptr<Socket> socket_;
   char* buf_;
   size_t size_;
+  // Slot 0 refers to `buf_`, the others to `batch_buffer_`.
+  std::vector<Socket::ReceivedDatagram> batch_slots_;
+  // Scratch space for SendToBatch(), kept to avoid per-call allocations.
+  std::vector<Socket::DatagramToSend> send_batch_;
+  std::unique_ptr<char[]> batch_buffer_;
+  ReceiveBatchStats receive_batch_stats_;
+  // Points to a flag on the stack of ReadBatch() while packets are being
+  // signaled, since a receiver may destroy this socket.
+  bool* destroyed_ = nullptr;
 };
 
 }  // namespace rtc
@@ -46,6 +46,12 @@ CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
   RTC_DCHECK(IsConsistent());
 }
 
+CopyOnWriteBuffer::CopyOnWriteBuffer(scoped_refptr<RefCountedBuffer> buffer,
+                                     size_t size)
+    : buffer_(std::move(buffer)), offset_(0), size_(size) {
+  RTC_DCHECK(IsConsistent());
+}
+
 CopyOnWriteBuffer::~CopyOnWriteBuffer() = default;
 
 bool CopyOnWriteBuffer::operator==(const CopyOnWriteBuffer& buf) const {
@@ -116,8 +122,14 @@ void CopyOnWriteBuffer::UnshareAndEnsureCapacity(size_t new_capacity) {
     return;
   }
 
-  buffer_ =
-      new RefCountedBuffer(buffer_->data() + offset_, size_, new_capacity);
+  RefCountedBuffer* storage = buffer_->CopyToPooledStorage(
+      buffer_->data() + offset_, size_, new_capacity);
+  if (storage) {
+    buffer_ = storage;
+  } else {
+    buffer_ =
+        new RefCountedBuffer(buffer_->data() + offset_, size_, new_capacity);
+  }
   offset_ = 0;
   RTC_DCHECK(IsConsistent());
 }
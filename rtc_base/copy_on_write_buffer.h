@@ -28,6 +28,8 @@
 
 namespace rtc {
 
+class CopyOnWriteBufferPool;
+
 class RTC_EXPORT CopyOnWriteBuffer {
  public:
   // An empty buffer.
@@ -275,7 +277,53 @@ class RTC_EXPORT CopyOnWriteBuffer {
   }
 
  private:
-  using RefCountedBuffer = FinalRefCountedObject<Buffer>;
+  friend class CopyOnWriteBufferPool;
+
+  // Storage shared between buffers. Storage allocated by a
+  // CopyOnWriteBufferPool is returned to the pool instead of being deleted
+  // when the last reference is dropped.
+  class RefCountedBuffer final : public Buffer {
+   public:
+    using BufferT<uint8_t>::BufferT;
+    RefCountedBuffer(const RefCountedBuffer&) = delete;
+    RefCountedBuffer& operator=(const RefCountedBuffer&) = delete;
+
+    void AddRef() const { ref_count_.IncRef(); }
+    RefCountReleaseStatus Release() const {
+      const auto status = ref_count_.DecRef();
+      if (status == RefCountReleaseStatus::kDroppedLastRef) {
+        if (pool_) {
+          ReturnToPool();
+        } else {
+          delete this;
+        }
+      }
+      return status;
+    }
+    bool HasOneRef() const { return ref_count_.HasOneRef(); }
+
+    // Returns storage from the pool this storage was allocated from, holding
+    // a copy of `size` bytes at `data`. Returns null if this storage isn't
+    // pooled, or if `capacity` exceeds the buffer size of the pool. Defined in
+    // copy_on_write_buffer_pool.cc.
+    RefCountedBuffer* CopyToPooledStorage(const uint8_t* data,
+                                          size_t size,
+                                          size_t capacity) const;
+
+   private:
+    friend class CopyOnWriteBufferPool;
+    ~RefCountedBuffer() = default;
+
+    // Defined in copy_on_write_buffer_pool.cc.
+    void ReturnToPool() const;
+
+    mutable webrtc::webrtc_impl::RefCounter ref_count_{0};
+    CopyOnWriteBufferPool* pool_ = nullptr;
+  };
+
+  // Used by CopyOnWriteBufferPool, `buffer` must have a size of `size`.
+  CopyOnWriteBuffer(scoped_refptr<RefCountedBuffer> buffer, size_t size);
+
   // Create a copy of the underlying data if it is referenced from other Buffer
   // objects or there is not enough capacity.
   void UnshareAndEnsureCapacity(size_t new_capacity);
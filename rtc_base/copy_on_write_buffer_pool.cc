@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/copy_on_write_buffer_pool.h"
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+void CopyOnWriteBuffer::RefCountedBuffer::ReturnToPool() const {
+  pool_->Recycle(const_cast<RefCountedBuffer*>(this));
+}
+
+CopyOnWriteBuffer::RefCountedBuffer*
+CopyOnWriteBuffer::RefCountedBuffer::CopyToPooledStorage(
+    const uint8_t* data,
+    size_t size,
+    size_t capacity) const {
+  if (!pool_ || capacity > pool_->buffer_size_) {
+    return nullptr;
+  }
+  RefCountedBuffer* storage = pool_->TakeStorage();
+  storage->SetData(data, size);
+  return storage;
+}
+
+scoped_refptr<CopyOnWriteBufferPool> CopyOnWriteBufferPool::Create(
+    size_t buffer_size,
+    size_t max_free_buffers) {
+  return scoped_refptr<CopyOnWriteBufferPool>(
+      new CopyOnWriteBufferPool(buffer_size, max_free_buffers));
+}
+
+CopyOnWriteBufferPool::CopyOnWriteBufferPool(size_t buffer_size,
+                                             size_t max_free_buffers)
+    : buffer_size_(buffer_size), max_free_buffers_(max_free_buffers) {
+  RTC_DCHECK_GT(buffer_size, 0);
+}
+
+CopyOnWriteBufferPool::~CopyOnWriteBufferPool() {
+  for (CopyOnWriteBuffer::RefCountedBuffer* storage : free_buffers_) {
+    delete storage;
+  }
+}
+
+CopyOnWriteBuffer CopyOnWriteBufferPool::Allocate(size_t size) {
+  if (size > buffer_size_) {
+    webrtc::MutexLock lock(&mutex_);
+    ++stats_.allocations;
+    return CopyOnWriteBuffer(size);
+  }
+  CopyOnWriteBuffer::RefCountedBuffer* storage = TakeStorage();
+  storage->SetSize(size);
+  return CopyOnWriteBuffer(
+      scoped_refptr<CopyOnWriteBuffer::RefCountedBuffer>(storage), size);
+}
+
+CopyOnWriteBufferPool::Stats CopyOnWriteBufferPool::GetStats() const {
+  webrtc::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+RefCountReleaseStatus CopyOnWriteBufferPool::Release() const {
+  const auto status = ref_count_.DecRef();
+  if (status == RefCountReleaseStatus::kDroppedLastRef) {
+    delete this;
+  }
+  return status;
+}
+
+CopyOnWriteBuffer::RefCountedBuffer* CopyOnWriteBufferPool::TakeStorage() {
+  CopyOnWriteBuffer::RefCountedBuffer* storage = nullptr;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    if (free_buffers_.empty()) {
+      ++stats_.allocations;
+    } else {
+      ++stats_.reuses;
+      storage = free_buffers_.back();
+      free_buffers_.pop_back();
+    }
+  }
+  if (!storage) {
+    storage = new CopyOnWriteBuffer::RefCountedBuffer(0, buffer_size_);
+    storage->pool_ = this;
+  }
+  // Released in Recycle().
+  AddRef();
+  return storage;
+}
+
+void CopyOnWriteBufferPool::Recycle(
+    CopyOnWriteBuffer::RefCountedBuffer* storage) {
+  bool keep;
+  {
+    webrtc::MutexLock lock(&mutex_);
+    keep = free_buffers_.size() < max_free_buffers_;
+    if (keep) {
+      free_buffers_.push_back(storage);
+    }
+  }
+  if (!keep) {
+    delete storage;
+  }
+  // May delete the pool.
+  Release();
+}
+
+}  // namespace rtc
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_COPY_ON_WRITE_BUFFER_POOL_H_
+#define RTC_BASE_COPY_ON_WRITE_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Recycles the storage of CopyOnWriteBuffers, for code that allocates a
+// buffer per packet. The storage of a buffer returns to the pool when the
+// last CopyOnWriteBuffer referencing it is destroyed, on any thread, so once
+// the pool has warmed up Allocate() doesn't allocate from the heap. Copies
+// made when writing to a shared buffer are taken from the same pool. Buffers
+// keep the pool alive, and may outlive the references held by its users.
+class RTC_EXPORT CopyOnWriteBufferPool {
+ public:
+  struct Stats {
+    // Storage allocated from the heap, including for sizes above the buffer
+    // size of the pool.
+    int64_t allocations = 0;
+    // Buffers that reused recycled storage.
+    int64_t reuses = 0;
+  };
+
+  // Storage is allocated with a capacity of `buffer_size` bytes, and at most
+  // `max_free_buffers` are kept for reuse.
+  static scoped_refptr<CopyOnWriteBufferPool> Create(size_t buffer_size,
+                                                     size_t max_free_buffers);
+
+  // Returns a buffer of `size` uninitialized bytes.
+  CopyOnWriteBuffer Allocate(size_t size);
+
+  // Capacity of the buffers allocated for sizes up to it.
+  size_t buffer_size() const { return buffer_size_; }
+
+  Stats GetStats() const;
+
+  void AddRef() const { ref_count_.IncRef(); }
+  RefCountReleaseStatus Release() const;
+
+ private:
+  friend class CopyOnWriteBuffer::RefCountedBuffer;
+
+  CopyOnWriteBufferPool(size_t buffer_size, size_t max_free_buffers);
+  ~CopyOnWriteBufferPool();
+
+  // Returns storage of `buffer_size_` bytes, recycled if possible.
+  CopyOnWriteBuffer::RefCountedBuffer* TakeStorage();
+  void Recycle(CopyOnWriteBuffer::RefCountedBuffer* storage);
+
+  const size_t buffer_size_;
+  const size_t max_free_buffers_;
+  mutable webrtc::Mutex mutex_;
+  std::vector<CopyOnWriteBuffer::RefCountedBuffer*> free_buffers_
+      RTC_GUARDED_BY(mutex_);
+  Stats stats_ RTC_GUARDED_BY(mutex_);
+  mutable webrtc::webrtc_impl::RefCounter ref_count_{0};
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_COPY_ON_WRITE_BUFFER_POOL_H_
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <string.h>
+
+#include <deque>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/copy_on_write_buffer_pool.h"
+
+namespace rtc {
+namespace {
+
+constexpr size_t kPacketSize = 1200;
+constexpr size_t kBufferSize = 2048;
+// Packets held further down the receive pipeline, e.g. by jitter buffers.
+constexpr size_t kPacketsInFlight = 64;
+
+// Copies a received packet into a buffer, modifies it in place like SRTP
+// unprotect does and keeps it in flight for a while.
+template <typename AllocateBuffer>
+void ReceivePackets(benchmark::State& state, AllocateBuffer allocate_buffer) {
+  uint8_t payload[kPacketSize] = {0};
+  std::deque<CopyOnWriteBuffer> in_flight;
+  for (auto _ : state) {
+    CopyOnWriteBuffer packet = allocate_buffer(payload, sizeof(payload));
+    packet.MutableData()[0] ^= 1;
+    in_flight.push_back(std::move(packet));
+    if (in_flight.size() > kPacketsInFlight) {
+      in_flight.pop_front();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The receive path before the pool, allocating storage for every packet.
+void BM_ReceiveWithoutPool(benchmark::State& state) {
+  ReceivePackets(state, [](const uint8_t* data, size_t size) {
+    return CopyOnWriteBuffer(data, size);
+  });
+  state.counters["allocations_per_packet"] = 1;
+}
+
+// The argument is the number of free buffers kept by the pool, 0 effectively
+// disabling it.
+void BM_ReceiveWithPool(benchmark::State& state) {
+  auto pool = CopyOnWriteBufferPool::Create(
+      kBufferSize, static_cast<size_t>(state.range(0)));
+  ReceivePackets(state, [&pool](const uint8_t* data, size_t size) {
+    CopyOnWriteBuffer packet = pool->Allocate(size);
+    memcpy(packet.MutableData(), data, size);
+    return packet;
+  });
+  state.counters["allocations_per_packet"] =
+      benchmark::Counter(static_cast<double>(pool->GetStats().allocations),
+                         benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_ReceiveWithoutPool);
+BENCHMARK(BM_ReceiveWithPool)->Arg(0)->Arg(128);
+
+}  // namespace
+}  // namespace rtc
+
+/*
+
+Results (Linux, 1200 byte packets, 64 packets in flight):
+
+--------------------------------------------------------------------------------
+Benchmark                   Time   UserCounters...
+--------------------------------------------------------------------------------
+BM_ReceiveWithoutPool     122 ns   allocations_per_packet=1 items_per_second=8.35M/s
+BM_ReceiveWithPool/0      188 ns   allocations_per_packet=1 items_per_second=5.59M/s
+BM_ReceiveWithPool/128    116 ns   allocations_per_packet=11.04u items_per_second=8.72M/s
+
+Once warmed up the pool allocates only for the first packets in flight. The
+gain in time is small with an allocator whose thread cache has a matching
+free block at hand; the point is to keep the network thread off the heap
+when other threads are allocating too.
+
+*/
@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/copy_on_write_buffer_pool.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+constexpr size_t kBufferSize = 64;
+
+TEST(CopyOnWriteBufferPoolTest, AllocatesBufferOfRequestedSize) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer buffer = pool->Allocate(10);
+  EXPECT_EQ(10u, buffer.size());
+  EXPECT_EQ(kBufferSize, buffer.capacity());
+  EXPECT_EQ(1, pool->GetStats().allocations);
+  EXPECT_EQ(0, pool->GetStats().reuses);
+}
+
+TEST(CopyOnWriteBufferPoolTest, ReusesStorageOfDestroyedBuffers) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  const uint8_t* data;
+  {
+    CopyOnWriteBuffer buffer = pool->Allocate(10);
+    data = buffer.cdata();
+  }
+  CopyOnWriteBuffer buffer = pool->Allocate(20);
+  EXPECT_EQ(data, buffer.cdata());
+  EXPECT_EQ(20u, buffer.size());
+  EXPECT_EQ(1, pool->GetStats().allocations);
+  EXPECT_EQ(1, pool->GetStats().reuses);
+}
+
+TEST(CopyOnWriteBufferPoolTest, StorageIsRecycledWhenLastCopyIsDestroyed) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer copy;
+  {
+    CopyOnWriteBuffer buffer = pool->Allocate(10);
+    copy = buffer;
+  }
+  pool->Allocate(10);
+  EXPECT_EQ(2, pool->GetStats().allocations);
+  copy = CopyOnWriteBuffer();
+  pool->Allocate(10);
+  EXPECT_EQ(2, pool->GetStats().allocations);
+  EXPECT_EQ(1, pool->GetStats().reuses);
+}
+
+TEST(CopyOnWriteBufferPoolTest, KeepsAtMostMaxFreeBuffers) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 2);
+  {
+    std::vector<CopyOnWriteBuffer> buffers;
+    for (int i = 0; i < 4; ++i) {
+      buffers.push_back(pool->Allocate(10));
+    }
+  }
+  std::vector<CopyOnWriteBuffer> buffers;
+  for (int i = 0; i < 4; ++i) {
+    buffers.push_back(pool->Allocate(10));
+  }
+  EXPECT_EQ(6, pool->GetStats().allocations);
+  EXPECT_EQ(2, pool->GetStats().reuses);
+}
+
+TEST(CopyOnWriteBufferPoolTest, AllocatesLargeBuffersOutsideOfPool) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  {
+    CopyOnWriteBuffer buffer = pool->Allocate(kBufferSize + 1);
+    EXPECT_EQ(kBufferSize + 1, buffer.size());
+  }
+  pool->Allocate(kBufferSize + 1);
+  EXPECT_EQ(2, pool->GetStats().allocations);
+  EXPECT_EQ(0, pool->GetStats().reuses);
+}
+
+TEST(CopyOnWriteBufferPoolTest, ModifyingUnsharedBufferDoesNotCopy) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer buffer = pool->Allocate(4);
+  const uint8_t* data = buffer.cdata();
+  memset(buffer.MutableData(), 0xab, buffer.size());
+  EXPECT_EQ(data, buffer.cdata());
+  buffer.SetSize(kBufferSize);
+  EXPECT_EQ(data, buffer.cdata());
+}
+
+TEST(CopyOnWriteBufferPoolTest, ModifyingSharedBufferCopies) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer buffer = pool->Allocate(4);
+  memset(buffer.MutableData(), 0xab, buffer.size());
+  CopyOnWriteBuffer copy = buffer;
+  buffer.MutableData()[0] = 0;
+  EXPECT_NE(buffer.cdata(), copy.cdata());
+  EXPECT_EQ(0xab, copy.cdata()[0]);
+}
+
+TEST(CopyOnWriteBufferPoolTest, CopiesOfSharedBuffersAreTakenFromPool) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  const uint8_t* data;
+  {
+    CopyOnWriteBuffer buffer = pool->Allocate(4);
+    data = buffer.cdata();
+  }
+  CopyOnWriteBuffer buffer = pool->Allocate(8);
+  memset(buffer.MutableData(), 0xab, buffer.size());
+  CopyOnWriteBuffer slice = buffer.Slice(2, 4);
+  slice.MutableData()[0] = 0;
+  EXPECT_EQ(2, pool->GetStats().allocations);
+  EXPECT_EQ(1, pool->GetStats().reuses);
+  EXPECT_EQ(kBufferSize, slice.capacity());
+  EXPECT_EQ(4u, slice.size());
+  EXPECT_EQ(0, slice.cdata()[0]);
+  EXPECT_EQ(0xab, slice.cdata()[3]);
+  EXPECT_EQ(0xab, buffer.cdata()[2]);
+
+  buffer = CopyOnWriteBuffer();
+  slice.SetSize(kBufferSize);
+  EXPECT_EQ(2, pool->GetStats().allocations);
+  EXPECT_EQ(data, pool->Allocate(4).cdata());
+}
+
+TEST(CopyOnWriteBufferPoolTest, CopiesLargerThanPoolBuffersAreNotPooled) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer buffer = pool->Allocate(4);
+  CopyOnWriteBuffer copy = buffer;
+  copy.EnsureCapacity(kBufferSize + 1);
+  EXPECT_EQ(1, pool->GetStats().allocations);
+  EXPECT_EQ(0, pool->GetStats().reuses);
+  EXPECT_EQ(4u, copy.size());
+  EXPECT_GE(copy.capacity(), kBufferSize + 1);
+}
+
+TEST(CopyOnWriteBufferPoolTest, BuffersMayOutlivePool) {
+  auto pool = CopyOnWriteBufferPool::Create(kBufferSize, 4);
+  CopyOnWriteBuffer buffer = pool->Allocate(4);
+  CopyOnWriteBuffer other = pool->Allocate(4);
+  other = CopyOnWriteBuffer();
+  pool = nullptr;
+  memset(buffer.MutableData(), 0xab, buffer.size());
+  EXPECT_EQ(0xab, buffer.cdata()[3]);
+}
+
+}  // namespace
+}  // namespace rtc
@@ -0,0 +1,851 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/io_uring_socket_server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/time_utils.h"
+
+namespace rtc {
+namespace {
+
+// Number of submission queue entries. The completion queue is twice as large
+// and doesn't limit the number of operations in flight, see
+// IORING_FEAT_NODROP.
+constexpr unsigned kRingEntries = 256;
+// Number of receives that each UDP socket keeps posted.
+constexpr size_t kReceiveDepth = 4;
+// Sends that a UDP socket may have in flight before further sends would block.
+constexpr size_t kMaxSendsInFlight = 64;
+// Size of the preallocated datagram buffers. Larger datagrams are sent
+// without the ring, and received ones are dropped.
+constexpr size_t kDatagramBufferSize = 2048;
+
+// User data of completions that don't belong to an Operation.
+constexpr uint64_t kWakeUpUserData = 1;
+constexpr uint64_t kEpollUserData = 2;
+constexpr uint64_t kCancelUserData = 3;
+
+}  // namespace
+
+// A receive or send, together with its buffers. Owned by the socket server
+// and recycled once its completion has been reaped.
+struct IoUringSocketServer::Operation {
+  enum class Type { kReceive, kSend };
+
+  Type type = Type::kReceive;
+  // The socket that the operation was submitted for, or null if the socket
+  // has been closed since.
+  IoUringUdpSocket* socket = nullptr;
+  // Bytes transferred or, if negative, the error.
+  int result = 0;
+  size_t size = 0;
+  msghdr header;
+  iovec iov;
+  sockaddr_storage address;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timeval))];
+  char data[kDatagramBufferSize];
+};
+
+// Minimal io_uring wrapper, since liburing isn't available.
+class IoUringSocketServer::Ring {
+ public:
+  // Returns null if the kernel doesn't support io_uring or lacks a feature
+  // that the socket server relies on.
+  static std::unique_ptr<Ring> Create(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      RTC_LOG_E(LS_INFO, EN, errno) << "io_uring_setup";
+      return nullptr;
+    }
+    constexpr uint32_t kRequiredFeatures =
+        IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & kRequiredFeatures) != kRequiredFeatures) {
+      RTC_LOG(LS_INFO) << "io_uring lacks required features: "
+                       << params.features;
+      close(fd);
+      return nullptr;
+    }
+    std::unique_ptr<Ring> ring(new Ring(fd));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~Ring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (rings_ != MAP_FAILED) {
+      munmap(rings_, rings_size_);
+    }
+    close(fd_);
+  }
+
+  // Returns a cleared submission queue entry, submitting the queued ones if
+  // the queue is full. Returns null if that fails.
+  io_uring_sqe* GetSqe() {
+    if (IsFull() && (!Enter(/*wait=*/false, 0) || IsFull())) {
+      return nullptr;
+    }
+    const unsigned index = sqe_tail_ & sq_mask_;
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    io_uring_sqe* sqe = &static_cast<io_uring_sqe*>(sqes_)[index];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+  }
+
+  // Submits the queued entries and reaps completed work. If `wait` is set,
+  // blocks for up to `timeout_ms` until there is a completion.
+  bool Enter(bool wait, int timeout_ms) {
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    const unsigned to_submit =
+        sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    __kernel_timespec timeout;
+    if (wait && timeout_ms != SocketServer::kForever) {
+      timeout.tv_sec = timeout_ms / kNumMillisecsPerSec;
+      timeout.tv_nsec = (timeout_ms % kNumMillisecsPerSec) *
+                        static_cast<int64_t>(kNumNanosecsPerMillisec);
+      arg.ts = reinterpret_cast<uint64_t>(&timeout);
+    }
+    int result = static_cast<int>(syscall(
+        __NR_io_uring_enter, fd_, to_submit, wait ? 1 : 0,
+        IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg)));
+    if (result < 0 && errno != ETIME && errno != EINTR && errno != EAGAIN &&
+        errno != EBUSY) {
+      RTC_LOG_E(LS_ERROR, EN, errno) << "io_uring_enter";
+      return false;
+    }
+    return true;
+  }
+
+  bool PopCompletion(uint64_t* user_data, int* result) {
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    *user_data = cqe.user_data;
+    *result = cqe.res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  explicit Ring(int fd) : fd_(fd) {}
+
+  bool IsFull() const {
+    return sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >=
+           sq_entries_;
+  }
+
+  bool Map(const io_uring_params& params) {
+    rings_size_ =
+        std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                 params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    rings_ = mmap(nullptr, rings_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (rings_ == MAP_FAILED) {
+      RTC_LOG_E(LS_ERROR, EN, errno) << "mmap";
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+      RTC_LOG_E(LS_ERROR, EN, errno) << "mmap";
+      return false;
+    }
+    char* rings = static_cast<char*>(rings_);
+    sq_head_ = reinterpret_cast<unsigned*>(rings + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(rings + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(rings + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(rings + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    sqe_tail_ = *sq_tail_;
+    cq_head_ = reinterpret_cast<unsigned*>(rings + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(rings + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(rings + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(rings + params.cq_off.cqes);
+    return true;
+  }
+
+  const int fd_;
+  void* rings_ = MAP_FAILED;
+  size_t rings_size_ = 0;
+  void* sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  // Tail including entries that haven't been published to the kernel yet.
+  unsigned sqe_tail_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+// A UDP socket whose receives and sends go through the ring of its socket
+// server. Datagrams are received ahead of time into buffers owned by the
+// socket server, and read events are raised while there are received
+// datagrams, like for a level-triggered SocketDispatcher.
+class IoUringUdpSocket : public PhysicalSocket {
+ public:
+  explicit IoUringUdpSocket(IoUringSocketServer* ss)
+      : PhysicalSocket(ss), server_(ss) {}
+  ~IoUringUdpSocket() override {
+    Close();
+    server_->RemoveSocket(this);
+  }
+
+  bool Create(int family, int type) override {
+    RTC_DCHECK_EQ(type, SOCK_DGRAM);
+    if (!PhysicalSocket::Create(family, type)) {
+      return false;
+    }
+    // Sends larger than the ring buffers use the socket directly, and must
+    // not block.
+    fcntl(s_, F_SETFL, fcntl(s_, F_GETFL, 0) | O_NONBLOCK);
+    // SIOCGSTAMP doesn't work for reads done by the kernel on behalf of the
+    // ring, so timestamps are delivered as control messages.
+    int enable = 1;
+    ::setsockopt(s_, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable));
+    PostReceives();
+    return true;
+  }
+
+  int Send(const void* pv, size_t cb) override {
+    int sent = QueueSend(pv, cb, nullptr, /*allow_direct=*/true);
+    server_->MaybeSubmit();
+    return sent;
+  }
+
+  int SendTo(const void* buffer,
+             size_t length,
+             const SocketAddress& addr) override {
+    int sent = QueueSend(buffer, length, &addr, /*allow_direct=*/true);
+    server_->MaybeSubmit();
+    return sent;
+  }
+
+  int SendToBatch(const DatagramToSend* datagrams, size_t count) override {
+    size_t sent = 0;
+    int result = 0;
+    for (; sent < count; ++sent) {
+      const DatagramToSend& datagram = datagrams[sent];
+      result = QueueSend(datagram.data, datagram.size, &datagram.destination,
+                         /*allow_direct=*/false);
+      if (result < 0) {
+        break;
+      }
+    }
+    server_->MaybeSubmit();
+    return sent > 0 ? static_cast<int>(sent) : result;
+  }
+
+  int Recv(void* buffer, size_t length, int64_t* timestamp) override {
+    return RecvFrom(buffer, length, nullptr, timestamp);
+  }
+
+  int RecvFrom(void* buffer,
+               size_t length,
+               SocketAddress* out_addr,
+               int64_t* timestamp) override {
+    int received = ReadDatagram(buffer, length, out_addr, timestamp,
+                                /*truncated=*/nullptr);
+    EnableEvents(DE_READ);
+    return received;
+  }
+
+  int RecvFromBatch(ReceivedDatagram* datagrams, size_t count) override {
+    int received = 0;
+    while (static_cast<size_t>(received) < count) {
+      if (received > 0 && (received_.empty() || received_.front()->result < 0))
+        break;
+      ReceivedDatagram& datagram = datagrams[received];
+      int size = ReadDatagram(datagram.data, datagram.capacity,
+                              &datagram.source, &datagram.timestamp,
+                              &datagram.truncated);
+      if (size < 0) {
+        EnableEvents(DE_READ);
+        return size;
+      }
+      datagram.size = size;
+      ++received;
+    }
+    EnableEvents(DE_READ);
+    return received;
+  }
+
+  int Close() override {
+    // Sends that are still in flight are waiting for room in the send
+    // buffer, and are dropped like sends that would block.
+    for (IoUringSocketServer::Operation* operation : in_flight_) {
+      operation->socket = nullptr;
+      server_->CancelOperation(operation);
+    }
+    in_flight_.clear();
+    for (IoUringSocketServer::Operation* operation : received_) {
+      server_->ReleaseOperation(operation);
+    }
+    received_.clear();
+    receives_posted_ = 0;
+    sends_in_flight_ = 0;
+    server_->MaybeSubmit();
+    return PhysicalSocket::Close();
+  }
+
+  void OnReceiveComplete(IoUringSocketServer::Operation* operation) {
+    RemoveInFlight(operation);
+    if (operation->result > static_cast<int>(sizeof(operation->data))) {
+      RTC_LOG(LS_WARNING) << "Dropping datagram of " << operation->result
+                          << " bytes, larger than the receive buffers.";
+      --receives_posted_;
+      PostReceive(operation);
+      return;
+    }
+    received_.push_back(operation);
+    MaybeQueue();
+  }
+
+  void OnSendComplete(IoUringSocketServer::Operation* operation) {
+    RemoveInFlight(operation);
+    --sends_in_flight_;
+    if (operation->result < 0) {
+      RTC_LOG(LS_VERBOSE) << "Send failed, error = " << -operation->result;
+    }
+    server_->ReleaseOperation(operation);
+    MaybeQueue();
+  }
+
+  // Returns the events that would be dispatched by Dispatch().
+  uint8_t PendingEvents() const {
+    uint8_t events = 0;
+    if ((enabled_events() & DE_READ) && !received_.empty()) {
+      events |= DE_READ;
+    }
+    if ((enabled_events() & DE_WRITE) && s_ != INVALID_SOCKET &&
+        sends_in_flight_ < kMaxSendsInFlight) {
+      events |= DE_WRITE;
+    }
+    return events;
+  }
+
+  // Like SocketDispatcher::OnEvent(), disables the event until the socket is
+  // read or written again. May delete the socket.
+  void Dispatch(uint8_t event) {
+    DisableEvents(event);
+    if (event == DE_READ) {
+      SignalReadEvent(this);
+    } else {
+      SignalWriteEvent(this);
+    }
+  }
+
+  void set_queued(bool queued) { queued_ = queued; }
+
+ protected:
+  void SetEnabledEvents(uint8_t events) override {
+    PhysicalSocket::SetEnabledEvents(events);
+    MaybeQueue();
+  }
+
+  void EnableEvents(uint8_t events) override {
+    PhysicalSocket::EnableEvents(events);
+    MaybeQueue();
+  }
+
+ private:
+  // Sends within event handlers are queued to the ring so that they are
+  // submitted together. Other sends have nothing to be batched with and, if
+  // `allow_direct` is set, are sent right away unless they would block or
+  // overtake sends in flight.
+  int QueueSend(const void* data,
+                size_t size,
+                const SocketAddress* destination,
+                bool allow_direct) {
+    if (size > kDatagramBufferSize) {
+      return destination ? PhysicalSocket::SendTo(data, size, *destination)
+                         : PhysicalSocket::Send(data, size);
+    }
+    if (s_ == INVALID_SOCKET) {
+      SetError(EBADF);
+      return SOCKET_ERROR;
+    }
+    if (allow_direct && !server_->in_wait_ && sends_in_flight_ == 0) {
+      int sent = SendDirect(data, size, destination);
+      if (sent >= 0 || !IsBlockingError(GetError())) {
+        return sent;
+      }
+    }
+    if (sends_in_flight_ >= kMaxSendsInFlight) {
+      SetError(EWOULDBLOCK);
+      EnableEvents(DE_WRITE);
+      return SOCKET_ERROR;
+    }
+    IoUringSocketServer::Operation* operation = server_->AcquireOperation();
+    operation->type = IoUringSocketServer::Operation::Type::kSend;
+    operation->socket = this;
+    memcpy(operation->data, data, size);
+    operation->size = size;
+    if (!server_->SubmitSend(s_, operation, destination)) {
+      server_->ReleaseOperation(operation);
+      SetError(ENOBUFS);
+      return SOCKET_ERROR;
+    }
+    in_flight_.push_back(operation);
+    ++sends_in_flight_;
+    return static_cast<int>(size);
+  }
+
+  int SendDirect(const void* data,
+                 size_t size,
+                 const SocketAddress* destination) {
+    sockaddr_storage saddr;
+    size_t len = 0;
+    if (destination) {
+      len = destination->ToSockAddrStorage(&saddr);
+    }
+    int sent = DoSendTo(s_, static_cast<const char*>(data),
+                        static_cast<int>(size), MSG_NOSIGNAL,
+                        destination ? reinterpret_cast<sockaddr*>(&saddr)
+                                    : nullptr,
+                        static_cast<socklen_t>(len));
+    UpdateLastError();
+    return sent;
+  }
+
+  // Copies the oldest received datagram to `buffer` and posts its buffer for
+  // another receive.
+  int ReadDatagram(void* buffer,
+                   size_t length,
+                   SocketAddress* out_addr,
+                   int64_t* timestamp,
+                   bool* truncated) {
+    if (received_.empty()) {
+      // Datagrams sent on loopback may have been received already.
+      server_->ProcessCompletions();
+    }
+    if (received_.empty()) {
+      SetError(s_ == INVALID_SOCKET ? EBADF : EWOULDBLOCK);
+      return SOCKET_ERROR;
+    }
+    IoUringSocketServer::Operation* operation = received_.front();
+    received_.pop_front();
+    int result = operation->result;
+    if (result < 0) {
+      SetError(-result);
+      RTC_LOG_F(LS_VERBOSE) << "Error = " << -result;
+      result = SOCKET_ERROR;
+    } else {
+      const size_t size = std::min(static_cast<size_t>(result), length);
+      memcpy(buffer, operation->data, size);
+      if (truncated) {
+        *truncated = size < static_cast<size_t>(result);
+      }
+      if (out_addr) {
+        SocketAddressFromSockAddrStorage(operation->address, out_addr);
+      }
+      if (timestamp) {
+        *timestamp = GetTimestamp(operation->header);
+      }
+      result = static_cast<int>(size);
+    }
+    --receives_posted_;
+    PostReceive(operation);
+    return result;
+  }
+
+  static int64_t GetTimestamp(msghdr& header) {
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&header, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+        timeval tv;
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        return kNumMicrosecsPerSec * static_cast<int64_t>(tv.tv_sec) +
+               static_cast<int64_t>(tv.tv_usec);
+      }
+    }
+    return -1;
+  }
+
+  void PostReceives() {
+    while (receives_posted_ < kReceiveDepth &&
+           PostReceive(server_->AcquireOperation())) {
+    }
+  }
+
+  bool PostReceive(IoUringSocketServer::Operation* operation) {
+    operation->type = IoUringSocketServer::Operation::Type::kReceive;
+    operation->socket = this;
+    if (!server_->SubmitReceive(s_, operation)) {
+      server_->ReleaseOperation(operation);
+      return false;
+    }
+    in_flight_.push_back(operation);
+    ++receives_posted_;
+    return true;
+  }
+
+  void RemoveInFlight(IoUringSocketServer::Operation* operation) {
+    auto it = std::find(in_flight_.begin(), in_flight_.end(), operation);
+    RTC_DCHECK(it != in_flight_.end());
+    *it = in_flight_.back();
+    in_flight_.pop_back();
+  }
+
+  void MaybeQueue() {
+    if (!queued_ && PendingEvents() != 0) {
+      queued_ = true;
+      server_->QueueSocket(this);
+    }
+  }
+
+  IoUringSocketServer* const server_;
+  // Receives and sends submitted to the ring.
+  std::vector<IoUringSocketServer::Operation*> in_flight_;
+  // Completed receives, oldest first.
+  std::deque<IoUringSocketServer::Operation*> received_;
+  // Receives in flight or in `received_`.
+  size_t receives_posted_ = 0;
+  size_t sends_in_flight_ = 0;
+  // Whether the socket is in the socket server's queue of sockets to
+  // dispatch.
+  bool queued_ = false;
+};
+
+IoUringSocketServer::IoUringSocketServer() {
+  if (epoll_fd() == INVALID_SOCKET) {
+    return;
+  }
+  wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeup_fd_ < 0) {
+    RTC_LOG_E(LS_ERROR, EN, errno) << "eventfd";
+    return;
+  }
+  ring_ = Ring::Create(kRingEntries);
+  if (!ring_) {
+    RTC_LOG(LS_INFO) << "io_uring unavailable, using epoll for UDP sockets.";
+    close(wakeup_fd_);
+    wakeup_fd_ = -1;
+  }
+}
+
+IoUringSocketServer::~IoUringSocketServer() {
+  if (ring_) {
+    // The kernel may still write to the operations and to `wakeup_value_`
+    // until their completions have been reaped.
+    if (epoll_armed_) {
+      CancelUserData(kEpollUserData);
+    }
+    if (wakeup_armed_) {
+      WakeUp();
+    }
+    for (int i = 0; i < 100 && (operations_in_flight_ > 0 || epoll_armed_ ||
+                                wakeup_armed_);
+         ++i) {
+      if (!ring_->Enter(/*wait=*/true, /*timeout_ms=*/10)) {
+        break;
+      }
+      ProcessCompletions();
+    }
+    RTC_DCHECK_EQ(operations_in_flight_, 0);
+    ring_ = nullptr;
+  }
+  if (wakeup_fd_ >= 0) {
+    close(wakeup_fd_);
+  }
+}
+
+Socket* IoUringSocketServer::CreateSocket(int family, int type) {
+  if (!ring_ || type != SOCK_DGRAM) {
+    return PhysicalSocketServer::CreateSocket(family, type);
+  }
+  IoUringUdpSocket* socket = new IoUringUdpSocket(this);
+  if (socket->Create(family, type)) {
+    return socket;
+  }
+  delete socket;
+  return nullptr;
+}
+
+bool IoUringSocketServer::Wait(int cms, bool process_io) {
+  if (!ring_) {
+    return PhysicalSocketServer::Wait(cms, process_io);
+  }
+  const int64_t stop = cms == kForever ? 0 : TimeAfter(cms);
+  in_wait_ = true;
+  bool success = true;
+  while (true) {
+    ArmPolls(process_io);
+    // Don't block while there are events to dispatch.
+    int timeout = cms;
+    if (process_io && (!queued_sockets_.empty() || epoll_ready_)) {
+      timeout = 0;
+    } else if (cms != kForever) {
+      timeout = std::max<int64_t>(TimeDiff(stop, TimeMillis()), 0);
+    }
+    sends_queued_ = false;
+    if (!ring_->Enter(/*wait=*/timeout != 0, timeout)) {
+      success = false;
+      break;
+    }
+    ProcessCompletions();
+    if (process_io) {
+      if (epoll_ready_) {
+        // Dispatch TCP sockets and other dispatchers without blocking.
+        epoll_ready_ = false;
+        PhysicalSocketServer::Wait(0, /*process_io=*/true);
+      }
+      DispatchQueuedSockets();
+    }
+    if (woken_) {
+      woken_ = false;
+      break;
+    }
+    if (cms != kForever && TimeDiff(stop, TimeMillis()) <= 0) {
+      break;
+    }
+  }
+  in_wait_ = false;
+  // Don't hold back sends from event handlers until the next Wait().
+  if (sends_queued_) {
+    MaybeSubmit();
+  }
+  return success;
+}
+
+void IoUringSocketServer::WakeUp() {
+  if (!ring_) {
+    PhysicalSocketServer::WakeUp();
+    return;
+  }
+  const uint64_t value = 1;
+  const ssize_t res = write(wakeup_fd_, &value, sizeof(value));
+  RTC_DCHECK_EQ(static_cast<ssize_t>(sizeof(value)), res);
+}
+
+IoUringSocketServer::Operation* IoUringSocketServer::AcquireOperation() {
+  if (free_operations_.empty()) {
+    operations_.push_back(std::make_unique<Operation>());
+    return operations_.back().get();
+  }
+  Operation* operation = free_operations_.back();
+  free_operations_.pop_back();
+  return operation;
+}
+
+void IoUringSocketServer::ReleaseOperation(Operation* operation) {
+  operation->socket = nullptr;
+  free_operations_.push_back(operation);
+}
+
+bool IoUringSocketServer::SubmitReceive(int fd, Operation* operation) {
+  io_uring_sqe* sqe = ring_->GetSqe();
+  if (!sqe) {
+    return false;
+  }
+  operation->iov.iov_base = operation->data;
+  operation->iov.iov_len = sizeof(operation->data);
+  msghdr& header = operation->header;
+  memset(&header, 0, sizeof(header));
+  header.msg_name = &operation->address;
+  header.msg_namelen = sizeof(operation->address);
+  header.msg_iov = &operation->iov;
+  header.msg_iovlen = 1;
+  header.msg_control = operation->control;
+  header.msg_controllen = sizeof(operation->control);
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(&header);
+  sqe->len = 1;
+  // Makes the result the size of the datagram even if it was truncated.
+  sqe->msg_flags = MSG_TRUNC;
+  sqe->user_data = reinterpret_cast<uint64_t>(operation);
+  ++operations_in_flight_;
+  return true;
+}
+
+bool IoUringSocketServer::SubmitSend(int fd,
+                                     Operation* operation,
+                                     const SocketAddress* destination) {
+  io_uring_sqe* sqe = ring_->GetSqe();
+  if (!sqe) {
+    return false;
+  }
+  operation->iov.iov_base = operation->data;
+  operation->iov.iov_len = operation->size;
+  msghdr& header = operation->header;
+  memset(&header, 0, sizeof(header));
+  if (destination) {
+    header.msg_name = &operation->address;
+    header.msg_namelen = static_cast<socklen_t>(
+        destination->ToSockAddrStorage(&operation->address));
+  }
+  header.msg_iov = &operation->iov;
+  header.msg_iovlen = 1;
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(&header);
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = reinterpret_cast<uint64_t>(operation);
+  ++operations_in_flight_;
+  sends_queued_ = true;
+  return true;
+}
+
+void IoUringSocketServer::CancelOperation(Operation* operation) {
+  CancelUserData(reinterpret_cast<uint64_t>(operation));
+}
+
+void IoUringSocketServer::CancelUserData(uint64_t user_data) {
+  io_uring_sqe* sqe = ring_->GetSqe();
+  if (!sqe) {
+    // The operation completes once there's data, or when the ring is closed.
+    return;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = user_data;
+  sqe->user_data = kCancelUserData;
+}
+
+void IoUringSocketServer::MaybeSubmit() {
+  if (!in_wait_) {
+    sends_queued_ = false;
+    ring_->Enter(/*wait=*/false, 0);
+  }
+}
+
+void IoUringSocketServer::QueueSocket(IoUringUdpSocket* socket) {
+  queued_sockets_.push_back(socket);
+}
+
+void IoUringSocketServer::RemoveSocket(IoUringUdpSocket* socket) {
+  std::replace(queued_sockets_.begin(), queued_sockets_.end(), socket,
+               static_cast<IoUringUdpSocket*>(nullptr));
+  std::replace(dispatched_sockets_.begin(), dispatched_sockets_.end(), socket,
+               static_cast<IoUringUdpSocket*>(nullptr));
+}
+
+void IoUringSocketServer::ArmPolls(bool process_io) {
+  if (!wakeup_armed_) {
+    io_uring_sqe* sqe = ring_->GetSqe();
+    if (sqe) {
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = wakeup_fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+      sqe->len = sizeof(wakeup_value_);
+      sqe->user_data = kWakeUpUserData;
+      wakeup_armed_ = true;
+    }
+  }
+  if (process_io && !epoll_armed_ && !epoll_ready_) {
+    io_uring_sqe* sqe = ring_->GetSqe();
+    if (sqe) {
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = epoll_fd();
+      sqe->poll32_events = POLLIN;
+      sqe->user_data = kEpollUserData;
+      epoll_armed_ = true;
+    }
+  }
+}
+
+void IoUringSocketServer::ProcessCompletions() {
+  uint64_t user_data;
+  int result;
+  while (ring_->PopCompletion(&user_data, &result)) {
+    switch (user_data) {
+      case kWakeUpUserData:
+        wakeup_armed_ = false;
+        woken_ = true;
+        continue;
+      case kEpollUserData:
+        epoll_armed_ = false;
+        epoll_ready_ = true;
+        continue;
+      case kCancelUserData:
+        continue;
+    }
+    Operation* operation = reinterpret_cast<Operation*>(user_data);
+    RTC_DCHECK_GT(operations_in_flight_, 0);
+    --operations_in_flight_;
+    operation->result = result;
+    if (!operation->socket) {
+      ReleaseOperation(operation);
+    } else if (operation->type == Operation::Type::kReceive) {
+      operation->socket->OnReceiveComplete(operation);
+    } else {
+      operation->socket->OnSendComplete(operation);
+    }
+  }
+}
+
+void IoUringSocketServer::DispatchQueuedSockets() {
+  // Sockets that still have events after being dispatched are queued again,
+  // so that all received datagrams are read without entering the kernel in
+  // between. The number of rounds is bounded to not starve other dispatchers
+  // if sockets are read from handlers of other sockets.
+  for (size_t round = 0; round < kReceiveDepth && !queued_sockets_.empty();
+       ++round) {
+    dispatched_sockets_.swap(queued_sockets_);
+    queued_sockets_.clear();
+    DispatchSockets();
+  }
+}
+
+void IoUringSocketServer::DispatchSockets() {
+  for (size_t i = 0; i < dispatched_sockets_.size(); ++i) {
+    if (dispatched_sockets_[i]) {
+      dispatched_sockets_[i]->set_queued(false);
+    }
+    for (uint8_t event : {DE_READ, DE_WRITE}) {
+      // Entries are cleared if their socket is destroyed by a handler.
+      IoUringUdpSocket* socket = dispatched_sockets_[i];
+      if (!socket) {
+        break;
+      }
+      if (socket->PendingEvents() & event) {
+        socket->Dispatch(event);
+      }
+    }
+  }
+  dispatched_sockets_.clear();
+}
+
+}  // namespace rtc
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_IO_URING_SOCKET_SERVER_H_
+#define RTC_BASE_IO_URING_SOCKET_SERVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/system/rtc_export.h"
+
+namespace rtc {
+
+class IoUringUdpSocket;
+
+// A socket server that moves UDP traffic to io_uring. Every UDP socket keeps
+// a number of receives posted to the ring, and sends are queued to the ring
+// rather than issued as separate system calls, so that a single
+// io_uring_enter() both submits the queued work and reaps all completions.
+// Receive and send buffers are preallocated and recycled by the socket
+// server.
+//
+// TCP sockets and other dispatchers are handled by the epoll loop of
+// PhysicalSocketServer, whose descriptor is polled through the ring. If
+// io_uring isn't available at runtime the socket server behaves exactly like
+// a PhysicalSocketServer.
+//
+// UDP sockets created by this socket server must only be used on the thread
+// that calls Wait().
+class RTC_EXPORT IoUringSocketServer : public PhysicalSocketServer {
+ public:
+  IoUringSocketServer();
+  ~IoUringSocketServer() override;
+
+  // Returns false if io_uring couldn't be set up and epoll is used for all
+  // sockets.
+  bool io_uring_enabled() const { return ring_ != nullptr; }
+
+  // SocketFactory:
+  Socket* CreateSocket(int family, int type) override;
+
+  // SocketServer:
+  bool Wait(int cms, bool process_io) override;
+  void WakeUp() override;
+
+ private:
+  friend class IoUringUdpSocket;
+  class Ring;
+  struct Operation;
+
+  // Operations are allocated on demand and recycled.
+  Operation* AcquireOperation();
+  void ReleaseOperation(Operation* operation);
+
+  // Queue an operation on the descriptor `fd` to the ring. Return false if
+  // the ring can't take more entries.
+  bool SubmitReceive(int fd, Operation* operation);
+  bool SubmitSend(int fd,
+                  Operation* operation,
+                  const SocketAddress* destination);
+  // Asks the kernel to cancel an operation that is in flight. Its completion
+  // is still reaped.
+  void CancelOperation(Operation* operation);
+  void CancelUserData(uint64_t user_data);
+  // Passes queued operations to the kernel, unless that is about to happen
+  // anyway because the calling thread is in Wait().
+  void MaybeSubmit();
+
+  // Called by sockets that have events to dispatch.
+  void QueueSocket(IoUringUdpSocket* socket);
+  void RemoveSocket(IoUringUdpSocket* socket);
+
+  // Makes sure that wake-ups and, if `process_io` is set, the epoll
+  // descriptor are polled through the ring.
+  void ArmPolls(bool process_io);
+  void ProcessCompletions();
+  void DispatchQueuedSockets();
+  void DispatchSockets();
+
+  std::unique_ptr<Ring> ring_;
+  // Eventfd written by WakeUp() and read through the ring.
+  int wakeup_fd_ = -1;
+  uint64_t wakeup_value_ = 0;
+  bool wakeup_armed_ = false;
+  // Set when a wake-up has been read and Wait() should return.
+  bool woken_ = false;
+  // Whether the epoll descriptor is being polled through the ring, and
+  // whether it has been reported readable without the epoll loop having run.
+  bool epoll_armed_ = false;
+  bool epoll_ready_ = false;
+  // Set while the thread is in Wait(), which submits before blocking.
+  bool in_wait_ = false;
+  // Set when sends have been queued since the last submission.
+  bool sends_queued_ = false;
+
+  std::vector<std::unique_ptr<Operation>> operations_;
+  std::vector<Operation*> free_operations_;
+  // Receives and sends whose completion hasn't been reaped yet.
+  size_t operations_in_flight_ = 0;
+
+  // Sockets with events to dispatch. Sockets destroyed while queued are
+  // replaced by null.
+  std::vector<IoUringUdpSocket*> queued_sockets_;
+  std::vector<IoUringUdpSocket*> dispatched_sockets_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_IO_URING_SOCKET_SERVER_H_
@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/io_uring_socket_server.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/net_helpers.h"
+#include "rtc_base/socket_unittest.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+#define MAYBE_SKIP_IPV4                        \
+  if (!HasIPv4Enabled()) {                     \
+    RTC_LOG(LS_INFO) << "No IPv4... skipping"; \
+    return;                                    \
+  }
+
+class PacketRecorder : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    packets.emplace_back(data, size);
+  }
+
+  std::vector<std::string> packets;
+};
+
+class IoUringSocketServerTest : public SocketTest {
+ protected:
+  IoUringSocketServerTest() : SocketTest(&server_), thread_(&server_) {}
+
+  IoUringSocketServer server_;
+  rtc::AutoSocketServerThread thread_;
+};
+
+TEST_F(IoUringSocketServerTest, TestConnectIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestConnectIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestTcpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestTcpIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestSocketServerWaitIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestSocketServerWaitIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestUdpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestUdpIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestUdpReadyToSendIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestUdpReadyToSendIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestGetSetOptionsIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestGetSetOptionsIPv4();
+}
+
+TEST_F(IoUringSocketServerTest, TestSocketRecvTimestampIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestSocketRecvTimestampIPv4();
+}
+
+// Several receives are posted per socket; datagrams must still be delivered
+// in the order they were sent.
+TEST_F(IoUringSocketServerTest, DeliversDatagramsInOrder) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  ASSERT_TRUE(sender);
+  receiver->SetOption(Socket::OPT_RCVBUF, 1024 * 1024);
+  PacketRecorder recorder;
+  receiver->SignalReadPacket.connect(&recorder,
+                                     &PacketRecorder::OnReadPacket);
+
+  constexpr int kNumPackets = 200;
+  rtc::PacketOptions options;
+  std::vector<std::string> expected;
+  for (int i = 0; i < kNumPackets; ++i) {
+    expected.push_back(std::to_string(i));
+    ASSERT_EQ(static_cast<int>(expected.back().size()),
+              sender->SendTo(expected.back().data(), expected.back().size(),
+                             receiver->GetLocalAddress(), options));
+    if (i % 32 == 31) {
+      // Stay below the limit of sends in flight.
+      server_.Wait(0, /*process_io=*/true);
+    }
+  }
+  EXPECT_EQ_WAIT(expected.size(), recorder.packets.size(), kTimeout);
+  EXPECT_EQ(expected, recorder.packets);
+}
+
+TEST_F(IoUringSocketServerTest, RecvFromBatchReturnsReceivedDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  for (int i = 0; i < 3; ++i) {
+    char payload = static_cast<char>('a' + i);
+    ASSERT_EQ(1, sender->SendTo(&payload, 1, receiver->GetLocalAddress()));
+  }
+
+  char buffers[4][16];
+  Socket::ReceivedDatagram datagrams[4];
+  for (int i = 0; i < 4; ++i) {
+    datagrams[i].data = buffers[i];
+    datagrams[i].capacity = sizeof(buffers[i]);
+  }
+  int received = 0;
+  int64_t start_ms = TimeMillis();
+  while (received < 3 && TimeMillis() - start_ms < kTimeout) {
+    server_.Wait(10, /*process_io=*/true);
+    int result = receiver->RecvFromBatch(&datagrams[received], 4 - received);
+    if (result > 0) {
+      received += result;
+    }
+  }
+  ASSERT_EQ(3, received);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(1u, datagrams[i].size);
+    EXPECT_EQ('a' + i, datagrams[i].data[0]);
+    EXPECT_FALSE(datagrams[i].truncated);
+    EXPECT_EQ(sender->GetLocalAddress(), datagrams[i].source);
+    EXPECT_GT(datagrams[i].timestamp, 0);
+  }
+}
+
+// Sockets may be closed and destroyed with receives in flight.
+TEST_F(IoUringSocketServerTest, DestroysSocketsWithReceivesInFlight) {
+  MAYBE_SKIP_IPV4;
+  for (int i = 0; i < 10; ++i) {
+    std::unique_ptr<Socket> socket(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+    ASSERT_EQ(0, socket->Bind(SocketAddress(kIPv4Loopback, 0)));
+    server_.Wait(0, /*process_io=*/true);
+  }
+  server_.Wait(0, /*process_io=*/true);
+}
+
+}  // namespace
+}  // namespace rtc
@@ -53,6 +53,10 @@
 
 #if defined(WEBRTC_LINUX)
 #include <linux/sockios.h>
+#include <netinet/udp.h>
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 #endif
 
 #if defined(WEBRTC_WIN)
@@ -361,6 +365,7 @@ int PhysicalSocket::Send(const void* pv, size_t cb) {
   RTC_DCHECK(sent <= static_cast<int>(cb));
   if ((sent > 0 && sent < static_cast<int>(cb)) ||
       (sent < 0 && IsBlockingError(GetError()))) {
+    OnWouldBlock(DE_WRITE);
     EnableEvents(DE_WRITE);
   }
   return sent;
@@ -386,11 +391,139 @@ int PhysicalSocket::SendTo(const void* buffer,
   RTC_DCHECK(sent <= static_cast<int>(length));
   if ((sent > 0 && sent < static_cast<int>(length)) ||
       (sent < 0 && IsBlockingError(GetError()))) {
+    OnWouldBlock(DE_WRITE);
     EnableEvents(DE_WRITE);
   }
   return sent;
 }
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
+// Upper bound on the number of datagrams sent by a single sendmmsg() call.
+constexpr size_t kMaxSendBatchSize = 64;
+
+int PhysicalSocket::SendToBatch(const DatagramToSend* datagrams, size_t count) {
+  if (!udp_ || count <= 1)
+    return Socket::SendToBatch(datagrams, count);
+  // Send in chunks of at most kMaxSendBatchSize datagrams until everything is
+  // sent or the socket blocks or fails.
+  size_t sent = 0;
+  while (sent < count) {
+    size_t chunk = std::min(count - sent, kMaxSendBatchSize);
+    int result = SendMmsg(datagrams + sent, chunk);
+    if (result < 0)
+      return sent == 0 ? result : static_cast<int>(sent);
+    sent += result;
+    if (static_cast<size_t>(result) < chunk)
+      break;
+  }
+  return static_cast<int>(sent);
+}
+
+int PhysicalSocket::SendMmsg(const DatagramToSend* datagrams, size_t count) {
+  RTC_DCHECK_LE(count, kMaxSendBatchSize);
+  // Kernel limits for a single GSO send (UDP_MAX_SEGMENTS and the maximum UDP
+  // payload, with room left for IPv6 headers).
+  constexpr size_t kMaxGsoSegments = 64;
+  constexpr size_t kMaxGsoBytes = 65535 - 8 - 40;
+
+  std::array<mmsghdr, kMaxSendBatchSize> messages;
+  std::array<iovec, kMaxSendBatchSize> iovecs;
+  std::array<sockaddr_storage, kMaxSendBatchSize> addresses;
+  // Number of datagrams carried by each message.
+  std::array<size_t, kMaxSendBatchSize> segments;
+  alignas(cmsghdr) char control[kMaxSendBatchSize]
+                               [CMSG_SPACE(sizeof(uint16_t))];
+  bool uses_gso = false;
+  size_t num_messages = 0;
+  for (size_t i = 0; i < count;) {
+    const DatagramToSend& first = datagrams[i];
+    // Group a run of datagrams to the same destination into one GSO send.
+    // All segments but the last one must be of the same size.
+    size_t num_segments = 1;
+    size_t total_size = first.size;
+    while (udp_gso_enabled_ && i + num_segments < count &&
+           num_segments < kMaxGsoSegments) {
+      const DatagramToSend& next = datagrams[i + num_segments];
+      if (next.size == 0 || next.size > first.size ||
+          total_size + next.size > kMaxGsoBytes ||
+          !(next.destination == first.destination)) {
+        break;
+      }
+      total_size += next.size;
+      ++num_segments;
+      if (next.size < first.size)
+        break;
+    }
+
+    for (size_t k = 0; k < num_segments; ++k) {
+      iovecs[i + k].iov_base = const_cast<void*>(datagrams[i + k].data);
+      iovecs[i + k].iov_len = datagrams[i + k].size;
+    }
+    msghdr& header = messages[num_messages].msg_hdr;
+    memset(&header, 0, sizeof(header));
+    header.msg_name = &addresses[num_messages];
+    header.msg_namelen = static_cast<socklen_t>(
+        first.destination.ToSockAddrStorage(&addresses[num_messages]));
+    header.msg_iov = &iovecs[i];
+    header.msg_iovlen = num_segments;
+    if (num_segments > 1) {
+      header.msg_control = control[num_messages];
+      header.msg_controllen = sizeof(control[num_messages]);
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      uint16_t segment_size = static_cast<uint16_t>(first.size);
+      memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+      uses_gso = true;
+    }
+    messages[num_messages].msg_len = 0;
+    segments[num_messages] = num_segments;
+    ++num_messages;
+    i += num_segments;
+  }
+
+  int sent_messages =
+      ::sendmmsg(s_, messages.data(), static_cast<unsigned int>(num_messages),
+                 // Suppress SIGPIPE. See Send() for explanation.
+                 MSG_NOSIGNAL);
+  if (sent_messages < 0 && uses_gso &&
+      (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+    // EIO is returned when the outgoing device can't checksum offload, the
+    // others when the kernel lacks UDP GSO. Don't try again on this socket.
+    RTC_LOG(LS_INFO) << "UDP GSO send failed with error " << errno
+                     << ", falling back to sendmmsg.";
+    udp_gso_enabled_ = false;
+    return SendMmsg(datagrams, count);
+  }
+  UpdateLastError();
+  MaybeRemapSendError();
+  if (sent_messages < 0) {
+    if (IsBlockingError(GetError())) {
+      OnWouldBlock(DE_WRITE);
+      EnableEvents(DE_WRITE);
+    }
+    return sent_messages;
+  }
+  if (static_cast<size_t>(sent_messages) < num_messages) {
+    OnWouldBlock(DE_WRITE);
+    EnableEvents(DE_WRITE);
+  }
+  size_t sent = 0;
+  for (int i = 0; i < sent_messages; ++i)
+    sent += segments[i];
+  return static_cast<int>(sent);
+}
+
+#else
+
+int PhysicalSocket::SendToBatch(const DatagramToSend* datagrams, size_t count) {
+  return Socket::SendToBatch(datagrams, count);
+}
+
+#endif  // WEBRTC_LINUX && !WEBRTC_ANDROID
+
 int PhysicalSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
   int received =
       ::recv(s_, static_cast<char*>(buffer), static_cast<int>(length), 0);
@@ -410,6 +543,9 @@ int PhysicalSocket::Recv(void* buffer, size_t length, int64_t* timestamp) {
   }
   UpdateLastError();
   int error = GetError();
+  if (received < 0 && IsBlockingError(error)) {
+    OnWouldBlock(DE_READ);
+  }
   bool success = (received >= 0) || IsBlockingError(error);
   if (udp_ || success) {
     EnableEvents(DE_READ);
@@ -436,6 +572,9 @@ int PhysicalSocket::RecvFrom(void* buffer,
   if ((received >= 0) && (out_addr != nullptr))
     SocketAddressFromSockAddrStorage(addr_storage, out_addr);
   int error = GetError();
+  if (received < 0 && IsBlockingError(error)) {
+    OnWouldBlock(DE_READ);
+  }
   bool success = (received >= 0) || IsBlockingError(error);
   if (udp_ || success) {
     EnableEvents(DE_READ);
@@ -446,6 +585,84 @@ int PhysicalSocket::RecvFrom(void* buffer,
   return received;
 }
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+
+int PhysicalSocket::RecvFromBatch(ReceivedDatagram* datagrams, size_t count) {
+  // Upper bound on the number of datagrams read by a single recvmmsg() call.
+  constexpr size_t kMaxRecvBatchSize = 64;
+  if (!udp_ || count <= 1)
+    return Socket::RecvFromBatch(datagrams, count);
+  count = std::min(count, kMaxRecvBatchSize);
+
+  if (!recv_batch_timestamps_enabled_) {
+    // Per-datagram timestamps are delivered as control messages, since
+    // SIOCGSTAMP only reports the time of the last datagram read.
+    int enable = 1;
+    ::setsockopt(s_, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable));
+    recv_batch_timestamps_enabled_ = true;
+  }
+
+  std::array<mmsghdr, kMaxRecvBatchSize> messages;
+  std::array<iovec, kMaxRecvBatchSize> iovecs;
+  std::array<sockaddr_storage, kMaxRecvBatchSize> addresses;
+  alignas(cmsghdr) char control[kMaxRecvBatchSize][CMSG_SPACE(sizeof(timeval))];
+  for (size_t i = 0; i < count; ++i) {
+    iovecs[i].iov_base = datagrams[i].data;
+    iovecs[i].iov_len = datagrams[i].capacity;
+    msghdr& header = messages[i].msg_hdr;
+    memset(&header, 0, sizeof(header));
+    header.msg_name = &addresses[i];
+    header.msg_namelen = sizeof(addresses[i]);
+    header.msg_iov = &iovecs[i];
+    header.msg_iovlen = 1;
+    header.msg_control = control[i];
+    header.msg_controllen = sizeof(control[i]);
+    messages[i].msg_len = 0;
+  }
+
+  int received =
+      ::recvmmsg(s_, messages.data(), static_cast<unsigned int>(count), 0,
+                 /*timeout=*/nullptr);
+  UpdateLastError();
+  if (received < 0 && IsBlockingError(GetError())) {
+    OnWouldBlock(DE_READ);
+  }
+  for (int i = 0; i < received; ++i) {
+    ReceivedDatagram& datagram = datagrams[i];
+    const msghdr& header = messages[i].msg_hdr;
+    datagram.size = messages[i].msg_len;
+    datagram.truncated = (header.msg_flags & MSG_TRUNC) != 0;
+    SocketAddressFromSockAddrStorage(addresses[i], &datagram.source);
+    datagram.timestamp = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&header), cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+        timeval tv;
+        memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+        datagram.timestamp =
+            kNumMicrosecsPerSec * static_cast<int64_t>(tv.tv_sec) +
+            static_cast<int64_t>(tv.tv_usec);
+        break;
+      }
+    }
+  }
+  // Unlike RecvFrom(), `udp_` is known to be set here, so reads are always
+  // re-enabled.
+  EnableEvents(DE_READ);
+  if (received < 0 && !IsBlockingError(GetError())) {
+    RTC_LOG_F(LS_VERBOSE) << "Error = " << GetError();
+  }
+  return received;
+}
+
+#else
+
+int PhysicalSocket::RecvFromBatch(ReceivedDatagram* datagrams, size_t count) {
+  return Socket::RecvFromBatch(datagrams, count);
+}
+
+#endif  // WEBRTC_LINUX && !WEBRTC_ANDROID
+
 int PhysicalSocket::Listen(int backlog) {
   int err = ::listen(s_, backlog);
   UpdateLastError();
@@ -469,8 +686,11 @@ Socket* PhysicalSocket::Accept(SocketAddress* out_addr) {
   sockaddr* addr = reinterpret_cast<sockaddr*>(&addr_storage);
   SOCKET s = DoAccept(s_, addr, &addr_len);
   UpdateLastError();
-  if (s == INVALID_SOCKET)
+  if (s == INVALID_SOCKET) {
+    if (IsBlockingError(GetError()))
+      OnWouldBlock(DE_READ);
     return nullptr;
+  }
   if (out_addr != nullptr)
     SocketAddressFromSockAddrStorage(addr_storage, out_addr);
   return ss_->WrapSocket(s);
@@ -907,6 +1127,14 @@ void SocketDispatcher::DisableEvents(uint8_t events) {
   MaybeUpdateDispatcher(old_events);
 }
 
+void SocketDispatcher::OnWouldBlock(uint8_t events) {
+  ss_->ClearEdgeTriggeredEvents(this, events);
+}
+
+bool SocketDispatcher::SupportsEdgeTriggeredEpoll() {
+  return true;
+}
+
 #endif  // WEBRTC_USE_EPOLL
 
 int SocketDispatcher::Close() {
@@ -1053,6 +1281,9 @@ class Signaler : public Dispatcher {
 #endif  // WEBRTC_WIN
 
 PhysicalSocketServer::PhysicalSocketServer()
+    : PhysicalSocketServer(/*edge_triggered_epoll=*/false) {}
+
+PhysicalSocketServer::PhysicalSocketServer(bool edge_triggered_epoll)
     :
 #if defined(WEBRTC_USE_EPOLL)
       // Since Linux 2.6.8, the size argument is ignored, but must be greater
@@ -1060,6 +1291,7 @@ PhysicalSocketServer::PhysicalSocketServer()
       // amount of space to initially allocate in internal data structures.
       epoll_fd_(epoll_create(FD_SETSIZE)),
 #endif
+      edge_triggered_epoll_(edge_triggered_epoll),
 #if defined(WEBRTC_WIN)
       socket_ev_(WSACreateEvent()),
 #endif
@@ -1121,6 +1353,11 @@ void PhysicalSocketServer::Add(Dispatcher* pdispatcher) {
     return;
   }
   uint64_t key = next_dispatcher_key_++;
+#if defined(WEBRTC_USE_EPOLL)
+  if (edge_triggered_epoll_ && pdispatcher->SupportsEdgeTriggeredEpoll()) {
+    key |= kEdgeTriggeredKeyBit;
+  }
+#endif  // WEBRTC_USE_EPOLL
   dispatcher_by_key_.emplace(key, pdispatcher);
   key_by_dispatcher_.emplace(pdispatcher, key);
 #if defined(WEBRTC_USE_EPOLL)
@@ -1142,6 +1379,8 @@ void PhysicalSocketServer::Remove(Dispatcher* pdispatcher) {
   key_by_dispatcher_.erase(pdispatcher);
   dispatcher_by_key_.erase(key);
 #if defined(WEBRTC_USE_EPOLL)
+  // Stale keys left in `edge_ready_list_` are skipped when dispatching.
+  edge_ready_states_.erase(key);
   if (epoll_fd_ != INVALID_SOCKET) {
     RemoveEpoll(pdispatcher);
   }
@@ -1160,10 +1399,65 @@ void PhysicalSocketServer::Update(Dispatcher* pdispatcher) {
     return;
   }
 
-  UpdateEpoll(pdispatcher, key_by_dispatcher_.at(pdispatcher));
+  uint64_t key = key_by_dispatcher_.at(pdispatcher);
+  if (!(key & kEdgeTriggeredKeyBit)) {
+    UpdateEpoll(pdispatcher, key);
+    return;
+  }
+
+  // The descriptor stays registered for all events. If an event that is
+  // already known to be ready got enabled, queue the dispatcher so that it
+  // doesn't wait for an edge that might never come.
+  auto it = edge_ready_states_.find(key);
+  if (it == edge_ready_states_.end() || it->second.queued ||
+      !(it->second.events &
+        GetEpollEvents(pdispatcher->GetRequestedEvents()))) {
+    return;
+  }
+  QueueEdgeTriggeredDispatcher(key, it->second);
+  if (!processing_edge_ready_list_) {
+    // Possibly called while another thread is blocked in epoll_wait().
+    WakeUp();
+  }
 #endif
 }
 
+#if defined(WEBRTC_USE_EPOLL)
+void PhysicalSocketServer::ClearEdgeTriggeredEvents(Dispatcher* pdispatcher,
+                                                    uint8_t events) {
+  if (!edge_triggered_epoll_) {
+    return;
+  }
+  CritScope cs(&crit_);
+  auto key_it = key_by_dispatcher_.find(pdispatcher);
+  if (key_it == key_by_dispatcher_.end()) {
+    return;
+  }
+  auto it = edge_ready_states_.find(key_it->second);
+  if (it == edge_ready_states_.end()) {
+    return;
+  }
+  if (events & DE_READ) {
+    it->second.events &= ~(EPOLLIN | EPOLLPRI);
+  }
+  if (events & DE_WRITE) {
+    it->second.events &= ~EPOLLOUT;
+  }
+  if (it->second.events == 0) {
+    edge_ready_states_.erase(it);
+  }
+}
+
+void PhysicalSocketServer::QueueEdgeTriggeredDispatcher(
+    uint64_t key,
+    EdgeReadyState& state) {
+  if (!state.queued) {
+    state.queued = true;
+    edge_ready_list_.push_back(key);
+  }
+}
+#endif  // WEBRTC_USE_EPOLL
+
 #if defined(WEBRTC_POSIX)
 
 bool PhysicalSocketServer::Wait(int cmsWait, bool process_io) {
@@ -1386,7 +1680,12 @@ void PhysicalSocketServer::AddEpoll(Dispatcher* pdispatcher, uint64_t key) {
   }
 
   struct epoll_event event = {0};
-  event.events = GetEpollEvents(pdispatcher->GetRequestedEvents());
+  if (key & kEdgeTriggeredKeyBit) {
+    // Registered once for everything, UpdateEpoll() is never called.
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+  } else {
+    event.events = GetEpollEvents(pdispatcher->GetRequestedEvents());
+  }
   if (event.events == 0u) {
     // Don't add at all if we don't have any requested events. Could indicate a
     // closed socket.
@@ -1461,12 +1760,18 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
 
   fWait_ = true;
   while (fWait_) {
+    // Don't block if edge-triggered dispatchers are known to be ready.
+    bool poll_only = false;
+    if (edge_triggered_epoll_) {
+      CritScope cr(&crit_);
+      poll_only = !edge_ready_list_.empty();
+    }
     // Wait then call handlers as appropriate
     // < 0 means error
     // 0 means timeout
     // > 0 means count of descriptors ready
     int n = epoll_wait(epoll_fd_, epoll_events_.data(), epoll_events_.size(),
-                       static_cast<int>(tvWait));
+                       poll_only ? 0 : static_cast<int>(tvWait));
     if (n < 0) {
       if (errno != EINTR) {
         RTC_LOG_E(LS_ERROR, EN, errno) << "epoll";
@@ -1476,7 +1781,7 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
       // signals managed by this PhysicalSocketServer, the
       // PosixSignalDeliveryDispatcher will be in the signaled state in the next
       // iteration.
-    } else if (n == 0) {
+    } else if (n == 0 && !poll_only) {
       // If timeout, return success
       return true;
     } else {
@@ -1489,6 +1794,13 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
           // The dispatcher for this socket no longer exists.
           continue;
         }
+        if (key & kEdgeTriggeredKeyBit) {
+          // Dispatched from the ready list below.
+          EdgeReadyState& state = edge_ready_states_[key];
+          state.events |= event.events;
+          QueueEdgeTriggeredDispatcher(key, state);
+          continue;
+        }
         Dispatcher* pdispatcher = dispatcher_by_key_.at(key);
 
         bool readable = (event.events & (EPOLLIN | EPOLLPRI));
@@ -1498,6 +1810,12 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
         ProcessEvents(pdispatcher, readable, writable, error, error);
       }
     }
+    if (edge_triggered_epoll_) {
+      CritScope cr(&crit_);
+      if (!edge_ready_list_.empty()) {
+        ProcessEdgeTriggeredEvents();
+      }
+    }
 
     if (cmsWait != kForever) {
       tvWait = TimeDiff(tvStop, TimeMillis());
@@ -1511,6 +1829,51 @@ bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
   return true;
 }
 
+void PhysicalSocketServer::ProcessEdgeTriggeredEvents() {
+  // Dispatchers queued while dispatching are handled in the next iteration of
+  // the wait loop, after polling for new events.
+  current_dispatcher_keys_.clear();
+  current_dispatcher_keys_.swap(edge_ready_list_);
+  processing_edge_ready_list_ = true;
+  for (uint64_t key : current_dispatcher_keys_) {
+    auto it = edge_ready_states_.find(key);
+    if (it == edge_ready_states_.end()) {
+      // Already consumed, or the dispatcher has been removed.
+      continue;
+    }
+    it->second.queued = false;
+    Dispatcher* pdispatcher = dispatcher_by_key_.at(key);
+    const uint32_t ready_events = it->second.events;
+    const uint32_t enabled_events =
+        GetEpollEvents(pdispatcher->GetRequestedEvents());
+    bool readable = (ready_events & enabled_events & (EPOLLIN | EPOLLPRI));
+    bool writable = (ready_events & enabled_events & EPOLLOUT);
+    bool error = enabled_events != 0 &&
+                 (ready_events & (EPOLLRDHUP | EPOLLERR | EPOLLHUP));
+    if (!readable && !writable && !error) {
+      // Queued again by Update() once enabled.
+      continue;
+    }
+    if (error) {
+      // Pending socket errors are reaped by ProcessEvents().
+      it->second.events &= ~(EPOLLERR | EPOLLHUP);
+    }
+
+    ProcessEvents(pdispatcher, readable, writable, error, error);
+
+    // Emulate level-triggered behavior: dispatch again as long as the event is
+    // enabled and no read or write has blocked. The dispatcher may have been
+    // removed by the handlers.
+    it = edge_ready_states_.find(key);
+    if (it != edge_ready_states_.end() &&
+        (it->second.events &
+         GetEpollEvents(pdispatcher->GetRequestedEvents()))) {
+      QueueEdgeTriggeredDispatcher(key, it->second);
+    }
+  }
+  processing_edge_ready_list_ = false;
+}
+
 bool PhysicalSocketServer::WaitPoll(int cmsWait, Dispatcher* dispatcher) {
   RTC_DCHECK(dispatcher);
   int64_t tvWait = -1;
@@ -59,12 +59,24 @@ class Dispatcher {
   virtual int GetDescriptor() = 0;
   virtual bool IsDescriptorClosed() = 0;
 #endif
+#if defined(WEBRTC_USE_EPOLL)
+  // Dispatchers that report consumed readiness through
+  // PhysicalSocketServer::ClearEdgeTriggeredEvents() may be registered
+  // edge-triggered.
+  virtual bool SupportsEdgeTriggeredEpoll() { return false; }
+#endif
 };
 
 // A socket server that provides the real sockets of the underlying OS.
 class RTC_EXPORT PhysicalSocketServer : public SocketServer {
  public:
   PhysicalSocketServer();
+  // If `edge_triggered_epoll` is set, sockets are registered with epoll once,
+  // edge-triggered, for both reading and writing, instead of being modified
+  // whenever their enabled events change. Readiness reported by epoll is kept
+  // in a ready list until the socket reports that a read or write would
+  // block. Has no effect where epoll isn't used.
+  explicit PhysicalSocketServer(bool edge_triggered_epoll);
   ~PhysicalSocketServer() override;
 
   // SocketFactory:
@@ -80,10 +92,25 @@ class RTC_EXPORT PhysicalSocketServer : public SocketServer {
   void Add(Dispatcher* dispatcher);
   void Remove(Dispatcher* dispatcher);
   void Update(Dispatcher* dispatcher);
+#if defined(WEBRTC_USE_EPOLL)
+  // Called when a read (DE_READ) or write (DE_WRITE) on the descriptor of an
+  // edge-triggered dispatcher would block.
+  void ClearEdgeTriggeredEvents(Dispatcher* dispatcher, uint8_t events);
+#endif
+
+ protected:
+#if defined(WEBRTC_USE_EPOLL)
+  // INVALID_SOCKET if epoll isn't available.
+  int epoll_fd() const { return epoll_fd_; }
+#endif
 
  private:
   // The number of events to process with one call to "epoll_wait".
   static constexpr size_t kNumEpollEvents = 128;
+#if defined(WEBRTC_USE_EPOLL)
+  // Set in the keys of dispatchers registered edge-triggered.
+  static constexpr uint64_t kEdgeTriggeredKeyBit = uint64_t{1} << 63;
+#endif
 
 #if defined(WEBRTC_POSIX)
   bool WaitSelect(int cms, bool process_io);
@@ -94,6 +121,8 @@ class RTC_EXPORT PhysicalSocketServer : public SocketServer {
   void UpdateEpoll(Dispatcher* dispatcher, uint64_t key);
   bool WaitEpoll(int cms);
   bool WaitPoll(int cms, Dispatcher* dispatcher);
+  // Dispatches the ready list of edge-triggered dispatchers.
+  void ProcessEdgeTriggeredEvents() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
   // This array is accessed in isolation by a thread calling into Wait().
   // It's useless to use a SequenceChecker to guard it because a socket
@@ -101,7 +130,26 @@ class RTC_EXPORT PhysicalSocketServer : public SocketServer {
   // to have to reset the sequence checker on Wait calls.
   std::array<epoll_event, kNumEpollEvents> epoll_events_;
   const int epoll_fd_ = INVALID_SOCKET;
+  struct EdgeReadyState {
+    // Readiness reported by epoll that hasn't been consumed yet, as epoll
+    // event bits.
+    uint32_t events = 0;
+    // Whether the key is in `edge_ready_list_`.
+    bool queued = false;
+  };
+  // Called with the key of an edge-triggered dispatcher whose events may be
+  // ready and enabled.
+  void QueueEdgeTriggeredDispatcher(uint64_t key, EdgeReadyState& state)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  std::unordered_map<uint64_t, EdgeReadyState> edge_ready_states_
+      RTC_GUARDED_BY(crit_);
+  // Keys of edge-triggered dispatchers to be dispatched without waiting for a
+  // new edge. May contain keys of removed dispatchers.
+  std::vector<uint64_t> edge_ready_list_ RTC_GUARDED_BY(crit_);
+  // Set while the ready list is being dispatched.
+  bool processing_edge_ready_list_ RTC_GUARDED_BY(crit_) = false;
 #endif  // WEBRTC_USE_EPOLL
+  const bool edge_triggered_epoll_;
   // uint64_t keys are used to uniquely identify a dispatcher in order to avoid
   // the ABA problem during the epoll loop (a dispatcher being destroyed and
   // replaced by one with the same address).
@@ -155,12 +203,18 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
   int SendTo(const void* buffer,
              size_t length,
              const SocketAddress& addr) override;
+  // Uses sendmmsg() for UDP sockets where available, and UDP GSO for runs of
+  // equally sized datagrams to the same destination. Large batches are split
+  // into several sendmmsg() calls.
+  int SendToBatch(const DatagramToSend* datagrams, size_t count) override;
 
   int Recv(void* buffer, size_t length, int64_t* timestamp) override;
   int RecvFrom(void* buffer,
                size_t length,
                SocketAddress* out_addr,
                int64_t* timestamp) override;
+  // Uses recvmmsg() for UDP sockets where available.
+  int RecvFromBatch(ReceivedDatagram* datagrams, size_t count) override;
 
   int Listen(int backlog) override;
   Socket* Accept(SocketAddress* out_addr) override;
@@ -198,6 +252,9 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
 
   int TranslateOption(Option opt, int* slevel, int* sopt);
 
+  // Called when a read (DE_READ) or write (DE_WRITE) would block.
+  virtual void OnWouldBlock(uint8_t events) {}
+
   PhysicalSocketServer* ss_;
   SOCKET s_;
   bool udp_;
@@ -206,12 +263,21 @@ class PhysicalSocket : public Socket, public sigslot::has_slots<> {
   int error_ RTC_GUARDED_BY(mutex_);
   ConnState state_;
   AsyncResolver* resolver_;
+  // Set once SO_TIMESTAMP has been enabled for batched receives.
+  bool recv_batch_timestamps_enabled_ = false;
+  // Cleared if the kernel or the outgoing device rejects UDP GSO sends.
+  bool udp_gso_enabled_ = true;
 
 #if !defined(NDEBUG)
   std::string dbg_addr_;
 #endif
 
  private:
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  // Sends up to 64 datagrams with a single sendmmsg() call.
+  int SendMmsg(const DatagramToSend* datagrams, size_t count);
+#endif
+
   uint8_t enabled_events_ = 0;
 };
 
@@ -237,6 +303,9 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
 
   uint32_t GetRequestedEvents() override;
   void OnEvent(uint32_t ff, int err) override;
+#if defined(WEBRTC_USE_EPOLL)
+  bool SupportsEdgeTriggeredEpoll() override;
+#endif
 
   int Close() override;
 
@@ -248,6 +317,7 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
   void SetEnabledEvents(uint8_t events) override;
   void EnableEvents(uint8_t events) override;
   void DisableEvents(uint8_t events) override;
+  void OnWouldBlock(uint8_t events) override;
 #endif
 
  private:
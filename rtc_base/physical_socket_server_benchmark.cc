@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <sys/resource.h>
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "rtc_base/io_uring_socket_server.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/socket.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+
+namespace rtc {
+namespace {
+
+constexpr size_t kPacketSize = 1200;
+
+// Reads one datagram per read event, like AsyncUDPSocket does.
+class DatagramReader : public sigslot::has_slots<> {
+ public:
+  void OnReadEvent(Socket* socket) {
+    if (socket->RecvFrom(buffer_, sizeof(buffer_), nullptr, nullptr) >= 0)
+      ++packets;
+  }
+
+  int packets = 0;
+
+ private:
+  char buffer_[kPacketSize];
+};
+
+// Owns `num_sockets` bound UDP sockets registered with `socket_server`.
+class SocketSet {
+ public:
+  SocketSet(PhysicalSocketServer* socket_server, int num_sockets) {
+    // Each socket uses a descriptor.
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+        limit.rlim_cur < limit.rlim_max) {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    for (int i = 0; i < num_sockets; ++i) {
+      std::unique_ptr<Socket> socket(
+          socket_server->CreateSocket(AF_INET, SOCK_DGRAM));
+      if (!socket || socket->Bind(SocketAddress("127.0.0.1", 0)) != 0)
+        return;
+      socket->SignalReadEvent.connect(&reader_, &DatagramReader::OnReadEvent);
+      sockets_.push_back(std::move(socket));
+    }
+  }
+
+  bool ok(int num_sockets) const {
+    return static_cast<int>(sockets_.size()) == num_sockets;
+  }
+  Socket* socket(int index) { return sockets_[index].get(); }
+  DatagramReader& reader() { return reader_; }
+
+ private:
+  DatagramReader reader_;
+  std::vector<std::unique_ptr<Socket>> sockets_;
+};
+
+// Sends a datagram to every `stride`:th socket and measures the time until
+// the socket server has dispatched all of them. Arguments are the number of
+// sockets and whether edge-triggered epoll is used.
+void RunWakeupBenchmark(benchmark::State& state, int stride) {
+  const int num_sockets = static_cast<int>(state.range(0));
+  PhysicalSocketServer socket_server(
+      /*edge_triggered_epoll=*/state.range(1) != 0);
+  SocketSet sockets(&socket_server, num_sockets);
+  std::unique_ptr<Socket> sender(
+      socket_server.CreateSocket(AF_INET, SOCK_DGRAM));
+  if (!sockets.ok(num_sockets) || !sender) {
+    state.SkipWithError("Failed to create sockets, check RLIMIT_NOFILE.");
+    return;
+  }
+  // Let the socket server see the initial writability of all sockets.
+  socket_server.Wait(0, /*process_io=*/true);
+
+  char payload[kPacketSize] = {0};
+  int64_t wakeups = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    int expected = 0;
+    for (int i = 0; i < num_sockets; i += stride) {
+      Socket* receiver = sockets.socket(i);
+      sender->SendTo(payload, sizeof(payload), receiver->GetLocalAddress());
+      ++expected;
+    }
+    sockets.reader().packets = 0;
+    state.ResumeTiming();
+    while (sockets.reader().packets < expected) {
+      socket_server.Wait(0, /*process_io=*/true);
+      ++wakeups;
+    }
+  }
+  state.counters["wakeups"] =
+      benchmark::Counter(wakeups, benchmark::Counter::kAvgIterations);
+}
+
+// One socket out of all is active.
+void BM_WakeupWithIdleSockets(benchmark::State& state) {
+  RunWakeupBenchmark(state, /*stride=*/static_cast<int>(state.range(0)));
+}
+
+// Every tenth socket is active.
+void BM_WakeupWithActiveSockets(benchmark::State& state) {
+  RunWakeupBenchmark(state, /*stride=*/10);
+}
+
+// Sends datagrams round-robin to a number of sockets and measures the time
+// until all of them have been read, including the time spent sending.
+// Arguments are the number of receiving sockets and whether UDP goes through
+// io_uring instead of epoll.
+void BM_UdpPacketsPerSecond(benchmark::State& state) {
+  constexpr int kPacketsPerIteration = 256;
+  const int num_sockets = static_cast<int>(state.range(0));
+  std::unique_ptr<PhysicalSocketServer> socket_server;
+  if (state.range(1) != 0) {
+    auto io_uring_socket_server = std::make_unique<IoUringSocketServer>();
+    if (!io_uring_socket_server->io_uring_enabled()) {
+      state.SkipWithError("io_uring isn't available.");
+      return;
+    }
+    socket_server = std::move(io_uring_socket_server);
+  } else {
+    socket_server = std::make_unique<PhysicalSocketServer>();
+  }
+  SocketSet sockets(socket_server.get(), num_sockets);
+  std::unique_ptr<Socket> sender(
+      socket_server->CreateSocket(AF_INET, SOCK_DGRAM));
+  if (!sockets.ok(num_sockets) || !sender ||
+      sender->Bind(SocketAddress("127.0.0.1", 0)) != 0) {
+    state.SkipWithError("Failed to create sockets.");
+    return;
+  }
+  std::vector<SocketAddress> destinations;
+  for (int i = 0; i < num_sockets; ++i) {
+    sockets.socket(i)->SetOption(Socket::OPT_RCVBUF, 1024 * 1024);
+    destinations.push_back(sockets.socket(i)->GetLocalAddress());
+  }
+  socket_server->Wait(0, /*process_io=*/true);
+
+  char payload[kPacketSize] = {0};
+  for (auto _ : state) {
+    sockets.reader().packets = 0;
+    for (int i = 0; i < kPacketsPerIteration;) {
+      if (sender->SendTo(payload, sizeof(payload),
+                         destinations[i % num_sockets]) > 0) {
+        ++i;
+      } else {
+        // Let sends in flight complete.
+        socket_server->Wait(0, /*process_io=*/true);
+      }
+    }
+    while (sockets.reader().packets < kPacketsPerIteration) {
+      socket_server->Wait(0, /*process_io=*/true);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerIteration);
+}
+
+BENCHMARK(BM_WakeupWithIdleSockets)
+    ->ArgsProduct({{1000, 10000, 50000}, {0, 1}})
+    ->ArgNames({"sockets", "edge_triggered"});
+BENCHMARK(BM_WakeupWithActiveSockets)
+    ->ArgsProduct({{1000, 10000, 50000}, {0, 1}})
+    ->ArgNames({"sockets", "edge_triggered"});
+BENCHMARK(BM_UdpPacketsPerSecond)
+    ->ArgsProduct({{1, 16}, {0, 1}})
+    ->ArgNames({"sockets", "io_uring"});
+
+}  // namespace
+}  // namespace rtc
+
+/*
+
+Results (Linux, loopback, RLIMIT_NOFILE of 20000):
+
+----------------------------------------------------------------------------
+Benchmark                                                  Time   wakeups
+----------------------------------------------------------------------------
+BM_WakeupWithIdleSockets/sockets:1000/edge_triggered:0      1729 ns   1.00
+BM_WakeupWithIdleSockets/sockets:10000/edge_triggered:0     1848 ns   1.00
+BM_WakeupWithIdleSockets/sockets:1000/edge_triggered:1      1897 ns   1.00
+BM_WakeupWithIdleSockets/sockets:10000/edge_triggered:1     1987 ns   1.00
+BM_WakeupWithActiveSockets/sockets:1000/edge_triggered:0   90732 ns   1.00
+BM_WakeupWithActiveSockets/sockets:10000/edge_triggered:0  1624614 ns 8.40
+BM_WakeupWithActiveSockets/sockets:1000/edge_triggered:1   95736 ns   1.00
+BM_WakeupWithActiveSockets/sockets:10000/edge_triggered:1  2009122 ns 8.69
+
+Reads re-enabled from within the read handler are already batched into a
+no-op by SocketDispatcher::OnEvent(), so for UDP receive the level-triggered
+mode makes no epoll_ctl() calls either and the ready list bookkeeping is pure
+overhead. The edge-triggered mode pays off for sockets whose write events are
+toggled frequently, e.g. TCP under flow control.
+
+--------------------------------------------------------------------------------
+Benchmark                                            Time   UserCounters...
+--------------------------------------------------------------------------------
+BM_UdpPacketsPerSecond/sockets:1/io_uring:0     766032 ns   items_per_second=336.622k/s
+BM_UdpPacketsPerSecond/sockets:16/io_uring:0    790887 ns   items_per_second=327.168k/s
+BM_UdpPacketsPerSecond/sockets:1/io_uring:1     802647 ns   items_per_second=338.961k/s
+BM_UdpPacketsPerSecond/sockets:16/io_uring:1    823377 ns   items_per_second=315.348k/s
+
+With sender and receivers on one thread the io_uring socket server enters the
+kernel once per up to four datagrams per socket, but that is offset by the
+cost of the kernel arming a poll for every posted receive, and the two are on
+par. Posting more receives per socket makes it slower, since a datagram wakes
+all receives posted on its socket.
+
+*/
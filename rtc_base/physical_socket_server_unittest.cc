@@ -14,7 +14,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
+#include "rtc_base/async_udp_socket.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/logging.h"
@@ -472,6 +474,250 @@ TEST_F(PhysicalSocketTest, TestSocketRecvTimestampIPv6) {
 }
 #endif
 
+class BatchPacketCounter : public sigslot::has_slots<> {
+ public:
+  void OnReadPacket(AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++packets;
+    last_size = size;
+  }
+  void OnSentPacket(AsyncPacketSocket* socket, const SentPacket& sent_packet) {
+    ++sent_packets;
+  }
+
+  int packets = 0;
+  int sent_packets = 0;
+  size_t last_size = 0;
+};
+
+TEST_F(PhysicalSocketTest, RecvFromBatchReturnsAllQueuedDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  const char kPayload[] = "batched";
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(static_cast<int>(sizeof(kPayload)),
+              sender->SendTo(kPayload, sizeof(kPayload),
+                             receiver->GetLocalAddress()));
+  }
+
+  char buffers[4][64];
+  Socket::ReceivedDatagram datagrams[4];
+  for (int i = 0; i < 4; ++i) {
+    datagrams[i].data = buffers[i];
+    datagrams[i].capacity = sizeof(buffers[i]);
+  }
+  int received = 0;
+  while (received < 3) {
+    int count = receiver->RecvFromBatch(datagrams, 4);
+    if (count < 0) {
+      ASSERT_TRUE(receiver->IsBlocking());
+      continue;
+    }
+    for (int i = 0; i < count; ++i) {
+      EXPECT_EQ(sizeof(kPayload), datagrams[i].size);
+      EXPECT_FALSE(datagrams[i].truncated);
+      EXPECT_EQ(sender->GetLocalAddress(), datagrams[i].source);
+      EXPECT_STREQ(kPayload, datagrams[i].data);
+    }
+    received += count;
+  }
+  EXPECT_EQ(3, received);
+}
+
+TEST_F(PhysicalSocketTest, SendToBatchDeliversDatagramsInOrder) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> other(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, other->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  // Four equally sized datagrams followed by a shorter one can share a GSO
+  // send, the datagram to `other` can not.
+  const size_t kSizes[] = {100, 100, 100, 100, 40, 100};
+  char payloads[6][100];
+  Socket::DatagramToSend datagrams[6];
+  for (int i = 0; i < 6; ++i) {
+    memset(payloads[i], 'a' + i, sizeof(payloads[i]));
+    datagrams[i].data = payloads[i];
+    datagrams[i].size = kSizes[i];
+    datagrams[i].destination =
+        i < 5 ? receiver->GetLocalAddress() : other->GetLocalAddress();
+  }
+  EXPECT_EQ(6, sender->SendToBatch(datagrams, 6));
+
+  char buffer[200];
+  SocketAddress source;
+  for (int i = 0; i < 5; ++i) {
+    int received = -1;
+    while (received < 0) {
+      received = receiver->RecvFrom(buffer, sizeof(buffer), &source, nullptr);
+      ASSERT_TRUE(received >= 0 || receiver->IsBlocking());
+    }
+    EXPECT_EQ(static_cast<int>(kSizes[i]), received);
+    EXPECT_EQ('a' + i, buffer[0]);
+    EXPECT_EQ(sender->GetLocalAddress(), source);
+  }
+  int received = -1;
+  while (received < 0) {
+    received = other->RecvFrom(buffer, sizeof(buffer), &source, nullptr);
+    ASSERT_TRUE(received >= 0 || other->IsBlocking());
+  }
+  EXPECT_EQ(100, received);
+  EXPECT_EQ('f', buffer[0]);
+}
+
+// Batches larger than a single sendmmsg() call are sent in several calls.
+TEST_F(PhysicalSocketTest, SendToBatchSendsLargeBatches) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<Socket> receiver(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_EQ(0, receiver->Bind(SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+
+  constexpr int kNumDatagrams = 150;
+  uint8_t payloads[kNumDatagrams][50];
+  Socket::DatagramToSend datagrams[kNumDatagrams];
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    memset(payloads[i], i, sizeof(payloads[i]));
+    datagrams[i].data = payloads[i];
+    datagrams[i].size = sizeof(payloads[i]);
+    datagrams[i].destination = receiver->GetLocalAddress();
+  }
+  EXPECT_EQ(kNumDatagrams, sender->SendToBatch(datagrams, kNumDatagrams));
+
+  uint8_t buffer[100];
+  SocketAddress source;
+  for (int i = 0; i < kNumDatagrams; ++i) {
+    int received = -1;
+    while (received < 0) {
+      received = receiver->RecvFrom(buffer, sizeof(buffer), &source, nullptr);
+      ASSERT_TRUE(received >= 0 || receiver->IsBlocking());
+    }
+    EXPECT_EQ(50, received);
+    EXPECT_EQ(i, buffer[0]);
+  }
+}
+
+TEST_F(PhysicalSocketTest, AsyncUdpSocketSendsAndReceivesBatches) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(receiver);
+  receiver->SetReceiveBatchSize(8);
+  BatchPacketCounter counter;
+  receiver->SignalReadPacket.connect(&counter,
+                                     &BatchPacketCounter::OnReadPacket);
+
+  std::unique_ptr<AsyncUDPSocket> sender(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  ASSERT_TRUE(sender);
+  sender->SignalSentPacket.connect(&counter,
+                                   &BatchPacketCounter::OnSentPacket);
+
+  char payload[100] = {0};
+  std::vector<AsyncPacketSocket::PacketToSend> packets(5);
+  for (AsyncPacketSocket::PacketToSend& packet : packets) {
+    packet.data = payload;
+    packet.size = sizeof(payload);
+    packet.address = receiver->GetLocalAddress();
+  }
+  EXPECT_EQ(5, sender->SendToBatch(packets));
+  EXPECT_EQ_WAIT(5, counter.packets, kTimeout);
+  EXPECT_EQ(sizeof(payload), counter.last_size);
+
+  EXPECT_EQ(5, counter.sent_packets);
+
+  const AsyncUDPSocket::ReceiveBatchStats& stats =
+      receiver->receive_batch_stats();
+  EXPECT_EQ(5, stats.packets);
+  EXPECT_EQ(0, stats.truncated_packets);
+  EXPECT_GE(stats.batches, 1);
+  EXPECT_LE(stats.max_batch_size, 8u);
+}
+
+#if defined(WEBRTC_USE_EPOLL)
+// Runs the generic socket tests against a socket server using edge-triggered
+// epoll, which has to behave like the level-triggered one.
+class PhysicalSocketEdgeTriggeredTest : public SocketTest {
+ protected:
+  PhysicalSocketEdgeTriggeredTest()
+      : SocketTest(&server_),
+        server_(/*edge_triggered_epoll=*/true),
+        thread_(&server_) {}
+
+  PhysicalSocketServer server_;
+  rtc::AutoSocketServerThread thread_;
+};
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestConnectIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestConnectIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestConnectFailIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestConnectFailIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestServerCloseIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestServerCloseIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestDeleteInReadCallbackIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestDeleteInReadCallbackIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestTcpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestTcpIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestSingleFlowControlCallbackIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestSingleFlowControlCallbackIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestUdpIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestUdpIPv4();
+}
+
+TEST_F(PhysicalSocketEdgeTriggeredTest, TestUdpReadyToSendIPv4) {
+  MAYBE_SKIP_IPV4;
+  SocketTest::TestUdpReadyToSendIPv4();
+}
+
+// Reading a single datagram per read event must not lose the datagrams that
+// were already queued when the edge was reported.
+TEST_F(PhysicalSocketEdgeTriggeredTest, DeliversAllQueuedDatagrams) {
+  MAYBE_SKIP_IPV4;
+  std::unique_ptr<AsyncUDPSocket> receiver(
+      AsyncUDPSocket::Create(&server_, SocketAddress(kIPv4Loopback, 0)));
+  std::unique_ptr<Socket> sender(server_.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_TRUE(receiver);
+  ASSERT_EQ(0, sender->Bind(SocketAddress(kIPv4Loopback, 0)));
+  BatchPacketCounter counter;
+  receiver->SignalReadPacket.connect(&counter,
+                                     &BatchPacketCounter::OnReadPacket);
+
+  char payload[100] = {0};
+  for (int i = 0; i < 10; ++i) {
+    sender->SendTo(payload, sizeof(payload), receiver->GetLocalAddress());
+  }
+  EXPECT_EQ_WAIT(10, counter.packets, kTimeout);
+}
+#endif  // WEBRTC_USE_EPOLL
+
 // Verify that if the socket was unable to be bound to a real network interface
 // (not loopback), Bind will return an error.
 TEST_F(PhysicalSocketTest,
@@ -10,4 +10,29 @@
 
 #include "rtc_base/socket.h"
 
-namespace rtc {}  // namespace rtc
+namespace rtc {
+
+int Socket::SendToBatch(const DatagramToSend* datagrams, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const DatagramToSend& datagram = datagrams[i];
+    int sent = SendTo(datagram.data, datagram.size, datagram.destination);
+    if (sent < 0)
+      return i == 0 ? sent : static_cast<int>(i);
+  }
+  return static_cast<int>(count);
+}
+
+int Socket::RecvFromBatch(ReceivedDatagram* datagrams, size_t count) {
+  if (count == 0)
+    return 0;
+  ReceivedDatagram& datagram = datagrams[0];
+  int received = RecvFrom(datagram.data, datagram.capacity, &datagram.source,
+                          &datagram.timestamp);
+  if (received < 0)
+    return received;
+  datagram.size = static_cast<size_t>(received);
+  datagram.truncated = false;
+  return 1;
+}
+
+}  // namespace rtc
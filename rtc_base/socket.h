@@ -95,12 +95,47 @@ class Socket {
   virtual int Connect(const SocketAddress& addr) = 0;
   virtual int Send(const void* pv, size_t cb) = 0;
   virtual int SendTo(const void* pv, size_t cb, const SocketAddress& addr) = 0;
+
+  // Describes one datagram passed to SendToBatch().
+  struct DatagramToSend {
+    const void* data = nullptr;
+    size_t size = 0;
+    SocketAddress destination;
+  };
+  // Sends `count` datagrams in order using as few system calls as the
+  // implementation allows. Returns the number of datagrams sent, or a negative
+  // value if the first datagram could not be sent, like SendTo(). A return
+  // value less than `count` means the socket blocked or failed after sending
+  // that many datagrams; the caller owns the rest and may retry them once the
+  // socket is writable again. The default implementation calls SendTo() for
+  // each datagram.
+  virtual int SendToBatch(const DatagramToSend* datagrams, size_t count);
   // `timestamp` is in units of microseconds.
   virtual int Recv(void* pv, size_t cb, int64_t* timestamp) = 0;
   virtual int RecvFrom(void* pv,
                        size_t cb,
                        SocketAddress* paddr,
                        int64_t* timestamp) = 0;
+
+  // Describes one datagram slot used by RecvFromBatch(). `data` and
+  // `capacity` are provided by the caller, the remaining fields are filled in
+  // for each received datagram.
+  struct ReceivedDatagram {
+    char* data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    // Set if the datagram was larger than `capacity` and has been cut off.
+    bool truncated = false;
+    SocketAddress source;
+    // In units of microseconds, or -1 if not available.
+    int64_t timestamp = -1;
+  };
+  // Receives up to `count` datagrams using as few system calls as the
+  // implementation allows. Returns the number of datagrams written to
+  // `datagrams`, or a negative value on error, like RecvFrom(). The default
+  // implementation receives a single datagram using RecvFrom().
+  virtual int RecvFromBatch(ReceivedDatagram* datagrams, size_t count);
+
   virtual int Listen(int backlog) = 0;
   virtual Socket* Accept(SocketAddress* paddr) = 0;
   virtual int Close() = 0;
@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_instrumentation.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include "absl/numeric/bits.h"
+#include "api/ref_counted_base.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace task_queue_instrumentation_impl {
+
+// Locations are made from string literals, so the pointers identify them.
+using LocationKey = std::tuple<const char*, const char*, int>;
+
+// What is recorded for one queue. Referenced by the queue and by the tasks
+// wrapped for it, which may outlive the queue.
+struct QueueRecord : public rtc::RefCountedNonVirtual<QueueRecord> {
+  explicit QueueRecord(absl::string_view name) : name(name) {}
+
+  const std::string name;
+  // Tasks wrapped for the queue that have been neither run nor destroyed.
+  std::atomic<int> depth{0};
+  Mutex mutex;
+  std::map<LocationKey, TaskQueueInstrumentation::Stats> stats
+      RTC_GUARDED_BY(mutex);
+};
+
+}  // namespace task_queue_instrumentation_impl
+
+namespace {
+
+using ::webrtc::task_queue_instrumentation_impl::LocationKey;
+using ::webrtc::task_queue_instrumentation_impl::QueueRecord;
+
+// The records of all live queues.
+class Registry {
+ public:
+  void Add(QueueRecord* record) {
+    MutexLock lock(&mutex_);
+    records_.insert(record);
+  }
+
+  void Remove(QueueRecord* record) {
+    MutexLock lock(&mutex_);
+    records_.erase(record);
+  }
+
+  std::vector<rtc::scoped_refptr<QueueRecord>> GetRecords() {
+    MutexLock lock(&mutex_);
+    return std::vector<rtc::scoped_refptr<QueueRecord>>(records_.begin(),
+                                                        records_.end());
+  }
+
+ private:
+  Mutex mutex_;
+  std::set<QueueRecord*> records_ RTC_GUARDED_BY(mutex_);
+};
+
+Registry& GetRegistry() {
+  // Never destroyed, since tasks may outlive static destruction.
+  static Registry* const registry = new Registry();
+  return *registry;
+}
+
+TaskQueueInstrumentation::Stats& GetStatsFor(QueueRecord* record,
+                                             const rtc::Location& posted_from)
+    RTC_EXCLUSIVE_LOCKS_REQUIRED(record->mutex) {
+  const LocationKey key(posted_from.function_name(), posted_from.file_name(),
+                        posted_from.line_number());
+  auto it = record->stats.find(key);
+  if (it == record->stats.end()) {
+    it = record->stats.emplace(key, TaskQueueInstrumentation::Stats()).first;
+    it->second.queue_name = record->name;
+    it->second.posted_from = posted_from.ToString();
+  }
+  return it->second;
+}
+
+void AddHistogram(const TaskQueueInstrumentation::Histogram& from,
+                  TaskQueueInstrumentation::Histogram* to) {
+  for (int i = 0; i < TaskQueueInstrumentation::Histogram::kNumBuckets; ++i) {
+    to->buckets[i] += from.buckets[i];
+  }
+  to->count += from.count;
+  to->total_us += from.total_us;
+  to->max_us = std::max(to->max_us, from.max_us);
+}
+
+void AddStats(const TaskQueueInstrumentation::Stats& from,
+              TaskQueueInstrumentation::Stats* to) {
+  to->posted_tasks += from.posted_tasks;
+  to->max_queue_depth = std::max(to->max_queue_depth, from.max_queue_depth);
+  AddHistogram(from.wait_time_us, &to->wait_time_us);
+  AddHistogram(from.run_time_us, &to->run_time_us);
+}
+
+void RecordPostedTask(QueueRecord* record,
+                      const rtc::Location& posted_from,
+                      int queue_depth) {
+  MutexLock lock(&record->mutex);
+  TaskQueueInstrumentation::Stats& stats = GetStatsFor(record, posted_from);
+  ++stats.posted_tasks;
+  stats.max_queue_depth = std::max(stats.max_queue_depth, queue_depth);
+}
+
+// Runs a task posted to a TaskQueueBase implementation and records how long
+// it waited and ran.
+class InstrumentedTask final : public QueuedTask, public PoolAllocated {
+ public:
+  InstrumentedTask(rtc::scoped_refptr<QueueRecord> record,
+                   std::unique_ptr<QueuedTask> task,
+                   int64_t due_us)
+      : record_(std::move(record)), task_(std::move(task)), due_us_(due_us) {}
+
+  ~InstrumentedTask() override {
+    if (!run_)
+      record_->depth.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+ private:
+  bool Run() override {
+    run_ = true;
+    record_->depth.fetch_sub(1, std::memory_order_relaxed);
+    const int64_t start_us = rtc::TimeMicros();
+    const int64_t wait_us = std::max<int64_t>(start_us - due_us_, 0);
+    {
+      TRACE_EVENT2("webrtc", "TaskQueueInstrumentation::RunTask", "queue",
+                   record_->name.c_str(), "wait_us", wait_us);
+      // `false` means the task took ownership of itself.
+      if (!task_->Run())
+        task_.release();
+    }
+    const int64_t run_us = rtc::TimeMicros() - start_us;
+    MutexLock lock(&record_->mutex);
+    TaskQueueInstrumentation::Stats& stats =
+        GetStatsFor(record_.get(), rtc::Location());
+    stats.wait_time_us.Add(wait_us);
+    stats.run_time_us.Add(run_us);
+    return true;
+  }
+
+  const rtc::scoped_refptr<QueueRecord> record_;
+  std::unique_ptr<QueuedTask> task_;
+  const int64_t due_us_;
+  bool run_ = false;
+};
+
+}  // namespace
+
+std::atomic<bool> TaskQueueInstrumentation::enabled_{false};
+
+void TaskQueueInstrumentation::Histogram::Add(int64_t duration_us) {
+  const int bucket =
+      duration_us < 1
+          ? 0
+          : std::min<int>(absl::bit_width(static_cast<uint64_t>(duration_us)),
+                          kNumBuckets - 1);
+  ++buckets[bucket];
+  ++count;
+  total_us += duration_us;
+  max_us = std::max(max_us, duration_us);
+}
+
+TaskQueueInstrumentation::Queue::Queue(absl::string_view name)
+    : name_(name) {}
+
+TaskQueueInstrumentation::Queue::~Queue() {
+  MutexLock lock(&mutex_);
+  for (const rtc::scoped_refptr<QueueRecord>& record : records_) {
+    GetRegistry().Remove(record.get());
+  }
+}
+
+void TaskQueueInstrumentation::Queue::SetName(absl::string_view name) {
+  MutexLock lock(&mutex_);
+  name_ = std::string(name);
+  // The next task recorded creates a record with the new name.
+  record_.store(nullptr, std::memory_order_relaxed);
+}
+
+QueueRecord* TaskQueueInstrumentation::Queue::GetRecord() {
+  QueueRecord* record = record_.load(std::memory_order_acquire);
+  if (record)
+    return record;
+  MutexLock lock(&mutex_);
+  record = record_.load(std::memory_order_relaxed);
+  if (!record) {
+    records_.push_back(rtc::scoped_refptr<QueueRecord>(new QueueRecord(name_)));
+    record = records_.back().get();
+    GetRegistry().Add(record);
+    record_.store(record, std::memory_order_release);
+  }
+  return record;
+}
+
+void TaskQueueInstrumentation::Queue::RecordPosted(
+    const rtc::Location& posted_from,
+    int queue_depth) {
+  RecordPostedTask(GetRecord(), posted_from, queue_depth);
+}
+
+void TaskQueueInstrumentation::Queue::RecordWaitTime(
+    const rtc::Location& posted_from,
+    int64_t wait_us) {
+  QueueRecord* record = GetRecord();
+  MutexLock lock(&record->mutex);
+  GetStatsFor(record, posted_from).wait_time_us.Add(wait_us);
+}
+
+void TaskQueueInstrumentation::Queue::RecordRunTime(
+    const rtc::Location& posted_from,
+    int64_t run_us) {
+  QueueRecord* record = GetRecord();
+  MutexLock lock(&record->mutex);
+  GetStatsFor(record, posted_from).run_time_us.Add(run_us);
+}
+
+std::unique_ptr<QueuedTask> TaskQueueInstrumentation::Queue::WrapTask(
+    std::unique_ptr<QueuedTask> task,
+    uint32_t delay_ms) {
+  QueueRecord* record = GetRecord();
+  const int queue_depth =
+      record->depth.fetch_add(1, std::memory_order_relaxed) + 1;
+  RecordPostedTask(record, rtc::Location(), queue_depth);
+  return std::make_unique<InstrumentedTask>(
+      rtc::scoped_refptr<QueueRecord>(record), std::move(task),
+      rtc::TimeMicros() + int64_t{delay_ms} * rtc::kNumMicrosecsPerMillisec);
+}
+
+void TaskQueueInstrumentation::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+std::vector<TaskQueueInstrumentation::Stats>
+TaskQueueInstrumentation::GetStats() {
+  // Queues with the same name are added up.
+  std::map<std::pair<std::string, LocationKey>, Stats> merged_stats;
+  for (const rtc::scoped_refptr<QueueRecord>& record :
+       GetRegistry().GetRecords()) {
+    MutexLock lock(&record->mutex);
+    for (const auto& location_and_stats : record->stats) {
+      auto inserted = merged_stats.emplace(
+          std::make_pair(record->name, location_and_stats.first),
+          location_and_stats.second);
+      if (!inserted.second)
+        AddStats(location_and_stats.second, &inserted.first->second);
+    }
+  }
+  std::vector<Stats> all_stats;
+  all_stats.reserve(merged_stats.size());
+  for (auto& key_and_stats : merged_stats) {
+    all_stats.push_back(std::move(key_and_stats.second));
+  }
+  return all_stats;
+}
+
+void TaskQueueInstrumentation::ResetStats() {
+  for (const rtc::scoped_refptr<QueueRecord>& record :
+       GetRegistry().GetRecords()) {
+    MutexLock lock(&record->mutex);
+    record->stats.clear();
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_QUEUE_INSTRUMENTATION_H_
+#define RTC_BASE_TASK_QUEUE_INSTRUMENTATION_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/queued_task.h"
+#include "rtc_base/location.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+namespace task_queue_instrumentation_impl {
+struct QueueRecord;
+}  // namespace task_queue_instrumentation_impl
+
+// Opt-in instrumentation of task queues and rtc::Thread, for finding out which
+// queue is backed up when latency spikes. When enabled, the depth of a queue
+// when a task is posted to it, how long the task waits before it runs and how
+// long it runs are recorded, keyed by the name of the queue and where the
+// task was posted from, and each task run is traced with TRACE_EVENT. When
+// disabled, posting a task costs a single branch.
+class RTC_EXPORT TaskQueueInstrumentation {
+ public:
+  // Durations in microseconds, in buckets whose bounds are powers of two.
+  struct Histogram {
+    static constexpr int kNumBuckets = 24;
+
+    void Add(int64_t duration_us);
+
+    // `buckets[0]` counts durations below 1 us, `buckets[i]` durations in
+    // [2^(i-1), 2^i) us, and the last bucket all longer durations.
+    std::array<int64_t, kNumBuckets> buckets = {};
+    int64_t count = 0;
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+  };
+
+  struct Stats {
+    std::string queue_name;
+    // Tasks posted through TaskQueueBase, which doesn't take the location,
+    // are recorded as posted from rtc::Location().
+    std::string posted_from;
+    int64_t posted_tasks = 0;
+    // The most tasks pending in the queue, including the posted one, when a
+    // task was posted.
+    int max_queue_depth = 0;
+    // Wait time is counted from when a delayed task is due.
+    Histogram wait_time_us;
+    Histogram run_time_us;
+  };
+
+  // The instrumentation of one queue, owned by the queue. Nothing is allocated
+  // for a queue until a task is recorded, and what is recorded is dropped with
+  // the queue. Queues with the same name are added up by GetStats().
+  class RTC_EXPORT Queue {
+   public:
+    explicit Queue(absl::string_view name);
+    ~Queue();
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    void SetName(absl::string_view name);
+
+    // For TaskQueueBase implementations, which don't track their depth or
+    // time their tasks. Returns `task` wrapped to be recorded when posted and
+    // when run, if instrumentation is enabled, and `task` otherwise.
+    std::unique_ptr<QueuedTask> Wrap(std::unique_ptr<QueuedTask> task,
+                                     uint32_t delay_ms = 0) {
+      if (!IsEnabled())
+        return task;
+      return WrapTask(std::move(task), delay_ms);
+    }
+
+    // For queues that track their depth and time their tasks themselves.
+    // Should only be called while instrumentation is enabled.
+    void RecordPosted(const rtc::Location& posted_from, int queue_depth);
+    void RecordWaitTime(const rtc::Location& posted_from, int64_t wait_us);
+    void RecordRunTime(const rtc::Location& posted_from, int64_t run_us);
+
+   private:
+    using QueueRecord = task_queue_instrumentation_impl::QueueRecord;
+
+    std::unique_ptr<QueuedTask> WrapTask(std::unique_ptr<QueuedTask> task,
+                                         uint32_t delay_ms);
+    QueueRecord* GetRecord();
+
+    Mutex mutex_;
+    std::string name_ RTC_GUARDED_BY(mutex_);
+    // Created on first use, and reset by SetName(). Owned by `records_`.
+    std::atomic<QueueRecord*> record_{nullptr};
+    // Every record created for this queue, since tasks may still be recorded
+    // to a record that was reset.
+    std::vector<rtc::scoped_refptr<QueueRecord>> records_
+        RTC_GUARDED_BY(mutex_);
+  };
+
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns what has been recorded since the last ResetStats().
+  static std::vector<Stats> GetStats();
+  static void ResetStats();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_INSTRUMENTATION_H_
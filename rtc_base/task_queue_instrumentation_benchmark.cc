@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_instrumentation.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kTasksPerIteration = 1024;
+
+// Posts small tasks to `task_queue`, with instrumentation enabled or not, and
+// waits for them to run. The task queue is blocked while the tasks are
+// posted, so that the task queue thread isn't woken up for every task.
+void PostTasks(benchmark::State& state,
+               TaskQueueBase* task_queue,
+               bool instrumented) {
+  TaskQueueInstrumentation::ResetStats();
+  TaskQueueInstrumentation::SetEnabled(instrumented);
+  std::atomic<int> counter{0};
+  rtc::Event unblock;
+  rtc::Event done;
+  for (auto _ : state) {
+    task_queue->PostTask(
+        ToQueuedTask([&unblock] { unblock.Wait(rtc::Event::kForever); }));
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      task_queue->PostTask(ToQueuedTask([&counter] { ++counter; }));
+    }
+    task_queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+    unblock.Set();
+    done.Wait(rtc::Event::kForever);
+  }
+  TaskQueueInstrumentation::SetEnabled(false);
+  state.SetItemsProcessed(state.iterations() * (kTasksPerIteration + 2));
+}
+
+// The argument is whether instrumentation is enabled.
+void BM_PostToTaskQueue(benchmark::State& state) {
+  std::unique_ptr<TaskQueueFactory> factory = CreateTaskQueueStdlibFactory();
+  auto task_queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  PostTasks(state, task_queue.get(), state.range(0) != 0);
+}
+
+// The argument is whether instrumentation is enabled.
+void BM_PostToThread(benchmark::State& state) {
+  std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+  thread->Start();
+  PostTasks(state, thread.get(), state.range(0) != 0);
+  thread->Stop();
+}
+
+BENCHMARK(BM_PostToTaskQueue)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("instrumented")
+    ->UseRealTime();
+BENCHMARK(BM_PostToThread)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("instrumented")
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
+
+/*
+
+Results (Linux, single core):
+
+Before task queues were instrumented:
+
+---------------------------------------------------------------------------------------------
+Benchmark                                            Time    UserCounters...
+---------------------------------------------------------------------------------------------
+BM_PostToTaskQueue/instrumented:0/real_time     151603 ns    items_per_second=6.77M/s
+BM_PostToThread/instrumented:0/real_time        299058 ns    items_per_second=3.43M/s
+
+After:
+
+---------------------------------------------------------------------------------------------
+Benchmark                                            Time    UserCounters...
+---------------------------------------------------------------------------------------------
+BM_PostToTaskQueue/instrumented:0/real_time     153004 ns    items_per_second=6.71M/s
+BM_PostToTaskQueue/instrumented:1/real_time     379035 ns    items_per_second=2.71M/s
+BM_PostToThread/instrumented:0/real_time        275472 ns    items_per_second=3.72M/s
+BM_PostToThread/instrumented:1/real_time        569016 ns    items_per_second=1.80M/s
+
+With instrumentation disabled the difference is within the run to run
+variation of about 10%. Enabled, every task takes the lock of its queue's
+record twice and reads the clock twice, which about halves the throughput
+of posting tiny tasks. That is meant for finding a backed up queue, not for
+leaving on.
+
+*/
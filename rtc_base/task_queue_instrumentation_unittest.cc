@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_instrumentation.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/thread.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::HasSubstr;
+
+class TaskQueueInstrumentationTest : public ::testing::Test {
+ protected:
+  TaskQueueInstrumentationTest() {
+    TaskQueueInstrumentation::ResetStats();
+    TaskQueueInstrumentation::SetEnabled(true);
+  }
+  ~TaskQueueInstrumentationTest() override {
+    TaskQueueInstrumentation::SetEnabled(false);
+    TaskQueueInstrumentation::ResetStats();
+  }
+
+  static std::vector<TaskQueueInstrumentation::Stats> GetStatsOf(
+      const std::string& queue_name) {
+    std::vector<TaskQueueInstrumentation::Stats> stats_of_queue;
+    for (const auto& stats : TaskQueueInstrumentation::GetStats()) {
+      if (stats.queue_name == queue_name)
+        stats_of_queue.push_back(stats);
+    }
+    return stats_of_queue;
+  }
+};
+
+TEST(TaskQueueInstrumentationHistogramTest, AddsToPowerOfTwoBuckets) {
+  TaskQueueInstrumentation::Histogram histogram;
+  histogram.Add(0);
+  histogram.Add(1);
+  histogram.Add(3);
+  histogram.Add(int64_t{1} << 40);
+  EXPECT_EQ(1, histogram.buckets[0]);
+  EXPECT_EQ(1, histogram.buckets[1]);
+  EXPECT_EQ(1, histogram.buckets[2]);
+  EXPECT_EQ(1, histogram.buckets.back());
+  EXPECT_EQ(4, histogram.count);
+  EXPECT_EQ(4 + (int64_t{1} << 40), histogram.total_us);
+  EXPECT_EQ(int64_t{1} << 40, histogram.max_us);
+}
+
+TEST(TaskQueueInstrumentationDisabledTest, DoesNotWrapTasks) {
+  ASSERT_FALSE(TaskQueueInstrumentation::IsEnabled());
+  TaskQueueInstrumentation::Queue queue("NotInstrumented");
+  std::unique_ptr<QueuedTask> task = ToQueuedTask([] {});
+  QueuedTask* const raw_task = task.get();
+  EXPECT_EQ(raw_task, queue.Wrap(std::move(task)).get());
+}
+
+TEST_F(TaskQueueInstrumentationTest, RecordsTasksPostedToTaskQueue) {
+  constexpr int kTasks = 10;
+  auto factory = CreateTaskQueueStdlibFactory();
+  auto task_queue = factory->CreateTaskQueue(
+      "InstrumentedTaskQueue", TaskQueueFactory::Priority::NORMAL);
+
+  rtc::Event blocked;
+  rtc::Event unblock;
+  rtc::Event done;
+  task_queue->PostTask(ToQueuedTask([&] {
+    blocked.Set();
+    unblock.Wait(rtc::Event::kForever);
+  }));
+  blocked.Wait(rtc::Event::kForever);
+  for (int i = 0; i < kTasks; ++i) {
+    task_queue->PostTask(ToQueuedTask([] {}));
+  }
+  task_queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+  unblock.Set();
+  done.Wait(rtc::Event::kForever);
+
+  std::vector<TaskQueueInstrumentation::Stats> stats =
+      GetStatsOf("InstrumentedTaskQueue");
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(kTasks + 2, stats[0].posted_tasks);
+  // The blocking task had started, so it is not counted.
+  EXPECT_EQ(kTasks + 1, stats[0].max_queue_depth);
+  // The last task may still be running.
+  EXPECT_GE(stats[0].wait_time_us.count, kTasks + 1);
+  EXPECT_GE(stats[0].run_time_us.count, kTasks + 1);
+}
+
+TEST_F(TaskQueueInstrumentationTest, RecordsMessagesPostedToThreadByLocation) {
+  std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+  thread->SetName("InstrumentedThread", nullptr);
+  thread->Start();
+  rtc::Event done;
+  thread->PostTask(RTC_FROM_HERE, [] {});
+  thread->PostTask(RTC_FROM_HERE, [&done] { done.Set(); });
+  done.Wait(rtc::Event::kForever);
+  thread->Stop();
+
+  std::vector<TaskQueueInstrumentation::Stats> stats =
+      GetStatsOf("InstrumentedThread");
+  ASSERT_EQ(2u, stats.size());
+  for (const TaskQueueInstrumentation::Stats& location_stats : stats) {
+    EXPECT_THAT(location_stats.posted_from,
+                HasSubstr("task_queue_instrumentation_unittest.cc"));
+    EXPECT_EQ(1, location_stats.posted_tasks);
+    EXPECT_EQ(1, location_stats.wait_time_us.count);
+    EXPECT_EQ(1, location_stats.run_time_us.count);
+  }
+}
+
+TEST_F(TaskQueueInstrumentationTest, DeletedTaskIsNoLongerCountedInDepth) {
+  TaskQueueInstrumentation::Queue queue("InstrumentedQueue");
+  queue.Wrap(ToQueuedTask([] {}));
+  std::unique_ptr<QueuedTask> task = queue.Wrap(ToQueuedTask([] {}));
+  EXPECT_TRUE(task->Run());
+
+  std::vector<TaskQueueInstrumentation::Stats> stats =
+      GetStatsOf("InstrumentedQueue");
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(2, stats[0].posted_tasks);
+  EXPECT_EQ(1, stats[0].max_queue_depth);
+  EXPECT_EQ(1, stats[0].run_time_us.count);
+}
+
+TEST_F(TaskQueueInstrumentationTest, QueuesWithSameNameHaveTheirOwnDepth) {
+  TaskQueueInstrumentation::Queue queue1("SameName");
+  TaskQueueInstrumentation::Queue queue2("SameName");
+  std::unique_ptr<QueuedTask> task1 = queue1.Wrap(ToQueuedTask([] {}));
+  std::unique_ptr<QueuedTask> task2 = queue2.Wrap(ToQueuedTask([] {}));
+  std::unique_ptr<QueuedTask> task3 = queue2.Wrap(ToQueuedTask([] {}));
+
+  std::vector<TaskQueueInstrumentation::Stats> stats = GetStatsOf("SameName");
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(3, stats[0].posted_tasks);
+  EXPECT_EQ(2, stats[0].max_queue_depth);
+}
+
+TEST_F(TaskQueueInstrumentationTest, DropsStatsOfDestroyedQueue) {
+  std::unique_ptr<QueuedTask> task;
+  {
+    TaskQueueInstrumentation::Queue queue("DestroyedQueue");
+    task = queue.Wrap(ToQueuedTask([] {}));
+    EXPECT_EQ(1u, GetStatsOf("DestroyedQueue").size());
+  }
+  EXPECT_TRUE(GetStatsOf("DestroyedQueue").empty());
+  // A task that outlives its queue can still run.
+  EXPECT_TRUE(task->Run());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -34,6 +34,7 @@
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_queue_instrumentation.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/time_utils.h"
 
@@ -116,6 +117,11 @@ class TaskQueueLibevent final : public TaskQueueBase {
 
   ~TaskQueueLibevent() override = default;
 
+  // Posts `task` without instrumenting it.
+  void Enqueue(std::unique_ptr<QueuedTask> task);
+  // Must be called on the task queue.
+  void SetTimer(std::unique_ptr<QueuedTask> task, uint32_t milliseconds);
+
   static void OnWakeup(int socket, short flags, void* context);  // NOLINT
   static void RunTimer(int fd, short flags, void* context);      // NOLINT
 
@@ -130,6 +136,7 @@ class TaskQueueLibevent final : public TaskQueueBase {
       RTC_GUARDED_BY(pending_lock_);
   // Holds a list of events pending timers for cleanup when the loop exits.
   std::list<TimerEvent*> pending_timers_;
+  TaskQueueInstrumentation::Queue instrumentation_;
 };
 
 struct TaskQueueLibevent::TimerEvent {
@@ -154,9 +161,9 @@ class TaskQueueLibevent::SetTimerTask : public QueuedTask {
     // Compensate for the time that has passed since construction
     // and until we got here.
     uint32_t post_time = rtc::Time32() - posted_;
-    TaskQueueLibevent::Current()->PostDelayedTask(
-        std::move(task_),
-        post_time > milliseconds_ ? 0 : milliseconds_ - post_time);
+    static_cast<TaskQueueLibevent*>(TaskQueueLibevent::Current())
+        ->SetTimer(std::move(task_),
+                   post_time > milliseconds_ ? 0 : milliseconds_ - post_time);
     return true;
   }
 
@@ -167,7 +174,7 @@ class TaskQueueLibevent::SetTimerTask : public QueuedTask {
 
 TaskQueueLibevent::TaskQueueLibevent(absl::string_view queue_name,
                                      rtc::ThreadPriority priority)
-    : event_base_(event_base_new()) {
+    : event_base_(event_base_new()), instrumentation_(queue_name) {
   int fds[2];
   RTC_CHECK(pipe(fds) == 0);
   SetNonBlocking(fds[0]);
@@ -220,6 +227,10 @@ void TaskQueueLibevent::Delete() {
 }
 
 void TaskQueueLibevent::PostTask(std::unique_ptr<QueuedTask> task) {
+  Enqueue(instrumentation_.Wrap(std::move(task)));
+}
+
+void TaskQueueLibevent::Enqueue(std::unique_ptr<QueuedTask> task) {
   {
     MutexLock lock(&pending_lock_);
     bool had_pending_tasks = !pending_.empty();
@@ -244,19 +255,26 @@ void TaskQueueLibevent::PostTask(std::unique_ptr<QueuedTask> task) {
 
 void TaskQueueLibevent::PostDelayedTask(std::unique_ptr<QueuedTask> task,
                                         uint32_t milliseconds) {
+  task = instrumentation_.Wrap(std::move(task), milliseconds);
   if (IsCurrent()) {
-    TimerEvent* timer = new TimerEvent(this, std::move(task));
-    EventAssign(&timer->ev, event_base_, -1, 0, &TaskQueueLibevent::RunTimer,
-                timer);
-    pending_timers_.push_back(timer);
-    timeval tv = {rtc::dchecked_cast<int>(milliseconds / 1000),
-                  rtc::dchecked_cast<int>(milliseconds % 1000) * 1000};
-    event_add(&timer->ev, &tv);
+    SetTimer(std::move(task), milliseconds);
   } else {
-    PostTask(std::make_unique<SetTimerTask>(std::move(task), milliseconds));
+    Enqueue(std::make_unique<SetTimerTask>(std::move(task), milliseconds));
   }
 }
 
+void TaskQueueLibevent::SetTimer(std::unique_ptr<QueuedTask> task,
+                                 uint32_t milliseconds) {
+  RTC_DCHECK(IsCurrent());
+  TimerEvent* timer = new TimerEvent(this, std::move(task));
+  EventAssign(&timer->ev, event_base_, -1, 0, &TaskQueueLibevent::RunTimer,
+              timer);
+  pending_timers_.push_back(timer);
+  timeval tv = {rtc::dchecked_cast<int>(milliseconds / 1000),
+                rtc::dchecked_cast<int>(milliseconds % 1000) * 1000};
+  event_add(&timer->ev, &tv);
+}
+
 // static
 void TaskQueueLibevent::OnWakeup(int socket,
                                  short flags,  // NOLINT
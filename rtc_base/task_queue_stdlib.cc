@@ -13,10 +13,13 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <queue>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "api/task_queue/queued_task.h"
@@ -24,8 +27,11 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/event.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_queue_instrumentation.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/time_utils.h"
 
@@ -108,6 +114,8 @@ class TaskQueueStdlib final : public TaskQueueBase {
   std::map<DelayedEntryTimeout, std::unique_ptr<QueuedTask>> delayed_queue_
       RTC_GUARDED_BY(pending_lock_);
 
+  TaskQueueInstrumentation::Queue instrumentation_;
+
   // Contains the active worker thread assigned to processing
   // tasks (including delayed tasks).
   // Placing this last ensures the thread doesn't touch uninitialized attributes
@@ -119,6 +127,7 @@ TaskQueueStdlib::TaskQueueStdlib(absl::string_view queue_name,
                                  rtc::ThreadPriority priority)
     : started_(/*manual_reset=*/false, /*initially_signaled=*/false),
       flag_notify_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      instrumentation_(queue_name),
       thread_(rtc::PlatformThread::SpawnJoinable(
           [this] {
             CurrentTaskQueueSetter set_current(this);
@@ -143,6 +152,7 @@ void TaskQueueStdlib::Delete() {
 }
 
 void TaskQueueStdlib::PostTask(std::unique_ptr<QueuedTask> task) {
+  task = instrumentation_.Wrap(std::move(task));
   {
     MutexLock lock(&pending_lock_);
     OrderId order = thread_posting_order_++;
@@ -156,6 +166,7 @@ void TaskQueueStdlib::PostTask(std::unique_ptr<QueuedTask> task) {
 
 void TaskQueueStdlib::PostDelayedTask(std::unique_ptr<QueuedTask> task,
                                       uint32_t milliseconds) {
+  task = instrumentation_.Wrap(std::move(task), milliseconds);
   auto fire_at = rtc::TimeMillis() + milliseconds;
 
   DelayedEntryTimeout delay;
@@ -269,20 +280,340 @@ void TaskQueueStdlib::NotifyWake() {
   flag_notify_.Set();
 }
 
+// Multi-producer single-consumer list of posted tasks that doesn't take
+// locks, after Dmitry Vyukov's non-intrusive MPSC queue. Push() may be called
+// on any thread, Pop() and IsEmpty() only on the task queue thread.
+class PostedTaskList {
+ public:
+  using OrderId = uint64_t;
+
+  struct Entry {
+    OrderId order = 0;
+    // Set for tasks posted with a delay.
+    bool delayed = false;
+    int64_t fire_at_ms = 0;
+    std::unique_ptr<QueuedTask> task;
+  };
+
+  PostedTaskList() : head_(new Node), tail_(head_.load()) {}
+  ~PostedTaskList() {
+    while (tail_) {
+      Node* next = tail_->next.load(std::memory_order_relaxed);
+      delete tail_;
+      tail_ = next;
+    }
+  }
+
+  void Push(Entry entry) {
+    Node* node = new Node;
+    node->entry = std::move(entry);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    // Until this store the list may look empty to Pop(). Sequentially
+    // consistent so that the task queue thread either sees the task or is
+    // seen to be waiting, see TaskQueueStdlibLockFree::NotifyWake().
+    prev->next.store(node, std::memory_order_seq_cst);
+  }
+
+  bool Pop(Entry* entry) {
+    Node* next = tail_->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+    // `next` becomes the new stub node.
+    *entry = std::move(next->entry);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+  bool IsEmpty() const {
+    return tail_->next.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+ private:
+  struct Node : public PoolAllocated {
+    std::atomic<Node*> next{nullptr};
+    Entry entry;
+  };
+
+  // Last pushed node, written by all producers. Kept on a cache line of its
+  // own so that posting doesn't contend with the task queue thread.
+  alignas(64) std::atomic<Node*> head_;
+  // Stub node preceding the next node to pop.
+  alignas(64) Node* tail_;
+};
+
+// Delayed tasks ordered by fire time and then by posting order, in a 4-ary
+// heap which is shallower and more cache friendly than a binary heap.
+class DelayedTaskHeap {
+ public:
+  using OrderId = uint64_t;
+
+  struct DelayedTask {
+    int64_t fire_at_ms = 0;
+    OrderId order = 0;
+    std::unique_ptr<QueuedTask> task;
+
+    bool operator<(const DelayedTask& o) const {
+      return std::tie(fire_at_ms, order) < std::tie(o.fire_at_ms, o.order);
+    }
+  };
+
+  bool empty() const { return tasks_.empty(); }
+  const DelayedTask& top() const { return tasks_.front(); }
+
+  void Push(DelayedTask task) {
+    size_t index = tasks_.size();
+    tasks_.push_back(std::move(task));
+    DelayedTask moved = std::move(tasks_[index]);
+    while (index > 0) {
+      size_t parent = (index - 1) / kArity;
+      if (!(moved < tasks_[parent]))
+        break;
+      tasks_[index] = std::move(tasks_[parent]);
+      index = parent;
+    }
+    tasks_[index] = std::move(moved);
+  }
+
+  DelayedTask Pop() {
+    RTC_DCHECK(!tasks_.empty());
+    DelayedTask result = std::move(tasks_.front());
+    DelayedTask moved = std::move(tasks_.back());
+    tasks_.pop_back();
+    if (tasks_.empty())
+      return result;
+    size_t index = 0;
+    while (true) {
+      size_t first_child = index * kArity + 1;
+      if (first_child >= tasks_.size())
+        break;
+      size_t last_child = std::min(first_child + kArity, tasks_.size());
+      size_t smallest = first_child;
+      for (size_t child = first_child + 1; child < last_child; ++child) {
+        if (tasks_[child] < tasks_[smallest])
+          smallest = child;
+      }
+      if (!(tasks_[smallest] < moved))
+        break;
+      tasks_[index] = std::move(tasks_[smallest]);
+      index = smallest;
+    }
+    tasks_[index] = std::move(moved);
+    return result;
+  }
+
+ private:
+  static constexpr size_t kArity = 4;
+
+  std::vector<DelayedTask> tasks_;
+};
+
+// Like TaskQueueStdlib, but tasks are posted to a PostedTaskList instead of
+// taking a mutex, and the event is only signaled if the task queue thread is
+// waiting for it. Delayed tasks are moved from the list to a heap owned by the
+// task queue thread, and go to the heap directly if posted on that thread.
+class TaskQueueStdlibLockFree final : public TaskQueueBase {
+ public:
+  TaskQueueStdlibLockFree(absl::string_view queue_name,
+                          rtc::ThreadPriority priority);
+  ~TaskQueueStdlibLockFree() override = default;
+
+  void Delete() override;
+  void PostTask(std::unique_ptr<QueuedTask> task) override;
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds) override;
+
+ private:
+  using OrderId = PostedTaskList::OrderId;
+
+  // Returns the task to run next, or null and sets `sleep_time_ms` to the
+  // time to wait for the next delayed task.
+  std::unique_ptr<QueuedTask> GetNextTask(int* sleep_time_ms);
+
+  void ProcessTasks();
+
+  void NotifyWake();
+
+  // Indicates if the thread has started.
+  rtc::Event started_;
+
+  // Signaled when a task is posted while the task queue thread is waiting.
+  rtc::Event flag_notify_;
+
+  // Indicates if the worker thread needs to shutdown now.
+  std::atomic<bool> thread_should_quit_{false};
+
+  // Set by the task queue thread before it checks for posted tasks and waits
+  // on flag_notify_.
+  std::atomic<bool> waiting_{false};
+
+  // Holds the next order to use for the next task to be posted.
+  std::atomic<OrderId> thread_posting_order_{0};
+
+  PostedTaskList posted_tasks_;
+
+  // Only accessed on the task queue thread. `next_task_` holds the oldest
+  // immediate task moved out of `posted_tasks_`, if any.
+  PostedTaskList::Entry next_task_;
+  DelayedTaskHeap delayed_tasks_;
+
+  TaskQueueInstrumentation::Queue instrumentation_;
+
+  // Contains the active worker thread assigned to processing
+  // tasks (including delayed tasks).
+  // Placing this last ensures the thread doesn't touch uninitialized attributes
+  // throughout it's lifetime.
+  rtc::PlatformThread thread_;
+};
+
+TaskQueueStdlibLockFree::TaskQueueStdlibLockFree(
+    absl::string_view queue_name,
+    rtc::ThreadPriority priority)
+    : started_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      flag_notify_(/*manual_reset=*/false, /*initially_signaled=*/false),
+      instrumentation_(queue_name),
+      thread_(rtc::PlatformThread::SpawnJoinable(
+          [this] {
+            CurrentTaskQueueSetter set_current(this);
+            ProcessTasks();
+          },
+          queue_name,
+          rtc::ThreadAttributes().SetPriority(priority))) {
+  started_.Wait(rtc::Event::kForever);
+}
+
+void TaskQueueStdlibLockFree::Delete() {
+  RTC_DCHECK(!IsCurrent());
+
+  thread_should_quit_.store(true, std::memory_order_release);
+  flag_notify_.Set();
+
+  delete this;
+}
+
+void TaskQueueStdlibLockFree::PostTask(std::unique_ptr<QueuedTask> task) {
+  PostedTaskList::Entry entry;
+  entry.order =
+      thread_posting_order_.fetch_add(1, std::memory_order_relaxed);
+  entry.task = instrumentation_.Wrap(std::move(task));
+  posted_tasks_.Push(std::move(entry));
+
+  NotifyWake();
+}
+
+void TaskQueueStdlibLockFree::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                              uint32_t milliseconds) {
+  task = instrumentation_.Wrap(std::move(task), milliseconds);
+  const int64_t fire_at = rtc::TimeMillis() + milliseconds;
+  const OrderId order =
+      thread_posting_order_.fetch_add(1, std::memory_order_relaxed);
+
+  if (IsCurrent()) {
+    delayed_tasks_.Push({fire_at, order, std::move(task)});
+    return;
+  }
+
+  PostedTaskList::Entry entry;
+  entry.order = order;
+  entry.delayed = true;
+  entry.fire_at_ms = fire_at;
+  entry.task = std::move(task);
+  posted_tasks_.Push(std::move(entry));
+
+  NotifyWake();
+}
+
+std::unique_ptr<QueuedTask> TaskQueueStdlibLockFree::GetNextTask(
+    int* sleep_time_ms) {
+  // Move posted tasks over until an immediate task is found, keeping the
+  // order of immediate tasks.
+  PostedTaskList::Entry entry;
+  while (!next_task_.task && posted_tasks_.Pop(&entry)) {
+    if (entry.delayed) {
+      delayed_tasks_.Push(
+          {entry.fire_at_ms, entry.order, std::move(entry.task)});
+    } else {
+      next_task_ = std::move(entry);
+    }
+  }
+
+  *sleep_time_ms = rtc::Event::kForever;
+  if (!delayed_tasks_.empty()) {
+    const DelayedTaskHeap::DelayedTask& delayed = delayed_tasks_.top();
+    const int64_t tick = rtc::TimeMillis();
+    if (tick >= delayed.fire_at_ms) {
+      if (!next_task_.task || delayed.order < next_task_.order) {
+        return delayed_tasks_.Pop().task;
+      }
+    } else {
+      *sleep_time_ms = rtc::saturated_cast<int>(delayed.fire_at_ms - tick);
+    }
+  }
+
+  return std::move(next_task_.task);
+}
+
+void TaskQueueStdlibLockFree::ProcessTasks() {
+  started_.Set();
+
+  while (!thread_should_quit_.load(std::memory_order_acquire)) {
+    int sleep_time_ms;
+    std::unique_ptr<QueuedTask> task = GetNextTask(&sleep_time_ms);
+
+    if (task) {
+      // process entry immediately then try again
+      QueuedTask* release_ptr = task.release();
+      if (release_ptr->Run())
+        delete release_ptr;
+      continue;
+    }
+
+    // Producers check `waiting_` after pushing, so either a task posted from
+    // now on is seen below, or its producer sees `waiting_` and signals.
+    waiting_.store(true, std::memory_order_seq_cst);
+    if (posted_tasks_.IsEmpty())
+      flag_notify_.Wait(sleep_time_ms);
+    waiting_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void TaskQueueStdlibLockFree::NotifyWake() {
+  // Signaling the event takes a lock, which is skipped while the task queue
+  // thread is busy. A spurious signal only makes the next wait return early.
+  if (waiting_.load(std::memory_order_seq_cst) &&
+      waiting_.exchange(false, std::memory_order_seq_cst)) {
+    flag_notify_.Set();
+  }
+}
+
 class TaskQueueStdlibFactory final : public TaskQueueFactory {
  public:
+  explicit TaskQueueStdlibFactory(bool lock_free) : lock_free_(lock_free) {}
+
   std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
       absl::string_view name,
       Priority priority) const override {
+    if (lock_free_) {
+      return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
+          new TaskQueueStdlibLockFree(
+              name, TaskQueuePriorityToThreadPriority(priority)));
+    }
     return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
         new TaskQueueStdlib(name, TaskQueuePriorityToThreadPriority(priority)));
   }
+
+ private:
+  const bool lock_free_;
 };
 
 }  // namespace
 
 std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory() {
-  return std::make_unique<TaskQueueStdlibFactory>();
+  return std::make_unique<TaskQueueStdlibFactory>(/*lock_free=*/false);
+}
+
+std::unique_ptr<TaskQueueFactory> CreateLockFreeTaskQueueStdlibFactory() {
+  return std::make_unique<TaskQueueStdlibFactory>(/*lock_free=*/true);
 }
 
 }  // namespace webrtc
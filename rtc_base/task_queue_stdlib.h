@@ -19,6 +19,12 @@ namespace webrtc {
 
 std::unique_ptr<TaskQueueFactory> CreateTaskQueueStdlibFactory();
 
+// Like CreateTaskQueueStdlibFactory(), but the task queues don't take a lock
+// when tasks are posted, so that threads posting to the same task queue don't
+// contend with each other nor with the task queue thread. Delayed tasks are
+// kept in a heap that is only accessed by the task queue thread.
+std::unique_ptr<TaskQueueFactory> CreateLockFreeTaskQueueStdlibFactory();
+
 }  // namespace webrtc
 
 #endif  // RTC_BASE_TASK_QUEUE_STDLIB_H_
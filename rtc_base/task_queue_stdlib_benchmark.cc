@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+std::unique_ptr<TaskQueueFactory> CreateFactory(bool lock_free) {
+  return lock_free ? CreateLockFreeTaskQueueStdlibFactory()
+                   : CreateTaskQueueStdlibFactory();
+}
+
+// Posts tasks to one task queue from a number of threads and measures the
+// time until all of them have run. Arguments are the number of posting
+// threads and whether the lock-free task queue is used.
+void BM_PostFromThreads(benchmark::State& state) {
+  constexpr int kTasksPerIteration = 16384;
+  const int num_threads = static_cast<int>(state.range(0));
+  const int tasks_per_thread = kTasksPerIteration / num_threads;
+  auto factory = CreateFactory(state.range(1) != 0);
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+
+  std::atomic<int64_t> post_time_ns{0};
+  for (auto _ : state) {
+    std::atomic<int> remaining{num_threads * tasks_per_thread};
+    rtc::Event done;
+    std::vector<rtc::PlatformThread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(rtc::PlatformThread::SpawnJoinable(
+          [&] {
+            int64_t start_ns = rtc::TimeNanos();
+            for (int j = 0; j < tasks_per_thread; ++j) {
+              queue->PostTask(ToQueuedTask([&] {
+                if (remaining.fetch_sub(1, std::memory_order_relaxed) == 1)
+                  done.Set();
+              }));
+            }
+            post_time_ns += rtc::TimeNanos() - start_ns;
+          },
+          "producer"));
+    }
+    done.Wait(rtc::Event::kForever);
+  }
+  const int64_t posted =
+      state.iterations() * num_threads * tasks_per_thread;
+  state.SetItemsProcessed(posted);
+  state.counters["post_ns"] =
+      benchmark::Counter(static_cast<double>(post_time_ns.load()) / posted);
+}
+
+// Measures the time from posting a task from another thread until it runs,
+// with the task queue idle in between.
+void BM_PostLatency(benchmark::State& state) {
+  auto factory = CreateFactory(state.range(0) != 0);
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  rtc::Event ran;
+  for (auto _ : state) {
+    queue->PostTask(ToQueuedTask([&ran] { ran.Set(); }));
+    ran.Wait(rtc::Event::kForever);
+  }
+}
+
+BENCHMARK(BM_PostFromThreads)
+    ->ArgsProduct({{1, 2, 4, 16}, {0, 1}})
+    ->ArgNames({"threads", "lock_free"})
+    ->UseRealTime();
+BENCHMARK(BM_PostLatency)->Arg(0)->Arg(1)->ArgName("lock_free");
+
+}  // namespace
+}  // namespace webrtc
+
+/*
+
+Results (Linux, single core):
+
+-----------------------------------------------------------------------------------
+Benchmark                                          Time   UserCounters...
+-----------------------------------------------------------------------------------
+BM_PostFromThreads/threads:1/lock_free:0     3663674 ns   items_per_second=4.47M/s post_ns=106.3
+BM_PostFromThreads/threads:2/lock_free:0     3359586 ns   items_per_second=4.88M/s post_ns=98.5
+BM_PostFromThreads/threads:4/lock_free:0     3356501 ns   items_per_second=4.88M/s post_ns=92.9
+BM_PostFromThreads/threads:16/lock_free:0    3978271 ns   items_per_second=4.12M/s post_ns=114.1
+BM_PostFromThreads/threads:1/lock_free:1     2302793 ns   items_per_second=7.11M/s post_ns=84.5
+BM_PostFromThreads/threads:2/lock_free:1     2669787 ns   items_per_second=6.14M/s post_ns=95.4
+BM_PostFromThreads/threads:4/lock_free:1     2409994 ns   items_per_second=6.80M/s post_ns=88.2
+BM_PostFromThreads/threads:16/lock_free:1    2632735 ns   items_per_second=6.22M/s post_ns=87.0
+BM_PostLatency/lock_free:0                      6323 ns
+BM_PostLatency/lock_free:1                      7707 ns
+
+The task queue thread no longer takes the mutex per task, nor is the event
+signaled per task while the thread is busy, which accounts for most of the
+throughput gain. On a single core the producers rarely run concurrently;
+the difference in contention shows with more cores. Waking an idle task
+queue is slightly slower, since the thread checks for posted tasks once more
+before waiting.
+
+*/
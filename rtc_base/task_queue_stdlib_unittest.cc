@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_stdlib.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_test.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+INSTANTIATE_TEST_SUITE_P(Stdlib,
+                         TaskQueueTest,
+                         ::testing::Values(CreateTaskQueueStdlibFactory));
+
+INSTANTIATE_TEST_SUITE_P(
+    LockFreeStdlib,
+    TaskQueueTest,
+    ::testing::Values(CreateLockFreeTaskQueueStdlibFactory));
+
+TEST(LockFreeTaskQueueStdlibTest, RunsTasksOfEachProducerInOrder) {
+  constexpr int kProducers = 4;
+  constexpr int kTasksPerProducer = 10000;
+  auto factory = CreateLockFreeTaskQueueStdlibFactory();
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+
+  // Only accessed on `queue`.
+  std::vector<int> next_index(kProducers, 0);
+  bool in_order = true;
+  rtc::Event done;
+  int remaining = kProducers * kTasksPerProducer;
+
+  std::vector<rtc::PlatformThread> producers;
+  for (int producer = 0; producer < kProducers; ++producer) {
+    producers.push_back(rtc::PlatformThread::SpawnJoinable(
+        [&, producer] {
+          for (int i = 0; i < kTasksPerProducer; ++i) {
+            queue->PostTask(ToQueuedTask([&, producer, i] {
+              in_order &= next_index[producer]++ == i;
+              if (--remaining == 0)
+                done.Set();
+            }));
+          }
+        },
+        "producer"));
+  }
+  EXPECT_TRUE(done.Wait(10000));
+  producers.clear();
+  EXPECT_TRUE(in_order);
+}
+
+TEST(LockFreeTaskQueueStdlibTest, RunsDelayedTasksInOrderOfFireTime) {
+  auto factory = CreateLockFreeTaskQueueStdlibFactory();
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+
+  Mutex mutex;
+  std::vector<int> order;
+  rtc::Event done;
+  const int kDelaysMs[] = {30, 10, 20, 10, 0, 30};
+  for (int i = 0; i < 6; ++i) {
+    queue->PostDelayedTask(ToQueuedTask([&, i] {
+                             MutexLock lock(&mutex);
+                             order.push_back(i);
+                             if (order.size() == 6)
+                               done.Set();
+                           }),
+                           kDelaysMs[i]);
+  }
+  EXPECT_TRUE(done.Wait(1000));
+  MutexLock lock(&mutex);
+  EXPECT_EQ(order, std::vector<int>({4, 1, 3, 2, 0, 5}));
+}
+
+TEST(LockFreeTaskQueueStdlibTest, DeletesPendingTasksOnDestruction) {
+  auto factory = CreateLockFreeTaskQueueStdlibFactory();
+  auto queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  rtc::Event blocker;
+  queue->PostTask(
+      ToQueuedTask([&blocker] { blocker.Wait(rtc::Event::kForever); }));
+  // Owned by the tasks as well.
+  auto token = std::make_shared<int>(0);
+  for (int i = 0; i < 10; ++i) {
+    queue->PostTask(ToQueuedTask([token] {}));
+    queue->PostDelayedTask(ToQueuedTask([token] {}), 1000);
+  }
+  blocker.Set();
+  queue = nullptr;
+  EXPECT_EQ(1, token.use_count());
+}
+
+}  // namespace
+}  // namespace webrtc
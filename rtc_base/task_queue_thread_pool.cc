@@ -0,0 +1,479 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/strings/string_view.h"
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_base.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/ref_counter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_queue_instrumentation.h"
+#include "rtc_base/thread_annotations.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+// Number of tasks a task queue may run before the worker moves on to other
+// task queues, so that a busy task queue doesn't starve the others.
+constexpr int kMaxTasksPerRun = 16;
+
+class ThreadPool;
+class PooledTaskQueue;
+
+struct Worker {
+  ThreadPool* pool = nullptr;
+  size_t index = 0;
+  Mutex mutex;
+  // Scheduled task queues. The worker takes task queues from the front of its
+  // own deque; idle workers steal from the back.
+  std::deque<PooledTaskQueue*> task_queues RTC_GUARDED_BY(mutex);
+  rtc::Event wake_up;
+  rtc::PlatformThread thread;
+};
+
+class PooledTaskQueue final : public TaskQueueBase {
+ public:
+  PooledTaskQueue(ThreadPool* pool, absl::string_view name);
+
+  void Delete() override;
+  void PostTask(std::unique_ptr<QueuedTask> task) override;
+  void PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds) override;
+
+  // Posts `task` without instrumenting it. Called by the thread pool for
+  // delayed tasks that are due.
+  void Enqueue(std::unique_ptr<QueuedTask> task);
+
+  // Called on a worker thread of the pool. Runs pending tasks, at most
+  // kMaxTasksPerRun of them. Returns true if there are more tasks to run, in
+  // which case the task queue stays scheduled.
+  bool RunTasks();
+
+  // Owners hold a reference until Delete(), the thread pool while the task
+  // queue is scheduled and while it has delayed tasks pending.
+  void AddRef() { ref_count_.IncRef(); }
+  void Release() {
+    if (ref_count_.DecRef() == rtc::RefCountReleaseStatus::kDroppedLastRef)
+      delete this;
+  }
+
+ private:
+  ~PooledTaskQueue() override = default;
+
+  ThreadPool* const pool_;
+  webrtc_impl::RefCounter ref_count_{1};
+
+  // Signaled when the task running during Delete() has returned.
+  rtc::Event stopped_;
+
+  Mutex mutex_;
+  std::deque<std::unique_ptr<QueuedTask>> tasks_ RTC_GUARDED_BY(mutex_);
+  // Set while the task queue is handed to the thread pool to run its tasks.
+  bool scheduled_ RTC_GUARDED_BY(mutex_) = false;
+  // Set while a worker thread runs one of the tasks.
+  bool running_ RTC_GUARDED_BY(mutex_) = false;
+  bool deleted_ RTC_GUARDED_BY(mutex_) = false;
+
+  TaskQueueInstrumentation::Queue instrumentation_;
+};
+
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  TaskQueueBase* CreateTaskQueue(absl::string_view name);
+  void OnTaskQueueDeleted();
+
+  // Hands `task_queue`, and a reference to it, to a worker. The worker runs
+  // the tasks of the task queue until it has none left and then releases the
+  // reference.
+  void Schedule(PooledTaskQueue* task_queue);
+
+  // Posts `task` to `task_queue` once `milliseconds` have passed.
+  void PostDelayedTask(PooledTaskQueue* task_queue,
+                       std::unique_ptr<QueuedTask> task,
+                       uint32_t milliseconds);
+
+ private:
+  struct DelayedTaskKey {
+    int64_t fire_at_ms;
+    uint64_t order;
+
+    bool operator<(const DelayedTaskKey& o) const {
+      return std::tie(fire_at_ms, order) < std::tie(o.fire_at_ms, o.order);
+    }
+  };
+
+  using DelayedTask =
+      std::pair<PooledTaskQueue*, std::unique_ptr<QueuedTask>>;
+
+  void RunWorker(Worker* worker);
+  // Takes a task queue from the worker's deque or steals one from another
+  // worker.
+  PooledTaskQueue* FindWork(Worker* worker);
+  void Push(Worker* worker, PooledTaskQueue* task_queue);
+  void WakeIdleWorker();
+  // Returns false if the pool is shutting down.
+  bool EnterIdle(Worker* worker);
+  void LeaveIdle(Worker* worker);
+
+  void RunTimer();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_worker_{0};
+  std::atomic<int> num_task_queues_{0};
+
+  Mutex idle_mutex_;
+  // Workers waiting on their `wake_up` event.
+  std::vector<Worker*> idle_workers_ RTC_GUARDED_BY(idle_mutex_);
+  // Size of `idle_workers_`, to avoid taking `idle_mutex_` when no worker is
+  // idle.
+  std::atomic<int> num_idle_workers_{0};
+  bool quit_ RTC_GUARDED_BY(idle_mutex_) = false;
+
+  Mutex timer_mutex_;
+  std::map<DelayedTaskKey, DelayedTask> delayed_tasks_
+      RTC_GUARDED_BY(timer_mutex_);
+  uint64_t next_delayed_task_order_ RTC_GUARDED_BY(timer_mutex_) = 0;
+  bool timer_quit_ RTC_GUARDED_BY(timer_mutex_) = false;
+  rtc::Event timer_wake_up_;
+  rtc::PlatformThread timer_thread_;
+};
+
+// The worker running on the current thread, if any.
+ABSL_CONST_INIT thread_local Worker* current_worker = nullptr;
+
+PooledTaskQueue::PooledTaskQueue(ThreadPool* pool, absl::string_view name)
+    : pool_(pool), instrumentation_(name) {}
+
+void PooledTaskQueue::Delete() {
+  RTC_DCHECK(!IsCurrent());
+  std::deque<std::unique_ptr<QueuedTask>> pending_tasks;
+  bool wait_for_task;
+  {
+    MutexLock lock(&mutex_);
+    deleted_ = true;
+    wait_for_task = running_;
+    pending_tasks.swap(tasks_);
+  }
+  if (wait_for_task)
+    stopped_.Wait(rtc::Event::kForever);
+  pending_tasks.clear();
+  pool_->OnTaskQueueDeleted();
+  Release();
+}
+
+void PooledTaskQueue::PostTask(std::unique_ptr<QueuedTask> task) {
+  Enqueue(instrumentation_.Wrap(std::move(task)));
+}
+
+void PooledTaskQueue::Enqueue(std::unique_ptr<QueuedTask> task) {
+  {
+    MutexLock lock(&mutex_);
+    if (deleted_)
+      return;
+    tasks_.push_back(std::move(task));
+    if (scheduled_)
+      return;
+    scheduled_ = true;
+    AddRef();
+  }
+  pool_->Schedule(this);
+}
+
+void PooledTaskQueue::PostDelayedTask(std::unique_ptr<QueuedTask> task,
+                                      uint32_t milliseconds) {
+  task = instrumentation_.Wrap(std::move(task), milliseconds);
+  if (milliseconds == 0) {
+    Enqueue(std::move(task));
+    return;
+  }
+  pool_->PostDelayedTask(this, std::move(task), milliseconds);
+}
+
+bool PooledTaskQueue::RunTasks() {
+  CurrentTaskQueueSetter set_current(this);
+  std::unique_ptr<QueuedTask> task;
+  for (int i = 0;; ++i) {
+    {
+      MutexLock lock(&mutex_);
+      if (running_) {
+        running_ = false;
+        if (deleted_)
+          stopped_.Set();
+      }
+      if (deleted_ || tasks_.empty()) {
+        scheduled_ = false;
+        return false;
+      }
+      if (i == kMaxTasksPerRun)
+        return true;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      running_ = true;
+    }
+    QueuedTask* release_ptr = task.release();
+    if (release_ptr->Run())
+      delete release_ptr;
+  }
+}
+
+ThreadPool::ThreadPool(int num_threads)
+    : timer_wake_up_(/*manual_reset=*/false, /*initially_signaled=*/false) {
+  if (num_threads <= 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+    workers_.back()->pool = this;
+    workers_.back()->index = i;
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    Worker* worker_ptr = worker.get();
+    worker->thread = rtc::PlatformThread::SpawnJoinable(
+        [this, worker_ptr] { RunWorker(worker_ptr); }, "TaskQueuePoolWorker");
+  }
+  timer_thread_ = rtc::PlatformThread::SpawnJoinable([this] { RunTimer(); },
+                                                     "TaskQueuePoolTimer");
+}
+
+ThreadPool::~ThreadPool() {
+  RTC_DCHECK_EQ(num_task_queues_.load(), 0);
+  {
+    MutexLock lock(&timer_mutex_);
+    timer_quit_ = true;
+  }
+  timer_wake_up_.Set();
+  timer_thread_.Finalize();
+  {
+    MutexLock lock(&idle_mutex_);
+    quit_ = true;
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->wake_up.Set();
+  }
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->thread.Finalize();
+  }
+
+  // Drop what deleted task queues left behind.
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    MutexLock lock(&worker->mutex);
+    for (PooledTaskQueue* task_queue : worker->task_queues) {
+      task_queue->Release();
+    }
+  }
+  std::map<DelayedTaskKey, DelayedTask> delayed_tasks;
+  {
+    MutexLock lock(&timer_mutex_);
+    delayed_tasks.swap(delayed_tasks_);
+  }
+  for (auto& delayed_task : delayed_tasks) {
+    delayed_task.second.second = nullptr;
+    delayed_task.second.first->Release();
+  }
+}
+
+TaskQueueBase* ThreadPool::CreateTaskQueue(absl::string_view name) {
+  ++num_task_queues_;
+  return new PooledTaskQueue(this, name);
+}
+
+void ThreadPool::OnTaskQueueDeleted() {
+  --num_task_queues_;
+}
+
+void ThreadPool::Schedule(PooledTaskQueue* task_queue) {
+  Worker* worker = current_worker;
+  if (!worker || worker->pool != this) {
+    worker = workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                      workers_.size()]
+                 .get();
+  }
+  Push(worker, task_queue);
+}
+
+void ThreadPool::Push(Worker* worker, PooledTaskQueue* task_queue) {
+  {
+    MutexLock lock(&worker->mutex);
+    worker->task_queues.push_back(task_queue);
+  }
+  // A worker counts itself as idle before looking for work a last time, and
+  // `worker->mutex` orders that with the push above. So either that worker
+  // finds `task_queue`, or it is seen here.
+  WakeIdleWorker();
+}
+
+void ThreadPool::WakeIdleWorker() {
+  if (num_idle_workers_.load(std::memory_order_relaxed) == 0)
+    return;
+  Worker* idle_worker = nullptr;
+  {
+    MutexLock lock(&idle_mutex_);
+    if (!idle_workers_.empty()) {
+      idle_worker = idle_workers_.back();
+      idle_workers_.pop_back();
+      num_idle_workers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  if (idle_worker)
+    idle_worker->wake_up.Set();
+}
+
+bool ThreadPool::EnterIdle(Worker* worker) {
+  MutexLock lock(&idle_mutex_);
+  if (quit_)
+    return false;
+  idle_workers_.push_back(worker);
+  num_idle_workers_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void ThreadPool::LeaveIdle(Worker* worker) {
+  MutexLock lock(&idle_mutex_);
+  auto it = std::find(idle_workers_.begin(), idle_workers_.end(), worker);
+  if (it != idle_workers_.end()) {
+    idle_workers_.erase(it);
+    num_idle_workers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  // Otherwise the worker has been woken up, and the next wait returns
+  // immediately.
+}
+
+PooledTaskQueue* ThreadPool::FindWork(Worker* worker) {
+  {
+    MutexLock lock(&worker->mutex);
+    if (!worker->task_queues.empty()) {
+      PooledTaskQueue* task_queue = worker->task_queues.front();
+      worker->task_queues.pop_front();
+      return task_queue;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(worker->index + i) % workers_.size()].get();
+    MutexLock lock(&victim->mutex);
+    if (!victim->task_queues.empty()) {
+      PooledTaskQueue* task_queue = victim->task_queues.back();
+      victim->task_queues.pop_back();
+      return task_queue;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::RunWorker(Worker* worker) {
+  current_worker = worker;
+  while (true) {
+    PooledTaskQueue* task_queue = FindWork(worker);
+    if (!task_queue) {
+      if (!EnterIdle(worker))
+        break;
+      task_queue = FindWork(worker);
+      if (!task_queue) {
+        worker->wake_up.Wait(rtc::Event::kForever);
+        continue;
+      }
+      LeaveIdle(worker);
+    }
+    if (task_queue->RunTasks()) {
+      Push(worker, task_queue);
+    } else {
+      task_queue->Release();
+    }
+  }
+  current_worker = nullptr;
+}
+
+void ThreadPool::PostDelayedTask(PooledTaskQueue* task_queue,
+                                 std::unique_ptr<QueuedTask> task,
+                                 uint32_t milliseconds) {
+  const int64_t fire_at_ms = rtc::TimeMillis() + milliseconds;
+  bool earliest;
+  task_queue->AddRef();
+  {
+    MutexLock lock(&timer_mutex_);
+    DelayedTaskKey key{fire_at_ms, next_delayed_task_order_++};
+    earliest = delayed_tasks_.empty() || key < delayed_tasks_.begin()->first;
+    delayed_tasks_.emplace(key, DelayedTask(task_queue, std::move(task)));
+  }
+  if (earliest)
+    timer_wake_up_.Set();
+}
+
+void ThreadPool::RunTimer() {
+  std::vector<DelayedTask> due_tasks;
+  while (true) {
+    int wait_ms = rtc::Event::kForever;
+    {
+      MutexLock lock(&timer_mutex_);
+      if (timer_quit_)
+        break;
+      const int64_t now_ms = rtc::TimeMillis();
+      while (!delayed_tasks_.empty()) {
+        auto it = delayed_tasks_.begin();
+        if (it->first.fire_at_ms > now_ms) {
+          wait_ms = rtc::saturated_cast<int>(it->first.fire_at_ms - now_ms);
+          break;
+        }
+        due_tasks.push_back(std::move(it->second));
+        delayed_tasks_.erase(it);
+      }
+    }
+    // Tasks posted to deleted task queues are deleted here.
+    for (DelayedTask& due_task : due_tasks) {
+      due_task.first->Enqueue(std::move(due_task.second));
+      due_task.first->Release();
+    }
+    due_tasks.clear();
+    timer_wake_up_.Wait(wait_ms);
+  }
+}
+
+class TaskQueueThreadPoolFactory final : public TaskQueueFactory {
+ public:
+  explicit TaskQueueThreadPoolFactory(int num_threads)
+      : pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> CreateTaskQueue(
+      absl::string_view name,
+      Priority priority) const override {
+    return std::unique_ptr<TaskQueueBase, TaskQueueDeleter>(
+        pool_->CreateTaskQueue(name));
+  }
+
+ private:
+  const std::unique_ptr<ThreadPool> pool_;
+};
+
+}  // namespace
+
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactory(
+    int num_threads) {
+  return std::make_unique<TaskQueueThreadPoolFactory>(num_threads);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,35 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
+#define RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
+
+#include <memory>
+
+#include "api/task_queue/task_queue_factory.h"
+
+namespace webrtc {
+
+// Creates a factory whose task queues don't have threads of their own, but
+// share a pool of `num_threads` worker threads, or one per core if
+// `num_threads` is 0. A task queue with tasks to run is scheduled on one of
+// the workers, and idle workers steal scheduled task queues from busy ones.
+// Tasks of a task queue still run in order and never concurrently. Delayed
+// tasks are kept by a single timer thread until they are due.
+//
+// Meant for processes hosting many calls, where a thread per task queue
+// would mean thousands of mostly idle threads. The priority of task queues
+// is ignored. The factory must outlive the task queues it creates.
+std::unique_ptr<TaskQueueFactory> CreateTaskQueueThreadPoolFactory(
+    int num_threads = 0);
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_QUEUE_THREAD_POOL_H_
@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/task_queue_factory.h"
+#include "api/units/time_delta.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_queue_thread_pool.h"
+#include "rtc_base/task_utils/repeating_task.h"
+#include "rtc_base/time_utils.h"
+
+namespace webrtc {
+namespace {
+
+using TaskQueuePtr = std::unique_ptr<TaskQueueBase, TaskQueueDeleter>;
+
+constexpr TimeDelta kInterval = TimeDelta::Millis(5);
+constexpr int64_t kRunTimeMs = 1000;
+
+struct Load {
+  std::atomic<int64_t> runs{0};
+  std::atomic<int64_t> total_delay_us{0};
+  std::atomic<int64_t> max_delay_us{0};
+};
+
+// Does a bit of work every kInterval, like a pacer or a stats timer, and
+// records how late it runs.
+class PeriodicTask {
+ public:
+  explicit PeriodicTask(Load* load) : load_(load) {}
+
+  TimeDelta operator()() {
+    const int64_t now_us = rtc::TimeMicros();
+    if (expected_us_ != 0) {
+      const int64_t delay_us = now_us - expected_us_;
+      load_->total_delay_us += delay_us;
+      int64_t max_delay_us = load_->max_delay_us.load();
+      while (delay_us > max_delay_us &&
+             !load_->max_delay_us.compare_exchange_weak(max_delay_us,
+                                                        delay_us)) {
+      }
+      ++load_->runs;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 2000; ++i) {
+      value = value * 31 + i;
+    }
+    benchmark::DoNotOptimize(value);
+    expected_us_ = now_us + kInterval.us();
+    return kInterval;
+  }
+
+ private:
+  Load* const load_;
+  int64_t expected_us_ = 0;
+};
+
+// Runs a periodic task on each of a number of task queues for a second and
+// reports the CPU usage of the process and how late the tasks ran. Arguments
+// are the number of task queues and whether they share a thread pool rather
+// than having a thread each.
+void BM_PeriodicTaskQueues(benchmark::State& state) {
+  const int num_task_queues = static_cast<int>(state.range(0));
+  std::unique_ptr<TaskQueueFactory> factory =
+      state.range(1) != 0 ? CreateTaskQueueThreadPoolFactory()
+                          : CreateTaskQueueStdlibFactory();
+  Load load;
+  double cpu_usage = 0;
+  for (auto _ : state) {
+    std::vector<TaskQueuePtr> task_queues;
+    for (int i = 0; i < num_task_queues; ++i) {
+      task_queues.push_back(factory->CreateTaskQueue(
+          "periodic", TaskQueueFactory::Priority::NORMAL));
+    }
+    const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+    const int64_t start_ns = rtc::TimeNanos();
+    for (TaskQueuePtr& task_queue : task_queues) {
+      RepeatingTaskHandle::Start(task_queue.get(), PeriodicTask(&load));
+    }
+    rtc::Event().Wait(kRunTimeMs);
+    cpu_usage = static_cast<double>(rtc::GetProcessCpuTimeNanos() -
+                                    start_cpu_ns) /
+                (rtc::TimeNanos() - start_ns);
+    // Deleting the task queues stops the periodic tasks.
+    task_queues.clear();
+  }
+  state.counters["cpu_percent"] = 100 * cpu_usage;
+  state.counters["mean_delay_us"] =
+      load.runs > 0 ? static_cast<double>(load.total_delay_us) / load.runs
+                    : 0;
+  state.counters["max_delay_us"] = static_cast<double>(load.max_delay_us);
+}
+
+BENCHMARK(BM_PeriodicTaskQueues)
+    ->ArgsProduct({{10, 100, 1000}, {0, 1}})
+    ->ArgNames({"task_queues", "thread_pool"})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
+
+/*
+
+Results (Linux, single core, thread pool of one worker):
+
+-------------------------------------------------------------------------------------------
+Benchmark                                              UserCounters...
+-------------------------------------------------------------------------------------------
+BM_PeriodicTaskQueues/task_queues:10/thread_pool:0     cpu_percent=1.97  max_delay_us=6.105k
+BM_PeriodicTaskQueues/task_queues:100/thread_pool:0    cpu_percent=19.40 max_delay_us=7.074k
+BM_PeriodicTaskQueues/task_queues:1000/thread_pool:0   cpu_percent=97.42 max_delay_us=84.032k
+BM_PeriodicTaskQueues/task_queues:10/thread_pool:1     cpu_percent=1.41  max_delay_us=2.572k
+BM_PeriodicTaskQueues/task_queues:100/thread_pool:1    cpu_percent=6.87  max_delay_us=1.993k
+BM_PeriodicTaskQueues/task_queues:1000/thread_pool:1   cpu_percent=63.72 max_delay_us=3.759k
+
+With a thread per task queue most of the CPU goes to context switches, and
+at 1000 task queues the core is saturated and tasks run up to 84 ms late.
+The mean delay is within a few microseconds of zero in all cases, since
+delays are rounded to milliseconds.
+
+*/
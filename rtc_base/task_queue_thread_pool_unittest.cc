@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_queue_thread_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/task_queue/task_queue_test.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+std::unique_ptr<TaskQueueFactory> CreateSingleThreadFactory() {
+  return CreateTaskQueueThreadPoolFactory(1);
+}
+
+std::unique_ptr<TaskQueueFactory> CreateMultiThreadFactory() {
+  return CreateTaskQueueThreadPoolFactory(4);
+}
+
+INSTANTIATE_TEST_SUITE_P(ThreadPool,
+                         TaskQueueTest,
+                         ::testing::Values(CreateSingleThreadFactory,
+                                           CreateMultiThreadFactory));
+
+using TaskQueuePtr = std::unique_ptr<TaskQueueBase, TaskQueueDeleter>;
+
+TEST(TaskQueueThreadPoolTest, RunsTasksOfEachTaskQueueInOrderAndInSequence) {
+  constexpr int kTaskQueues = 50;
+  constexpr int kTasksPerTaskQueue = 200;
+  auto factory = CreateTaskQueueThreadPoolFactory(4);
+
+  struct State {
+    TaskQueuePtr task_queue;
+    // Only accessed on `task_queue`, unless `running` is set by two workers.
+    int next_index = 0;
+    std::atomic<bool> running{false};
+  };
+  std::vector<State> states(kTaskQueues);
+  std::atomic<bool> in_order{true};
+  std::atomic<int> remaining{kTaskQueues * kTasksPerTaskQueue};
+  rtc::Event done;
+  for (State& state : states) {
+    state.task_queue = factory->CreateTaskQueue(
+        "queue", TaskQueueFactory::Priority::NORMAL);
+  }
+  for (int i = 0; i < kTasksPerTaskQueue; ++i) {
+    for (State& state : states) {
+      state.task_queue->PostTask(ToQueuedTask([&, i] {
+        if (state.running.exchange(true) || state.next_index++ != i ||
+            !state.task_queue->IsCurrent()) {
+          in_order = false;
+        }
+        state.running = false;
+        if (--remaining == 0)
+          done.Set();
+      }));
+    }
+  }
+  EXPECT_TRUE(done.Wait(10000));
+  EXPECT_TRUE(in_order);
+}
+
+TEST(TaskQueueThreadPoolTest, BusyTaskQueueDoesNotStarveOthers) {
+  auto factory = CreateTaskQueueThreadPoolFactory(1);
+  TaskQueuePtr busy =
+      factory->CreateTaskQueue("busy", TaskQueueFactory::Priority::NORMAL);
+  TaskQueuePtr other =
+      factory->CreateTaskQueue("other", TaskQueueFactory::Priority::NORMAL);
+
+  // Reposts itself until `other` has run a task.
+  std::atomic<bool> other_ran{false};
+  class BusyTask : public QueuedTask {
+   public:
+    explicit BusyTask(std::atomic<bool>* other_ran) : other_ran_(other_ran) {}
+    bool Run() override {
+      if (!*other_ran_)
+        TaskQueueBase::Current()->PostTask(absl::WrapUnique(this));
+      return false;
+    }
+
+   private:
+    std::atomic<bool>* const other_ran_;
+  };
+  busy->PostTask(std::make_unique<BusyTask>(&other_ran));
+  rtc::Event done;
+  other->PostTask(ToQueuedTask([&] {
+    other_ran = true;
+    done.Set();
+  }));
+  EXPECT_TRUE(done.Wait(1000));
+}
+
+TEST(TaskQueueThreadPoolTest, DeleteWaitsForRunningTask) {
+  auto factory = CreateTaskQueueThreadPoolFactory(2);
+  TaskQueuePtr task_queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  rtc::Event started;
+  std::atomic<bool> finished{false};
+  task_queue->PostTask(ToQueuedTask([&] {
+    started.Set();
+    rtc::Event().Wait(50);
+    finished = true;
+  }));
+  ASSERT_TRUE(started.Wait(1000));
+  task_queue = nullptr;
+  EXPECT_TRUE(finished);
+}
+
+}  // namespace
+}  // namespace webrtc
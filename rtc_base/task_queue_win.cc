@@ -40,6 +40,7 @@
 #include "rtc_base/numerics/safe_conversions.h"
 #include "rtc_base/platform_thread.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_queue_instrumentation.h"
 #include "rtc_base/time_utils.h"
 
 namespace webrtc {
@@ -165,6 +166,8 @@ class TaskQueueWin : public TaskQueueBase {
   void RunPendingTasks();
 
  private:
+  // Posts `task` without instrumenting it.
+  void Enqueue(std::unique_ptr<QueuedTask> task);
   void RunThreadMain();
   bool ProcessQueuedMessages();
   void RunDueTasks();
@@ -192,11 +195,13 @@ class TaskQueueWin : public TaskQueueBase {
   std::queue<std::unique_ptr<QueuedTask>> pending_
       RTC_GUARDED_BY(pending_lock_);
   HANDLE in_queue_;
+  TaskQueueInstrumentation::Queue instrumentation_;
 };
 
 TaskQueueWin::TaskQueueWin(absl::string_view queue_name,
                            rtc::ThreadPriority priority)
-    : in_queue_(::CreateEvent(nullptr, true, false, nullptr)) {
+    : in_queue_(::CreateEvent(nullptr, true, false, nullptr)),
+      instrumentation_(queue_name) {
   RTC_DCHECK(in_queue_);
   thread_ = rtc::PlatformThread::SpawnJoinable(
       [this] { RunThreadMain(); }, queue_name,
@@ -222,6 +227,10 @@ void TaskQueueWin::Delete() {
 }
 
 void TaskQueueWin::PostTask(std::unique_ptr<QueuedTask> task) {
+  Enqueue(instrumentation_.Wrap(std::move(task)));
+}
+
+void TaskQueueWin::Enqueue(std::unique_ptr<QueuedTask> task) {
   MutexLock lock(&pending_lock_);
   pending_.push(std::move(task));
   ::SetEvent(in_queue_);
@@ -229,8 +238,9 @@ void TaskQueueWin::PostTask(std::unique_ptr<QueuedTask> task) {
 
 void TaskQueueWin::PostDelayedTask(std::unique_ptr<QueuedTask> task,
                                    uint32_t milliseconds) {
+  task = instrumentation_.Wrap(std::move(task), milliseconds);
   if (!milliseconds) {
-    PostTask(std::move(task));
+    Enqueue(std::move(task));
     return;
   }
 
@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_utils/queued_task_allocator.h"
+
+#include <atomic>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+namespace {
+
+// Blocks are moved between threads in batches of this many.
+constexpr int kBatchSize = 32;
+// A thread hands a batch to other threads when it holds more than this.
+constexpr int kMaxCachedBlocks = 2 * kBatchSize;
+// Batches beyond this are returned to the heap, bounding the memory kept
+// after a burst of tasks.
+constexpr size_t kMaxSharedBatches = 256;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+std::atomic<int64_t> heap_allocations{0};
+
+void* AllocateFromHeap(size_t size) {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void FreeList(FreeBlock* head) {
+  while (head) {
+    FreeBlock* next = head->next;
+    ::operator delete(head, QueuedTaskAllocator::kBlockSize);
+    head = next;
+  }
+}
+
+// Batches of free blocks available to all threads.
+class SharedBatches {
+ public:
+  FreeBlock* Take() {
+    MutexLock lock(&mutex_);
+    if (batches_.empty())
+      return nullptr;
+    FreeBlock* batch = batches_.back();
+    batches_.pop_back();
+    return batch;
+  }
+
+  void Give(FreeBlock* batch) {
+    {
+      MutexLock lock(&mutex_);
+      if (batches_.size() < kMaxSharedBatches) {
+        batches_.push_back(batch);
+        return;
+      }
+    }
+    FreeList(batch);
+  }
+
+ private:
+  Mutex mutex_;
+  std::vector<FreeBlock*> batches_ RTC_GUARDED_BY(mutex_);
+};
+
+SharedBatches& GetSharedBatches() {
+  // Never destroyed, since tasks may be deleted during static destruction.
+  static SharedBatches* const shared_batches = new SharedBatches();
+  return *shared_batches;
+}
+
+// Set when the cache of the thread has been destroyed at thread exit, after
+// which blocks are allocated from and returned to the heap.
+ABSL_CONST_INIT thread_local bool thread_cache_destroyed = false;
+
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    thread_cache_destroyed = true;
+    // Keep full batches for other threads.
+    while (count_ >= kBatchSize) {
+      GetSharedBatches().Give(TakeBatch());
+    }
+    FreeList(head_);
+  }
+
+  void* Allocate() {
+    if (!head_) {
+      head_ = GetSharedBatches().Take();
+      if (!head_)
+        return AllocateFromHeap(QueuedTaskAllocator::kBlockSize);
+      count_ = kBatchSize;
+    }
+    FreeBlock* block = head_;
+    head_ = block->next;
+    --count_;
+    return block;
+  }
+
+  void Free(void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = head_;
+    head_ = block;
+    if (++count_ > kMaxCachedBlocks) {
+      // Hand the most recently freed blocks to other threads.
+      GetSharedBatches().Give(TakeBatch());
+    }
+  }
+
+ private:
+  FreeBlock* TakeBatch() {
+    FreeBlock* batch = head_;
+    FreeBlock* last = head_;
+    for (int i = 1; i < kBatchSize; ++i) {
+      last = last->next;
+    }
+    head_ = last->next;
+    last->next = nullptr;
+    count_ -= kBatchSize;
+    return batch;
+  }
+
+  FreeBlock* head_ = nullptr;
+  int count_ = 0;
+};
+
+ThreadCache* GetThreadCache() {
+  static thread_local ThreadCache thread_cache;
+  return &thread_cache;
+}
+
+}  // namespace
+
+void* QueuedTaskAllocator::Allocate(size_t size) {
+  if (size > kBlockSize)
+    return AllocateFromHeap(size);
+  if (thread_cache_destroyed)
+    return AllocateFromHeap(kBlockSize);
+  return GetThreadCache()->Allocate();
+}
+
+void QueuedTaskAllocator::Free(void* ptr, size_t size) {
+  if (!ptr)
+    return;
+  if (size > kBlockSize) {
+    ::operator delete(ptr, size);
+    return;
+  }
+  if (thread_cache_destroyed) {
+    ::operator delete(ptr, kBlockSize);
+    return;
+  }
+  GetThreadCache()->Free(ptr);
+}
+
+QueuedTaskAllocator::Stats QueuedTaskAllocator::GetStats() {
+  Stats stats;
+  stats.heap_allocations = heap_allocations.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_TASK_UTILS_QUEUED_TASK_ALLOCATOR_H_
+#define RTC_BASE_TASK_UTILS_QUEUED_TASK_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <new>
+
+#include "rtc_base/system/rtc_export.h"
+
+namespace webrtc {
+
+// Allocates posted tasks, and other small objects that are created on one
+// thread and destroyed on another at a high rate, from fixed size blocks
+// kept in per-thread caches instead of from the heap. Blocks freed by a
+// thread beyond what its cache holds are handed to other threads in
+// batches, so that a thread that posts tasks and a thread that runs them
+// reach a state where neither allocates from the heap. Larger objects are
+// allocated from the heap.
+class RTC_EXPORT QueuedTaskAllocator {
+ public:
+  static constexpr size_t kBlockSize = 128;
+
+  struct Stats {
+    // Allocations that had to go to the heap, because the object was too
+    // large or no free block was available.
+    int64_t heap_allocations = 0;
+  };
+
+  static void* Allocate(size_t size);
+  static void Free(void* ptr, size_t size);
+
+  // Counts of all threads.
+  static Stats GetStats();
+};
+
+// Derive from this to have `new` and `delete` of a class, and of the classes
+// derived from it, use QueuedTaskAllocator. Classes deleted through a pointer
+// to a base class need a virtual destructor, so that the size of the most
+// derived class is known when deleting.
+class PoolAllocated {
+ public:
+  static void* operator new(size_t size) {
+    return QueuedTaskAllocator::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    QueuedTaskAllocator::Free(ptr, size);
+  }
+  // Over-aligned classes are allocated from the heap.
+  static void* operator new(size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+  }
+  static void operator delete(void* ptr,
+                              size_t size,
+                              std::align_val_t alignment) {
+    ::operator delete(ptr, size, alignment);
+  }
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_TASK_UTILS_QUEUED_TASK_ALLOCATOR_H_
@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <atomic>
+#include <memory>
+
+#include "api/task_queue/queued_task.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_stdlib.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/thread.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kTasksPerIteration = 1024;
+
+// A small closure task allocated from the heap, like ToQueuedTask() did
+// before QueuedTaskAllocator.
+class HeapTask : public QueuedTask {
+ public:
+  explicit HeapTask(std::atomic<int>* counter) : counter_(counter) {}
+  bool Run() override {
+    ++*counter_;
+    return true;
+  }
+
+ private:
+  std::atomic<int>* const counter_;
+};
+
+// Posts small tasks to `task_queue` and waits for them to run. Reports the
+// heap allocations per task made for the tasks, and for the message data
+// wrapping them if posted to an rtc::Thread. The task queue is blocked while
+// the tasks are posted, so that the task queue thread isn't woken up for
+// every task.
+void PostTasks(benchmark::State& state,
+               TaskQueueBase* task_queue,
+               bool pooled) {
+  std::atomic<int> counter{0};
+  rtc::Event unblock;
+  rtc::Event done;
+  const int64_t heap_allocations =
+      QueuedTaskAllocator::GetStats().heap_allocations;
+  for (auto _ : state) {
+    counter = 0;
+    task_queue->PostTask(
+        ToQueuedTask([&unblock] { unblock.Wait(rtc::Event::kForever); }));
+    for (int i = 0; i < kTasksPerIteration; ++i) {
+      if (pooled) {
+        task_queue->PostTask(ToQueuedTask([&counter] { ++counter; }));
+      } else {
+        task_queue->PostTask(std::make_unique<HeapTask>(&counter));
+      }
+    }
+    task_queue->PostTask(ToQueuedTask([&done] { done.Set(); }));
+    unblock.Set();
+    done.Wait(rtc::Event::kForever);
+  }
+  const int64_t posted = state.iterations() * (kTasksPerIteration + 2);
+  state.SetItemsProcessed(posted);
+  state.counters["pool_heap_allocations_per_task"] =
+      static_cast<double>(QueuedTaskAllocator::GetStats().heap_allocations -
+                          heap_allocations) /
+      posted;
+}
+
+// Arguments are whether the lock-free stdlib task queue is used and whether
+// tasks are created with ToQueuedTask().
+void BM_PostSmallTaskToTaskQueue(benchmark::State& state) {
+  std::unique_ptr<TaskQueueFactory> factory =
+      state.range(0) != 0 ? CreateLockFreeTaskQueueStdlibFactory()
+                          : CreateTaskQueueStdlibFactory();
+  auto task_queue =
+      factory->CreateTaskQueue("queue", TaskQueueFactory::Priority::NORMAL);
+  PostTasks(state, task_queue.get(), state.range(1) != 0);
+}
+
+// The argument is whether tasks are created with ToQueuedTask().
+void BM_PostSmallTaskToThread(benchmark::State& state) {
+  std::unique_ptr<rtc::Thread> thread = rtc::Thread::Create();
+  thread->Start();
+  PostTasks(state, thread.get(), state.range(0) != 0);
+  thread->Stop();
+}
+
+BENCHMARK(BM_PostSmallTaskToTaskQueue)
+    ->ArgsProduct({{0, 1}, {0, 1}})
+    ->ArgNames({"lock_free", "pooled"})
+    ->UseRealTime();
+BENCHMARK(BM_PostSmallTaskToThread)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgName("pooled")
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace webrtc
+
+/*
+
+Results (Linux, single core):
+
+---------------------------------------------------------------------------------------------------------------
+Benchmark                                                        Time    UserCounters...
+---------------------------------------------------------------------------------------------------------------
+BM_PostSmallTaskToTaskQueue/lock_free:0/pooled:0/real_time   140723 ns   items_per_second=7.29M/s
+BM_PostSmallTaskToTaskQueue/lock_free:1/pooled:0/real_time    88964 ns   items_per_second=11.53M/s
+BM_PostSmallTaskToTaskQueue/lock_free:0/pooled:1/real_time   117786 ns   items_per_second=8.71M/s
+BM_PostSmallTaskToTaskQueue/lock_free:1/pooled:1/real_time    63074 ns   items_per_second=16.27M/s
+BM_PostSmallTaskToThread/pooled:0/real_time                  293411 ns   items_per_second=3.50M/s
+BM_PostSmallTaskToThread/pooled:1/real_time                  259573 ns   items_per_second=3.95M/s
+
+pool_heap_allocations_per_task is zero, or a few per million tasks, in all
+cases. Without pooling every task is a heap allocation, and posting to an
+rtc::Thread allocates the message data wrapping the task as well. Pooling
+makes posting to the lock-free task queue about 40% faster, and posting to
+an rtc::Thread about 13% faster, where the message queue lock dominates.
+
+*/
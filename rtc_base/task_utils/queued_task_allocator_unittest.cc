@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/task_utils/queued_task_allocator.h"
+
+#include <stdint.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/queued_task.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+int64_t HeapAllocations() {
+  return QueuedTaskAllocator::GetStats().heap_allocations;
+}
+
+TEST(QueuedTaskAllocatorTest, ReusesFreedBlocks) {
+  // Warm up the cache of this thread.
+  QueuedTaskAllocator::Free(QueuedTaskAllocator::Allocate(16), 16);
+  const int64_t heap_allocations = HeapAllocations();
+  for (int i = 0; i < 1000; ++i) {
+    void* ptr = QueuedTaskAllocator::Allocate(32);
+    QueuedTaskAllocator::Free(ptr, 32);
+  }
+  EXPECT_EQ(heap_allocations, HeapAllocations());
+}
+
+TEST(QueuedTaskAllocatorTest, AllocatesLargeObjectsFromHeap) {
+  const int64_t heap_allocations = HeapAllocations();
+  void* ptr =
+      QueuedTaskAllocator::Allocate(QueuedTaskAllocator::kBlockSize + 1);
+  QueuedTaskAllocator::Free(ptr, QueuedTaskAllocator::kBlockSize + 1);
+  EXPECT_EQ(heap_allocations + 1, HeapAllocations());
+}
+
+TEST(QueuedTaskAllocatorTest, SmallClosureTaskIsPooled) {
+  // Warm up the cache of this thread.
+  ToQueuedTask([] {});
+  const int64_t heap_allocations = HeapAllocations();
+  int runs = 0;
+  for (int i = 0; i < 1000; ++i) {
+    std::unique_ptr<QueuedTask> task = ToQueuedTask([&runs] { ++runs; });
+    EXPECT_TRUE(task->Run());
+  }
+  EXPECT_EQ(1000, runs);
+  EXPECT_EQ(heap_allocations, HeapAllocations());
+}
+
+TEST(QueuedTaskAllocatorTest, LargeClosureTaskIsAllocatedFromHeap) {
+  std::array<uint8_t, QueuedTaskAllocator::kBlockSize> capture = {};
+  const int64_t heap_allocations = HeapAllocations();
+  std::unique_ptr<QueuedTask> task =
+      ToQueuedTask([capture] { EXPECT_EQ(0, capture[0]); });
+  EXPECT_TRUE(task->Run());
+  EXPECT_EQ(heap_allocations + 1, HeapAllocations());
+}
+
+TEST(QueuedTaskAllocatorTest, BlocksFreedOnOtherThreadAreReused) {
+  constexpr int kRounds = 100;
+  constexpr int kTasksPerRound = 256;
+  int64_t heap_allocations_after_first_round = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    std::vector<std::unique_ptr<QueuedTask>> tasks;
+    for (int i = 0; i < kTasksPerRound; ++i) {
+      tasks.push_back(ToQueuedTask([] {}));
+    }
+    // Run and delete the tasks on another thread, like a task queue would.
+    rtc::PlatformThread::SpawnJoinable(
+        [&tasks] {
+          for (std::unique_ptr<QueuedTask>& task : tasks) {
+            task->Run();
+            task = nullptr;
+          }
+        },
+        "runner");
+    if (round == 0)
+      heap_allocations_after_first_round = HeapAllocations();
+  }
+  // The blocks freed by each thread are handed back in batches.
+  EXPECT_EQ(heap_allocations_after_first_round, HeapAllocations());
+}
+
+}  // namespace
+}  // namespace webrtc
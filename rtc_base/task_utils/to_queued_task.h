@@ -17,12 +17,14 @@
 
 #include "api/task_queue/queued_task.h"
 #include "rtc_base/task_utils/pending_task_safety_flag.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
 
 namespace webrtc {
 namespace webrtc_new_closure_impl {
-// Simple implementation of QueuedTask for use with lambdas.
+// Simple implementation of QueuedTask for use with lambdas. Tasks with small
+// captures don't allocate from the heap once posting has warmed up.
 template <typename Closure>
-class ClosureTask : public QueuedTask {
+class ClosureTask : public QueuedTask, public PoolAllocated {
  public:
   explicit ClosureTask(Closure&& closure)
       : closure_(std::forward<Closure>(closure)) {}
@@ -37,7 +39,7 @@ class ClosureTask : public QueuedTask {
 };
 
 template <typename Closure>
-class SafetyClosureTask : public QueuedTask {
+class SafetyClosureTask : public QueuedTask, public PoolAllocated {
  public:
   explicit SafetyClosureTask(rtc::scoped_refptr<PendingTaskSafetyFlag> safety,
                              Closure&& closure)
@@ -26,6 +26,7 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "absl/algorithm/container.h"
@@ -37,6 +38,7 @@
 #include "rtc_base/internal/default_socket_server.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/null_socket_server.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
 #include "rtc_base/task_utils/to_queued_task.h"
 #include "rtc_base/time_utils.h"
 #include "rtc_base/trace_event.h"
@@ -71,6 +73,10 @@ class ScopedAutoReleasePool {
 namespace rtc {
 namespace {
 
+// Delayed messages may be dispatched up to 1/16 of their delay late, but no
+// more than this.
+constexpr int64_t kMaxDelayedMessageLeewayMs = 16;
+
 class MessageHandlerWithTask final : public MessageHandler {
  public:
   MessageHandlerWithTask() {}
@@ -86,6 +92,15 @@ class MessageHandlerWithTask final : public MessageHandler {
   RTC_DISALLOW_COPY_AND_ASSIGN(MessageHandlerWithTask);
 };
 
+// Message data carrying a posted QueuedTask. Allocated like the task itself,
+// so that posting a small closure doesn't allocate from the heap.
+class QueuedTaskMessageData final
+    : public ScopedMessageData<webrtc::QueuedTask>,
+      public webrtc::PoolAllocated {
+ public:
+  using ScopedMessageData<webrtc::QueuedTask>::ScopedMessageData;
+};
+
 class RTC_SCOPED_LOCKABLE MarkProcessingCritScope {
  public:
   MarkProcessingCritScope(const RecursiveCriticalSection* cs,
@@ -392,7 +407,8 @@ Thread::Thread(SocketServer* ss, bool do_init)
       fInitialized_(false),
       fDestroyed_(false),
       stop_(0),
-      ss_(ss) {
+      ss_(ss),
+      instrumentation_("Thread") {
   RTC_DCHECK(ss);
   ss_->SetMessageQueue(this);
   SetName("Thread", this);  // default name
@@ -457,6 +473,107 @@ void Thread::Restart() {
   AtomicOps::ReleaseStore(&stop_, 0);
 }
 
+Thread::PostedMessages::~PostedMessages() {
+  while (head_) {
+    Node* next = head_->next;
+    delete head_;
+    head_ = next;
+  }
+}
+
+void Thread::PostedMessages::PushBack(const Message& msg,
+                                      int64_t posted_at_us) {
+  Node* node = new Node(msg, posted_at_us);
+  if (tail_) {
+    tail_->next = node;
+  } else {
+    head_ = node;
+  }
+  tail_ = node;
+  ++size_;
+}
+
+Message Thread::PostedMessages::PopFront(int64_t* posted_at_us) {
+  RTC_DCHECK(head_);
+  Node* node = head_;
+  head_ = node->next;
+  if (!head_)
+    tail_ = nullptr;
+  --size_;
+  Message msg = node->msg;
+  *posted_at_us = node->posted_at_us;
+  delete node;
+  return msg;
+}
+
+void Thread::PostedMessages::Remove(MessageHandler* phandler,
+                                    uint32_t id,
+                                    MessageList* removed) {
+  // Unlink the matching messages before deleting their data, since deleting
+  // it may clear messages re-entrantly.
+  Node* matching_head = nullptr;
+  Node** matching_tail = &matching_head;
+  Node* prev = nullptr;
+  Node* node = head_;
+  while (node) {
+    Node* next = node->next;
+    if (node->msg.Match(phandler, id)) {
+      if (prev) {
+        prev->next = next;
+      } else {
+        head_ = next;
+      }
+      if (tail_ == node)
+        tail_ = prev;
+      --size_;
+      node->next = nullptr;
+      *matching_tail = node;
+      matching_tail = &node->next;
+    } else {
+      prev = node;
+    }
+    node = next;
+  }
+
+  while (matching_head) {
+    node = matching_head;
+    matching_head = node->next;
+    if (removed) {
+      removed->push_back(node->msg);
+    } else {
+      delete node->msg.pdata;
+    }
+    delete node;
+  }
+}
+
+// static
+int64_t Thread::DelayedMessage::LeewayMs(int64_t delay_ms) {
+  return std::min(std::max<int64_t>(delay_ms / 16, 0),
+                  kMaxDelayedMessageLeewayMs);
+}
+
+int64_t Thread::PriorityQueue::NextWakeUpTimeMs() const {
+  RTC_DCHECK(!empty());
+  int64_t wake_up_time_ms = top().run_time_ms_ + top().leeway_ms_;
+  UpdateNextWakeUpTime(0, &wake_up_time_ms);
+  return wake_up_time_ms;
+}
+
+void Thread::PriorityQueue::UpdateNextWakeUpTime(
+    size_t index,
+    int64_t* wake_up_time_ms) const {
+  // Messages below `index` in the heap are due no earlier than the message at
+  // `index`, so only the subtrees of messages due before the wake up time can
+  // lower it further. These are few, since the leeway is short.
+  if (index >= c.size() || c[index].run_time_ms_ >= *wake_up_time_ms)
+    return;
+  *wake_up_time_ms = std::min(*wake_up_time_ms,
+                              c[index].run_time_ms_ + c[index].leeway_ms_);
+  UpdateNextWakeUpTime(2 * index + 1, wake_up_time_ms);
+  UpdateNextWakeUpTime(2 * index + 2, wake_up_time_ms);
+}
+
 bool Thread::Peek(Message* pmsg, int cmsWait) {
   if (fPeekKeep_) {
     *pmsg = msgPeek_;
@@ -490,6 +607,7 @@ bool Thread::Get(Message* pmsg, int cmsWait, bool process_io) {
     int64_t cmsDelayNext = kForever;
     bool first_pass = true;
     while (true) {
+      int64_t posted_at_us = 0;
       // All queue operations need to be locked, but nothing else in this loop
       // (specifically handling disposed message) can happen inside the crit.
       // Otherwise, disposed MessageHandlers will cause deadlocks.
@@ -501,11 +619,19 @@ bool Thread::Get(Message* pmsg, int cmsWait, bool process_io) {
           first_pass = false;
           while (!delayed_messages_.empty()) {
             if (msCurrent < delayed_messages_.top().run_time_ms_) {
-              cmsDelayNext =
-                  TimeDiff(delayed_messages_.top().run_time_ms_, msCurrent);
+              // Wake up once for all delayed messages whose leeway allows
+              // it, rather than once for each.
+              cmsDelayNext = TimeDiff(delayed_messages_.NextWakeUpTimeMs(),
+                                      msCurrent);
               break;
             }
-            messages_.push_back(delayed_messages_.top().msg_);
+            // Delayed messages wait from when they are due.
+            messages_.PushBack(
+                delayed_messages_.top().msg_,
+                webrtc::TaskQueueInstrumentation::IsEnabled()
+                    ? delayed_messages_.top().run_time_ms_ *
+                          kNumMicrosecsPerMillisec
+                    : 0);
             delayed_messages_.pop();
           }
         }
@@ -513,8 +639,7 @@ bool Thread::Get(Message* pmsg, int cmsWait, bool process_io) {
         if (messages_.empty()) {
           break;
         } else {
-          *pmsg = messages_.front();
-          messages_.pop_front();
+          *pmsg = messages_.PopFront(&posted_at_us);
         }
       }  // crit_ is released here.
 
@@ -525,6 +650,10 @@ bool Thread::Get(Message* pmsg, int cmsWait, bool process_io) {
         *pmsg = Message();
         continue;
       }
+      if (posted_at_us != 0) {
+        instrumentation_.RecordWaitTime(pmsg->posted_from,
+                                        TimeMicros() - posted_at_us);
+      }
       return true;
     }
 
@@ -582,7 +711,14 @@ void Thread::Post(const Location& posted_from,
     msg.phandler = phandler;
     msg.message_id = id;
     msg.pdata = pdata;
-    messages_.push_back(msg);
+    int64_t posted_at_us = 0;
+    if (webrtc::TaskQueueInstrumentation::IsEnabled()) {
+      posted_at_us = TimeMicros();
+      instrumentation_.RecordPosted(
+          posted_from, static_cast<int>(messages_.size() +
+                                        delayed_messages_.size() + 1));
+    }
+    messages_.PushBack(msg, posted_at_us);
   }
   WakeUpSocketServer();
 }
@@ -627,8 +763,17 @@ void Thread::DoDelayPost(const Location& posted_from,
     msg.phandler = phandler;
     msg.message_id = id;
     msg.pdata = pdata;
-    DelayedMessage delayed(delay_ms, run_at_ms, delayed_next_num_, msg);
+    DelayedMessage delayed(
+        delay_ms, run_at_ms,
+        delayed_message_leeway_allowed_ ? DelayedMessage::LeewayMs(delay_ms)
+                                        : 0,
+        delayed_next_num_, msg);
     delayed_messages_.push(delayed);
+    if (webrtc::TaskQueueInstrumentation::IsEnabled()) {
+      instrumentation_.RecordPosted(
+          posted_from,
+          static_cast<int>(messages_.size() + delayed_messages_.size()));
+    }
     // If this message queue processes 1 message every millisecond for 50 days,
     // we will wrap this number.  Even then, only messages with identical times
     // will be misordered, and then only briefly.  This is probably ok.
@@ -670,18 +815,7 @@ void Thread::ClearInternal(MessageHandler* phandler,
 
   // Remove from ordered message queue
 
-  for (auto it = messages_.begin(); it != messages_.end();) {
-    if (it->Match(phandler, id)) {
-      if (removed) {
-        removed->push_back(*it);
-      } else {
-        delete it->pdata;
-      }
-      it = messages_.erase(it);
-    } else {
-      ++it;
-    }
-  }
+  messages_.Remove(phandler, id, removed);
 
   // Remove from priority queue. Not directly iterable, so use this approach
 
@@ -707,9 +841,15 @@ void Thread::Dispatch(Message* pmsg) {
                pmsg->posted_from.file_name(), "src_func",
                pmsg->posted_from.function_name());
   RTC_DCHECK_RUN_ON(this);
+  const bool instrumented = webrtc::TaskQueueInstrumentation::IsEnabled();
+  const int64_t start_us = instrumented ? TimeMicros() : 0;
   int64_t start_time = TimeMillis();
   pmsg->phandler->OnMessage(pmsg);
   int64_t end_time = TimeMillis();
+  if (instrumented) {
+    instrumentation_.RecordRunTime(pmsg->posted_from,
+                                   TimeMicros() - start_us);
+  }
   int64_t diff = TimeDiff(end_time, start_time);
   if (diff >= dispatch_warning_ms_) {
     RTC_LOG(LS_INFO) << "Message to " << name() << " took " << diff
@@ -759,6 +899,8 @@ bool Thread::SetName(const std::string& name, const void* obj) {
   RTC_DCHECK(!IsRunning());
 
   name_ = name;
+  // Threads with the same name are instrumented together, without `obj`.
+  instrumentation_.SetName(name);
   if (obj) {
     // The %p specifier typically produce at most 16 hex digits, possibly with a
     // 0x prefix. But format is implementation defined, so add some margin.
@@ -769,6 +911,11 @@ bool Thread::SetName(const std::string& name, const void* obj) {
   return true;
 }
 
+void Thread::AllowDelayedMessageLeeway(bool allow) {
+  CritScope cs(&crit_);
+  delayed_message_leeway_allowed_ = allow;
+}
+
 void Thread::SetDispatchWarningMs(int deadline) {
   if (!IsCurrent()) {
     PostTask(webrtc::ToQueuedTask(
@@ -1005,6 +1152,21 @@ void Thread::InvokeInternal(const Location& posted_from,
   TRACE_EVENT2("webrtc", "Thread::Invoke", "src_file", posted_from.file_name(),
                "src_func", posted_from.function_name());
 
+  // Same as what Send() does when called on this thread, without going
+  // through a message and a handler.
+  if (IsCurrent()) {
+    RTC_DCHECK(!IsQuitting());
+    if (IsQuitting())
+      return;
+#if RTC_DCHECK_IS_ON
+    RTC_DCHECK(this->IsInvokeToThreadAllowed(this));
+    RTC_DCHECK_RUN_ON(this);
+    could_be_blocking_call_count_++;
+#endif
+    functor();
+    return;
+  }
+
   class FunctorMessageHandler : public MessageHandler {
    public:
     explicit FunctorMessageHandler(rtc::FunctionView<void()> functor)
@@ -1102,7 +1264,7 @@ void Thread::PostTask(std::unique_ptr<webrtc::QueuedTask> task) {
   // Though Post takes MessageData by raw pointer (last parameter), it still
   // takes it with ownership.
   Post(RTC_FROM_HERE, &queued_task_handler_,
-       /*id=*/0, new ScopedMessageData<webrtc::QueuedTask>(std::move(task)));
+       /*id=*/0, new QueuedTaskMessageData(std::move(task)));
 }
 
 void Thread::PostDelayedTask(std::unique_ptr<webrtc::QueuedTask> task,
@@ -1111,7 +1273,7 @@ void Thread::PostDelayedTask(std::unique_ptr<webrtc::QueuedTask> task,
   // it still takes it with ownership.
   PostDelayed(RTC_FROM_HERE, milliseconds, &queued_task_handler_,
               /*id=*/0,
-              new ScopedMessageData<webrtc::QueuedTask>(std::move(task)));
+              new QueuedTaskMessageData(std::move(task)));
 }
 
 void Thread::Delete() {
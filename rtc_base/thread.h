@@ -36,6 +36,8 @@
 #include "rtc_base/platform_thread_types.h"
 #include "rtc_base/socket_server.h"
 #include "rtc_base/system/rtc_export.h"
+#include "rtc_base/task_queue_instrumentation.h"
+#include "rtc_base/task_utils/queued_task_allocator.h"
 #include "rtc_base/thread_annotations.h"
 #include "rtc_base/thread_message.h"
 
@@ -84,7 +86,8 @@ class MessageLikeTask : public MessageData {
 };
 
 template <class FunctorT>
-class MessageWithFunctor final : public MessageLikeTask {
+class MessageWithFunctor final : public MessageLikeTask,
+                                 public webrtc::PoolAllocated {
  public:
   explicit MessageWithFunctor(FunctorT&& functor)
       : functor_(std::forward<FunctorT>(functor)) {}
@@ -354,6 +357,13 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
   // Default is 50 ms.
   void SetDispatchWarningMs(int deadline);
 
+  // Lets delayed messages posted after this call be dispatched up to 1/16 of
+  // their delay, and at most 16 ms, late, so that the thread can wake up once
+  // for several delayed messages that are due at about the same time. For
+  // threads running many timers that don't need to be precise. Off by
+  // default.
+  void AllowDelayedMessageLeeway(bool allow);
+
   // Starts the execution of the thread.
   bool Start();
 
@@ -520,19 +530,61 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
     rtc::Thread* const previous_;
   };
 
+  // Posted messages in FIFO order. The nodes are intrusive and allocated from
+  // per-thread caches, so posting a message doesn't allocate from the heap.
+  class PostedMessages {
+   public:
+    PostedMessages() = default;
+    PostedMessages(const PostedMessages&) = delete;
+    PostedMessages& operator=(const PostedMessages&) = delete;
+    // Deletes the nodes, but not the data of the messages.
+    ~PostedMessages();
+
+    bool empty() const { return head_ == nullptr; }
+    size_t size() const { return size_; }
+
+    // `posted_at_us` is only set while instrumentation is enabled.
+    void PushBack(const Message& msg, int64_t posted_at_us);
+    // Must not be called when empty.
+    Message PopFront(int64_t* posted_at_us);
+    // Removes the messages matching `phandler` and `id`. Their data is moved
+    // to `removed` if not null, and deleted otherwise.
+    void Remove(MessageHandler* phandler, uint32_t id, MessageList* removed);
+
+   private:
+    struct Node : public webrtc::PoolAllocated {
+      Node(const Message& msg, int64_t posted_at_us)
+          : msg(msg), posted_at_us(posted_at_us) {}
+      Message msg;
+      int64_t posted_at_us;
+      Node* next = nullptr;
+    };
+
+    Node* head_ = nullptr;
+    Node* tail_ = nullptr;
+    size_t size_ = 0;
+  };
+
   // DelayedMessage goes into a priority queue, sorted by trigger time. Messages
   // with the same trigger time are processed in num_ (FIFO) order.
   class DelayedMessage {
    public:
     DelayedMessage(int64_t delay,
                    int64_t run_time_ms,
+                   int64_t leeway_ms,
                    uint32_t num,
                    const Message& msg)
         : delay_ms_(delay),
           run_time_ms_(run_time_ms),
+          leeway_ms_(leeway_ms),
           message_number_(num),
           msg_(msg) {}
 
+    // How late a message with `delay_ms` may be dispatched, so that the
+    // thread can wake up once for several delayed messages that are due at
+    // about the same time.
+    static int64_t LeewayMs(int64_t delay_ms);
+
     bool operator<(const DelayedMessage& dmsg) const {
       return (dmsg.run_time_ms_ < run_time_ms_) ||
              ((dmsg.run_time_ms_ == run_time_ms_) &&
@@ -541,6 +593,7 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
 
     int64_t delay_ms_;  // for debugging
     int64_t run_time_ms_;
+    int64_t leeway_ms_;
     // Monotonicaly incrementing number used for ordering of messages
     // targeted to execute at the same time.
     uint32_t message_number_;
@@ -551,6 +604,13 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
    public:
     container_type& container() { return c; }
     void reheap() { make_heap(c.begin(), c.end(), comp); }
+    // Returns the earliest time at which the thread needs to wake up to
+    // dispatch all messages within their leeway. Must not be called when
+    // empty.
+    int64_t NextWakeUpTimeMs() const;
+
+   private:
+    void UpdateNextWakeUpTime(size_t index, int64_t* wake_up_time_ms) const;
   };
 
   void DoDelayPost(const Location& posted_from,
@@ -635,9 +695,10 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
 
   bool fPeekKeep_;
   Message msgPeek_;
-  MessageList messages_ RTC_GUARDED_BY(crit_);
+  PostedMessages messages_ RTC_GUARDED_BY(crit_);
   PriorityQueue delayed_messages_ RTC_GUARDED_BY(crit_);
   uint32_t delayed_next_num_ RTC_GUARDED_BY(crit_);
+  bool delayed_message_leeway_allowed_ RTC_GUARDED_BY(crit_) = false;
 #if RTC_DCHECK_IS_ON
   uint32_t blocking_call_count_ RTC_GUARDED_BY(this) = 0;
   uint32_t could_be_blocking_call_count_ RTC_GUARDED_BY(this) = 0;
@@ -679,6 +740,7 @@ class RTC_LOCKABLE RTC_EXPORT Thread : public webrtc::TaskQueueBase {
 
   // Runs webrtc::QueuedTask posted to the Thread.
   QueuedTaskHandler queued_task_handler_;
+  webrtc::TaskQueueInstrumentation::Queue instrumentation_;
   std::unique_ptr<TaskQueueBase::CurrentTaskQueueSetter>
       task_queue_registration_;
 
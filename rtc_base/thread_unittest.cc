@@ -442,6 +442,20 @@ TEST(ThreadTest, Invoke) {
   thread->Invoke<void>(RTC_FROM_HERE, &LocalFuncs::Func2);
 }
 
+TEST(ThreadTest, InvokeOnCurrentThreadRunsFunctorDirectly) {
+  auto thread = Thread::Create();
+  thread->Start();
+  thread->Invoke<void>(RTC_FROM_HERE, [&thread] {
+    int value = 0;
+    EXPECT_EQ(42, thread->Invoke<int>(RTC_FROM_HERE, [&value] {
+      value = 42;
+      return value;
+    }));
+    EXPECT_EQ(42, value);
+    EXPECT_TRUE(thread->empty());
+  });
+}
+
 // Verifies that two threads calling Invoke on each other at the same time does
 // not deadlock but crash.
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
@@ -613,6 +627,40 @@ TEST_F(ThreadQueueTest, DelayedPostsWithIdenticalTimesAreProcessedInFifoOrder) {
   DelayedPostsWithIdenticalTimesAreProcessedInFifoOrder(&q_nullss);
 }
 
+TEST_F(ThreadQueueTest, ClearKeepsOrderOfRemainingMessages) {
+  class : public MessageHandler {
+    void OnMessage(Message* msg) override {}
+  } handler;
+  for (uint32_t id = 0; id < 6; ++id) {
+    Post(RTC_FROM_HERE, id % 2 == 0 ? nullptr : &handler, id);
+  }
+  Clear(&handler);
+  EXPECT_EQ(3u, size());
+
+  Message msg;
+  for (uint32_t id = 0; id < 6; id += 2) {
+    EXPECT_TRUE(Get(&msg, 0));
+    EXPECT_EQ(id, msg.message_id);
+  }
+  EXPECT_FALSE(Get(&msg, 0));
+  // Messages can be posted after the last one was removed.
+  Post(RTC_FROM_HERE, nullptr, 6);
+  EXPECT_TRUE(Get(&msg, 0));
+  EXPECT_EQ(6u, msg.message_id);
+}
+
+TEST_F(ThreadQueueTest, DelayedMessageIsNotDispatchedBeforeItIsDue) {
+  // This thread isn't running, so the clock must not process messages.
+  ScopedBaseFakeClock clock;
+  PostDelayed(RTC_FROM_HERE, 1000, nullptr, 1);
+  Message msg;
+  clock.AdvanceTime(webrtc::TimeDelta::Millis(999));
+  EXPECT_FALSE(Get(&msg, 0));
+  clock.AdvanceTime(webrtc::TimeDelta::Millis(1));
+  EXPECT_TRUE(Get(&msg, 0));
+  EXPECT_EQ(1u, msg.message_id);
+}
+
 TEST_F(ThreadQueueTest, DisposeNotLocked) {
   bool was_locked = true;
   bool deleted = false;